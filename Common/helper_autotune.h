@@ -0,0 +1,464 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Helper functions to autotune host and launch parameters.
+//
+// An engine declares its parameter space (tile sizes, unroll factors, thread
+// counts, SIMD widths, ...) with addParam() and calls tune() with a function
+// that times one configuration. The best configuration is stored in a cache
+// file per engine, CPU model and problem size bucket, so that later runs on
+// the same machine load it with lookup() without searching again.
+//
+// The cache file is CUDA_SAMPLES_AUTOTUNE_CACHE if set, otherwise
+// $HOME/.cuda_samples_autotune (%LOCALAPPDATA%\cuda_samples_autotune.txt on
+// Windows). Every line holds one entry of tab separated fields:
+//   engine  cpu model  size bucket  time (ms)  name=value,name=value,...
+// Setting CUDA_SAMPLES_AUTOTUNE_CACHE to an empty string disables the cache.
+
+#ifndef COMMON_HELPER_AUTOTUNE_H_
+#define COMMON_HELPER_AUTOTUNE_H_
+
+// includes, system
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+#include <intrin.h>
+#endif
+
+class sdkAutoTuner {
+ public:
+  // Returns the time in ms of one run of the configuration, or a negative
+  // value if the configuration is not valid for the problem
+  typedef std::function<float(const std::vector<int> &config)> TimeFunction;
+
+  explicit sdkAutoTuner(const char *engine, const char *cacheFile = NULL)
+      : engine_(engine),
+        cacheFile_(cacheFile ? cacheFile : getDefaultCacheFile()),
+        cpuModel_(getCPUModel()),
+        maxExhaustive_(256),
+        verbose_(false) {}
+
+  //! Declare a parameter and the values to search, in the order they are
+  //! tried. The first value is the default of the parameter.
+  void addParam(const char *name, const std::vector<int> &values) {
+    names_.push_back(name);
+    values_.push_back(values);
+  }
+
+  int getNumParams() const { return (int)names_.size(); }
+
+  const char *getParamName(int i) const { return names_[i].c_str(); }
+
+  const char *getCPUModelName() const { return cpuModel_.c_str(); }
+
+  //! Spaces with more configurations than this are searched one parameter at
+  //! a time instead of exhaustively
+  void setMaxExhaustive(int n) { maxExhaustive_ = n; }
+
+  void setVerbose(bool verbose) { verbose_ = verbose; }
+
+  //! The default configuration, the first value of every parameter
+  std::vector<int> getDefaultConfig() const {
+    std::vector<int> config;
+
+    for (size_t i = 0; i < values_.size(); i++) {
+      config.push_back(values_[i].empty() ? 0 : values_[i][0]);
+    }
+
+    return config;
+  }
+
+  //! Load the configuration of problemSize from the cache file
+  bool lookup(long long problemSize, std::vector<int> &config) const {
+    std::vector<std::string> lines;
+    readCache(lines);
+
+    std::string key = getKey(problemSize);
+
+    for (size_t i = 0; i < lines.size(); i++) {
+      if (lines[i].compare(0, key.size(), key) != 0) continue;
+
+      std::vector<std::string> fields = split(lines[i], '\t');
+
+      if (fields.size() == 5 && parseConfig(fields[4], config)) return true;
+    }
+
+    return false;
+  }
+
+  //! Search the parameter space for problemSize and store the fastest
+  //! configuration in the cache file. Every configuration is timed once,
+  //! only those within pruneFactor of the best time so far are timed
+  //! another repeats - 1 times, and the minimum time is kept.
+  bool tune(long long problemSize, TimeFunction run, std::vector<int> &best,
+            int repeats = 3, float pruneFactor = 1.25f) {
+    long long numConfigs = 1;
+
+    for (size_t i = 0; i < values_.size(); i++) {
+      if (values_[i].empty()) return false;
+
+      numConfigs *= (long long)values_[i].size();
+    }
+
+    bestTime_ = -1.0f;
+    numTimed_ = 0;
+    numPruned_ = 0;
+
+    if (numConfigs <= maxExhaustive_) {
+      std::vector<int> index(values_.size(), 0);
+
+      for (long long c = 0; c < numConfigs; c++) {
+        evaluate(toConfig(index), run, repeats, pruneFactor, best);
+
+        for (size_t i = 0; i < index.size(); i++) {
+          if (++index[i] < (int)values_[i].size()) break;
+
+          index[i] = 0;
+        }
+      }
+    } else {
+      // coordinate search: sweep every parameter with the others fixed at
+      // their best value, until a full pass does not improve
+      std::vector<int> index(values_.size(), 0);
+      bool improved = true;
+
+      evaluate(toConfig(index), run, repeats, pruneFactor, best);
+
+      for (int pass = 0; pass < 4 && improved; pass++) {
+        improved = false;
+
+        for (size_t i = 0; i < index.size(); i++) {
+          int bestIndex = index[i];
+
+          for (int v = 0; v < (int)values_[i].size(); v++) {
+            if (v == bestIndex) continue;
+
+            std::vector<int> trial = index;
+            trial[i] = v;
+
+            if (evaluate(toConfig(trial), run, repeats, pruneFactor, best)) {
+              bestIndex = v;
+              improved = true;
+            }
+          }
+
+          index[i] = bestIndex;
+        }
+      }
+    }
+
+    if (bestTime_ < 0.0f) return false;
+
+    if (verbose_) {
+      printf("autotune %s: %d configurations timed, %d pruned, best %s "
+             "(%.5f ms)\n",
+             engine_.c_str(), numTimed_, numPruned_,
+             formatConfig(best).c_str(), bestTime_);
+    }
+
+    store(problemSize, best, bestTime_);
+
+    return true;
+  }
+
+  //! Load the configuration of problemSize, and search for it if it is not
+  //! cached yet or if retune is set. Returns false only if no configuration
+  //! could be found, in which case config holds the default configuration.
+  bool getConfig(long long problemSize, TimeFunction run,
+                 std::vector<int> &config, bool retune = false) {
+    if (!retune && lookup(problemSize, config)) return true;
+
+    if (tune(problemSize, run, config)) return true;
+
+    config = getDefaultConfig();
+
+    return false;
+  }
+
+  float getBestTime() const { return bestTime_; }
+
+  //! "name=value,name=value,..."
+  std::string formatConfig(const std::vector<int> &config) const {
+    std::ostringstream s;
+
+    for (size_t i = 0; i < names_.size() && i < config.size(); i++) {
+      s << (i ? "," : "") << names_[i] << "=" << config[i];
+    }
+
+    return s.str();
+  }
+
+  //! Problem sizes are grouped by powers of two
+  static int getSizeBucket(long long problemSize) {
+    int bucket = 0;
+
+    while (problemSize > 1) {
+      problemSize >>= 1;
+      bucket++;
+    }
+
+    return bucket;
+  }
+
+  static std::string getCPUModel() {
+    std::string model;
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+#if defined(_M_X64) || defined(_M_IX86)
+    int regs[4];
+    char brand[49] = {0};
+
+    __cpuid(regs, 0x80000000);
+
+    if ((unsigned int)regs[0] >= 0x80000004) {
+      for (int i = 0; i < 3; i++) {
+        __cpuid(regs, 0x80000002 + i);
+        memcpy(brand + 16 * i, regs, 16);
+      }
+
+      model = brand;
+    }
+#endif
+#else
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    std::string hardware;
+
+    // x86 reports "model name", POWER "cpu" and ARM "Hardware"
+    while (model.empty() && std::getline(cpuinfo, line)) {
+      size_t colon = line.find(':');
+
+      if (colon == std::string::npos) continue;
+
+      std::string name = line.substr(0, colon);
+      name = name.substr(0, name.find_last_not_of(" \t") + 1);
+
+      if (name == "model name" || name == "cpu") {
+        model = line.substr(colon + 1);
+      } else if (name == "Hardware" && hardware.empty()) {
+        hardware = line.substr(colon + 1);
+      }
+    }
+
+    if (model.empty()) model = hardware;
+#endif
+
+    // keep the model on one field of the cache file
+    for (size_t i = 0; i < model.size(); i++) {
+      if (model[i] == '\t' || model[i] == '\n' || model[i] == '\r') {
+        model[i] = ' ';
+      }
+    }
+
+    size_t first = model.find_first_not_of(' ');
+    size_t last = model.find_last_not_of(' ');
+    model = (first == std::string::npos)
+                ? std::string("unknown")
+                : model.substr(first, last - first + 1);
+
+    std::ostringstream s;
+    s << model << " x" << std::thread::hardware_concurrency();
+
+    return s.str();
+  }
+
+  static std::string getDefaultCacheFile() {
+    const char *file = getenv("CUDA_SAMPLES_AUTOTUNE_CACHE");
+
+    if (file) return file;
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    const char *dir = getenv("LOCALAPPDATA");
+
+    if (dir) return std::string(dir) + "\\cuda_samples_autotune.txt";
+#else
+    const char *dir = getenv("HOME");
+
+    if (dir) return std::string(dir) + "/.cuda_samples_autotune";
+#endif
+
+    return "cuda_samples_autotune.txt";
+  }
+
+ private:
+  std::string engine_;
+  std::string cacheFile_;
+  std::string cpuModel_;
+  std::vector<std::string> names_;
+  std::vector<std::vector<int> > values_;
+  int maxExhaustive_;
+  bool verbose_;
+  float bestTime_ = -1.0f;
+  int numTimed_ = 0;
+  int numPruned_ = 0;
+
+  std::vector<int> toConfig(const std::vector<int> &index) const {
+    std::vector<int> config(index.size());
+
+    for (size_t i = 0; i < index.size(); i++) config[i] = values_[i][index[i]];
+
+    return config;
+  }
+
+  // Times one configuration, returns true if it is the best one so far
+  bool evaluate(const std::vector<int> &config, TimeFunction &run,
+                int repeats, float pruneFactor, std::vector<int> &best) {
+    float t = run(config);
+
+    if (t < 0.0f) return false;
+
+    numTimed_++;
+
+    if (bestTime_ >= 0.0f && t > pruneFactor * bestTime_) {
+      numPruned_++;
+      return false;
+    }
+
+    for (int r = 1; r < repeats; r++) {
+      float tr = run(config);
+
+      if (tr >= 0.0f && tr < t) t = tr;
+    }
+
+    if (bestTime_ >= 0.0f && t >= bestTime_) return false;
+
+    bestTime_ = t;
+    best = config;
+
+    return true;
+  }
+
+  std::string getKey(long long problemSize) const {
+    std::ostringstream s;
+    s << engine_ << '\t' << cpuModel_ << '\t' << getSizeBucket(problemSize)
+      << '\t';
+
+    return s.str();
+  }
+
+  static std::vector<std::string> split(const std::string &s, char sep) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream stream(s);
+
+    while (std::getline(stream, field, sep)) fields.push_back(field);
+
+    return fields;
+  }
+
+  // Accepts a cached configuration only if it names the same parameters
+  bool parseConfig(const std::string &s, std::vector<int> &config) const {
+    std::vector<std::string> items = split(s, ',');
+
+    if (items.size() != names_.size()) return false;
+
+    std::vector<int> parsed;
+
+    for (size_t i = 0; i < items.size(); i++) {
+      size_t eq = items[i].find('=');
+
+      if (eq == std::string::npos || items[i].substr(0, eq) != names_[i]) {
+        return false;
+      }
+
+      parsed.push_back(atoi(items[i].c_str() + eq + 1));
+    }
+
+    config = parsed;
+
+    return true;
+  }
+
+  void readCache(std::vector<std::string> &lines) const {
+    if (cacheFile_.empty()) return;
+
+    std::ifstream in(cacheFile_.c_str());
+    std::string line;
+
+    while (std::getline(in, line)) {
+      if (!line.empty()) lines.push_back(line);
+    }
+  }
+
+  // Rewrites the cache file with the entry of problemSize replaced. The new
+  // file is written next to the old one and renamed over it, so that an
+  // interrupted run never leaves a truncated cache behind.
+  void store(long long problemSize, const std::vector<int> &config,
+             float time) const {
+    if (cacheFile_.empty()) return;
+
+    std::vector<std::string> lines;
+    readCache(lines);
+
+    std::string key = getKey(problemSize);
+    std::ostringstream entry;
+    entry << key << time << '\t' << formatConfig(config);
+
+    bool replaced = false;
+
+    for (size_t i = 0; i < lines.size(); i++) {
+      if (lines[i].compare(0, key.size(), key) == 0) {
+        lines[i] = entry.str();
+        replaced = true;
+      }
+    }
+
+    if (!replaced) lines.push_back(entry.str());
+
+    std::string tmpFile = cacheFile_ + ".tmp";
+
+    {
+      std::ofstream out(tmpFile.c_str());
+
+      if (!out) {
+        printf("autotune: cannot write %s\n", tmpFile.c_str());
+        return;
+      }
+
+      for (size_t i = 0; i < lines.size(); i++) out << lines[i] << '\n';
+    }
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    remove(cacheFile_.c_str());
+#endif
+
+    if (rename(tmpFile.c_str(), cacheFile_.c_str()) != 0) {
+      printf("autotune: cannot write %s\n", cacheFile_.c_str());
+    }
+  }
+};
+
+#endif  // COMMON_HELPER_AUTOTUNE_H_
@@ -0,0 +1,437 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host BC1 (DXT1) decoding and error metrics.
+//
+//   sdkDecodeBC1(blocks, width, height, rgba, width * 4);
+//   sdkBC1Error error;
+//   sdkCompareBC1(blocks, refBlocks, width, height, error);
+//   sdkCompareBC1Image(blocks, width, height, rgba, pitch, error);
+//
+// A block is 8 bytes, two RGB 565 end points followed by 16 2-bit indices,
+// and blocks are stored row by row with (width + 3) / 4 blocks per row. The
+// palette is the one of the dxtc sample: end points are expanded by bit
+// replication, a block with c0 > c1 adds (2 c0 + c1) / 3 and (c0 + 2 c1) / 3,
+// otherwise (c0 + c1) / 2 and transparent black, all rounded down. Images are
+// 8-bit RGBA with R in the first byte, as loaded by sdkLoadPPM4ub().
+//
+// Four blocks are decoded per iteration with SSE2: the palettes are built
+// with one block per lane, then each 4-texel row of a block is selected from
+// its palette by compares and written with one 16-byte store. The compare
+// functions do the same decode and, in the same loop, sum the squared R, G
+// and B differences against the reference rows (alpha is ignored), so no
+// decoded image is written. A BC1 reference is decoded one block row at a
+// time into a small buffer. Block rows are distributed over threads; the
+// integer sums do not depend on the number of threads.
+
+#ifndef COMMON_HELPER_DXT_H_
+#define COMMON_HELPER_DXT_H_
+
+// includes, system
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SDK_DXT_SSE2 1
+#endif
+
+struct sdkBC1Error {
+  unsigned long long sse;        // sum of squared R, G and B differences
+  unsigned long long pixels;
+  unsigned int maxError;         // largest channel difference
+  unsigned int blocksDiffering;  // blocks with an RGB difference
+  double mse;                    // sse / (3 pixels)
+  double psnr;                   // dB for a peak of 255, infinite if equal
+};
+
+namespace sdkDxtDetail {
+
+// blocks below which a call runs on fewer threads
+const int kBlocksPerThread = 4096;
+
+// Run fn(index, worker) for index in [0, count) on up to numThreads threads
+template <class F>
+inline void parallelFor(int count, int numThreads, F fn) {
+  numThreads = (std::max)(1, (std::min)(numThreads, count));
+
+  std::atomic<int> next(0);
+  auto worker = [&](int w) {
+    int i;
+
+    while ((i = next++) < count) fn(i, w);
+  };
+
+  std::vector<std::thread> threads;
+
+  for (int t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker, t));
+    } catch (const std::system_error &) {
+      // no thread support, this thread takes the remaining work
+      break;
+    }
+  }
+
+  worker(0);
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+
+struct Accum {
+  unsigned long long sse;
+  unsigned int maxError;
+  unsigned int blocksDiffering;
+
+  Accum() : sse(0), maxError(0), blocksDiffering(0) {}
+};
+
+inline uint32_t pack(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+  return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+// Palette of one block as packed RGBA
+inline void palette(const uint8_t *block, uint32_t pal[4]) {
+  const uint32_t c0 = block[0] | (block[1] << 8);
+  const uint32_t c1 = block[2] | (block[3] << 8);
+  const uint32_t r0 = ((c0 >> 11) << 3) | (c0 >> 13);
+  const uint32_t g0 = (((c0 >> 5) & 63) << 2) | ((c0 >> 9) & 3);
+  const uint32_t b0 = ((c0 & 31) << 3) | ((c0 >> 2) & 7);
+  const uint32_t r1 = ((c1 >> 11) << 3) | (c1 >> 13);
+  const uint32_t g1 = (((c1 >> 5) & 63) << 2) | ((c1 >> 9) & 3);
+  const uint32_t b1 = ((c1 & 31) << 3) | ((c1 >> 2) & 7);
+
+  pal[0] = pack(r0, g0, b0, 255);
+  pal[1] = pack(r1, g1, b1, 255);
+
+  if (c0 > c1) {
+    pal[2] = pack((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3,
+                  255);
+    pal[3] = pack((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3,
+                  255);
+  } else {
+    pal[2] = pack((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+    pal[3] = 0;
+  }
+}
+
+inline uint32_t texelError(uint32_t a, uint32_t b, unsigned int &maxError) {
+  uint32_t sse = 0;
+
+  for (int c = 0; c < 24; c += 8) {
+    int d = (int)((a >> c) & 255) - (int)((b >> c) & 255);
+    d = d < 0 ? -d : d;
+    maxError = (std::max)(maxError, (unsigned int)d);
+    sse += d * d;
+  }
+
+  return sse;
+}
+
+#if defined(SDK_DXT_SSE2)
+// Palettes of four blocks, one block per lane
+inline void palette4(__m128i colors, __m128i pal[4]) {
+  const __m128i m5 = _mm_set1_epi32(31), m6 = _mm_set1_epi32(63);
+  const __m128i third = _mm_set1_epi32(0xAAAB);  // x / 3 = x 0xAAAB >> 17
+  __m128i c[2] = {_mm_and_si128(colors, _mm_set1_epi32(0xFFFF)),
+                  _mm_srli_epi32(colors, 16)};
+  __m128i ch[2][3];
+
+  for (int e = 0; e < 2; e++) {
+    __m128i r = _mm_srli_epi32(c[e], 11);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(c[e], 5), m6);
+    __m128i b = _mm_and_si128(c[e], m5);
+    ch[e][0] = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+    ch[e][1] = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+    ch[e][2] = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+  }
+
+  __m128i p[4][3];
+
+  for (int k = 0; k < 3; k++) {
+    __m128i a = ch[0][k], b = ch[1][k];
+    __m128i sum = _mm_add_epi32(a, b);
+    // the values are below 2^16, the low 16 bits of each lane hold them
+    __m128i p2 = _mm_srli_epi32(
+        _mm_mulhi_epu16(_mm_add_epi32(sum, a), third), 1);
+    __m128i p3 = _mm_srli_epi32(
+        _mm_mulhi_epu16(_mm_add_epi32(sum, b), third), 1);
+    __m128i half = _mm_srli_epi32(sum, 1);
+    __m128i four = _mm_cmpgt_epi32(c[0], c[1]);
+
+    p[0][k] = a;
+    p[1][k] = b;
+    p[2][k] = _mm_or_si128(_mm_and_si128(four, p2),
+                           _mm_andnot_si128(four, half));
+    p[3][k] = _mm_and_si128(four, p3);
+  }
+
+  const __m128i opaque = _mm_set1_epi32((int)0xFF000000);
+  const __m128i four = _mm_cmpgt_epi32(c[0], c[1]);
+
+  for (int e = 0; e < 4; e++) {
+    pal[e] = _mm_or_si128(
+        _mm_or_si128(p[e][0], _mm_slli_epi32(p[e][1], 8)),
+        _mm_slli_epi32(p[e][2], 16));
+    pal[e] = _mm_or_si128(pal[e], e < 3 ? opaque
+                                        : _mm_and_si128(four, opaque));
+  }
+}
+
+inline uint32_t horizontalSum(__m128i v) {
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_cvtsi128_si32(v);
+}
+#endif
+
+// Decodes a row of nbx blocks covering rows of the image (1 to 4) and
+// width texels. Writes the texels to out and / or compares them with ref,
+// either can be NULL; blockErrors receives the squared error per block.
+inline void blockRow(const uint8_t *blocks, int nbx, int width, int rows,
+                     uint8_t *out, size_t pitch, const uint8_t *ref,
+                     size_t refPitch, Accum &acc, unsigned int *blockErrors) {
+  int bx = 0;
+
+#if defined(SDK_DXT_SSE2)
+  const int fullBlocks = (rows == 4) ? width / 4 : 0;
+  const __m128i shift = _mm_setr_epi32(3, 12, 48, 192);
+  const __m128i key1 = _mm_setr_epi32(1, 4, 16, 64);
+  const __m128i key2 = _mm_setr_epi32(2, 8, 32, 128);
+  const __m128i rgb = _mm_set1_epi32(0x00FFFFFF), zero = _mm_setzero_si128();
+  __m128i maxDiff = zero;
+
+  for (; bx + 4 <= fullBlocks; bx += 4) {
+    const uint8_t *b = blocks + 8 * bx;
+    __m128 lo = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)b));
+    __m128 hi = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(b + 16)));
+    __m128i colors =
+        _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    union {
+      __m128i v;
+      uint32_t u[4];
+    } pal[4], indices;
+
+    indices.v =
+        _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    __m128i p[4];
+    palette4(colors, p);
+
+    for (int e = 0; e < 4; e++) pal[e].v = p[e];
+
+    for (int k = 0; k < 4; k++) {
+      const __m128i p0 = _mm_set1_epi32((int)pal[0].u[k]);
+      const __m128i p1 = _mm_set1_epi32((int)pal[1].u[k]);
+      const __m128i p2 = _mm_set1_epi32((int)pal[2].u[k]);
+      const __m128i p3 = _mm_set1_epi32((int)pal[3].u[k]);
+      const size_t x = 16 * (size_t)(bx + k);
+      __m128i blockSse = zero;
+
+      for (int y = 0; y < 4; y++) {
+        __m128i sel = _mm_and_si128(
+            _mm_set1_epi32((int)((indices.u[k] >> (8 * y)) & 255)), shift);
+        __m128i t = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(sel, zero), p0),
+                         _mm_and_si128(_mm_cmpeq_epi32(sel, key1), p1)),
+            _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(sel, key2), p2),
+                         _mm_and_si128(_mm_cmpeq_epi32(sel, shift), p3)));
+
+        if (out) _mm_storeu_si128((__m128i *)(out + y * pitch + x), t);
+
+        if (ref) {
+          __m128i r =
+              _mm_loadu_si128((const __m128i *)(ref + y * refPitch + x));
+          __m128i d = _mm_and_si128(
+              _mm_or_si128(_mm_subs_epu8(t, r), _mm_subs_epu8(r, t)), rgb);
+          __m128i dl = _mm_unpacklo_epi8(d, zero);
+          __m128i dh = _mm_unpackhi_epi8(d, zero);
+          maxDiff = _mm_max_epu8(maxDiff, d);
+          blockSse = _mm_add_epi32(blockSse, _mm_madd_epi16(dl, dl));
+          blockSse = _mm_add_epi32(blockSse, _mm_madd_epi16(dh, dh));
+        }
+      }
+
+      if (ref) {
+        uint32_t sse = horizontalSum(blockSse);
+        acc.sse += sse;
+        acc.blocksDiffering += sse != 0;
+
+        if (blockErrors) blockErrors[bx + k] = sse;
+      }
+    }
+  }
+
+  if (ref) {
+    union {
+      __m128i v;
+      uint8_t u[16];
+    } m;
+
+    m.v = maxDiff;
+
+    for (int i = 0; i < 16; i++)
+      acc.maxError = (std::max)(acc.maxError, (unsigned int)m.u[i]);
+  }
+#endif
+
+  // remaining blocks, clipped at the image border
+  for (; bx < nbx; bx++) {
+    uint32_t pal[4];
+    const uint8_t *b = blocks + 8 * bx;
+    const uint32_t indices = b[4] | (b[5] << 8) | (b[6] << 16) |
+                             ((uint32_t)b[7] << 24);
+    const int cols = (std::min)(4, width - 4 * bx);
+    uint32_t sse = 0;
+
+    palette(b, pal);
+
+    for (int y = 0; y < rows; y++) {
+      for (int x = 0; x < cols; x++) {
+        const uint32_t t = pal[(indices >> (8 * y + 2 * x)) & 3];
+        const size_t offset = 4 * (size_t)(4 * bx + x);
+
+        if (out) memcpy(out + y * pitch + offset, &t, 4);
+
+        if (ref) {
+          uint32_t r;
+          memcpy(&r, ref + y * refPitch + offset, 4);
+          sse += texelError(t, r, acc.maxError);
+        }
+      }
+    }
+
+    if (ref) {
+      acc.sse += sse;
+      acc.blocksDiffering += sse != 0;
+
+      if (blockErrors) blockErrors[bx] = sse;
+    }
+  }
+}
+
+// Decode and / or compare against an RGBA image or BC1 blocks
+inline void run(const void *blocks, int width, int height, uint8_t *out,
+                size_t pitch, const uint8_t *refImage, size_t refPitch,
+                const void *refBlocks, sdkBC1Error *error,
+                unsigned int *blockErrors, int numThreads) {
+  const int nbx = (width + 3) / 4, nby = (height + 3) / 4;
+
+  if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+  numThreads = (std::min)(numThreads, nbx * nby / kBlocksPerThread + 1);
+
+  std::vector<Accum> acc((std::max)(numThreads, 1));
+  std::vector<std::vector<uint8_t> > buffers(acc.size());
+
+  parallelFor(nby, numThreads, [&](int by, int w) {
+    const int rows = (std::min)(4, height - 4 * by);
+    const uint8_t *row = (const uint8_t *)blocks + 8 * (size_t)nbx * by;
+    const uint8_t *ref = refImage ? refImage + 4 * refPitch * by : NULL;
+    size_t rowPitch = refPitch;
+
+    if (refBlocks) {
+      std::vector<uint8_t> &buffer = buffers[w];
+
+      if (buffer.empty()) buffer.resize(16 * (size_t)nbx * 4);
+
+      rowPitch = 16 * (size_t)nbx;
+      blockRow((const uint8_t *)refBlocks + 8 * (size_t)nbx * by, nbx, width,
+               rows, &buffer[0], rowPitch, NULL, 0, acc[w], NULL);
+      ref = &buffer[0];
+    }
+
+    blockRow(row, nbx, width, rows, out ? out + 4 * pitch * by : NULL, pitch,
+             ref, rowPitch, acc[w],
+             blockErrors ? blockErrors + (size_t)nbx * by : NULL);
+  });
+
+  if (!error) return;
+
+  memset(error, 0, sizeof(*error));
+  error->pixels = (unsigned long long)width * height;
+
+  for (size_t w = 0; w < acc.size(); w++) {
+    error->sse += acc[w].sse;
+    error->maxError = (std::max)(error->maxError, acc[w].maxError);
+    error->blocksDiffering += acc[w].blocksDiffering;
+  }
+
+  error->mse = error->pixels ? (double)error->sse / (3.0 * error->pixels) : 0;
+  error->psnr = (error->mse > 0) ? 10.0 * log10(255.0 * 255.0 / error->mse)
+                                 : HUGE_VAL;
+}
+
+}  // namespace sdkDxtDetail
+
+//////////////////////////////////////////////////////////////////////////////
+//! Decode BC1 blocks into RGBA rows
+//! @param pitch       bytes between output rows, at least 4 width
+//! @param numThreads  <= 0 selects the number of hardware threads
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkDecodeBC1(const void *blocks, int width, int height,
+                         unsigned char *rgba, size_t pitch,
+                         int numThreads = 0) {
+  sdkDxtDetail::run(blocks, width, height, rgba, pitch, NULL, 0, NULL, NULL,
+                    NULL, numThreads);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Error of BC1 blocks against an RGBA image, without writing the decoded
+//! image
+//! @param blockErrors  optional, the squared RGB error of every block
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkCompareBC1Image(const void *blocks, int width, int height,
+                               const unsigned char *rgba, size_t pitch,
+                               sdkBC1Error &error,
+                               unsigned int *blockErrors = NULL,
+                               int numThreads = 0) {
+  sdkDxtDetail::run(blocks, width, height, NULL, 0, rgba, pitch, NULL, &error,
+                    blockErrors, numThreads);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Error of BC1 blocks against reference BC1 blocks of the same size
+//! @param blockErrors  optional, the squared RGB error of every block
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkCompareBC1(const void *blocks, const void *refBlocks,
+                          int width, int height, sdkBC1Error &error,
+                          unsigned int *blockErrors = NULL,
+                          int numThreads = 0) {
+  sdkDxtDetail::run(blocks, width, height, NULL, 0, NULL, 0, refBlocks,
+                    &error, blockErrors, numThreads);
+}
+
+#endif  // COMMON_HELPER_DXT_H_
@@ -0,0 +1,832 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host FFT of single precision complex and real data.
+//
+//   int n[2] = {fftH, fftW};
+//   std::shared_ptr<const sdkFftPlan> plan =
+//       sdkFftGetPlan(2, n, SDK_FFT_R2C);        // cached by size
+//   plan->execR2C(h_Data, h_Spectrum);           // fftH x (fftW / 2 + 1)
+//
+// Plans follow cuFFT: rank 1 to 3 with n[0] the slowest dimension, batch
+// transforms stored one after the other, unnormalized transforms (an
+// inverse after a forward transform scales by the number of points), R2C
+// producing the n[rank - 1] / 2 + 1 non-redundant outputs of the last
+// dimension and C2R consuming them. sdkFftComplex has the layout of
+// cufftComplex and float2.
+//
+// A 1D transform is a Stockham autosort FFT over the factors of its length:
+// radix 4, 2, 3, 5 and 7 butterflies and a generic odd radix for larger
+// primes (O(n p), slow for large prime factors). The transforms of a pass
+// along one axis are gathered four at a time into split real and imaginary
+// vectors, every butterfly works on four transforms at once (SSE on x86),
+// and the groups are distributed over threads. A single 1D transform of
+// 2^14 or more points is done in four steps, n = n1 n2: n2 transforms of
+// length n1, twiddles, n1 transforms of length n2 and a transpose, each
+// step batched and threaded. Real transforms of even length run a complex
+// transform of half the length on the packed even and odd samples.
+//
+// Twiddles are computed in double precision. Plans are immutable and can be
+// shared between threads; exec functions return false for a plan of another
+// type. Real transforms are out of place.
+
+#ifndef COMMON_HELPER_FFT_H_
+#define COMMON_HELPER_FFT_H_
+
+// includes, system
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SDK_FFT_SSE2 1
+#endif
+
+#define SDK_FFT_FORWARD (-1)
+#define SDK_FFT_INVERSE (1)
+
+typedef enum { SDK_FFT_C2C, SDK_FFT_R2C, SDK_FFT_C2R } sdkFftType;
+
+struct sdkFftComplex {
+  float x, y;
+};
+
+namespace sdkFftDetail {
+
+const double kPi = 3.14159265358979323846;
+
+// single transforms of at least this size are done in four steps
+const int kFourStepMin = 1 << 14;
+
+// points per thread below which a pass runs on fewer threads
+const double kPointsPerThread = 1 << 15;
+
+// Four transforms in the lanes of a vector
+#if defined(SDK_FFT_SSE2)
+struct Lanes {
+  __m128 v;
+  Lanes() {}
+  Lanes(float x) : v(_mm_set1_ps(x)) {}
+  Lanes(__m128 x) : v(x) {}
+};
+
+inline Lanes operator+(Lanes a, Lanes b) { return _mm_add_ps(a.v, b.v); }
+inline Lanes operator-(Lanes a, Lanes b) { return _mm_sub_ps(a.v, b.v); }
+inline Lanes operator*(Lanes a, Lanes b) { return _mm_mul_ps(a.v, b.v); }
+#else
+struct Lanes {
+  float v[4];
+  Lanes() {}
+  Lanes(float x) { v[0] = v[1] = v[2] = v[3] = x; }
+};
+
+#define SDK_FFT_LANES_OP(op)                                    \
+  inline Lanes operator op(Lanes a, Lanes b) {                  \
+    for (int i = 0; i < 4; i++) a.v[i] = a.v[i] op b.v[i];      \
+    return a;                                                   \
+  }
+SDK_FFT_LANES_OP(+)
+SDK_FFT_LANES_OP(-)
+SDK_FFT_LANES_OP(*)
+#undef SDK_FFT_LANES_OP
+#endif
+
+const int kLanes = (int)(sizeof(Lanes) / sizeof(float));
+
+// Run fn(index, worker) for index in [0, count) on up to numThreads threads
+template <class F>
+inline void parallelFor(int count, int numThreads, F fn) {
+  numThreads = (std::max)(1, (std::min)(numThreads, count));
+
+  std::atomic<int> next(0);
+  auto worker = [&](int w) {
+    int i;
+
+    while ((i = next++) < count) fn(i, w);
+  };
+
+  std::vector<std::thread> threads;
+
+  for (int t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker, t));
+    } catch (const std::system_error &) {
+      // no thread support, this thread takes the remaining work
+      break;
+    }
+  }
+
+  worker(0);
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+
+inline int threadsFor(int numThreads, double points) {
+  if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+  const int useful = (int)(points / kPointsPerThread);
+
+  return (std::max)(1, (std::min)(numThreads, useful));
+}
+
+struct Stage {
+  int p, m, s;  // radix, outputs per butterfly group, stride
+  size_t tw;    // offset of the twiddles, (p - 1) per group
+  size_t rot;   // offset of the cos / sin table of odd radices
+};
+
+// Plan of one 1D complex transform
+struct Plan1D {
+  int n;
+  int maxRadix;
+  std::vector<Stage> stages;
+  std::vector<float> twCos, twSin;    // cos, sin(2 pi j k / N)
+  std::vector<float> rotCos, rotSin;  // cos, sin(2 pi m k / p)
+  // four steps, n = n1 n2, with twiddles cos, sin(2 pi j2 k1 / n)
+  int n1, n2;
+  std::unique_ptr<Plan1D> plan1, plan2;
+  std::vector<float> fsCos, fsSin;
+
+  explicit Plan1D(int length, bool allowFourStep = true)
+      : n(length), maxRadix(1), n1(0), n2(0) {
+    std::vector<int> factors;
+    int rest = n;
+
+    while (rest % 4 == 0) factors.push_back(4), rest /= 4;
+
+    for (int f = 2; rest > 1; f++) {
+      while (rest % f == 0) factors.push_back(f), rest /= f;
+
+      if (f * f > rest && rest > 1) {
+        factors.push_back(rest);
+        break;
+      }
+    }
+
+    int N = n, s = 1;
+
+    for (size_t i = 0; i < factors.size(); i++) {
+      Stage st;
+      st.p = factors[i];
+      st.m = N / st.p;
+      st.s = s;
+      st.tw = twCos.size();
+      st.rot = rotCos.size();
+
+      for (int j = 0; j < st.m; j++) {
+        for (int k = 1; k < st.p; k++) {
+          double a = 2.0 * kPi * (double)((long long)j * k % N) / N;
+          twCos.push_back((float)cos(a));
+          twSin.push_back((float)sin(a));
+        }
+      }
+
+      if (st.p % 2) {
+        for (int mm = 1; mm <= st.p / 2; mm++) {
+          for (int k = 1; k <= st.p / 2; k++) {
+            double a = 2.0 * kPi * (double)(mm * k % st.p) / st.p;
+            rotCos.push_back((float)cos(a));
+            rotSin.push_back((float)sin(a));
+          }
+        }
+      }
+
+      maxRadix = (std::max)(maxRadix, st.p);
+      stages.push_back(st);
+      N = st.m;
+      s *= st.p;
+    }
+
+    if (!allowFourStep || n < kFourStepMin) return;
+
+    // n1 the largest product of factors not above sqrt(n)
+    int p1 = 1;
+
+    for (size_t i = 0; i < factors.size(); i++) {
+      if ((double)p1 * factors[i] * p1 * factors[i] <= (double)n)
+        p1 *= factors[i];
+    }
+
+    if (p1 < 16 || n / p1 < 16) return;
+
+    n1 = p1;
+    n2 = n / p1;
+    plan1.reset(new Plan1D(n1, false));
+    plan2.reset(new Plan1D(n2, false));
+    fsCos.resize(n);
+    fsSin.resize(n);
+
+    for (int k1 = 0; k1 < n1; k1++) {
+      for (int j2 = 0; j2 < n2; j2++) {
+        double a = 2.0 * kPi * (double)((long long)j2 * k1 % n) / n;
+        fsCos[(size_t)k1 * n2 + j2] = (float)cos(a);
+        fsSin[(size_t)k1 * n2 + j2] = (float)sin(a);
+      }
+    }
+  }
+
+  // scratch of runGroup in elements of V
+  size_t scratchSize() const { return 4 * (size_t)n + 2 * maxRadix; }
+};
+
+// y = x w, w = c + i s
+template <class V>
+inline void twiddle(V &re, V &im, V c, V s) {
+  V r = re * c - im * s;
+  im = re * s + im * c;
+  re = r;
+}
+
+// One Stockham stage of radix p: for j < m and q < s
+//   y[q + s (p j + k)] = w^(j k) sum_r x[q + s (j + r m)] u^(r k)
+// with w = exp(sign 2 pi i / (p m)) and u = exp(sign 2 pi i / p)
+// P is p for the unrolled radices and 0 for the generic odd radix
+template <class V, int P>
+inline void stage(const Plan1D &plan, const Stage &st, const V *xr,
+                  const V *xi, V *yr, V *yi, float sign, V *tmp) {
+  const int p = P ? P : st.p, m = st.m, s = st.s, half = p / 2;
+  const float *twc = &plan.twCos[0] + st.tw, *tws = &plan.twSin[0] + st.tw;
+  const float *rc = plan.rotCos.empty() ? NULL : &plan.rotCos[0] + st.rot;
+  const float *rs = plan.rotSin.empty() ? NULL : &plan.rotSin[0] + st.rot;
+  V stackRe[P ? P : 1], stackIm[P ? P : 1];
+  V *ar = P ? stackRe : tmp, *ai = P ? stackIm : tmp + p;
+
+  for (int j = 0; j < m; j++) {
+    const float *wc = twc + (size_t)j * (p - 1);
+    const float *ws = tws + (size_t)j * (p - 1);
+
+    for (int q = 0; q < s; q++) {
+      for (int r = 0; r < p; r++) {
+        ar[r] = xr[q + (size_t)s * (j + r * m)];
+        ai[r] = xi[q + (size_t)s * (j + r * m)];
+      }
+
+      V *outR = yr + q + (size_t)s * p * j, *outI = yi + q + (size_t)s * p * j;
+
+      if (P == 2) {
+        V r1 = ar[0] - ar[1], i1 = ai[0] - ai[1];
+        outR[0] = ar[0] + ar[1];
+        outI[0] = ai[0] + ai[1];
+        twiddle(r1, i1, V(wc[0]), V(sign * ws[0]));
+        outR[s] = r1;
+        outI[s] = i1;
+      } else if (P == 4) {
+        V t0r = ar[0] + ar[2], t0i = ai[0] + ai[2];
+        V t1r = ar[0] - ar[2], t1i = ai[0] - ai[2];
+        V t2r = ar[1] + ar[3], t2i = ai[1] + ai[3];
+        // (a1 - a3) times exp(sign pi i / 2) = sign i
+        V t3r = (ai[3] - ai[1]) * V(sign), t3i = (ar[1] - ar[3]) * V(sign);
+        V c1r = t1r + t3r, c1i = t1i + t3i;
+        V c2r = t0r - t2r, c2i = t0i - t2i;
+        V c3r = t1r - t3r, c3i = t1i - t3i;
+        outR[0] = t0r + t2r;
+        outI[0] = t0i + t2i;
+        twiddle(c1r, c1i, V(wc[0]), V(sign * ws[0]));
+        twiddle(c2r, c2i, V(wc[1]), V(sign * ws[1]));
+        twiddle(c3r, c3i, V(wc[2]), V(sign * ws[2]));
+        outR[s] = c1r;
+        outI[s] = c1i;
+        outR[2 * s] = c2r;
+        outI[2 * s] = c2i;
+        outR[3 * s] = c3r;
+        outI[3 * s] = c3i;
+      } else {
+        // odd radix: pairs k, p - k share cos and differ in the sign of sin
+        V c0r = ar[0], c0i = ai[0];
+
+        for (int k = 1; k <= half; k++) {
+          V sr = ar[k] + ar[p - k], si = ai[k] + ai[p - k];
+          V dr = ar[k] - ar[p - k], di = ai[k] - ai[p - k];
+          c0r = c0r + sr;
+          c0i = c0i + si;
+          ar[k] = sr;
+          ai[k] = si;
+          ar[p - k] = dr;
+          ai[p - k] = di;
+        }
+
+        outR[0] = c0r;
+        outI[0] = c0i;
+
+        for (int mm = 1; mm <= half; mm++) {
+          V Ar = ar[0], Ai = ai[0], Br = V(0.0f), Bi = V(0.0f);
+
+          for (int k = 1; k <= half; k++) {
+            V c(rc[(mm - 1) * half + k - 1]), sn(rs[(mm - 1) * half + k - 1]);
+            Ar = Ar + c * ar[k];
+            Ai = Ai + c * ai[k];
+            Br = Br + sn * ar[p - k];
+            Bi = Bi + sn * ai[p - k];
+          }
+
+          // c_m = A + sign i B, c_(p - m) = A - sign i B
+          V sBr = Bi * V(-sign), sBi = Br * V(sign);
+          V cmr = Ar + sBr, cmi = Ai + sBi;
+          V cpr = Ar - sBr, cpi = Ai - sBi;
+          twiddle(cmr, cmi, V(wc[mm - 1]), V(sign * ws[mm - 1]));
+          twiddle(cpr, cpi, V(wc[p - mm - 1]), V(sign * ws[p - mm - 1]));
+          outR[(size_t)mm * s] = cmr;
+          outI[(size_t)mm * s] = cmi;
+          outR[(size_t)(p - mm) * s] = cpr;
+          outI[(size_t)(p - mm) * s] = cpi;
+        }
+      }
+    }
+  }
+}
+
+// All stages, ping-ponging between x and y; returns the buffers holding
+// the result in natural order
+template <class V>
+inline void stockham(const Plan1D &plan, V *&re, V *&im, V *yr, V *yi,
+                     float sign, V *tmp) {
+  for (size_t i = 0; i < plan.stages.size(); i++) {
+    const Stage &st = plan.stages[i];
+
+    switch (st.p) {
+      case 2:
+        stage<V, 2>(plan, st, re, im, yr, yi, sign, tmp);
+        break;
+      case 3:
+        stage<V, 3>(plan, st, re, im, yr, yi, sign, tmp);
+        break;
+      case 4:
+        stage<V, 4>(plan, st, re, im, yr, yi, sign, tmp);
+        break;
+      case 5:
+        stage<V, 5>(plan, st, re, im, yr, yi, sign, tmp);
+        break;
+      case 7:
+        stage<V, 7>(plan, st, re, im, yr, yi, sign, tmp);
+        break;
+      default:
+        stage<V, 0>(plan, st, re, im, yr, yi, sign, tmp);
+        break;
+    }
+
+    std::swap(re, yr);
+    std::swap(im, yi);
+  }
+}
+
+// How the transforms of a pass are read and written
+enum PassInput {
+  INPUT_COMPLEX,
+  INPUT_REAL,       // real samples, zero imaginary part
+  INPUT_HERMITIAN,  // n / 2 + 1 outputs of a real transform
+};
+
+// count transforms t = o inner + c of length n, element e of t at
+// o block + c + e stride of the input and output arrays, in complex
+// elements, or in floats for real input and output
+struct Pass {
+  int n, count, inner;
+  size_t inBlock, inStride, outBlock, outStride;
+  PassInput input;
+  bool realOutput;  // only the real part is written
+  int outCount;     // elements written per transform
+
+  Pass(int n_, int count_, int inner_, size_t inBlock_, size_t inStride_,
+       size_t outBlock_, size_t outStride_)
+      : n(n_),
+        count(count_),
+        inner(inner_),
+        inBlock(inBlock_),
+        inStride(inStride_),
+        outBlock(outBlock_),
+        outStride(outStride_),
+        input(INPUT_COMPLEX),
+        realOutput(false),
+        outCount(n_) {}
+
+  size_t inBase(int t) const {
+    return (size_t)(t / inner) * inBlock + (size_t)(t % inner);
+  }
+
+  size_t outBase(int t) const {
+    return (size_t)(t / inner) * outBlock + (size_t)(t % inner);
+  }
+};
+
+// Gathers transforms t0 ... t0 + L - 1 into lanes l of re[e L + l]
+inline void gather(const Pass &pass, const float *in, int t0, int L,
+                   float *re, float *im) {
+  const int n = pass.n, h = n / 2;
+
+  for (int l = 0; l < L; l++) {
+    const int t = t0 + l;
+
+    if (t >= pass.count) {
+      for (int e = 0; e < n; e++) re[e * L + l] = im[e * L + l] = 0.0f;
+
+      continue;
+    }
+
+    const size_t base = pass.inBase(t);
+
+    for (int e = 0; e < n; e++) {
+      if (pass.input == INPUT_REAL) {
+        re[e * L + l] = in[base + e * pass.inStride];
+        im[e * L + l] = 0.0f;
+      } else if (pass.input == INPUT_HERMITIAN && e > h) {
+        const size_t i = 2 * (base + (n - e) * pass.inStride);
+        re[e * L + l] = in[i];
+        im[e * L + l] = -in[i + 1];
+      } else {
+        const size_t i = 2 * (base + e * pass.inStride);
+        re[e * L + l] = in[i];
+        im[e * L + l] = in[i + 1];
+      }
+    }
+  }
+}
+
+inline void scatter(const Pass &pass, float *out, int t0, int L,
+                    const float *re, const float *im) {
+  for (int l = 0; l < L && t0 + l < pass.count; l++) {
+    const size_t base = pass.outBase(t0 + l);
+
+    if (pass.realOutput) {
+      for (int e = 0; e < pass.outCount; e++)
+        out[base + e * pass.outStride] = re[e * L + l];
+    } else {
+      for (int e = 0; e < pass.outCount; e++) {
+        const size_t i = 2 * (base + e * pass.outStride);
+        out[i] = re[e * L + l];
+        out[i + 1] = im[e * L + l];
+      }
+    }
+  }
+}
+
+template <class V>
+inline void runGroup(const Plan1D &plan, const Pass &pass, const float *in,
+                     float *out, int t0, float sign, V *buf) {
+  const int n = plan.n, L = (int)(sizeof(V) / sizeof(float));
+  V *re = buf, *im = buf + n;
+
+  gather(pass, in, t0, L, (float *)re, (float *)im);
+  stockham(plan, re, im, buf + 2 * n, buf + 3 * n, sign, buf + 4 * n);
+  scatter(pass, out, t0, L, (const float *)re, (const float *)im);
+}
+
+inline void runPass(const Plan1D &plan, const Pass &pass, const float *in,
+                    float *out, float sign, int numThreads);
+
+// One large transform t of a complex pass in four steps
+inline void runFourStep(const Plan1D &plan, const Pass &pass,
+                        const float *in, float *out, int t, float sign,
+                        int numThreads) {
+  const int n1 = plan.n1, n2 = plan.n2;
+  const size_t inBase = pass.inBase(t), outBase = pass.outBase(t);
+  std::vector<sdkFftComplex> T(plan.n);
+  float *tf = (float *)&T[0];
+  const int threads = threadsFor(numThreads, (double)plan.n);
+
+  for (int e = 0; e < plan.n; e++) {
+    T[e].x = in[2 * (inBase + e * pass.inStride)];
+    T[e].y = in[2 * (inBase + e * pass.inStride) + 1];
+  }
+
+  // n2 columns of length n1, then twiddles
+  runPass(*plan.plan1, Pass(n1, n2, n2, 0, n2, 0, n2), tf, tf, sign,
+          numThreads);
+
+  parallelFor(n1, threads, [&](int k1, int) {
+    sdkFftComplex *row = &T[(size_t)k1 * n2];
+    const float *c = &plan.fsCos[(size_t)k1 * n2];
+    const float *s = &plan.fsSin[(size_t)k1 * n2];
+
+    for (int j2 = 0; j2 < n2; j2++) {
+      float re = row[j2].x, im = row[j2].y, sn = sign * s[j2];
+      row[j2].x = re * c[j2] - im * sn;
+      row[j2].y = re * sn + im * c[j2];
+    }
+  });
+
+  // n1 rows of length n2, X[k1 + n1 k2] = T[k1][k2]
+  runPass(*plan.plan2, Pass(n2, n1, 1, n2, 1, n2, 1), tf, tf, sign,
+          numThreads);
+
+  parallelFor(n1, threads, [&](int k1, int) {
+    const sdkFftComplex *row = &T[(size_t)k1 * n2];
+
+    for (int k2 = 0; k2 < n2; k2++) {
+      const size_t i = 2 * (outBase + ((size_t)k1 + (size_t)n1 * k2) *
+                                          pass.outStride);
+      out[i] = row[k2].x;
+      out[i + 1] = row[k2].y;
+    }
+  });
+}
+
+// All transforms of a pass, in place if in == out
+inline void runPass(const Plan1D &plan, const Pass &pass, const float *in,
+                    float *out, float sign, int numThreads) {
+  if (plan.n1 && pass.input == INPUT_COMPLEX && !pass.realOutput &&
+      pass.outCount == plan.n) {
+    for (int t = 0; t < pass.count; t++)
+      runFourStep(plan, pass, in, out, t, sign, numThreads);
+
+    return;
+  }
+
+  const int threads =
+      threadsFor(numThreads, (double)plan.n * (double)pass.count);
+
+  if (pass.count == 1) {
+    std::vector<float> buf(plan.scratchSize());
+    runGroup(plan, pass, in, out, 0, sign, &buf[0]);
+    return;
+  }
+
+  const int groups = (pass.count + kLanes - 1) / kLanes;
+  std::vector<std::vector<Lanes> > scratch(threads);
+
+  parallelFor(groups, threads, [&](int g, int w) {
+    if (scratch[w].empty()) scratch[w].resize(plan.scratchSize());
+
+    runGroup(plan, pass, in, out, g * kLanes, sign, &scratch[w][0]);
+  });
+}
+
+}  // namespace sdkFftDetail
+
+//////////////////////////////////////////////////////////////////////////////
+//! Plan of batched 1D, 2D or 3D transforms of n[0] x ... x n[rank - 1]
+//! points, n[rank - 1] contiguous
+//////////////////////////////////////////////////////////////////////////////
+class sdkFftPlan {
+ public:
+  sdkFftPlan(int rank, const int *n, sdkFftType type, int batch = 1)
+      : rank_(rank), type_(type), batch_(batch), valid_(false) {
+    if (rank < 1 || rank > 3 || batch < 1 || !n) return;
+
+    for (int i = 0; i < rank; i++) {
+      if (n[i] < 1) return;
+
+      dims_[i] = n[i];
+    }
+
+    const int last = dims_[rank - 1];
+
+    for (int i = 0; i < rank; i++) {
+      int length = dims_[i];
+
+      // even real transforms run at half the length
+      if (i == rank - 1 && type != SDK_FFT_C2C && last % 2 == 0)
+        length = last / 2;
+
+      axes_.push_back(std::shared_ptr<sdkFftDetail::Plan1D>(
+          new sdkFftDetail::Plan1D(length)));
+    }
+
+    if (type != SDK_FFT_C2C && last % 2 == 0) {
+      for (int k = 0; k <= last / 2; k++) {
+        double a = 2.0 * sdkFftDetail::kPi * k / last;
+        realCos_.push_back((float)cos(a));
+        realSin_.push_back((float)sin(a));
+      }
+    }
+
+    valid_ = true;
+  }
+
+  bool valid() const { return valid_; }
+  int rank() const { return rank_; }
+  int dim(int i) const { return dims_[i]; }
+  int batch() const { return batch_; }
+  sdkFftType type() const { return type_; }
+
+  //! Complex elements of the spectrum of one transform (real transforms:
+  //! n[rank - 1] / 2 + 1 in the last dimension)
+  size_t spectrumSize() const {
+    size_t size = (type_ == SDK_FFT_C2C) ? dims_[rank_ - 1]
+                                         : dims_[rank_ - 1] / 2 + 1;
+
+    for (int i = 0; i < rank_ - 1; i++) size *= dims_[i];
+
+    return size;
+  }
+
+  //! Points of one transform
+  size_t size() const {
+    size_t size = 1;
+
+    for (int i = 0; i < rank_; i++) size *= dims_[i];
+
+    return size;
+  }
+
+  //! Complex to complex transform, in place if in == out
+  //! @param direction   SDK_FFT_FORWARD or SDK_FFT_INVERSE
+  //! @param numThreads  <= 0 selects the number of hardware threads
+  bool execC2C(const sdkFftComplex *in, sdkFftComplex *out, int direction,
+               int numThreads = 0) const {
+    if (!valid_ || type_ != SDK_FFT_C2C) return false;
+
+    complexAxes(rank_, (const float *)in, (float *)out, dims_[rank_ - 1],
+                (float)direction, numThreads);
+    return true;
+  }
+
+  //! Real to complex forward transform, in and out must not overlap
+  bool execR2C(const float *in, sdkFftComplex *out,
+               int numThreads = 0) const {
+    using namespace sdkFftDetail;
+
+    if (!valid_ || type_ != SDK_FFT_R2C) return false;
+
+    const int n = dims_[rank_ - 1], h = n / 2;
+    const int rows = (int)(size() / n) * batch_;
+    float *o = (float *)out;
+
+    if (n % 2) {
+      Pass pass(n, rows, 1, n, 1, h + 1, 1);
+      pass.input = INPUT_REAL;
+      pass.outCount = h + 1;
+      runPass(*axes_[rank_ - 1], pass, in, o, -1.0f, numThreads);
+    } else {
+      // complex transform of z[k] = x[2k] + i x[2k + 1], then split
+      runPass(*axes_[rank_ - 1], Pass(h, rows, 1, h, 1, h + 1, 1), in, o,
+              -1.0f, numThreads);
+      parallelFor(rows, threadsFor(numThreads, (double)rows * n),
+                  [&](int r, int) { splitRow(out + (size_t)r * (h + 1), h); });
+    }
+
+    complexAxes(rank_ - 1, o, o, h + 1, -1.0f, numThreads);
+    return true;
+  }
+
+  //! Complex to real inverse transform of the n[rank - 1] / 2 + 1
+  //! non-redundant outputs, in is not modified
+  bool execC2R(const sdkFftComplex *in, float *out,
+               int numThreads = 0) const {
+    using namespace sdkFftDetail;
+
+    if (!valid_ || type_ != SDK_FFT_C2R) return false;
+
+    const int n = dims_[rank_ - 1], h = n / 2;
+    const int rows = (int)(size() / n) * batch_;
+    std::vector<sdkFftComplex> copy;
+    const sdkFftComplex *src = in;
+
+    if (rank_ > 1) {
+      copy.assign(in, in + spectrumSize() * batch_);
+      complexAxes(rank_ - 1, (float *)&copy[0], (float *)&copy[0], h + 1,
+                  1.0f, numThreads);
+      src = &copy[0];
+    }
+
+    if (n % 2) {
+      Pass pass(n, rows, 1, h + 1, 1, n, 1);
+      pass.input = INPUT_HERMITIAN;
+      pass.realOutput = true;
+      runPass(*axes_[rank_ - 1], pass, (const float *)src, out, 1.0f,
+              numThreads);
+    } else {
+      // merge the halves into z = x[2k] + i x[2k + 1] and transform back
+      parallelFor(rows, threadsFor(numThreads, (double)rows * n),
+                  [&](int r, int) {
+                    mergeRow((sdkFftComplex *)out + (size_t)r * h,
+                             src + (size_t)r * (h + 1), h);
+                  });
+      runPass(*axes_[rank_ - 1], Pass(h, rows, 1, h, 1, h, 1), out, out,
+              1.0f, numThreads);
+    }
+
+    return true;
+  }
+
+ private:
+  // Complex transforms along axes numAxes - 1, ..., 0 of arrays whose last
+  // dimension has lastDim elements; the first pass reads in
+  void complexAxes(int numAxes, const float *in, float *out, int lastDim,
+                   float sign, int numThreads) const {
+    using namespace sdkFftDetail;
+    int d[3];
+
+    for (int i = 0; i < rank_; i++) d[i] = dims_[i];
+
+    d[rank_ - 1] = lastDim;
+
+    for (int a = numAxes - 1; a >= 0; a--) {
+      size_t inner = 1, outer = batch_;
+
+      for (int i = a + 1; i < rank_; i++) inner *= d[i];
+
+      for (int i = 0; i < a; i++) outer *= d[i];
+
+      const size_t block = (size_t)d[a] * inner;
+      runPass(*axes_[a],
+              Pass(d[a], (int)(outer * inner), (int)inner, block, inner, block,
+                   inner),
+              in, out, sign, numThreads);
+      in = out;
+    }
+  }
+
+  // X[k] = E[k] + W^k O[k] from Z = FFT(x[2k] + i x[2k + 1]), in place for
+  // the pairs k, h - k; W = exp(-2 pi i / n)
+  void splitRow(sdkFftComplex *z, int h) const {
+    for (int k = 0; k <= h / 2; k++) {
+      const int j = h - k;
+      const sdkFftComplex a = z[k], b = z[j % h];
+      sdkFftComplex xk = split(a, b, k), xj = split(b, a, j);
+      z[k] = xk;
+      z[j] = xj;
+    }
+  }
+
+  // E = (a + conj b) / 2, O = -i (a - conj b) / 2, returns E + W^k O
+  sdkFftComplex split(sdkFftComplex a, sdkFftComplex b, int k) const {
+    float er = 0.5f * (a.x + b.x), ei = 0.5f * (a.y - b.y);
+    float or_ = 0.5f * (a.y + b.y), oi = -0.5f * (a.x - b.x);
+    float c = realCos_[k], s = -realSin_[k];
+    sdkFftComplex x = {er + or_ * c - oi * s, ei + or_ * s + oi * c};
+    return x;
+  }
+
+  // Z[k] = (X[k] + conj X[h - k]) + i W^-k (X[k] - conj X[h - k])
+  void mergeRow(sdkFftComplex *z, const sdkFftComplex *X, int h) const {
+    for (int k = 0; k < h; k++) {
+      const sdkFftComplex a = X[k], b = X[h - k];
+      float er = a.x + b.x, ei = a.y - b.y;
+      float dr = a.x - b.x, di = a.y + b.y;
+      float c = realCos_[k], s = realSin_[k];
+      // W^-k (dr + i di), then times i
+      float tr = dr * c - di * s, ti = dr * s + di * c;
+      z[k].x = er - ti;
+      z[k].y = ei + tr;
+    }
+  }
+
+  int rank_;
+  int dims_[3];
+  sdkFftType type_;
+  int batch_;
+  bool valid_;
+  std::vector<std::shared_ptr<sdkFftDetail::Plan1D> > axes_;
+  std::vector<float> realCos_, realSin_;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//! Plan for the given size, type and batch, created on first use and cached
+//! for the lifetime of the program (thread safe)
+//////////////////////////////////////////////////////////////////////////////
+inline std::shared_ptr<const sdkFftPlan> sdkFftGetPlan(int rank, const int *n,
+                                                       sdkFftType type,
+                                                       int batch = 1) {
+  static std::mutex mutex;
+  static std::map<std::vector<int>, std::shared_ptr<const sdkFftPlan> > cache;
+  std::vector<int> key;
+
+  key.push_back((int)type);
+  key.push_back(batch);
+
+  for (int i = 0; n && i < rank && i < 4; i++) key.push_back(n[i]);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<const sdkFftPlan> &plan = cache[key];
+
+  if (!plan) plan.reset(new sdkFftPlan(rank, n, type, batch));
+
+  return plan;
+}
+
+#endif  // COMMON_HELPER_FFT_H_
@@ -0,0 +1,481 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Cache of expensive CPU reference (gold) results.
+//
+// A reference computation is identified by a name, its inputs and its
+// parameters, which are hashed into a 64-bit key. The output is stored in a
+// file of the cache directory and memory mapped on later runs, so that an
+// identical validation run skips the computation and compares against the
+// mapped data:
+//
+//   sdkGoldCache cache("FDTD3d/fdtdReference", argc, argv);
+//   cache.addInput(input, bytes).addParam(dimx).addParam(timesteps);
+//   const float *reference = cache.compute(output, count, [&]() {
+//     fdtdReference(output, input, ...);
+//   });
+//   compareData(reference, data, count, epsilon, threshold);
+//
+// The returned pointer is valid while the cache object lives, and can be
+// passed to compareData(), sdkCompareL2fe() and the other comparisons of
+// helper_image.h directly.
+//
+// The key also covers the size and time stamp of the executable, so a
+// rebuilt sample never reuses results of an older build. Every file holds a
+// checksum of its data, a damaged file is recomputed.
+//
+// Environment:
+//   CUDA_SAMPLES_GOLD_CACHE       cache directory (default
+//                                 $HOME/.cuda_samples_gold_cache or
+//                                 %LOCALAPPDATA%\cuda_samples_gold_cache),
+//                                 an empty value or "off" disables the cache
+//   CUDA_SAMPLES_GOLD_CACHE_MB    size limit, the least recently used files
+//                                 are evicted beyond it (default 1024)
+// The command line option -nogoldcache disables the cache as well.
+
+#ifndef COMMON_HELPER_GOLD_CACHE_H_
+#define COMMON_HELPER_GOLD_CACHE_H_
+
+// includes, system
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+#define WINDOWS_LEAN_AND_MEAN
+#include <windows.h>
+#include <direct.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+// includes, project
+#include <helper_string.h>
+
+class sdkGoldCache {
+ public:
+  sdkGoldCache(const char *name, int argc = 0, const char **argv = NULL)
+      : name_(name),
+        key_(0x9e3779b97f4a7c15ULL),
+        enabled_(true),
+        mapped_(NULL),
+        mappedBytes_(0) {
+    const char *dir = getenv("CUDA_SAMPLES_GOLD_CACHE");
+
+    if (dir && (dir[0] == 0 || strcmp(dir, "off") == 0)) enabled_ = false;
+
+    if (argc > 0 && checkCmdLineFlag(argc, argv, "nogoldcache")) {
+      enabled_ = false;
+    }
+
+    dir_ = dir ? std::string(dir) : getDefaultDir();
+
+    const char *mb = getenv("CUDA_SAMPLES_GOLD_CACHE_MB");
+    maxBytes_ = (uint64_t)(mb ? atof(mb) : 1024.0) * 1024 * 1024;
+
+    uint64_t exe[2];
+    getExecutableStamp(exe);
+    addInput(name, strlen(name)).addInput(exe, sizeof(exe));
+  }
+
+  ~sdkGoldCache() { unmap(); }
+
+  bool isEnabled() const { return enabled_; }
+
+  //! Add an input array to the key
+  sdkGoldCache &addInput(const void *data, size_t bytes) {
+    uint64_t h = hash(data, bytes, key_);
+    key_ = mix(key_ ^ h) + (uint64_t)bytes;
+    return *this;
+  }
+
+  //! Add a parameter of a plain type to the key
+  template <class T>
+  sdkGoldCache &addParam(const T &value) {
+    return addInput(&value, sizeof(T));
+  }
+
+  //! Cached output of count elements, NULL if there is none
+  template <class T>
+  const T *lookup(size_t count) {
+    return (const T *)lookupBytes(count * sizeof(T));
+  }
+
+  //! Store the output of count elements
+  template <class T>
+  bool store(const T *output, size_t count) {
+    return storeBytes(output, count * sizeof(T));
+  }
+
+  //! Cached output, or the output of compute() which is stored for the
+  //! next runs
+  template <class T, class F>
+  const T *compute(T *output, size_t count, F compute) {
+    const T *cached = lookup<T>(count);
+
+    if (cached) return cached;
+
+    compute();
+    store(output, count);
+
+    return output;
+  }
+
+  std::string getFileName() const {
+    char key[32];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)key_);
+
+    std::string file = name_;
+
+    for (size_t i = 0; i < file.size(); i++) {
+      char c = file[i];
+
+      if (!isalnum((unsigned char)c) && c != '_' && c != '-') file[i] = '_';
+    }
+
+    return dir_ + kSeparator + file + "-" + key + ".gold";
+  }
+
+  //! 64-bit hash, four interleaved multiply-rotate lanes over 32 byte
+  //! stripes (the structure of xxHash64)
+  static uint64_t hash(const void *data, size_t bytes, uint64_t seed) {
+    const uint64_t p1 = 0x9e3779b185ebca87ULL, p2 = 0xc2b2ae3d27d4eb4fULL;
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + bytes;
+    uint64_t v[4] = {seed + p1 + p2, seed + p2, seed, seed - p1};
+
+    for (; p + 32 <= end; p += 32) {
+      for (int i = 0; i < 4; i++) {
+        uint64_t w;
+        memcpy(&w, p + 8 * i, sizeof(w));
+        v[i] = rotl(v[i] + w * p2, 31) * p1;
+      }
+    }
+
+    uint64_t h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) +
+                 rotl(v[3], 18) + (uint64_t)bytes;
+
+    for (; p + 8 <= end; p += 8) {
+      uint64_t w;
+      memcpy(&w, p, sizeof(w));
+      h = rotl(h ^ (rotl(w * p2, 31) * p1), 27) * p1 + 0x85ebca77c2b2ae63ULL;
+    }
+
+    for (; p < end; p++) h = rotl(h ^ (*p * 0x27d4eb2f165667c5ULL), 11) * p1;
+
+    return mix(h);
+  }
+
+ private:
+  struct FileHeader {
+    char magic[8];
+    uint64_t key;
+    uint64_t bytes;
+    uint64_t checksum;
+  };
+
+  struct Entry {
+    std::string path;
+    uint64_t bytes;
+    time_t time;
+
+    bool operator<(const Entry &e) const { return time < e.time; }
+  };
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+  static const char kSeparator = '\\';
+#else
+  static const char kSeparator = '/';
+#endif
+
+  std::string name_;
+  std::string dir_;
+  uint64_t key_;
+  uint64_t maxBytes_;
+  bool enabled_;
+  void *mapped_;
+  size_t mappedBytes_;
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = NULL;
+#endif
+
+  static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+  static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static std::string getDefaultDir() {
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    const char *dir = getenv("LOCALAPPDATA");
+
+    if (dir) return std::string(dir) + "\\cuda_samples_gold_cache";
+#else
+    const char *dir = getenv("HOME");
+
+    if (dir) return std::string(dir) + "/.cuda_samples_gold_cache";
+#endif
+
+    return "cuda_samples_gold_cache";
+  }
+
+  static void getExecutableStamp(uint64_t stamp[2]) {
+    stamp[0] = stamp[1] = 0;
+    struct stat st;
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    char path[MAX_PATH];
+
+    if (GetModuleFileNameA(NULL, path, MAX_PATH) == 0) return;
+
+    if (stat(path, &st) != 0) return;
+#else
+    if (stat("/proc/self/exe", &st) != 0) return;
+#endif
+
+    stamp[0] = (uint64_t)st.st_size;
+    stamp[1] = (uint64_t)st.st_mtime;
+  }
+
+  const void *lookupBytes(size_t bytes) {
+    if (!enabled_) return NULL;
+
+    unmap();
+
+    std::string path = getFileName();
+
+    if (!map(path, sizeof(FileHeader) + bytes)) return NULL;
+
+    const FileHeader *header = (const FileHeader *)mapped_;
+    const void *data = (const char *)mapped_ + sizeof(FileHeader);
+
+    if (memcmp(header->magic, "SDKGOLD", 8) != 0 || header->key != key_ ||
+        header->bytes != bytes || header->checksum != hash(data, bytes, 0)) {
+      printf("> gold cache: ignoring damaged <%s>\n", path.c_str());
+      unmap();
+      return NULL;
+    }
+
+    // the time stamp orders the files for eviction
+    utime(path.c_str(), NULL);
+    printf("> gold cache: using <%s>\n", path.c_str());
+
+    return data;
+  }
+
+  bool storeBytes(const void *data, size_t bytes) {
+    if (!enabled_) return false;
+
+    if (sizeof(FileHeader) + bytes > maxBytes_) return false;
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    _mkdir(dir_.c_str());
+#else
+    mkdir(dir_.c_str(), 0755);
+#endif
+
+    FileHeader header;
+    memcpy(header.magic, "SDKGOLD", 8);
+    header.key = key_;
+    header.bytes = bytes;
+    header.checksum = hash(data, bytes, 0);
+
+    // write a temporary file and rename it, concurrent runs never see a
+    // partial file
+    std::string path = getFileName();
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%llx.tmp",
+             (unsigned long long)mix((uint64_t)(size_t)this ^ key_));
+    std::string tmp = path + suffix;
+
+    FILE *fp = fopen(tmp.c_str(), "wb");
+
+    if (fp == NULL) return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              (bytes == 0 || fwrite(data, bytes, 1, fp) == 1);
+    ok = (fclose(fp) == 0) && ok;
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    ok = ok && MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+
+    if (!ok) {
+      remove(tmp.c_str());
+      return false;
+    }
+
+    evict();
+
+    return true;
+  }
+
+  // Remove the least recently used files until the cache fits its limit
+  void evict() {
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    listEntries(entries);
+
+    for (size_t i = 0; i < entries.size(); i++) total += entries[i].bytes;
+
+    std::sort(entries.begin(), entries.end());
+
+    for (size_t i = 0; i < entries.size() && total > maxBytes_; i++) {
+      if (remove(entries[i].path.c_str()) == 0) total -= entries[i].bytes;
+    }
+  }
+
+  void listEntries(std::vector<Entry> &entries) const {
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA((dir_ + "\\*.gold").c_str(), &fd);
+
+    if (h == INVALID_HANDLE_VALUE) return;
+
+    do {
+      addEntry(entries, dir_ + kSeparator + fd.cFileName);
+    } while (FindNextFileA(h, &fd));
+
+    FindClose(h);
+#else
+    DIR *d = opendir(dir_.c_str());
+
+    if (d == NULL) return;
+
+    while (struct dirent *e = readdir(d)) {
+      size_t n = strlen(e->d_name);
+
+      if (n > 5 && strcmp(e->d_name + n - 5, ".gold") == 0) {
+        addEntry(entries, dir_ + kSeparator + e->d_name);
+      }
+    }
+
+    closedir(d);
+#endif
+  }
+
+  static void addEntry(std::vector<Entry> &entries, const std::string &path) {
+    struct stat st;
+
+    if (stat(path.c_str(), &st) != 0) return;
+
+    Entry e;
+    e.path = path;
+    e.bytes = (uint64_t)st.st_size;
+    e.time = st.st_mtime;
+    entries.push_back(e);
+  }
+
+  bool map(const std::string &path, size_t bytes) {
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file_ == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file_, &size) || (uint64_t)size.QuadPart != bytes) {
+      unmap();
+      return false;
+    }
+
+    mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+    mapped_ = mapping_ ? MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0) : NULL;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != bytes) {
+      close(fd);
+      return false;
+    }
+
+    mapped_ = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapped_ == MAP_FAILED) mapped_ = NULL;
+#endif
+
+    if (mapped_ == NULL) {
+      unmap();
+      return false;
+    }
+
+    mappedBytes_ = bytes;
+
+    return true;
+  }
+
+  void unmap() {
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+    if (mapped_) UnmapViewOfFile(mapped_);
+
+    if (mapping_) CloseHandle(mapping_);
+
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+
+    mapping_ = NULL;
+    file_ = INVALID_HANDLE_VALUE;
+#else
+    if (mapped_) munmap(mapped_, mappedBytes_);
+#endif
+
+    mapped_ = NULL;
+    mappedBytes_ = 0;
+  }
+
+  // not copyable, the object owns the mapping
+  sdkGoldCache(const sdkGoldCache &);
+  sdkGoldCache &operator=(const sdkGoldCache &);
+};
+
+#endif  // COMMON_HELPER_GOLD_CACHE_H_
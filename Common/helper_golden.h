@@ -0,0 +1,759 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Chunked, compressed and checksummed container for reference (golden) data.
+//
+// The data is split into chunks of SDK_GOLDEN_CHUNK_BYTES. Every chunk is
+// byte shuffled by the element size (byte k of all elements, then byte k+1,
+// which groups the similar exponent and sign bytes of float data), compressed
+// with a small LZ77 codec and stored with a 64-bit checksum of its raw bytes.
+// Chunks that do not compress are stored raw.
+//
+//   header  "SDKGLDN", version, element size, bytes, chunk bytes, chunk count
+//   table   offset, stored bytes, flags and checksum of every chunk
+//   data    the stored chunks
+//
+// sdkCompareGoldenFile() streams the computed file chunk by chunk and only
+// decompresses the reference chunks whose checksum differs, in parallel.
+// Chunks of floating point data that hold NaNs are compared even when the
+// checksums match, so NaNs count as errors as with raw references.
+//
+// sdkCompareBin2BinGoldenUint() and sdkCompareBin2BinGoldenFloat() take the
+// arguments of sdkCompareBin2BinUint() and sdkCompareBin2BinFloat() and
+// accept both golden and raw references.
+
+#ifndef COMMON_HELPER_GOLDEN_H_
+#define COMMON_HELPER_GOLDEN_H_
+
+// includes, system
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// includes, project
+#include <helper_gold_cache.h>
+#include <helper_image.h>
+
+#ifndef SDK_GOLDEN_CHUNK_BYTES
+#define SDK_GOLDEN_CHUNK_BYTES (64 * 1024)
+#endif
+
+struct sdkGoldenHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t elementSize;
+  uint64_t bytes;
+  uint32_t chunkBytes;
+  uint32_t numChunks;
+};
+
+enum sdkGoldenChunkFlags {
+  SDK_GOLDEN_CHUNK_LZ = 1,
+  SDK_GOLDEN_CHUNK_SHUFFLED = 2
+};
+
+struct sdkGoldenChunk {
+  uint64_t offset;
+  uint32_t storedBytes;
+  uint32_t flags;
+  uint64_t checksum;
+};
+
+inline uint64_t sdkGoldenChecksum(const void *data, size_t bytes) {
+  return sdkGoldCache::hash(data, bytes, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Byte shuffle, dst[k * n + i] = byte k of element i
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkGoldenShuffle(unsigned char *dst, const unsigned char *src,
+                             size_t bytes, unsigned int elementSize) {
+  size_t n = bytes / elementSize;
+
+  for (unsigned int k = 0; k < elementSize; k++) {
+    for (size_t i = 0; i < n; i++) dst[k * n + i] = src[i * elementSize + k];
+  }
+
+  // a partial last element is kept in place
+  if (bytes % elementSize) {
+    memcpy(dst + n * elementSize, src + n * elementSize, bytes % elementSize);
+  }
+}
+
+inline void sdkGoldenUnshuffle(unsigned char *dst, const unsigned char *src,
+                               size_t bytes, unsigned int elementSize) {
+  size_t n = bytes / elementSize;
+
+  for (unsigned int k = 0; k < elementSize; k++) {
+    for (size_t i = 0; i < n; i++) dst[i * elementSize + k] = src[k * n + i];
+  }
+
+  if (bytes % elementSize) {
+    memcpy(dst + n * elementSize, src + n * elementSize, bytes % elementSize);
+  }
+}
+
+// Length continuation bytes of the LZ77 codec
+inline bool sdkGoldenPutLength(unsigned char *&op, unsigned char *oend,
+                               size_t len) {
+  for (; len >= 255; len -= 255) {
+    if (op >= oend) return false;
+
+    *op++ = 255;
+  }
+
+  if (op >= oend) return false;
+
+  *op++ = (unsigned char)len;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! LZ77 codec. A block is a sequence of
+//!   token    literal count (high 4 bits) and match length - 4 (low 4 bits),
+//!            15 continues the count in the following bytes (255 = more)
+//!   literals
+//!   offset   2 bytes, little endian, omitted after the last literals
+//! @return  compressed size, 0 if the data does not fit into dstCapacity
+//////////////////////////////////////////////////////////////////////////////
+inline size_t sdkGoldenCompress(unsigned char *dst, size_t dstCapacity,
+                                const unsigned char *src, size_t bytes) {
+  const int kHashBits = 14;
+  const size_t kMinMatch = 4, kMaxOffset = 65535;
+  std::vector<uint32_t> table(1 << kHashBits, 0xffffffffu);
+
+  unsigned char *op = dst, *const oend = dst + dstCapacity;
+  size_t anchor = 0, ip = 0;
+
+  while (ip + kMinMatch <= bytes) {
+    uint32_t v;
+    memcpy(&v, src + ip, 4);
+    uint32_t h = (v * 2654435761u) >> (32 - kHashBits);
+    size_t ref = table[h];
+    table[h] = (uint32_t)ip;
+
+    uint32_t w = 0;
+
+    if (ref != 0xffffffffu) memcpy(&w, src + ref, 4);
+
+    if (ref == 0xffffffffu || ip - ref > kMaxOffset || w != v) {
+      ip++;
+      continue;
+    }
+
+    size_t len = kMinMatch;
+
+    while (ip + len < bytes && src[ref + len] == src[ip + len]) len++;
+
+    size_t lit = ip - anchor, ml = len - kMinMatch;
+
+    if (op >= oend) return 0;
+
+    unsigned char *token = op++;
+    *token =
+        (unsigned char)(((lit < 15 ? lit : 15) << 4) | (ml < 15 ? ml : 15));
+
+    if (lit >= 15 && !sdkGoldenPutLength(op, oend, lit - 15)) return 0;
+
+    if ((size_t)(oend - op) < lit + 2) return 0;
+
+    memcpy(op, src + anchor, lit);
+    op += lit;
+    *op++ = (unsigned char)((ip - ref) & 0xff);
+    *op++ = (unsigned char)((ip - ref) >> 8);
+
+    if (ml >= 15 && !sdkGoldenPutLength(op, oend, ml - 15)) return 0;
+
+    ip += len;
+    anchor = ip;
+  }
+
+  // last literals
+  size_t lit = bytes - anchor;
+
+  if (op >= oend) return 0;
+
+  *op++ = (unsigned char)((lit < 15 ? lit : 15) << 4);
+
+  if (lit >= 15 && !sdkGoldenPutLength(op, oend, lit - 15)) return 0;
+
+  if ((size_t)(oend - op) < lit) return 0;
+
+  memcpy(op, src + anchor, lit);
+  op += lit;
+
+  return op - dst;
+}
+
+//! @return  false if the block is damaged or does not decode to bytes
+inline bool sdkGoldenDecompress(unsigned char *dst, size_t bytes,
+                                const unsigned char *src, size_t srcBytes) {
+  const unsigned char *ip = src, *const iend = src + srcBytes;
+  unsigned char *op = dst, *const oend = dst + bytes;
+
+  while (ip < iend) {
+    unsigned int token = *ip++;
+    size_t lit = token >> 4, ml = token & 15;
+
+    if (lit == 15) {
+      unsigned int b;
+
+      do {
+        if (ip >= iend) return false;
+
+        b = *ip++;
+        lit += b;
+      } while (b == 255);
+    }
+
+    if ((size_t)(iend - ip) < lit || (size_t)(oend - op) < lit) return false;
+
+    // an empty block leaves dst untouched, it may be NULL
+    if (lit) memcpy(op, ip, lit);
+
+    ip += lit;
+    op += lit;
+
+    if (ip == iend) break;
+
+    if (iend - ip < 2) return false;
+
+    size_t offset = ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+
+    if (ml == 15) {
+      unsigned int b;
+
+      do {
+        if (ip >= iend) return false;
+
+        b = *ip++;
+        ml += b;
+      } while (b == 255);
+    }
+
+    ml += 4;
+
+    if (offset == 0 || offset > (size_t)(op - dst) ||
+        (size_t)(oend - op) < ml) {
+      return false;
+    }
+
+    // the match may overlap the output, copy forward byte by byte
+    const unsigned char *match = op - offset;
+
+    for (size_t i = 0; i < ml; i++) op[i] = match[i];
+
+    op += ml;
+  }
+
+  return op == oend;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Write data as a golden container
+//! @param elementSize  size of the elements for the byte shuffle, 1 disables
+//!                     it
+//////////////////////////////////////////////////////////////////////////////
+inline bool sdkWriteGoldenFile(const char *filename, const void *data,
+                               size_t bytes, unsigned int elementSize) {
+  const size_t chunkBytes = SDK_GOLDEN_CHUNK_BYTES;
+  const unsigned char *src = (const unsigned char *)data;
+
+  sdkGoldenHeader header;
+  memcpy(header.magic, "SDKGLDN", 8);
+  header.version = 1;
+  header.elementSize = elementSize ? elementSize : 1;
+  header.bytes = bytes;
+  header.chunkBytes = (uint32_t)chunkBytes;
+  header.numChunks = (uint32_t)((bytes + chunkBytes - 1) / chunkBytes);
+
+  std::vector<sdkGoldenChunk> chunks(header.numChunks);
+  std::vector<unsigned char> payload, shuffled(chunkBytes), packed(chunkBytes);
+  uint64_t offset = sizeof(header) + chunks.size() * sizeof(sdkGoldenChunk);
+
+  for (uint32_t c = 0; c < header.numChunks; c++) {
+    size_t begin = c * chunkBytes;
+    size_t n = (std::min)(chunkBytes, bytes - begin);
+    const unsigned char *raw = src + begin;
+    uint32_t flags = 0;
+
+    if (header.elementSize > 1) {
+      sdkGoldenShuffle(shuffled.data(), raw, n, header.elementSize);
+      raw = shuffled.data();
+      flags |= SDK_GOLDEN_CHUNK_SHUFFLED;
+    }
+
+    // keep the chunk raw unless it shrinks
+    size_t stored = sdkGoldenCompress(packed.data(), n - 1, raw, n);
+
+    if (stored) {
+      raw = packed.data();
+      flags |= SDK_GOLDEN_CHUNK_LZ;
+    } else {
+      raw = src + begin;
+      stored = n;
+      flags = 0;
+    }
+
+    chunks[c].offset = offset;
+    chunks[c].storedBytes = (uint32_t)stored;
+    chunks[c].flags = flags;
+    chunks[c].checksum = sdkGoldenChecksum(src + begin, n);
+    payload.insert(payload.end(), raw, raw + stored);
+    offset += stored;
+  }
+
+  FILE *fp = fopen(filename, "wb");
+
+  if (fp == NULL) return false;
+
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+  ok = ok && (chunks.empty() || fwrite(chunks.data(), sizeof(sdkGoldenChunk),
+                                       chunks.size(), fp) == chunks.size());
+  ok = ok && (payload.empty() ||
+              fwrite(payload.data(), payload.size(), 1, fp) == 1);
+
+  return (fclose(fp) == 0) && ok;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Golden container loaded into memory, the chunks stay compressed
+//////////////////////////////////////////////////////////////////////////////
+class sdkGoldenFile {
+ public:
+  sdkGoldenHeader header;
+  std::vector<sdkGoldenChunk> chunks;
+
+  //! @return  false if the file is not a valid golden container
+  bool load(const char *filename) {
+    FILE *fp = fopen(filename, "rb");
+
+    if (fp == NULL) return false;
+
+    bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+              memcmp(header.magic, "SDKGLDN", 8) == 0 && header.version == 1 &&
+              header.elementSize > 0 && header.chunkBytes > 0 &&
+              header.numChunks ==
+                  (header.bytes + header.chunkBytes - 1) / header.chunkBytes;
+
+    if (ok) {
+      chunks.resize(header.numChunks);
+      ok = chunks.empty() || fread(chunks.data(), sizeof(sdkGoldenChunk),
+                                   chunks.size(), fp) == chunks.size();
+    }
+
+    if (ok) {
+      long begin = ftell(fp);
+      fseek(fp, 0, SEEK_END);
+      long end = ftell(fp);
+      fseek(fp, begin, SEEK_SET);
+      data_.resize(end - begin);
+      base_ = (uint64_t)begin;
+      ok = data_.empty() || fread(data_.data(), data_.size(), 1, fp) == 1;
+    }
+
+    fclose(fp);
+
+    for (size_t c = 0; ok && c < chunks.size(); c++) {
+      ok = chunks[c].offset >= base_ &&
+           chunks[c].offset - base_ + chunks[c].storedBytes <= data_.size();
+    }
+
+    return ok;
+  }
+
+  size_t chunkSize(size_t c) const {
+    return (size_t)(std::min<uint64_t>)(header.chunkBytes,
+                                      header.bytes - c * header.chunkBytes);
+  }
+
+  //! Decode chunk c into dst (chunkSize(c) bytes), scratch must hold as many
+  //! @return  false if the chunk is damaged
+  bool decode(size_t c, unsigned char *dst, unsigned char *scratch) const {
+    const sdkGoldenChunk &chunk = chunks[c];
+    const unsigned char *src = data_.data() + (chunk.offset - base_);
+    size_t n = chunkSize(c);
+    bool shuffled = (chunk.flags & SDK_GOLDEN_CHUNK_SHUFFLED) != 0;
+    unsigned char *out = shuffled ? scratch : dst;
+
+    if (chunk.flags & SDK_GOLDEN_CHUNK_LZ) {
+      if (!sdkGoldenDecompress(out, n, src, chunk.storedBytes)) return false;
+    } else {
+      if (chunk.storedBytes != n) return false;
+
+      if (n) memcpy(out, src, n);
+    }
+
+    if (shuffled) sdkGoldenUnshuffle(dst, scratch, n, header.elementSize);
+
+    return sdkGoldenChecksum(dst, n) == chunk.checksum;
+  }
+
+  //! Decode all chunks
+  bool read(std::vector<unsigned char> &data) const {
+    std::vector<unsigned char> scratch(header.chunkBytes);
+    data.resize((size_t)header.bytes);
+
+    for (size_t c = 0; c < chunks.size(); c++) {
+      if (!decode(c, data.data() + c * header.chunkBytes, scratch.data())) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  std::vector<unsigned char> data_;
+  uint64_t base_ = 0;
+};
+
+inline bool sdkIsGoldenFile(const char *filename) {
+  char magic[8];
+  FILE *fp = fopen(filename, "rb");
+
+  if (fp == NULL) return false;
+
+  bool golden = fread(magic, sizeof(magic), 1, fp) == 1 &&
+                memcmp(magic, "SDKGLDN", 8) == 0;
+  fclose(fp);
+
+  return golden;
+}
+
+// True if bytes of elements of type T hold a NaN, never for integer types
+template <class T>
+inline bool sdkGoldenHasNaN(const unsigned char *data, size_t bytes) {
+  for (size_t i = 0; i + sizeof(T) <= bytes; i += sizeof(T)) {
+    T value;
+    memcpy(&value, data + i, sizeof(T));
+
+    if (value != value) return true;
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Compare a computed file (raw or golden) against a golden reference
+//! @return  false if a file cannot be read, otherwise error_count is the
+//!          number of mismatches found by countErrors(reference, data, n)
+//!          over the first nelements elements of type T
+//////////////////////////////////////////////////////////////////////////////
+template <class T, class F>
+inline bool sdkCompareGoldenFile(const char *src_file, const char *ref_file,
+                                 size_t nelements, F countErrors,
+                                 uint64_t &error_count,
+                                 size_t *mismatched_chunks = NULL) {
+  sdkGoldenFile ref;
+  error_count = 0;
+
+  if (!ref.load(ref_file)) {
+    printf("compareGolden unable to read ref_file: %s\n", ref_file);
+    return false;
+  }
+
+  size_t bytes = nelements * sizeof(T);
+
+  if (ref.header.bytes < bytes || ref.header.chunkBytes % sizeof(T) != 0) {
+    printf("compareGolden ref_file <%s> holds %llu bytes, %llu expected\n",
+           ref_file, (unsigned long long)ref.header.bytes,
+           (unsigned long long)bytes);
+    return false;
+  }
+
+  // the computed file is streamed one chunk at a time, a golden file is
+  // decoded at once
+  std::vector<unsigned char> src_golden;
+  FILE *src_fp = NULL;
+
+  if (sdkIsGoldenFile(src_file)) {
+    sdkGoldenFile src;
+
+    if (!src.load(src_file) || !src.read(src_golden)) {
+      printf("compareGolden unable to read src_file: %s\n", src_file);
+      return false;
+    }
+  } else if ((src_fp = fopen(src_file, "rb")) == NULL) {
+    printf("compareGolden unable to open src_file: %s\n", src_file);
+    return false;
+  }
+
+  const size_t chunkBytes = ref.header.chunkBytes;
+  const size_t numChunks = (bytes + chunkBytes - 1) / chunkBytes;
+  std::vector<size_t> mismatches;
+  std::vector<std::vector<unsigned char> > srcChunks;
+  std::vector<unsigned char> chunk(chunkBytes);
+  bool ok = true;
+
+  for (size_t c = 0; c < numChunks && ok; c++) {
+    size_t n = (std::min)(chunkBytes, bytes - c * chunkBytes);
+    size_t got = n;
+
+    if (src_fp) {
+      got = fread(chunk.data(), 1, n, src_fp);
+    } else {
+      got = (std::min)(n, src_golden.size() - (std::min)(src_golden.size(),
+                                                     c * chunkBytes));
+      if (got) memcpy(chunk.data(), src_golden.data() + c * chunkBytes, got);
+    }
+
+    if (got != n) {
+      printf("compareGolden src_file <%s> is shorter than %llu bytes\n",
+             src_file, (unsigned long long)bytes);
+      ok = false;
+    } else if (n != ref.chunkSize(c) ||
+               sdkGoldenChecksum(chunk.data(), n) != ref.chunks[c].checksum ||
+               sdkGoldenHasNaN<T>(chunk.data(), n)) {
+      // a partial last chunk is always compared element by element, and so
+      // is a chunk with NaNs, which countErrors counts as mismatches
+      mismatches.push_back(c);
+      srcChunks.push_back(std::vector<unsigned char>(chunk.begin(),
+                                                     chunk.begin() + n));
+    }
+  }
+
+  if (src_fp) fclose(src_fp);
+
+  if (!ok) return false;
+
+  // decode and compare the mismatching chunks in parallel
+  std::atomic<size_t> next(0);
+  std::atomic<uint64_t> errors(0);
+  std::atomic<bool> damaged(false);
+
+  auto worker = [&]() {
+    std::vector<unsigned char> refChunk(chunkBytes), scratch(chunkBytes);
+    size_t i;
+
+    while ((i = next++) < mismatches.size()) {
+      size_t c = mismatches[i];
+
+      if (!ref.decode(c, refChunk.data(), scratch.data())) {
+        damaged = true;
+        continue;
+      }
+
+      errors += countErrors((const T *)refChunk.data(),
+                            (const T *)srcChunks[i].data(),
+                            srcChunks[i].size() / sizeof(T));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  size_t numThreads = (std::min<size_t>)(
+      (std::max)(1u, std::thread::hardware_concurrency()), mismatches.size());
+
+  for (size_t t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker));
+    } catch (const std::system_error &) {
+      // no thread support, the calling thread does the remaining work
+      break;
+    }
+  }
+
+  worker();
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+  if (damaged) {
+    printf("compareGolden ref_file <%s> is damaged\n", ref_file);
+    return false;
+  }
+
+  if (mismatched_chunks) *mismatched_chunks = mismatches.size();
+
+  error_count = errors;
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Write data as a golden container, chunked, compressed and checksummed.
+//! sdkCompareBin2BinGoldenUint() and sdkCompareBin2BinGoldenFloat() accept
+//! such files as references.
+//! @param elementSize  size of the data elements, 4 for float data
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkDumpBinGolden(void *data, unsigned int bytes,
+                             unsigned int elementSize, const char *filename) {
+  printf("sdkDumpBinGolden: <%s>\n", filename);
+
+  if (!sdkWriteGoldenFile(filename, data, bytes, elementSize)) {
+    printf("sdkDumpBinGolden: unable to write <%s>\n", filename);
+  }
+}
+
+// Compare against a golden reference, only chunks whose checksum differs
+// or that hold NaNs are decompressed and compared by countErrors
+template <class T, class F>
+inline bool sdkCompareBin2BinGolden(const char *src_file,
+                                    const char *ref_file_path,
+                                    unsigned int nelements, F countErrors,
+                                    const float threshold,
+                                    uint64_t &error_count) {
+  size_t mismatched = 0;
+
+  if (!sdkCompareGoldenFile<T>(src_file, ref_file_path, nelements, countErrors,
+                               error_count, &mismatched)) {
+    return false;
+  }
+
+  printf("   golden ref_file <%s>, %d of %d chunks compared\n", ref_file_path,
+         static_cast<int>(mismatched),
+         static_cast<int>((nelements * sizeof(T) + SDK_GOLDEN_CHUNK_BYTES - 1) /
+                          SDK_GOLDEN_CHUNK_BYTES));
+
+  if (threshold == 0.0f) {
+    if (error_count) {
+      printf("total # of errors = %d\n", static_cast<int>(error_count));
+    }
+
+    return error_count == 0;
+  }
+
+  if (error_count) {
+    printf("%4.2f(%%) of bytes mismatched (count=%d)\n",
+           static_cast<float>(error_count) * 100 /
+               static_cast<float>(nelements),
+           static_cast<int>(error_count));
+  }
+
+  return nelements * threshold > error_count;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! sdkCompareBin2BinUint() for a reference that may be a golden container.
+//! A golden reference is compared chunk by chunk, any other reference is
+//! passed on to sdkCompareBin2BinUint().
+//////////////////////////////////////////////////////////////////////////////
+inline bool sdkCompareBin2BinGoldenUint(const char *src_file,
+                                        const char *ref_file,
+                                        unsigned int nelements,
+                                        const float epsilon,
+                                        const float threshold,
+                                        char *exec_path) {
+  char *ref_file_path = sdkFindFilePath(ref_file, exec_path);
+
+  if (ref_file_path == NULL || !sdkIsGoldenFile(ref_file_path)) {
+    free(ref_file_path);
+    return sdkCompareBin2BinUint(src_file, ref_file, nelements, epsilon,
+                                 threshold, exec_path);
+  }
+
+  printf(
+      "> compareBin2Bin <unsigned int> nelements=%d,"
+      " epsilon=%4.2f, threshold=%4.2f\n",
+      nelements, epsilon, threshold);
+
+  // same criterion as compareData()
+  uint64_t errors = 0;
+  bool ok = sdkCompareBin2BinGolden<unsigned int>(
+      src_file, ref_file_path, nelements,
+      [epsilon](const unsigned int *ref, const unsigned int *data, size_t n) {
+        size_t count = 0;
+
+        for (size_t i = 0; i < n; i++) {
+          float diff = static_cast<float>(ref[i]) - static_cast<float>(data[i]);
+          count += !((diff <= epsilon) && (diff >= -epsilon));
+        }
+
+        return count;
+      },
+      threshold, errors);
+
+  free(ref_file_path);
+
+  if (ok) {
+    printf("  OK\n");
+  } else {
+    printf("  FAILURE: 1 errors...\n");
+  }
+
+  return ok;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! sdkCompareBin2BinFloat() for a reference that may be a golden container.
+//! A golden reference is compared chunk by chunk, any other reference is
+//! passed on to sdkCompareBin2BinFloat().
+//////////////////////////////////////////////////////////////////////////////
+inline bool sdkCompareBin2BinGoldenFloat(const char *src_file,
+                                         const char *ref_file,
+                                         unsigned int nelements,
+                                         const float epsilon,
+                                         const float threshold,
+                                         char *exec_path) {
+  char *ref_file_path = sdkFindFilePath(ref_file, exec_path);
+
+  if (ref_file_path == NULL || !sdkIsGoldenFile(ref_file_path)) {
+    free(ref_file_path);
+    return sdkCompareBin2BinFloat(src_file, ref_file, nelements, epsilon,
+                                  threshold, exec_path);
+  }
+
+  printf(
+      "> compareBin2Bin <float> nelements=%d, epsilon=%4.2f,"
+      " threshold=%4.2f\n",
+      nelements, epsilon, threshold);
+
+  // same criterion as compareDataAsFloatThreshold()
+  float max_error = MAX(epsilon, __MIN_EPSILON_ERROR);
+  uint64_t errors = 0;
+  bool ok = sdkCompareBin2BinGolden<float>(
+      src_file, ref_file_path, nelements,
+      [max_error](const float *ref, const float *data, size_t n) {
+        size_t count = 0;
+
+        for (size_t i = 0; i < n; i++) {
+          count += !(fabs(ref[i] - data[i]) < max_error);
+        }
+
+        return count;
+      },
+      threshold, errors);
+
+  free(ref_file_path);
+
+  if (ok) {
+    printf("  OK\n");
+  } else {
+    printf("  FAILURE: 1 errors...\n");
+  }
+
+  return ok;
+}
+
+#endif  // COMMON_HELPER_GOLDEN_H_
@@ -0,0 +1,613 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Runtime of the host execution backend, see helper_host_exec.h
+
+#include <helper_host_exec.h>
+
+// the runtime sets the built-in variables of the workers
+#undef threadIdx
+#undef blockIdx
+#undef blockDim
+#undef gridDim
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+#define WINDOWS_LEAN_AND_MEAN
+#include <windows.h>
+#define HOST_EXEC_WIN_FIBERS 1
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__))
+#define HOST_EXEC_ASM_CONTEXT 1
+#else
+#include <ucontext.h>
+#endif
+
+// stack of the fiber of one CUDA thread
+#ifndef HOST_EXEC_STACK_SIZE
+#define HOST_EXEC_STACK_SIZE (64 * 1024)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Context switch
+
+#if defined(HOST_EXEC_ASM_CONTEXT)
+// Saves the callee-saved registers on the current stack, stores the stack
+// pointer in *fromSp and resumes the context saved at toSp. ucontext would
+// do the same with a signal mask system call on every switch.
+extern "C" void hostExecSwitchContext(void **fromSp, void *toSp);
+
+#if defined(__x86_64__)
+asm(R"(
+    .text
+    .globl hostExecSwitchContext
+    .type hostExecSwitchContext, @function
+hostExecSwitchContext:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size hostExecSwitchContext, .-hostExecSwitchContext
+)");
+#else
+asm(R"(
+    .text
+    .globl hostExecSwitchContext
+    .type hostExecSwitchContext, %function
+hostExecSwitchContext:
+    sub sp, sp, #160
+    stp x19, x20, [sp, #0]
+    stp x21, x22, [sp, #16]
+    stp x23, x24, [sp, #32]
+    stp x25, x26, [sp, #48]
+    stp x27, x28, [sp, #64]
+    stp x29, x30, [sp, #80]
+    stp d8, d9, [sp, #96]
+    stp d10, d11, [sp, #112]
+    stp d12, d13, [sp, #128]
+    stp d14, d15, [sp, #144]
+    mov x2, sp
+    str x2, [x0]
+    mov sp, x1
+    ldp x19, x20, [sp, #0]
+    ldp x21, x22, [sp, #16]
+    ldp x23, x24, [sp, #32]
+    ldp x25, x26, [sp, #48]
+    ldp x27, x28, [sp, #64]
+    ldp x29, x30, [sp, #80]
+    ldp d8, d9, [sp, #96]
+    ldp d10, d11, [sp, #112]
+    ldp d12, d13, [sp, #128]
+    ldp d14, d15, [sp, #144]
+    add sp, sp, #160
+    ret
+    .size hostExecSwitchContext, .-hostExecSwitchContext
+)");
+#endif
+#endif
+
+namespace {
+
+struct Context {
+#if defined(HOST_EXEC_WIN_FIBERS)
+  LPVOID fiber = NULL;
+#elif defined(HOST_EXEC_ASM_CONTEXT)
+  void *sp = NULL;
+#else
+  ucontext_t uc;
+#endif
+};
+
+struct Fiber {
+  Context context;
+  char *stack = NULL;
+  bool done = false;
+};
+
+// Per worker state of the block being run
+struct Worker {
+  std::vector<Fiber> fibers;
+  Context scheduler;
+  const std::function<void()> *body = NULL;
+  int current = 0;
+  bool inFiber = false;
+  std::vector<double> shared;
+
+  ~Worker() {
+    for (size_t i = 0; i < fibers.size(); i++) {
+#if defined(HOST_EXEC_WIN_FIBERS)
+      if (fibers[i].context.fiber) DeleteFiber(fibers[i].context.fiber);
+#endif
+      free(fibers[i].stack);
+    }
+  }
+};
+
+thread_local Worker worker;
+
+void switchContext(Context *from, Context *to) {
+#if defined(HOST_EXEC_WIN_FIBERS)
+  (void)from;
+  SwitchToFiber(to->fiber);
+#elif defined(HOST_EXEC_ASM_CONTEXT)
+  hostExecSwitchContext(&from->sp, to->sp);
+#else
+  swapcontext(&from->uc, &to->uc);
+#endif
+}
+
+void fiberMain() {
+  Worker &w = worker;
+
+  (*w.body)();
+
+  w.fibers[w.current].done = true;
+
+  // a finished fiber is never resumed
+  switchContext(&w.fibers[w.current].context, &w.scheduler);
+}
+
+#if defined(HOST_EXEC_WIN_FIBERS)
+VOID CALLBACK fiberEntry(LPVOID) { fiberMain(); }
+#else
+void fiberEntry() { fiberMain(); }
+#endif
+
+// Prepares fiber f to run the body of the block from its beginning
+void startFiber(Fiber &f) {
+  f.done = false;
+
+#if defined(HOST_EXEC_WIN_FIBERS)
+  if (f.context.fiber) DeleteFiber(f.context.fiber);
+
+  f.context.fiber = CreateFiber(HOST_EXEC_STACK_SIZE, fiberEntry, NULL);
+#else
+  if (f.stack == NULL) f.stack = (char *)malloc(HOST_EXEC_STACK_SIZE);
+
+  if (f.stack == NULL) {
+    fprintf(stderr, "host exec: cannot allocate a fiber stack\n");
+    exit(EXIT_FAILURE);
+  }
+
+#if defined(HOST_EXEC_ASM_CONTEXT)
+  uintptr_t top = ((uintptr_t)f.stack + HOST_EXEC_STACK_SIZE) & ~(uintptr_t)15;
+  void **sp = (void **)top;
+
+#if defined(__x86_64__)
+  // fake return address of fiberEntry, then fiberEntry as the return address
+  // of hostExecSwitchContext and six callee-saved registers
+  *--sp = NULL;
+  *--sp = (void *)&fiberEntry;
+
+  for (int i = 0; i < 6; i++) *--sp = NULL;
+#else
+  // x19-x30 and d8-d15, fiberEntry in the slot of the link register x30
+  sp -= 20;
+  memset(sp, 0, 20 * sizeof(void *));
+  sp[11] = (void *)&fiberEntry;
+#endif
+
+  f.context.sp = sp;
+#else
+  getcontext(&f.context.uc);
+  f.context.uc.uc_stack.ss_sp = f.stack;
+  f.context.uc.uc_stack.ss_size = HOST_EXEC_STACK_SIZE;
+  f.context.uc.uc_link = NULL;
+  makecontext(&f.context.uc, fiberEntry, 0);
+#endif
+#endif
+}
+
+void setThreadIdx(hostExecState &s, int t) {
+  s.threadIdx.x = t % s.blockDim.x;
+  s.threadIdx.y = (t / s.blockDim.x) % s.blockDim.y;
+  s.threadIdx.z = t / (s.blockDim.x * s.blockDim.y);
+}
+
+// Runs all threads of the current block of the worker
+void runBlock(const std::function<void()> &body, int numThreads) {
+  Worker &w = worker;
+  hostExecState &s = hostExecGetState();
+
+#if defined(HOST_EXEC_WIN_FIBERS)
+  if (w.scheduler.fiber == NULL) {
+    w.scheduler.fiber = ConvertThreadToFiber(NULL);
+  }
+#endif
+
+  if ((int)w.fibers.size() < numThreads) w.fibers.resize(numThreads);
+
+  w.body = &body;
+
+  // thread 0 runs as a fiber, if it does not reach a barrier no thread of
+  // the block does, and the others run as a plain loop
+  w.current = 0;
+  w.inFiber = true;
+  setThreadIdx(s, 0);
+  startFiber(w.fibers[0]);
+  switchContext(&w.scheduler, &w.fibers[0].context);
+
+  if (w.fibers[0].done) {
+    w.inFiber = false;
+
+    for (int t = 1; t < numThreads; t++) {
+      setThreadIdx(s, t);
+      body();
+    }
+
+    return;
+  }
+
+  for (int t = 1; t < numThreads; t++) startFiber(w.fibers[t]);
+
+  // every pass takes all threads to the next barrier
+  int alive = numThreads;
+
+  while (alive > 0) {
+    alive = 0;
+
+    for (int t = 0; t < numThreads; t++) {
+      if (w.fibers[t].done) continue;
+
+      w.current = t;
+      setThreadIdx(s, t);
+      switchContext(&w.scheduler, &w.fibers[t].context);
+
+      if (!w.fibers[t].done) alive++;
+    }
+  }
+
+  w.inFiber = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Worker pool, the blocks of a launch are its tasks
+
+class WorkerPool {
+ public:
+  static WorkerPool &get() {
+    static WorkerPool pool;
+    return pool;
+  }
+
+  int getNumWorkers() const { return (int)threads_.size(); }
+
+  // Runs task(0) ... task(numTasks - 1) on the workers and waits for them
+  void run(int numTasks, const std::function<void(int)> &task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    task_ = &task;
+    numTasks_ = numTasks;
+    next_.store(0);
+    busy_ = (int)threads_.size();
+    generation_++;
+    start_.notify_all();
+
+    done_.wait(lock, [this]() { return busy_ == 0; });
+
+    task_ = NULL;
+  }
+
+ private:
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  const std::function<void(int)> *task_ = NULL;
+  int numTasks_ = 0;
+  std::atomic<int> next_;
+  int busy_ = 0;
+  long long generation_ = 0;
+  bool quit_ = false;
+
+  WorkerPool() : next_(0) {
+    int n = (int)std::thread::hardware_concurrency();
+    const char *env = getenv("CUDA_HOST_EXEC_THREADS");
+
+    if (env && atoi(env) > 0) n = atoi(env);
+
+    if (n <= 0) n = 1;
+
+    for (int i = 0; i < n; i++) {
+      threads_.push_back(std::thread(&WorkerPool::workerLoop, this));
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      quit_ = true;
+    }
+
+    start_.notify_all();
+
+    for (size_t i = 0; i < threads_.size(); i++) threads_[i].join();
+  }
+
+  void workerLoop() {
+    long long seen = 0;
+
+    for (;;) {
+      const std::function<void(int)> *task;
+      int numTasks;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        start_.wait(lock, [&]() { return quit_ || generation_ != seen; });
+
+        if (quit_) return;
+
+        seen = generation_;
+        task = task_;
+        numTasks = numTasks_;
+      }
+
+      for (int i = next_.fetch_add(1); i < numTasks; i = next_.fetch_add(1)) {
+        (*task)(i);
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (--busy_ == 0) done_.notify_one();
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernel registry and profile
+
+struct KernelProfile {
+  long long launches = 0;
+  long long blocks = 0;
+  long long threads = 0;
+  double ms = 0.0;
+};
+
+class Registry {
+ public:
+  static Registry &get() {
+    static Registry registry;
+    return registry;
+  }
+
+  std::map<std::string, hostExecLauncher> kernels;
+  std::map<std::string, KernelProfile> profile;
+  std::mutex mutex;
+  bool profiling;
+
+ private:
+  Registry() : profiling(getenv("CUDA_HOST_EXEC_PROFILE") != NULL) {}
+
+  ~Registry() {
+    if (!profiling || profile.empty()) return;
+
+    printf("\nhost exec profile:\n");
+    printf("%-32s %10s %12s %14s %12s\n", "kernel", "launches", "blocks",
+           "threads", "time (ms)");
+
+    for (std::map<std::string, KernelProfile>::iterator it = profile.begin();
+         it != profile.end(); ++it) {
+      printf("%-32s %10lld %12lld %14lld %12.3f\n", it->first.c_str(),
+             it->second.launches, it->second.blocks, it->second.threads,
+             it->second.ms);
+    }
+  }
+};
+
+// address of the module returned by loadCUBIN
+char hostExecModuleTag;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Built-in variables and synchronization
+
+thread_local hostExecState hostExecCurrentState;
+
+void __syncthreads() {
+  Worker &w = worker;
+
+  if (!w.inFiber) {
+    fprintf(stderr,
+            "host exec: __syncthreads() not reached by thread 0 of the "
+            "block\n");
+    exit(EXIT_FAILURE);
+  }
+
+  switchContext(&w.fibers[w.current].context, &w.scheduler);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Launch
+
+void hostExecLaunchGrid(const char *name, dim3 grid, dim3 block,
+                        size_t sharedMem, const std::function<void()> &body) {
+  const int numBlocks = grid.x * grid.y * grid.z;
+  const int numThreads = block.x * block.y * block.z;
+
+  if (numBlocks <= 0 || numThreads <= 0) return;
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+
+  WorkerPool::get().run(numBlocks, [&](int b) {
+    hostExecState &s = hostExecGetState();
+    Worker &w = worker;
+
+    s.gridDim = grid;
+    s.blockDim = block;
+    s.blockIdx.x = b % grid.x;
+    s.blockIdx.y = (b / grid.x) % grid.y;
+    s.blockIdx.z = b / (grid.x * grid.y);
+
+    size_t words = (sharedMem + sizeof(double) - 1) / sizeof(double);
+
+    if (w.shared.size() < words) w.shared.resize(words);
+
+    s.dynamicShared = words ? &w.shared[0] : NULL;
+
+    runBlock(body, numThreads);
+  });
+
+  Registry &r = Registry::get();
+
+  if (r.profiling) {
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    KernelProfile &p = r.profile[name];
+    p.launches++;
+    p.blocks += numBlocks;
+    p.threads += (long long)numBlocks * numThreads;
+    p.ms += ms;
+  }
+}
+
+bool hostExecRegister(const char *name, const hostExecLauncher &launcher) {
+  Registry &r = Registry::get();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  r.kernels[name] = launcher;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Driver API subset
+
+CUresult cuMemAlloc(CUdeviceptr *dptr, size_t bytesize) {
+  void *p = malloc(bytesize);
+
+  if (p == NULL) return CUDA_ERROR_OUT_OF_MEMORY;
+
+  *dptr = (CUdeviceptr)(uintptr_t)p;
+
+  return CUDA_SUCCESS;
+}
+
+CUresult cuMemFree(CUdeviceptr dptr) {
+  free((void *)(uintptr_t)dptr);
+
+  return CUDA_SUCCESS;
+}
+
+CUresult cuMemcpyHtoD(CUdeviceptr dstDevice, const void *srcHost,
+                      size_t ByteCount) {
+  memcpy((void *)(uintptr_t)dstDevice, srcHost, ByteCount);
+
+  return CUDA_SUCCESS;
+}
+
+CUresult cuMemcpyDtoH(void *dstHost, CUdeviceptr srcDevice, size_t ByteCount) {
+  memcpy(dstHost, (const void *)(uintptr_t)srcDevice, ByteCount);
+
+  return CUDA_SUCCESS;
+}
+
+// launches are synchronous
+CUresult cuCtxSynchronize() { return CUDA_SUCCESS; }
+
+CUresult cuModuleGetFunction(CUfunction *hfunc, CUmodule hmod,
+                             const char *name) {
+  Registry &r = Registry::get();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  std::map<std::string, hostExecLauncher>::const_iterator it =
+      r.kernels.find(name);
+
+  if (hmod == NULL || it == r.kernels.end()) return CUDA_ERROR_NOT_FOUND;
+
+  *hfunc = &it->second;
+
+  return CUDA_SUCCESS;
+}
+
+CUresult cuLaunchKernel(CUfunction f, unsigned int gridDimX,
+                        unsigned int gridDimY, unsigned int gridDimZ,
+                        unsigned int blockDimX, unsigned int blockDimY,
+                        unsigned int blockDimZ, unsigned int sharedMemBytes,
+                        CUstream hStream, void **kernelParams, void **extra) {
+  (void)hStream;
+
+  if (f == NULL || extra != NULL) return CUDA_ERROR_INVALID_VALUE;
+
+  (*f)(dim3(gridDimX, gridDimY, gridDimZ),
+       dim3(blockDimX, blockDimY, blockDimZ), sharedMemBytes, kernelParams);
+
+  return CUDA_SUCCESS;
+}
+
+void compileFileToCUBIN(char *filename, int argc, char **argv,
+                        char **cubinResult, size_t *cubinResultSize,
+                        int requiresCGheaders) {
+  (void)filename;
+  (void)argc;
+  (void)argv;
+  (void)requiresCGheaders;
+
+  *cubinResult = NULL;
+  *cubinResultSize = 0;
+}
+
+CUmodule loadCUBIN(char *cubin, int argc, char **argv) {
+  (void)cubin;
+  (void)argc;
+  (void)argv;
+
+  printf("> Using the host execution backend with %d worker threads\n",
+         WorkerPool::get().getNumWorkers());
+
+  return (CUmodule)&hostExecModuleTag;
+}
+
+void hostExecCheck(CUresult result, const char *func, const char *file,
+                   int line) {
+  if (result != CUDA_SUCCESS) {
+    fprintf(stderr, "host exec error = %04d from file <%s>, line %i: %s\n",
+            result, file, line, func);
+    exit(EXIT_FAILURE);
+  }
+}
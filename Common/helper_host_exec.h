@@ -0,0 +1,230 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host execution backend for simple CUDA kernels.
+//
+// With CUDA_HOST_EXEC defined, kernel sources (*.cu) compile with a host
+// compiler and run on the CPU. The blocks of a launch are tasks of a pool of
+// worker threads, and the threads of a block run on the worker that owns the
+// block:
+//  - a kernel that does not reach __syncthreads() runs its threads as a
+//    plain loop,
+//  - at the first barrier the block switches to one fiber per thread, and
+//    every barrier resumes the next fiber until all threads have reached it.
+// __shared__ variables are thread_local, so they are private to the worker,
+// i.e. to the block it runs. Dynamic shared memory is hostExecDynamicShared().
+//
+// The subset of the driver API used by the nvrtc samples is provided as
+// well (cuMemAlloc, cuMemcpyHtoD, cuLaunchKernel, ...). Kernels are found by
+// the names registered with HOST_EXEC_REGISTER_KERNEL, so the host code of a
+// sample runs unchanged. The runtime is in helper_host_exec.cpp.
+//
+// Environment:
+//   CUDA_HOST_EXEC_THREADS  number of workers (default: hardware threads)
+//   CUDA_HOST_EXEC_PROFILE  print the launches and time per kernel at exit
+
+#ifndef COMMON_HELPER_HOST_EXEC_H_
+#define COMMON_HELPER_HOST_EXEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+// Execution space qualifiers and built-in types
+
+#define __global__
+#define __device__
+#define __host__
+#define __forceinline__ inline
+#define __shared__ static thread_local
+
+struct uint3 {
+  unsigned int x, y, z;
+};
+
+struct dim3 {
+  unsigned int x, y, z;
+
+  dim3(unsigned int vx = 1, unsigned int vy = 1, unsigned int vz = 1)
+      : x(vx), y(vy), z(vz) {}
+  dim3(uint3 v) : x(v.x), y(v.y), z(v.z) {}
+  operator uint3() const {
+    uint3 t = {x, y, z};
+    return t;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Built-in variables, per worker thread
+
+// trivial type, so that the thread_local needs no initialization guard and
+// the built-in variables are plain TLS loads
+struct hostExecState {
+  uint3 threadIdx;
+  uint3 blockIdx;
+  uint3 blockDim;
+  uint3 gridDim;
+  void *dynamicShared;
+};
+
+extern thread_local hostExecState hostExecCurrentState;
+
+inline hostExecState &hostExecGetState() { return hostExecCurrentState; }
+
+#define threadIdx (hostExecGetState().threadIdx)
+#define blockIdx (hostExecGetState().blockIdx)
+#define blockDim (hostExecGetState().blockDim)
+#define gridDim (hostExecGetState().gridDim)
+
+inline void *hostExecDynamicShared() {
+  return hostExecGetState().dynamicShared;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Synchronization
+
+void __syncthreads();
+
+// all threads of a block run on one worker, memory is always coherent
+inline void __threadfence_block() {}
+
+namespace cooperative_groups {
+
+class thread_block {
+ public:
+  void sync() const { __syncthreads(); }
+
+  unsigned int thread_rank() const {
+    return (threadIdx.z * blockDim.y + threadIdx.y) * blockDim.x + threadIdx.x;
+  }
+
+  unsigned int size() const { return blockDim.x * blockDim.y * blockDim.z; }
+
+  dim3 group_dim() const { return blockDim; }
+  uint3 group_index() const { return blockIdx; }
+  uint3 thread_index() const { return threadIdx; }
+};
+
+inline thread_block this_thread_block() { return thread_block(); }
+
+inline void sync(const thread_block &g) { g.sync(); }
+
+}  // namespace cooperative_groups
+
+////////////////////////////////////////////////////////////////////////////////
+// Launch
+
+typedef std::function<void(dim3, dim3, size_t, void **)> hostExecLauncher;
+
+// runs body for every thread of the grid
+void hostExecLaunchGrid(const char *name, dim3 grid, dim3 block,
+                        size_t sharedMem, const std::function<void()> &body);
+
+template <class... Args>
+void hostExecLaunch(const char *name, void (*kernel)(Args...), dim3 grid,
+                    dim3 block, size_t sharedMem,
+                    typename std::decay<Args>::type... args) {
+  hostExecLaunchGrid(name, grid, block, sharedMem,
+                     [&]() { kernel(args...); });
+}
+
+template <class... Args, size_t... I>
+void hostExecLaunchPacked(const char *name, void (*kernel)(Args...), dim3 grid,
+                          dim3 block, size_t sharedMem, void **params,
+                          std::index_sequence<I...>) {
+  hostExecLaunch(
+      name, kernel, grid, block, sharedMem,
+      *reinterpret_cast<typename std::decay<Args>::type *>(params[I])...);
+}
+
+bool hostExecRegister(const char *name, const hostExecLauncher &launcher);
+
+// kernel arguments are passed the cuLaunchKernel way, as an array of
+// pointers to the argument values
+template <class... Args>
+bool hostExecRegisterKernel(const char *name, void (*kernel)(Args...)) {
+  return hostExecRegister(
+      name, [name, kernel](dim3 grid, dim3 block, size_t sharedMem,
+                           void **params) {
+        hostExecLaunchPacked(name, kernel, grid, block, sharedMem, params,
+                             std::index_sequence_for<Args...>());
+      });
+}
+
+#define HOST_EXEC_REGISTER_KERNEL(kernel)         \
+  static const bool hostExecRegistered_##kernel = \
+      hostExecRegisterKernel(#kernel, &kernel)
+
+////////////////////////////////////////////////////////////////////////////////
+// Driver API subset used by the nvrtc samples
+
+typedef int CUresult;
+typedef int CUdevice;
+typedef unsigned long long CUdeviceptr;
+typedef struct hostExecModule *CUmodule;
+typedef const hostExecLauncher *CUfunction;
+typedef void *CUstream;
+
+#define CUDA_SUCCESS 0
+#define CUDA_ERROR_INVALID_VALUE 1
+#define CUDA_ERROR_OUT_OF_MEMORY 2
+#define CUDA_ERROR_NOT_FOUND 500
+
+CUresult cuMemAlloc(CUdeviceptr *dptr, size_t bytesize);
+CUresult cuMemFree(CUdeviceptr dptr);
+CUresult cuMemcpyHtoD(CUdeviceptr dstDevice, const void *srcHost,
+                      size_t ByteCount);
+CUresult cuMemcpyDtoH(void *dstHost, CUdeviceptr srcDevice, size_t ByteCount);
+CUresult cuCtxSynchronize();
+CUresult cuModuleGetFunction(CUfunction *hfunc, CUmodule hmod,
+                             const char *name);
+CUresult cuLaunchKernel(CUfunction f, unsigned int gridDimX,
+                        unsigned int gridDimY, unsigned int gridDimZ,
+                        unsigned int blockDimX, unsigned int blockDimY,
+                        unsigned int blockDimZ, unsigned int sharedMemBytes,
+                        CUstream hStream, void **kernelParams, void **extra);
+
+// the kernels are compiled into the executable, there is nothing to compile
+// or load at run time
+void compileFileToCUBIN(char *filename, int argc, char **argv,
+                        char **cubinResult, size_t *cubinResultSize,
+                        int requiresCGheaders);
+CUmodule loadCUBIN(char *cubin, int argc, char **argv);
+
+void hostExecCheck(CUresult result, const char *func, const char *file,
+                   int line);
+
+#define checkCudaErrors(val) hostExecCheck((val), #val, __FILE__, __LINE__)
+
+#endif  // COMMON_HELPER_HOST_EXEC_H_
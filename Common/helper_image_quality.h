@@ -0,0 +1,629 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host image quality metrics of pitched images.
+//
+//   sdkImageQualityParams params;        // defaults: 8-bit, 1 channel,
+//   sdkImageQualityResult result;        // 64 x 64 tiles, 7 x 7 SSIM window
+//   sdkImageQuality(img, pitch, ref, refPitch, width, height, params, result);
+//   sdkFlowQuality(u, v, uRef, vRef, pitch, width, height, params, result);
+//
+// sdkImageQuality computes the mean squared error, the PSNR, the largest
+// absolute difference and the mean SSIM of an image against a reference, for
+// the whole image and for every tile. sdkFlowQuality computes the mean and
+// largest endpoint error |(u, v) - (uRef, vRef)| and the mean L1 error
+// |u - uRef| + |v - vRef| of a flow field.
+//
+// The image is split into tiles that are processed by a pool of threads in
+// one pass. A tile reads its rows plus an SSIM window radius of halo once:
+// every row updates the summed area tables of a, b, a^2, b^2 and ab for each
+// channel and, inside the tile, the squared error (SSE2 on x86). The SSIM of
+// every pixel then takes four lookups per table, with the box window clipped
+// at the image border. The tables are kept in double precision, sums of 8-bit
+// and float images are exact or nearly so. Per tile sums are reduced in tile
+// order, the results do not depend on the number of threads.
+//
+// Pitches are in bytes, channels are interleaved. SSIM uses the constants
+// (0.01 peak)^2 and (0.03 peak)^2 and is averaged over the channels.
+
+#ifndef COMMON_HELPER_IMAGE_QUALITY_H_
+#define COMMON_HELPER_IMAGE_QUALITY_H_
+
+// includes, system
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <helper_image.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SDK_IMAGE_QUALITY_SSE2 1
+#endif
+
+struct sdkImageQualityParams {
+  double peak;     // largest pixel value, 255 for 8-bit images
+  int channels;    // interleaved channels per pixel
+  int tileSize;    // side of the tiles of the breakdown
+  int ssimRadius;  // SSIM window of (2 r + 1)^2 pixels, 0: no SSIM
+  int numThreads;  // <= 0 selects the number of hardware threads
+
+  sdkImageQualityParams()
+      : peak(255.0), channels(1), tileSize(64), ssimRadius(3), numThreads(0) {}
+};
+
+struct sdkImageQualityTile {
+  int x, y, width, height;  // pixels of the tile
+  double mse;               // mean squared error over pixels and channels
+  double psnr;              // dB, infinite if the tile matches exactly
+  double ssim;              // mean SSIM of the windows centered in the tile
+  double maxError;          // largest absolute difference
+  double epe;               // mean endpoint error (flow)
+  double maxEpe;            // largest endpoint error (flow)
+  double l1;                // mean |du| + |dv| (flow)
+};
+
+struct sdkImageQualityResult {
+  double mse, psnr, ssim, maxError;  // images
+  double epe, maxEpe, l1;            // flow fields
+  int tilesX, tilesY;
+  std::vector<sdkImageQualityTile> tiles;  // tilesY x tilesX, row major
+};
+
+namespace sdkImageQualityDetail {
+
+// Run fn(index, worker) for index in [0, count) on up to numThreads threads,
+// worker in [0, threads) identifies the per thread scratch
+template <class F>
+inline int parallelFor(int count, int numThreads, F fn) {
+  if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+  numThreads = (std::max)(1, (std::min)(numThreads, count));
+
+  std::atomic<int> next(0);
+  auto worker = [&](int w) {
+    int i;
+
+    while ((i = next++) < count) fn(i, w);
+  };
+
+  std::vector<std::thread> threads;
+
+  for (int t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker, t));
+    } catch (const std::system_error &) {
+      // no thread support, the calling thread does the remaining tiles
+      break;
+    }
+  }
+
+  worker(0);
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+  return numThreads;
+}
+
+template <class T>
+inline const T *row(const T *base, size_t pitch, int y) {
+  return (const T *)((const char *)base + (size_t)y * pitch);
+}
+
+// Sum of squared differences and largest absolute difference of n values
+inline void rowError(const unsigned char *a, const unsigned char *b, int n,
+                     double &sse, double &maxError) {
+  uint64_t sum = 0;
+  int maxAbs = 0, i = 0;
+#if defined(SDK_IMAGE_QUALITY_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i vmax = zero;
+
+  while (i + 16 <= n) {
+    // at most 1024 blocks of 16 before the 32-bit lanes are flushed
+    const int end = (std::min)(n & ~15, i + 16 * 1024);
+    __m128i acc = zero;
+
+    for (; i < end; i += 16) {
+      __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+      __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+      __m128i d = _mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x));
+      __m128i lo = _mm_unpacklo_epi8(d, zero);
+      __m128i hi = _mm_unpackhi_epi8(d, zero);
+      vmax = _mm_max_epu8(vmax, d);
+      acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_madd_epi16(lo, lo),
+                                             _mm_madd_epi16(hi, hi)));
+    }
+
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+
+  unsigned char bytes[16];
+  _mm_storeu_si128((__m128i *)bytes, vmax);
+
+  for (int k = 0; k < 16; k++) maxAbs = (std::max)(maxAbs, (int)bytes[k]);
+#endif
+
+  for (; i < n; i++) {
+    int d = (int)a[i] - (int)b[i];
+    sum += (uint64_t)(d * d);
+    maxAbs = (std::max)(maxAbs, abs(d));
+  }
+
+  sse += (double)sum;
+  maxError = (std::max)(maxError, (double)maxAbs);
+}
+
+inline void rowError(const float *a, const float *b, int n, double &sse,
+                     double &maxError) {
+  double sum = 0.0, maxAbs = 0.0;
+  int i = 0;
+#if defined(SDK_IMAGE_QUALITY_SSE2)
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+  __m128 vmax = _mm_setzero_ps();
+
+  for (; i + 4 <= n; i += 4) {
+    __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    __m128d lo = _mm_cvtps_pd(d), hi = _mm_cvtps_pd(_mm_movehl_ps(d, d));
+    vmax = _mm_max_ps(vmax, _mm_andnot_ps(signMask, d));
+    acc0 = _mm_add_pd(acc0, _mm_mul_pd(lo, lo));
+    acc1 = _mm_add_pd(acc1, _mm_mul_pd(hi, hi));
+  }
+
+  double lanes[2];
+  float m[4];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+  _mm_storeu_ps(m, vmax);
+  sum = lanes[0] + lanes[1];
+
+  for (int k = 0; k < 4; k++) maxAbs = (std::max)(maxAbs, (double)m[k]);
+#endif
+
+  for (; i < n; i++) {
+    double d = (double)a[i] - (double)b[i];
+    sum += d * d;
+    maxAbs = (std::max)(maxAbs, fabs(d));
+  }
+
+  sse += sum;
+  maxError = (std::max)(maxError, maxAbs);
+}
+
+// Endpoint and L1 errors of n flow vectors
+inline void rowFlow(const float *u, const float *v, const float *uRef,
+                    const float *vRef, int n, double &epe, double &maxEpe,
+                    double &l1) {
+  double sumEpe = 0.0, sumL1 = 0.0, maxE = 0.0;
+  int i = 0;
+#if defined(SDK_IMAGE_QUALITY_SSE2)
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  __m128d accEpe = _mm_setzero_pd(), accL1 = _mm_setzero_pd();
+  __m128 vmax = _mm_setzero_ps();
+
+  for (; i + 4 <= n; i += 4) {
+    __m128 du = _mm_sub_ps(_mm_loadu_ps(u + i), _mm_loadu_ps(uRef + i));
+    __m128 dv = _mm_sub_ps(_mm_loadu_ps(v + i), _mm_loadu_ps(vRef + i));
+    __m128 e = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(du, du), _mm_mul_ps(dv, dv)));
+    __m128 a = _mm_add_ps(_mm_andnot_ps(signMask, du),
+                          _mm_andnot_ps(signMask, dv));
+    vmax = _mm_max_ps(vmax, e);
+    accEpe = _mm_add_pd(accEpe, _mm_add_pd(_mm_cvtps_pd(e),
+                                           _mm_cvtps_pd(_mm_movehl_ps(e, e))));
+    accL1 = _mm_add_pd(accL1, _mm_add_pd(_mm_cvtps_pd(a),
+                                         _mm_cvtps_pd(_mm_movehl_ps(a, a))));
+  }
+
+  double lanes[2];
+  float m[4];
+  _mm_storeu_pd(lanes, accEpe);
+  sumEpe = lanes[0] + lanes[1];
+  _mm_storeu_pd(lanes, accL1);
+  sumL1 = lanes[0] + lanes[1];
+  _mm_storeu_ps(m, vmax);
+
+  for (int k = 0; k < 4; k++) maxE = (std::max)(maxE, (double)m[k]);
+#endif
+
+  for (; i < n; i++) {
+    float du = u[i] - uRef[i], dv = v[i] - vRef[i];
+    float e = sqrtf(du * du + dv * dv);
+    sumEpe += e;
+    sumL1 += fabsf(du) + fabsf(dv);
+    maxE = (std::max)(maxE, (double)e);
+  }
+
+  epe += sumEpe;
+  l1 += sumL1;
+  maxEpe = (std::max)(maxEpe, maxE);
+}
+
+// summed area tables of a, b, a^2, b^2 and ab
+const int kTables = 5;
+
+// Sum of the SSIM of count windows [j, j + d) x [k0, k1), j = j0, j0 + 1, ...
+// top[t] and bottom[t] are the rows k0 and k1 of table t
+inline double ssimSpan(const double *const *top, const double *const *bottom,
+                       int j0, int d, int count, double invArea, double c1,
+                       double c2) {
+  double sum = 0.0;
+  int i = 0;
+#if defined(SDK_IMAGE_QUALITY_SSE2)
+  const __m128d vInv = _mm_set1_pd(invArea), two = _mm_set1_pd(2.0);
+  const __m128d vc1 = _mm_set1_pd(c1), vc2 = _mm_set1_pd(c2);
+  __m128d acc = _mm_setzero_pd();
+
+  for (; i + 2 <= count; i += 2) {
+    const int j = j0 + i;
+    __m128d s[kTables];
+
+    for (int t = 0; t < kTables; t++) {
+      __m128d lower = _mm_sub_pd(_mm_loadu_pd(bottom[t] + j + d),
+                                 _mm_loadu_pd(bottom[t] + j));
+      __m128d upper = _mm_sub_pd(_mm_loadu_pd(top[t] + j + d),
+                                 _mm_loadu_pd(top[t] + j));
+      s[t] = _mm_mul_pd(_mm_sub_pd(lower, upper), vInv);
+    }
+
+    __m128d ma = s[0], mb = s[1], mab = _mm_mul_pd(ma, mb);
+    __m128d ma2 = _mm_mul_pd(ma, ma), mb2 = _mm_mul_pd(mb, mb);
+    __m128d var = _mm_sub_pd(_mm_add_pd(s[2], s[3]), _mm_add_pd(ma2, mb2));
+    __m128d cov = _mm_sub_pd(s[4], mab);
+    __m128d num = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(two, mab), vc1),
+                             _mm_add_pd(_mm_mul_pd(two, cov), vc2));
+    __m128d den = _mm_mul_pd(_mm_add_pd(_mm_add_pd(ma2, mb2), vc1),
+                             _mm_add_pd(var, vc2));
+    acc = _mm_add_pd(acc, _mm_div_pd(num, den));
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  sum = lanes[0] + lanes[1];
+#endif
+
+  for (; i < count; i++) {
+    const int j = j0 + i;
+    double s[kTables];
+
+    for (int t = 0; t < kTables; t++) {
+      s[t] = (bottom[t][j + d] - bottom[t][j] - top[t][j + d] + top[t][j]) *
+             invArea;
+    }
+
+    double ma = s[0], mb = s[1];
+    double var = s[2] + s[3] - ma * ma - mb * mb, cov = s[4] - ma * mb;
+    sum += (2.0 * ma * mb + c1) * (2.0 * cov + c2) /
+           ((ma * ma + mb * mb + c1) * (var + c2));
+  }
+
+  return sum;
+}
+
+// Per tile sums, reduced in tile order
+struct TileSums {
+  double sse, maxError, ssim;
+};
+
+template <class T>
+inline void imageTile(const T *img, size_t imgPitch, const T *ref,
+                      size_t refPitch, int width, int height,
+                      const sdkImageQualityParams &params,
+                      const sdkImageQualityTile &tile, double *scratch,
+                      TileSums &sums) {
+  const int C = params.channels, r = (std::max)(params.ssimRadius, 0);
+  const int x0 = tile.x, y0 = tile.y, x1 = x0 + tile.width,
+            y1 = y0 + tile.height;
+
+  sums.sse = sums.maxError = sums.ssim = 0.0;
+
+  if (r == 0) {
+    for (int y = y0; y < y1; y++) {
+      rowError(row(img, imgPitch, y) + x0 * C, row(ref, refPitch, y) + x0 * C,
+               tile.width * C, sums.sse, sums.maxError);
+    }
+
+    return;
+  }
+
+  // halo of the SSIM windows, clipped to the image
+  const int hx0 = (std::max)(x0 - r, 0), hx1 = (std::min)(x1 + r, width);
+  const int hy0 = (std::max)(y0 - r, 0), hy1 = (std::min)(y1 + r, height);
+  const int hw = hx1 - hx0, hh = hy1 - hy0, pitch = hw + 1;
+  const size_t plane = (size_t)(hh + 1) * pitch;
+  const double peak = params.peak;
+  const double c1 = (0.01 * peak) * (0.01 * peak);
+  const double c2 = (0.03 * peak) * (0.03 * peak);
+  // pixels whose windows are not clipped at the left and right border
+  const int cx0 = (std::max)(x0, hx0 + r), cx1 = (std::min)(x1, hx1 - r);
+
+  for (int c = 0; c < C; c++) {
+    double *table[kTables];
+
+    for (int t = 0; t < kTables; t++) {
+      table[t] = scratch + t * plane;
+      std::fill(table[t], table[t] + pitch, 0.0);
+    }
+
+    for (int k = 0; k < hh; k++) {
+      const int y = hy0 + k;
+      const T *a = row(img, imgPitch, y) + hx0 * C + c;
+      const T *b = row(ref, refPitch, y) + hx0 * C + c;
+      const double *up[kTables];
+      double *out[kTables];
+      double s[kTables] = {0.0, 0.0, 0.0, 0.0, 0.0};
+
+      // the error of the tile rows, while they are in the cache
+      if (c == 0 && y >= y0 && y < y1) {
+        rowError(a + (x0 - hx0) * C, b + (x0 - hx0) * C, tile.width * C,
+                 sums.sse, sums.maxError);
+      }
+
+      for (int t = 0; t < kTables; t++) {
+        up[t] = table[t] + k * pitch;
+        out[t] = table[t] + (k + 1) * pitch;
+        out[t][0] = 0.0;
+      }
+
+      for (int j = 0; j < hw; j++) {
+        const double va = (double)a[j * C], vb = (double)b[j * C];
+        s[0] += va;
+        s[1] += vb;
+        s[2] += va * va;
+        s[3] += vb * vb;
+        s[4] += va * vb;
+
+        for (int t = 0; t < kTables; t++) out[t][j + 1] = up[t][j + 1] + s[t];
+      }
+    }
+
+    for (int y = y0; y < y1; y++) {
+      const int k0 = (std::max)(y - r, hy0) - hy0;
+      const int k1 = (std::min)(y + r + 1, hy1) - hy0;
+      const double *top[kTables], *bottom[kTables];
+
+      for (int t = 0; t < kTables; t++) {
+        top[t] = table[t] + k0 * pitch;
+        bottom[t] = table[t] + k1 * pitch;
+      }
+
+      for (int x = x0; x < x1; x++) {
+        if (x == cx0 && cx0 < cx1) {
+          sums.ssim += ssimSpan(top, bottom, x - r - hx0, 2 * r + 1,
+                                cx1 - cx0, 1.0 / ((k1 - k0) * (2 * r + 1)),
+                                c1, c2);
+          x = cx1 - 1;
+          continue;
+        }
+
+        const int j0 = (std::max)(x - r, hx0) - hx0;
+        const int j1 = (std::min)(x + r + 1, hx1) - hx0;
+        sums.ssim += ssimSpan(top, bottom, j0, j1 - j0, 1,
+                              1.0 / ((k1 - k0) * (j1 - j0)), c1, c2);
+      }
+    }
+  }
+}
+
+inline double psnr(double mse, double peak) {
+  return (mse > 0.0) ? 10.0 * log10(peak * peak / mse) : HUGE_VAL;
+}
+
+inline void initTiles(int width, int height,
+                      const sdkImageQualityParams &params,
+                      sdkImageQualityResult &result) {
+  const int size = (params.tileSize > 0) ? params.tileSize : 64;
+
+  result.mse = result.psnr = result.ssim = result.maxError = 0.0;
+  result.epe = result.maxEpe = result.l1 = 0.0;
+  result.tilesX = (width > 0) ? (width + size - 1) / size : 0;
+  result.tilesY = (height > 0) ? (height + size - 1) / size : 0;
+  result.tiles.assign((size_t)result.tilesX * result.tilesY,
+                      sdkImageQualityTile());
+
+  for (int ty = 0; ty < result.tilesY; ty++) {
+    for (int tx = 0; tx < result.tilesX; tx++) {
+      sdkImageQualityTile &tile = result.tiles[ty * result.tilesX + tx];
+      tile.x = tx * size;
+      tile.y = ty * size;
+      tile.width = (std::min)(size, width - tile.x);
+      tile.height = (std::min)(size, height - tile.y);
+      tile.mse = tile.psnr = tile.ssim = tile.maxError = 0.0;
+      tile.epe = tile.maxEpe = tile.l1 = 0.0;
+    }
+  }
+}
+
+template <class T>
+inline void imageQuality(const T *img, size_t imgPitch, const T *ref,
+                         size_t refPitch, int width, int height,
+                         const sdkImageQualityParams &params,
+                         sdkImageQualityResult &result) {
+  initTiles(width, height, params, result);
+
+  const int count = (int)result.tiles.size();
+
+  if (count == 0 || params.channels <= 0) return;
+
+  const int r = (std::max)(params.ssimRadius, 0);
+  const int side = (params.tileSize > 0 ? params.tileSize : 64) + 2 * r + 1;
+  const size_t scratchSize = (r > 0) ? (size_t)kTables * side * side : 0;
+  const int numThreads = (params.numThreads > 0)
+                             ? params.numThreads
+                             : (int)std::thread::hardware_concurrency();
+  std::vector<TileSums> sums(count);
+  std::vector<std::vector<double> > scratch((std::max)(numThreads, 1));
+
+  parallelFor(count, (int)scratch.size(), [&](int i, int w) {
+    if (scratch[w].size() < scratchSize) scratch[w].resize(scratchSize);
+
+    imageTile(img, imgPitch, ref, refPitch, width, height, params,
+              result.tiles[i], scratchSize ? &scratch[w][0] : NULL, sums[i]);
+  });
+
+  double sse = 0.0, ssim = 0.0;
+
+  for (int i = 0; i < count; i++) {
+    sdkImageQualityTile &tile = result.tiles[i];
+    const double n = (double)tile.width * tile.height * params.channels;
+
+    tile.mse = sums[i].sse / n;
+    tile.psnr = psnr(tile.mse, params.peak);
+    tile.ssim = (r > 0) ? sums[i].ssim / n : 0.0;
+    tile.maxError = sums[i].maxError;
+    sse += sums[i].sse;
+    ssim += sums[i].ssim;
+    result.maxError = (std::max)(result.maxError, tile.maxError);
+  }
+
+  const double n = (double)width * height * params.channels;
+  result.mse = sse / n;
+  result.psnr = psnr(result.mse, params.peak);
+  result.ssim = (r > 0) ? ssim / n : 0.0;
+}
+
+}  // namespace sdkImageQualityDetail
+
+//////////////////////////////////////////////////////////////////////////////
+//! MSE, PSNR, largest error and SSIM of an 8-bit image against a reference
+//! @param img       width x height pixels of params.channels bytes
+//! @param imgPitch  row pitch of img in bytes
+//! @param ref       reference image of the same size
+//! @param refPitch  row pitch of ref in bytes
+//! @param result    totals and per tile breakdown
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkImageQuality(const unsigned char *img, size_t imgPitch,
+                            const unsigned char *ref, size_t refPitch,
+                            int width, int height,
+                            const sdkImageQualityParams &params,
+                            sdkImageQualityResult &result) {
+  sdkImageQualityDetail::imageQuality(img, imgPitch, ref, refPitch, width,
+                                      height, params, result);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! MSE, PSNR, largest error and SSIM of a float image against a reference,
+//! params.peak is the dynamic range, e.g. 1 for images in [0, 1]
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkImageQuality(const float *img, size_t imgPitch,
+                            const float *ref, size_t refPitch, int width,
+                            int height, const sdkImageQualityParams &params,
+                            sdkImageQualityResult &result) {
+  sdkImageQualityDetail::imageQuality(img, imgPitch, ref, refPitch, width,
+                                      height, params, result);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Endpoint error and L1 error of a flow field against a reference, all four
+//! planes share the row pitch (in bytes). Only params.tileSize and
+//! params.numThreads are used.
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkFlowQuality(const float *u, const float *v, const float *uRef,
+                           const float *vRef, size_t pitch, int width,
+                           int height, const sdkImageQualityParams &params,
+                           sdkImageQualityResult &result) {
+  using namespace sdkImageQualityDetail;
+  initTiles(width, height, params, result);
+
+  const int count = (int)result.tiles.size();
+
+  if (count == 0) return;
+
+  parallelFor(count, params.numThreads, [&](int i, int) {
+    sdkImageQualityTile &tile = result.tiles[i];
+    double epe = 0.0, l1 = 0.0, maxEpe = 0.0;
+
+    for (int y = tile.y; y < tile.y + tile.height; y++) {
+      rowFlow(row(u, pitch, y) + tile.x, row(v, pitch, y) + tile.x,
+              row(uRef, pitch, y) + tile.x, row(vRef, pitch, y) + tile.x,
+              tile.width, epe, maxEpe, l1);
+    }
+
+    tile.epe = epe;
+    tile.l1 = l1;
+    tile.maxEpe = maxEpe;
+  });
+
+  double epe = 0.0, l1 = 0.0;
+
+  for (int i = 0; i < count; i++) {
+    sdkImageQualityTile &tile = result.tiles[i];
+    const double n = (double)tile.width * tile.height;
+
+    epe += tile.epe;
+    l1 += tile.l1;
+    tile.epe /= n;
+    tile.l1 /= n;
+    result.maxEpe = (std::max)(result.maxEpe, tile.maxEpe);
+  }
+
+  result.epe = epe / ((double)width * height);
+  result.l1 = l1 / ((double)width * height);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Image quality of a PPM or PGM file against a reference file, the number
+//! of channels is taken from the files
+//! @return false if a file cannot be loaded or the images differ in size
+//////////////////////////////////////////////////////////////////////////////
+inline bool sdkImageQualityPPM(const char *src_file, const char *ref_file,
+                               const sdkImageQualityParams &params,
+                               sdkImageQualityResult &result) {
+  unsigned char *src_data = NULL, *ref_data = NULL;
+  unsigned int src_width, src_height, src_channels;
+  unsigned int ref_width, ref_height, ref_channels;
+  bool ok = src_file && ref_file &&
+            __loadPPM(src_file, &src_data, &src_width, &src_height,
+                      &src_channels) &&
+            __loadPPM(ref_file, &ref_data, &ref_width, &ref_height,
+                      &ref_channels);
+
+  ok = ok && src_width == ref_width && src_height == ref_height &&
+       src_channels == ref_channels;
+
+  if (ok) {
+    sdkImageQualityParams p = params;
+    p.channels = (int)src_channels;
+    sdkImageQuality(src_data, (size_t)src_width * src_channels, ref_data,
+                    (size_t)ref_width * ref_channels, (int)src_width,
+                    (int)src_height, p, result);
+  }
+
+  free(src_data);
+  free(ref_data);
+  return ok;
+}
+
+#endif  // COMMON_HELPER_IMAGE_QUALITY_H_
@@ -0,0 +1,824 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host memory bandwidth and access pattern benchmarks.
+//
+//   sdkMemBenchConfig config;            // defaults: 64 MB arrays, threads
+//   config.jsonFile = "membench.json";   // 1, 2, 4, ... up to all CPUs
+//   sdkMemBenchRun(config);
+//
+// The suite measures
+//   stream   copy c = a, scale b = s c, add c = a + b and triad (saxpy)
+//            a = s b + c, with regular and non-temporal stores
+//   strided  sum of every stride-th element, strides 1 to 1024 floats
+//   random   gather a[idx[i]] with independent random indices
+//   chase    dependent loads through a random cycle of cache lines, for
+//            working sets from 16 KB to the array size (latency)
+//   numa     triad on arrays initialized by the threads that use them
+//            (first touch), by one thread, and interleaved over all nodes
+//   pages    triad and random gather on 4 KB pages, transparent huge pages
+//            and hugetlbfs pages
+//
+// Threads are pinned to the CPUs of the process affinity mask in order.
+// Every measurement reports the best and the median of the repetitions;
+// bandwidths count the bytes read plus the bytes written, as STREAM does.
+// The results are printed as a table and optionally written as JSON.
+//
+// NUMA placement, huge pages and pinning use Linux system calls and are
+// skipped (reported as unavailable) elsewhere.
+
+#ifndef COMMON_HELPER_MEMBENCH_H_
+#define COMMON_HELPER_MEMBENCH_H_
+
+// includes, system
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SDK_MEMBENCH_SSE2 1
+#endif
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+struct sdkMemBenchConfig {
+  size_t bytesPerArray;
+  std::vector<int> threadCounts;  // empty: 1, 2, 4, ... and all CPUs
+  int repetitions;
+  const char *jsonFile;  // NULL: no JSON output
+  bool quiet;            // no table on stdout
+
+  sdkMemBenchConfig()
+      : bytesPerArray((size_t)64 << 20),
+        repetitions(10),
+        jsonFile(NULL),
+        quiet(false) {}
+};
+
+struct sdkMemBenchResult {
+  std::string test;       // copy, scale, add, triad, strided, random, chase
+  std::string variant;    // e.g. "nt" stores, "stride=8", "ws=1MB"
+  std::string placement;  // first_touch, serial, interleave
+  std::string pages;      // 4k, thp, hugetlb
+  int threads;
+  size_t bytes;         // bytes moved per repetition
+  double bestGBps;      // 1e9 bytes/s
+  double medianGBps;
+  double nsPerAccess;   // gathers and chase, 0 otherwise
+};
+
+namespace sdkMemBenchDetail {
+
+enum Pages { PAGES_4K, PAGES_THP, PAGES_HUGETLB };
+enum Placement { FIRST_TOUCH, SERIAL, INTERLEAVE };
+
+static const char *const kPagesName[] = {"4k", "thp", "hugetlb"};
+static const char *const kPlacementName[] = {"first_touch", "serial",
+                                             "interleave"};
+
+const size_t kHugePage = (size_t)2 << 20;
+
+// Range of thread t out of T over n elements, multiples of 16 elements so
+// that non-temporal stores stay aligned to cache lines
+inline void partition(size_t n, int t, int T, size_t *begin, size_t *end) {
+  *begin = (n / 16 * t / T) * 16;
+  *end = (t == T - 1) ? n : (n / 16 * (t + 1) / T) * 16;
+}
+
+inline double now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Memory
+//////////////////////////////////////////////////////////////////////////////
+struct Buffer {
+  void *base;
+  size_t mapped;
+  float *data;
+};
+
+inline bool allocate(Buffer &b, size_t bytes, Pages pages) {
+  b.base = NULL;
+  b.mapped = 0;
+  b.data = NULL;
+  bytes = (bytes + kHugePage - 1) / kHugePage * kHugePage;
+
+#if defined(__linux__)
+  if (pages == PAGES_HUGETLB) {
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    if (p == MAP_FAILED) return false;
+
+    b.base = p;
+    b.mapped = bytes;
+    b.data = (float *)p;
+    return true;
+  }
+
+  // over-allocate to align to a huge page boundary
+  void *p = mmap(NULL, bytes + kHugePage, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (p == MAP_FAILED) return false;
+
+  b.base = p;
+  b.mapped = bytes + kHugePage;
+  b.data = (float *)(((uintptr_t)p + kHugePage - 1) & ~(kHugePage - 1));
+#if defined(MADV_HUGEPAGE)
+  madvise(b.data, bytes, pages == PAGES_THP ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#else
+  if (pages == PAGES_THP) {
+    munmap(p, b.mapped);
+    return false;
+  }
+#endif
+  return true;
+#else
+  if (pages != PAGES_4K) return false;
+
+#if defined(_WIN32)
+  b.base = _aligned_malloc(bytes, kHugePage);
+#else
+  if (posix_memalign(&b.base, kHugePage, bytes) != 0) b.base = NULL;
+#endif
+  b.data = (float *)b.base;
+  return b.base != NULL;
+#endif
+}
+
+inline void release(Buffer &b) {
+  if (!b.base) return;
+
+#if defined(__linux__)
+  munmap(b.base, b.mapped);
+#elif defined(_WIN32)
+  _aligned_free(b.base);
+#else
+  free(b.base);
+#endif
+  b.base = NULL;
+  b.data = NULL;
+}
+
+// Online NUMA nodes as a bit mask, 1 (node 0) if unknown
+inline unsigned long numaNodes() {
+  unsigned long mask = 0;
+#if defined(__linux__)
+  FILE *fp = fopen("/sys/devices/system/node/online", "r");
+
+  if (fp) {
+    int first, last;
+    char sep = ',';
+
+    while (sep == ',' && fscanf(fp, "%d", &first) == 1) {
+      last = first;
+
+      if (fscanf(fp, "%c", &sep) == 1 && sep == '-') {
+        if (fscanf(fp, "%d", &last) != 1) break;
+
+        if (fscanf(fp, "%c", &sep) != 1) sep = 0;
+      }
+
+      for (int n = first; n <= last && n < (int)(8 * sizeof(mask)); n++)
+        mask |= 1UL << n;
+    }
+
+    fclose(fp);
+  }
+#endif
+  return mask ? mask : 1UL;
+}
+
+inline bool interleave(const Buffer &b, size_t bytes) {
+#if defined(__linux__) && defined(SYS_mbind)
+  const int MPOL_INTERLEAVE_ = 3;
+  unsigned long mask = numaNodes();
+
+  return syscall(SYS_mbind, b.data, bytes, MPOL_INTERLEAVE_, &mask,
+                 8 * sizeof(mask), 0) == 0;
+#else
+  (void)b;
+  (void)bytes;
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Threads
+//////////////////////////////////////////////////////////////////////////////
+inline std::vector<int> allowedCpus() {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  cpu_set_t set;
+
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int c = 0; c < CPU_SETSIZE; c++)
+      if (CPU_ISSET(c, &set)) cpus.push_back(c);
+  }
+#endif
+  if (cpus.empty()) {
+    int n = (std::max)(1, (int)std::thread::hardware_concurrency());
+
+    for (int c = 0; c < n; c++) cpus.push_back(c);
+  }
+
+  return cpus;
+}
+
+class Barrier {
+ public:
+  explicit Barrier(int n) : n_(n), count_(0), epoch_(0) {}
+
+  void wait() {
+    unsigned epoch = epoch_.load(std::memory_order_acquire);
+
+    if (count_.fetch_add(1, std::memory_order_acq_rel) == n_ - 1) {
+      count_.store(0, std::memory_order_relaxed);
+      epoch_.fetch_add(1, std::memory_order_release);
+      return;
+    }
+
+    for (int spins = 0; epoch_.load(std::memory_order_acquire) == epoch;)
+      if (++spins > 64) std::this_thread::yield();
+  }
+
+ private:
+  int n_;
+  std::atomic<int> count_;
+  std::atomic<unsigned> epoch_;
+};
+
+// Runs fn(t) on T threads pinned to cpus[t % cpus.size()]; returns false if
+// the threads could not be created
+template <class F>
+inline bool runTeam(int T, const std::vector<int> &cpus, F fn) {
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < T; t++) {
+    try {
+      threads.push_back(std::thread([&, t]() {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[t % cpus.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+        fn(t);
+      }));
+    } catch (const std::system_error &) {
+      // the started threads would wait at the barrier forever
+      fprintf(stderr, "sdkMemBench: failed to create %d threads\n", T);
+      abort();
+    }
+  }
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+  return true;
+}
+
+// Times body(t) over all repetitions on a team of T threads, the threads
+// are synchronized before every repetition
+template <class F>
+inline std::vector<double> timeTeam(int T, const std::vector<int> &cpus,
+                                    int repetitions, F body) {
+  std::vector<double> times(repetitions);
+  Barrier barrier(T);
+
+  runTeam(T, cpus, [&](int t) {
+    // one untimed warm up repetition
+    for (int r = -1; r < repetitions; r++) {
+      double start = 0.0;
+      barrier.wait();
+
+      if (t == 0) start = now();
+
+      body(t);
+      barrier.wait();
+
+      if (t == 0 && r >= 0) times[r] = now() - start;
+    }
+  });
+
+  std::sort(times.begin(), times.end());
+  return times;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Kernels over the range [i0, i1) of one thread
+//////////////////////////////////////////////////////////////////////////////
+inline void copyKernel(float *c, const float *a, size_t i0, size_t i1,
+                       bool nt) {
+#if defined(SDK_MEMBENCH_SSE2)
+  if (nt) {
+    for (size_t i = i0; i < i1; i += 4)
+      _mm_stream_ps(c + i, _mm_load_ps(a + i));
+
+    _mm_sfence();
+    return;
+  }
+#endif
+  (void)nt;
+  for (size_t i = i0; i < i1; i++) c[i] = a[i];
+}
+
+inline void scaleKernel(float *b, const float *c, float s, size_t i0,
+                        size_t i1, bool nt) {
+#if defined(SDK_MEMBENCH_SSE2)
+  if (nt) {
+    __m128 s4 = _mm_set1_ps(s);
+
+    for (size_t i = i0; i < i1; i += 4)
+      _mm_stream_ps(b + i, _mm_mul_ps(s4, _mm_load_ps(c + i)));
+
+    _mm_sfence();
+    return;
+  }
+#endif
+  (void)nt;
+  for (size_t i = i0; i < i1; i++) b[i] = s * c[i];
+}
+
+inline void addKernel(float *c, const float *a, const float *b, size_t i0,
+                      size_t i1, bool nt) {
+#if defined(SDK_MEMBENCH_SSE2)
+  if (nt) {
+    for (size_t i = i0; i < i1; i += 4)
+      _mm_stream_ps(c + i, _mm_add_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+
+    _mm_sfence();
+    return;
+  }
+#endif
+  (void)nt;
+  for (size_t i = i0; i < i1; i++) c[i] = a[i] + b[i];
+}
+
+// a = s * b + c, the saxpy of cudaCompressibleMemory
+inline void triadKernel(float *a, const float *b, const float *c, float s,
+                        size_t i0, size_t i1, bool nt) {
+#if defined(SDK_MEMBENCH_SSE2)
+  if (nt) {
+    __m128 s4 = _mm_set1_ps(s);
+
+    for (size_t i = i0; i < i1; i += 4)
+      _mm_stream_ps(a + i, _mm_add_ps(_mm_mul_ps(s4, _mm_load_ps(b + i)),
+                                      _mm_load_ps(c + i)));
+
+    _mm_sfence();
+    return;
+  }
+#endif
+  (void)nt;
+  for (size_t i = i0; i < i1; i++) a[i] = s * b[i] + c[i];
+}
+
+// four independent sums, so that the loads and not the additions limit
+inline float stridedKernel(const float *a, size_t stride, size_t i0,
+                           size_t i1) {
+  float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+  size_t i = i0;
+
+  for (; i + 3 * stride < i1; i += 4 * stride) {
+    sum0 += a[i];
+    sum1 += a[i + stride];
+    sum2 += a[i + 2 * stride];
+    sum3 += a[i + 3 * stride];
+  }
+
+  for (; i < i1; i += stride) sum0 += a[i];
+
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+inline float gatherKernel(const float *a, const uint32_t *idx, size_t i0,
+                          size_t i1) {
+  float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+  size_t i = i0;
+
+  for (; i + 3 < i1; i += 4) {
+    sum0 += a[idx[i]];
+    sum1 += a[idx[i + 1]];
+    sum2 += a[idx[i + 2]];
+    sum3 += a[idx[i + 3]];
+  }
+
+  for (; i < i1; i++) sum0 += a[idx[i]];
+
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Suite
+//////////////////////////////////////////////////////////////////////////////
+class Suite {
+ public:
+  explicit Suite(const sdkMemBenchConfig &config)
+      : config_(config), cpus_(allowedCpus()), sink_(0.0f) {
+    n_ = (std::max)(config.bytesPerArray / sizeof(float), (size_t)1024) / 16 *
+         16;
+
+    threadCounts_ = config.threadCounts;
+
+    if (threadCounts_.empty()) {
+      int maxThreads = (int)cpus_.size();
+
+      for (int T = 1; T < maxThreads; T *= 2) threadCounts_.push_back(T);
+
+      threadCounts_.push_back(maxThreads);
+    }
+
+    maxThreads_ = *std::max_element(threadCounts_.begin(), threadCounts_.end());
+  }
+
+  void run() {
+    // stream kernels over the thread counts, first touch on 4 KB pages
+    for (size_t i = 0; i < threadCounts_.size(); i++) {
+      streamTests(threadCounts_[i], FIRST_TOUCH, PAGES_4K, true);
+      gatherTests(threadCounts_[i], FIRST_TOUCH, PAGES_4K, true);
+    }
+
+    // placement and pages at the largest thread count
+    streamTests(maxThreads_, SERIAL, PAGES_4K, false);
+    streamTests(maxThreads_, INTERLEAVE, PAGES_4K, false);
+    streamTests(maxThreads_, FIRST_TOUCH, PAGES_THP, false);
+    streamTests(maxThreads_, FIRST_TOUCH, PAGES_HUGETLB, false);
+    gatherTests(maxThreads_, FIRST_TOUCH, PAGES_THP, false);
+    gatherTests(maxThreads_, FIRST_TOUCH, PAGES_HUGETLB, false);
+
+    chaseTests(PAGES_4K);
+    chaseTests(PAGES_THP);
+  }
+
+  const std::vector<sdkMemBenchResult> &results() const { return results_; }
+
+  const std::vector<std::string> &skipped() const { return skipped_; }
+
+  int numCpus() const { return (int)cpus_.size(); }
+
+ private:
+  // Allocates and initializes arrays with the placement, false if the page
+  // size or placement is not available
+  bool prepare(std::vector<Buffer> &buffers, size_t n, int T,
+               Placement placement, Pages pages) {
+    for (size_t k = 0; k < buffers.size(); k++) {
+      if (!allocate(buffers[k], n * sizeof(float), pages) ||
+          (placement == INTERLEAVE &&
+           !interleave(buffers[k], n * sizeof(float)))) {
+        for (size_t j = 0; j <= k; j++) release(buffers[j]);
+
+        return false;
+      }
+    }
+
+    runTeam(placement == FIRST_TOUCH ? T : 1, cpus_, [&](int t) {
+      size_t i0, i1;
+      partition(n, t, placement == FIRST_TOUCH ? T : 1, &i0, &i1);
+
+      for (size_t k = 0; k < buffers.size(); k++)
+        for (size_t i = i0; i < i1; i++)
+          buffers[k].data[i] = 1.0f + (float)(k + (i & 7));
+    });
+
+    return true;
+  }
+
+  void add(const char *test, const std::string &variant, int T,
+           Placement placement, Pages pages, size_t bytes, size_t accesses,
+           const std::vector<double> &times) {
+    sdkMemBenchResult r;
+    r.test = test;
+    r.variant = variant;
+    r.placement = kPlacementName[placement];
+    r.pages = kPagesName[pages];
+    r.threads = T;
+    r.bytes = bytes;
+    r.bestGBps = bytes / times.front() * 1e-9;
+    r.medianGBps = bytes / times[times.size() / 2] * 1e-9;
+    r.nsPerAccess = accesses ? times[times.size() / 2] * 1e9 / accesses : 0.0;
+    results_.push_back(r);
+
+    if (!config_.quiet) {
+      printf("%-7s %-12s %-11s %-7s %3d threads  %9.2f GB/s best  %9.2f GB/s"
+             " median",
+             r.test.c_str(), r.variant.c_str(), r.placement.c_str(),
+             r.pages.c_str(), T, r.bestGBps, r.medianGBps);
+
+      if (accesses) printf("  %8.2f ns/access", r.nsPerAccess);
+
+      printf("\n");
+    }
+  }
+
+  void skip(const char *what, Placement placement, Pages pages) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s %s %s", what, kPlacementName[placement],
+             kPagesName[pages]);
+    skipped_.push_back(buf);
+
+    if (!config_.quiet) printf("%-7s unavailable (%s %s)\n", what,
+                               kPlacementName[placement], kPagesName[pages]);
+  }
+
+  void streamTests(int T, Placement placement, Pages pages, bool all) {
+    std::vector<Buffer> buffers(3);
+
+    if (!prepare(buffers, n_, T, placement, pages)) {
+      skip("stream", placement, pages);
+      return;
+    }
+
+    float *a = buffers[0].data, *b = buffers[1].data, *c = buffers[2].data;
+    const size_t n = n_, bytes = n * sizeof(float);
+    const int reps = config_.repetitions;
+
+    for (int nt = 0; nt < 2; nt++) {
+#if !defined(SDK_MEMBENCH_SSE2)
+      if (nt) break;
+#endif
+      const char *variant = nt ? "nt" : "";
+
+      if (all) {
+        add("copy", variant, T, placement, pages, 2 * bytes, 0,
+            timeTeam(T, cpus_, reps, [&](int t) {
+              size_t i0, i1;
+              partition(n, t, T, &i0, &i1);
+              copyKernel(c, a, i0, i1, nt != 0);
+            }));
+        add("scale", variant, T, placement, pages, 2 * bytes, 0,
+            timeTeam(T, cpus_, reps, [&](int t) {
+              size_t i0, i1;
+              partition(n, t, T, &i0, &i1);
+              scaleKernel(b, c, 3.0f, i0, i1, nt != 0);
+            }));
+        add("add", variant, T, placement, pages, 3 * bytes, 0,
+            timeTeam(T, cpus_, reps, [&](int t) {
+              size_t i0, i1;
+              partition(n, t, T, &i0, &i1);
+              addKernel(c, a, b, i0, i1, nt != 0);
+            }));
+      }
+
+      add("triad", variant, T, placement, pages, 3 * bytes, 0,
+          timeTeam(T, cpus_, reps, [&](int t) {
+            size_t i0, i1;
+            partition(n, t, T, &i0, &i1);
+            triadKernel(a, b, c, 3.0f, i0, i1, nt != 0);
+          }));
+    }
+
+    for (size_t k = 0; k < buffers.size(); k++) release(buffers[k]);
+  }
+
+  void gatherTests(int T, Placement placement, Pages pages, bool strided) {
+    std::vector<Buffer> buffers(2);
+
+    if (!prepare(buffers, n_, T, placement, pages)) {
+      skip("gather", placement, pages);
+      return;
+    }
+
+    const float *a = buffers[0].data;
+    uint32_t *idx = (uint32_t *)buffers[1].data;
+    const size_t n = n_;
+    const int reps = config_.repetitions;
+    std::vector<float> sums(T * 16);
+
+    if (strided) {
+      static const size_t strides[] = {1, 2, 4, 8, 16, 32, 64, 1024};
+
+      for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        const size_t stride = strides[s];
+        // every stride-th element of the whole array
+        const size_t accesses = (n + stride - 1) / stride;
+        char variant[32];
+        snprintf(variant, sizeof(variant), "stride=%zu", stride);
+
+        add("strided", variant, T, placement, pages, accesses * sizeof(float),
+            accesses, timeTeam(T, cpus_, reps, [&](int t) {
+              size_t i0, i1;
+              partition(accesses, t, T, &i0, &i1);
+              sums[t * 16] += stridedKernel(a, stride, i0 * stride,
+                                            (std::min)(i1 * stride, n));
+            }));
+      }
+    }
+
+    // independent random indices, written by the threads that read them
+    runTeam(T, cpus_, [&](int t) {
+      size_t i0, i1;
+      partition(n, t, T, &i0, &i1);
+      uint64_t x = 0x9E3779B97F4A7C15ULL * (t + 1);
+
+      for (size_t i = i0; i < i1; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        idx[i] = (uint32_t)(x % n);
+      }
+    });
+
+    add("random", "", T, placement, pages, n * 2 * sizeof(float), n,
+        timeTeam(T, cpus_, reps, [&](int t) {
+          size_t i0, i1;
+          partition(n, t, T, &i0, &i1);
+          sums[t * 16] += gatherKernel(a, idx, i0, i1);
+        }));
+
+    for (int t = 0; t < T; t++) sink_ += sums[t * 16];
+
+    for (size_t k = 0; k < buffers.size(); k++) release(buffers[k]);
+  }
+
+  void chaseTests(Pages pages) {
+    const size_t line = 64 / sizeof(size_t);
+    const size_t maxBytes = n_ * sizeof(float);
+    Buffer buffer;
+
+    if (!allocate(buffer, maxBytes, pages)) {
+      skip("chase", FIRST_TOUCH, pages);
+      return;
+    }
+
+    size_t *next = (size_t *)buffer.data;
+    std::vector<size_t> order;
+
+    for (size_t bytes = (size_t)16 << 10; bytes <= maxBytes; bytes *= 4) {
+      // random cycle through the cache lines of the working set
+      const size_t lines = bytes / 64;
+      order.resize(lines);
+
+      for (size_t i = 0; i < lines; i++) order[i] = i;
+
+      uint64_t x = 0x2545F4914F6CDD1DULL;
+
+      for (size_t i = lines - 1; i > 0; i--) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        std::swap(order[i], order[x % (i + 1)]);
+      }
+
+      for (size_t i = 0; i < lines; i++)
+        next[order[i] * line] = order[(i + 1) % lines] * line;
+
+      const size_t steps = (std::max)(lines, (size_t)1 << 20);
+      size_t p = 0;
+
+      std::vector<double> times =
+          timeTeam(1, cpus_, (std::max)(config_.repetitions / 2, 1),
+                   [&](int) {
+                     size_t q = p;
+
+                     for (size_t s = 0; s < steps; s++) q = next[q];
+
+                     p = q;
+                   });
+      sink_ += (float)p;
+
+      char variant[32];
+      if (bytes >= ((size_t)1 << 20))
+        snprintf(variant, sizeof(variant), "ws=%zuMB", bytes >> 20);
+      else
+        snprintf(variant, sizeof(variant), "ws=%zuKB", bytes >> 10);
+
+      add("chase", variant, 1, FIRST_TOUCH, pages, steps * 64, steps, times);
+    }
+
+    release(buffer);
+  }
+
+  sdkMemBenchConfig config_;
+  std::vector<int> cpus_;
+  std::vector<int> threadCounts_;
+  int maxThreads_;
+  size_t n_;
+  std::vector<sdkMemBenchResult> results_;
+  std::vector<std::string> skipped_;
+
+  // sums of the gathers, keeps them from being optimized away
+  volatile float sink_;
+};
+
+}  // namespace sdkMemBenchDetail
+
+//////////////////////////////////////////////////////////////////////////////
+//! Writes the machine description and results as JSON
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkMemBenchWriteJSON(FILE *fp, const sdkMemBenchConfig &config,
+                                 int numCpus,
+                                 const std::vector<sdkMemBenchResult> &results,
+                                 const std::vector<std::string> &skipped) {
+  unsigned long nodes = sdkMemBenchDetail::numaNodes();
+  int numNodes = 0;
+
+  for (unsigned long m = nodes; m; m >>= 1) numNodes += (int)(m & 1);
+
+  fprintf(fp, "{\n  \"benchmark\": \"host_memory\",\n");
+  fprintf(fp, "  \"cpus\": %d,\n  \"numa_nodes\": %d,\n", numCpus, numNodes);
+  fprintf(fp, "  \"bytes_per_array\": %zu,\n  \"repetitions\": %d,\n",
+          config.bytesPerArray, config.repetitions);
+  fprintf(fp, "  \"results\": [\n");
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const sdkMemBenchResult &r = results[i];
+    fprintf(fp,
+            "    {\"test\": \"%s\", \"variant\": \"%s\", \"placement\": "
+            "\"%s\", \"pages\": \"%s\", \"threads\": %d, \"bytes\": %zu, "
+            "\"best_gbps\": %.3f, \"median_gbps\": %.3f, "
+            "\"ns_per_access\": %.3f}%s\n",
+            r.test.c_str(), r.variant.c_str(), r.placement.c_str(),
+            r.pages.c_str(), r.threads, r.bytes, r.bestGBps, r.medianGBps,
+            r.nsPerAccess, (i + 1 < results.size()) ? "," : "");
+  }
+
+  fprintf(fp, "  ],\n  \"unavailable\": [");
+
+  for (size_t i = 0; i < skipped.size(); i++)
+    fprintf(fp, "%s\"%s\"", i ? ", " : "", skipped[i].c_str());
+
+  fprintf(fp, "]\n}\n");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Runs the suite, prints the results unless config.quiet and writes them
+//! to config.jsonFile if set
+//! @return the results, empty if the JSON file could not be written
+//////////////////////////////////////////////////////////////////////////////
+inline std::vector<sdkMemBenchResult> sdkMemBenchRun(
+    const sdkMemBenchConfig &config) {
+  sdkMemBenchDetail::Suite suite(config);
+
+  if (!config.quiet) {
+    printf("Host memory benchmark: %zu MB arrays, %d CPUs, %d repetitions\n",
+           config.bytesPerArray >> 20, suite.numCpus(), config.repetitions);
+  }
+
+  suite.run();
+
+  if (config.jsonFile) {
+    FILE *fp = fopen(config.jsonFile, "w");
+
+    if (!fp) {
+      fprintf(stderr, "sdkMemBench: cannot write %s\n", config.jsonFile);
+      return std::vector<sdkMemBenchResult>();
+    }
+
+    sdkMemBenchWriteJSON(fp, config, suite.numCpus(), suite.results(),
+                         suite.skipped());
+    fclose(fp);
+  }
+
+  return suite.results();
+}
+
+#endif  // COMMON_HELPER_MEMBENCH_H_
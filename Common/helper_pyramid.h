@@ -0,0 +1,486 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host image pyramids with a fused separable filter and decimation.
+//
+// One level is computed from the previous one in a single pass: for every
+// output row the vertical filter taps are accumulated over the source rows
+// into a row buffer, which the horizontal filter then samples at every step
+// columns. No full size intermediate image is written. With step 1 this is a
+// plain separable convolution.
+//
+// sdkPyramidSweep() emits all levels of a pyramid in one streaming sweep: a
+// row of a coarser level is computed as soon as the rows it depends on
+// exist, while they are still in cache. The rows are split into bands, one
+// per thread; the few rows next to a band border that depend on rows of
+// another band are computed after the sweep.
+//
+//   sdkPyramid pyramid;
+//   pyramid.buildGaussian(image, width, height, width, 5);
+//   const sdkPyramidLevel &level = pyramid.level(2);
+
+#ifndef COMMON_HELPER_PYRAMID_H_
+#define COMMON_HELPER_PYRAMID_H_
+
+// includes, system
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+enum sdkPyramidBorder {
+  SDK_PYRAMID_BORDER_ZERO,    // samples outside the image are 0
+  SDK_PYRAMID_BORDER_CLAMP,   // nearest edge sample
+  SDK_PYRAMID_BORDER_MIRROR   // symmetric reflection, -1 -> 0, w -> w - 1
+};
+
+struct sdkPyramidLevel {
+  float *data;
+  int width;
+  int height;
+  int stride;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//! Separable filter with decimation,
+//!   out(x) = sum_k taps[k] * in(step * x + k - origin), k = 0 .. length - 1
+//! applied to the rows and to the columns
+//////////////////////////////////////////////////////////////////////////////
+struct sdkPyramidFilter {
+  std::vector<float> taps;
+  int origin;
+  int step;
+  sdkPyramidBorder border;
+
+  sdkPyramidFilter() : origin(0), step(2), border(SDK_PYRAMID_BORDER_MIRROR) {}
+
+  sdkPyramidFilter(const float *t, int length, int o, int s,
+                   sdkPyramidBorder b)
+      : taps(t, t + length), origin(o), step(s), border(b) {}
+
+  //! 5-tap binomial filter (1 4 6 4 1) / 16 of the Burt-Adelson pyramid
+  static sdkPyramidFilter gaussian5() {
+    const float t[5] = {1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16,
+                        1.0f / 16};
+    return sdkPyramidFilter(t, 5, 2, 2, SDK_PYRAMID_BORDER_MIRROR);
+  }
+
+  //! 2x2 box average
+  static sdkPyramidFilter box2() {
+    const float t[2] = {0.5f, 0.5f};
+    return sdkPyramidFilter(t, 2, 0, 2, SDK_PYRAMID_BORDER_MIRROR);
+  }
+
+  int length() const { return (int)taps.size(); }
+
+  //! Source index of tap k for output index x, -1 if it is outside and the
+  //! border is zero
+  int source(int x, int k, int size) const {
+    int i = step * x + k - origin;
+
+    if (i >= 0 && i < size) return i;
+
+    switch (border) {
+      case SDK_PYRAMID_BORDER_ZERO:
+        return -1;
+
+      case SDK_PYRAMID_BORDER_CLAMP:
+        return i < 0 ? 0 : size - 1;
+
+      default:
+        // reflect until inside, for filters longer than the image
+        while (i < 0 || i >= size) i = i < 0 ? -i - 1 : 2 * size - i - 1;
+
+        return i;
+    }
+  }
+
+  //! Source rows [first, last] needed by output row y (border resolved)
+  void sourceRange(int y, int size, int &first, int &last) const {
+    first = size;
+    last = -1;
+
+    for (int k = 0; k < length(); k++) {
+      int i = source(y, k, size);
+
+      if (i >= 0) {
+        first = (std::min)(first, i);
+        last = (std::max)(last, i);
+      }
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//! Row buffer of one thread, holds a vertically filtered row with an apron
+//! for the horizontal filter
+//////////////////////////////////////////////////////////////////////////////
+class sdkPyramidRowBuffer {
+ public:
+  //! Compute row y of dst from src
+  void filterRow(const sdkPyramidFilter &f, const sdkPyramidLevel &src,
+                 const sdkPyramidLevel &dst, int y) {
+    const int w = src.width, n = f.length();
+    const int left = (std::max)(f.origin, 0);
+    const int right = (std::max)(n - 1 - f.origin, 0) + f.step;
+    row_.resize(left + w + right);
+    float *row = &row_[left];
+
+    // vertical taps, accumulated over the source rows
+    bool first = true;
+
+    for (int k = 0; k < n; k++) {
+      int sy = f.source(y, k, src.height);
+
+      if (sy < 0) continue;
+
+      const float *in = src.data + (size_t)sy * src.stride;
+      const float t = f.taps[k];
+
+      if (first) {
+        for (int x = 0; x < w; x++) row[x] = t * in[x];
+      } else {
+        for (int x = 0; x < w; x++) row[x] += t * in[x];
+      }
+
+      first = false;
+    }
+
+    if (first) memset(row, 0, w * sizeof(float));
+
+    // apron, so that the horizontal taps need no border test
+    for (int x = -left; x < 0; x++) row[x] = apron(f, row, w, x);
+
+    for (int x = w; x < w + right; x++) row[x] = apron(f, row, w, x);
+
+    // horizontal taps at every step columns
+    float *out = dst.data + (size_t)y * dst.stride;
+
+    for (int x = 0; x < dst.width; x++) {
+      const float *in = row + f.step * x - f.origin;
+      float sum = 0.0f;
+
+      for (int k = 0; k < n; k++) sum += f.taps[k] * in[k];
+
+      out[x] = sum;
+    }
+  }
+
+  //! Compute row y of the expansion of coarse to the size of dst, which is
+  //! fine - expand(coarse) if subtract is set
+  void expandRow(const sdkPyramidFilter &f, const sdkPyramidLevel &coarse,
+                 const sdkPyramidLevel &dst, int y, bool subtract) {
+    const int n = f.length(), w = coarse.width;
+    row_.resize(w);
+    float *row = &row_[0];
+    std::fill(row_.begin(), row_.end(), 0.0f);
+
+    // the coarse sample i contributes to the fine sample step * i + k - origin
+    // with weight step * taps[k]
+    for (int k = 0; k < n; k++) {
+      int t = y + f.origin - k;
+
+      if (t % f.step != 0) continue;
+
+      int sy = expandSource(f, t / f.step, t, coarse.height);
+
+      if (sy < 0) continue;
+
+      const float *in = coarse.data + (size_t)sy * coarse.stride;
+      const float wk = f.step * f.taps[k];
+
+      for (int x = 0; x < w; x++) row[x] += wk * in[x];
+    }
+
+    float *out = dst.data + (size_t)y * dst.stride;
+
+    for (int x = 0; x < dst.width; x++) {
+      float sum = 0.0f;
+
+      for (int k = 0; k < n; k++) {
+        int t = x + f.origin - k;
+
+        if (t % f.step != 0) continue;
+
+        int sx = expandSource(f, t / f.step, t, w);
+
+        if (sx >= 0) sum += f.step * f.taps[k] * row[sx];
+      }
+
+      out[x] = subtract ? out[x] - sum : sum;
+    }
+  }
+
+ private:
+  std::vector<float> row_;
+
+  static float apron(const sdkPyramidFilter &f, const float *row, int w,
+                     int x) {
+    int i = x;
+
+    if (f.border == SDK_PYRAMID_BORDER_ZERO) return 0.0f;
+
+    if (f.border == SDK_PYRAMID_BORDER_CLAMP) return row[x < 0 ? 0 : w - 1];
+
+    while (i < 0 || i >= w) i = i < 0 ? -i - 1 : 2 * w - i - 1;
+
+    return row[i];
+  }
+
+  // coarse index i of the fine position t = step * i, -1 if it falls
+  // outside and the border is zero
+  static int expandSource(const sdkPyramidFilter &f, int i, int t, int size) {
+    if (t >= 0 && i < size) return i;
+
+    if (f.border == SDK_PYRAMID_BORDER_ZERO) return -1;
+
+    return i < 0 ? 0 : size - 1;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//! Run fn(thread) on numThreads threads, the calling thread is thread 0
+//////////////////////////////////////////////////////////////////////////////
+template <class F>
+inline void sdkPyramidParallel(int numThreads, F fn) {
+  std::vector<std::thread> threads;
+
+  for (int t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(fn, t));
+    } catch (const std::system_error &) {
+      // no thread support, run the remaining bands here
+      for (int u = t; u < numThreads; u++) fn(u);
+
+      break;
+    }
+  }
+
+  fn(0);
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+
+inline int sdkPyramidThreads(int numThreads, int rows) {
+  if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+  // bands of fewer than 32 rows are not worth a thread
+  return (std::max)(1, (std::min)(numThreads, rows / 32));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Compute levels[1 .. nLevels - 1] from levels[0] in one streaming sweep,
+//! level l + 1 is f applied to level l. The caller sets the size, stride and
+//! storage of every level.
+//! @param numThreads  number of row bands, <= 0 selects the number of
+//!                    hardware threads
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkPyramidSweep(const sdkPyramidLevel *levels, int nLevels,
+                            const sdkPyramidFilter &f, int numThreads = 0) {
+  if (nLevels < 2) return;
+
+  const int bands = sdkPyramidThreads(numThreads, levels[1].height);
+
+  // done[l][y] is set once row y of level l exists, level 0 is the input
+  std::vector<std::vector<char> > done(nLevels);
+
+  for (int l = 1; l < nLevels; l++) done[l].assign(levels[l].height, 0);
+
+  sdkPyramidParallel(bands, [&](int band) {
+    sdkPyramidRowBuffer buffer;
+
+    // rows [lo[l], hi[l]) of every level are owned by this band, rows
+    // [lo[l], next[l]) have been computed by it
+    std::vector<int> lo(nLevels), hi(nLevels), next(nLevels);
+    lo[0] = 0;
+    hi[0] = next[0] = levels[0].height;
+
+    for (int l = 1; l < nLevels; l++) {
+      const int h = levels[l].height;
+      lo[l] = (int)((long long)h * band / bands);
+      hi[l] = (int)((long long)h * (band + 1) / bands);
+      next[l] = lo[l];
+    }
+
+    // rows of a band which depend on rows above it are left to the border
+    // pass, the sweep starts at the first row that does not
+    for (int l = 1; l < nLevels; l++) {
+      int first, last;
+
+      while (next[l] < hi[l]) {
+        f.sourceRange(next[l], levels[l - 1].height, first, last);
+
+        if (first >= lo[l - 1]) break;
+
+        next[l]++;
+      }
+
+      lo[l] = next[l];
+    }
+
+    // rounds from the finest to the coarsest level
+    for (;;) {
+      bool progress = false;
+
+      for (int l = 1; l < nLevels; l++) {
+        int first, last;
+
+        while (next[l] < hi[l]) {
+          f.sourceRange(next[l], levels[l - 1].height, first, last);
+
+          if (last >= next[l - 1] || (last >= 0 && first < lo[l - 1])) break;
+
+          buffer.filterRow(f, levels[l - 1], levels[l], next[l]);
+          done[l][next[l]] = 1;
+          next[l]++;
+          progress = true;
+
+          // one row per level and round, a coarser row follows as soon as
+          // its source rows were emitted
+          break;
+        }
+      }
+
+      if (!progress) break;
+    }
+  });
+
+  // rows next to the band borders, level by level
+  for (int l = 1; l < nLevels; l++) {
+    std::vector<int> rows;
+
+    for (int y = 0; y < levels[l].height; y++) {
+      if (!done[l][y]) rows.push_back(y);
+    }
+
+    std::atomic<size_t> next(0);
+    const int threads = (std::min)(bands, (int)rows.size() / 8 + 1);
+
+    sdkPyramidParallel(threads, [&](int) {
+      sdkPyramidRowBuffer buffer;
+      size_t i;
+
+      while ((i = next++) < rows.size()) {
+        buffer.filterRow(f, levels[l - 1], levels[l], rows[i]);
+      }
+    });
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! fine = fine - expand(coarse), the Laplacian of fine when coarse was
+//! reduced from it with f
+//////////////////////////////////////////////////////////////////////////////
+inline void sdkPyramidSubtractExpanded(const sdkPyramidLevel &fine,
+                                       const sdkPyramidLevel &coarse,
+                                       const sdkPyramidFilter &f,
+                                       int numThreads = 0) {
+  const int bands = sdkPyramidThreads(numThreads, fine.height);
+
+  sdkPyramidParallel(bands, [&](int band) {
+    sdkPyramidRowBuffer buffer;
+    int y0 = (int)((long long)fine.height * band / bands);
+    int y1 = (int)((long long)fine.height * (band + 1) / bands);
+
+    for (int y = y0; y < y1; y++) buffer.expandRow(f, coarse, fine, y, true);
+  });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! Pyramid with its own storage, level 0 is the full size image
+//////////////////////////////////////////////////////////////////////////////
+class sdkPyramid {
+ public:
+  explicit sdkPyramid(const sdkPyramidFilter &f = sdkPyramidFilter::gaussian5(),
+                      int numThreads = 0)
+      : filter_(f), numThreads_(numThreads) {}
+
+  //! Gaussian pyramid of nLevels levels, a level is (w + 1) / 2 by
+  //! (h + 1) / 2 for a filter with step 2
+  void buildGaussian(const float *image, int width, int height, int stride,
+                     int nLevels) {
+    allocate(width, height, nLevels);
+
+    for (int y = 0; y < height; y++) {
+      memcpy(levels_[0].data + (size_t)y * levels_[0].stride,
+             image + (size_t)y * stride, width * sizeof(float));
+    }
+
+    sdkPyramidSweep(&levels_[0], (int)levels_.size(), filter_, numThreads_);
+  }
+
+  //! Laplacian pyramid, levels 0 .. nLevels - 2 hold the band pass images
+  //! and the last level the coarsest Gaussian level
+  void buildLaplacian(const float *image, int width, int height, int stride,
+                      int nLevels) {
+    buildGaussian(image, width, height, stride, nLevels);
+
+    for (int l = 0; l + 1 < (int)levels_.size(); l++) {
+      sdkPyramidSubtractExpanded(levels_[l], levels_[l + 1], filter_,
+                                 numThreads_);
+    }
+  }
+
+  int numLevels() const { return (int)levels_.size(); }
+
+  const sdkPyramidLevel &level(int l) const { return levels_[l]; }
+
+ private:
+  sdkPyramidFilter filter_;
+  int numThreads_;
+  std::vector<sdkPyramidLevel> levels_;
+  std::vector<float> storage_;
+
+  void allocate(int width, int height, int nLevels) {
+    levels_.resize(nLevels);
+    size_t total = 0;
+
+    for (int l = 0; l < nLevels; l++) {
+      levels_[l].width = width;
+      levels_[l].height = height;
+      // rows start on 64 byte boundaries relative to the storage
+      levels_[l].stride = (width + 15) & ~15;
+      total += (size_t)levels_[l].stride * height;
+      width = (std::max)(1, (width + filter_.step - 1) / filter_.step);
+      height = (std::max)(1, (height + filter_.step - 1) / filter_.step);
+    }
+
+    storage_.resize(total);
+    total = 0;
+
+    for (int l = 0; l < nLevels; l++) {
+      levels_[l].data = &storage_[total];
+      total += (size_t)levels_[l].stride * levels_[l].height;
+    }
+  }
+};
+
+#endif  // COMMON_HELPER_PYRAMID_H_
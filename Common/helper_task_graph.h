@@ -0,0 +1,338 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host task graphs, the CPU counterpart of CUDA Graphs for iterative solvers.
+//
+//   sdkTaskGraph        records a sequence of nodes once:
+//                         addLoop    parallel loop func(begin, end, args)
+//                         addReduce  parallel loop returning a partial sum,
+//                                    the sum of all partials is stored to
+//                                    *result
+//                         addHost    func(args) on a single thread
+//   sdkTaskGraphExec    instantiates a graph into a fixed schedule: the range
+//                       of every loop is split into one static chunk per
+//                       thread when the graph is instantiated, and the worker
+//                       threads are created once and wait between launches.
+//     launch()          replays all nodes in order, with a barrier after
+//                       every node
+//     setNodeArgs()     changes the arguments of one node, like
+//                       cudaGraphExecKernelNodeSetParams()
+//     update()          takes the functions and arguments of a graph with
+//                       the same nodes and loop counts, like
+//                       cudaGraphExecUpdate()
+//
+// A launch costs one wake up and one barrier per node instead of creating
+// and joining threads for every loop, which dominates the run time of
+// solvers for small systems. Partial sums are added in thread order, so
+// the results of a reduction do not depend on timing.
+
+#ifndef COMMON_HELPER_TASK_GRAPH_H_
+#define COMMON_HELPER_TASK_GRAPH_H_
+
+// includes, system
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+typedef void (*sdkTaskLoopFunc)(int begin, int end, void *args);
+typedef double (*sdkTaskReduceFunc)(int begin, int end, void *args);
+typedef void (*sdkTaskHostFunc)(void *args);
+
+enum sdkTaskNodeType {
+  SDK_TASK_NODE_LOOP,
+  SDK_TASK_NODE_REDUCE,
+  SDK_TASK_NODE_HOST
+};
+
+struct sdkTaskNode {
+  sdkTaskNodeType type;
+  int count;
+  sdkTaskLoopFunc loop;
+  sdkTaskReduceFunc reduce;
+  sdkTaskHostFunc host;
+  void *args;
+  double *result;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//! Sequence of nodes executed in the order they were added
+//////////////////////////////////////////////////////////////////////////////
+class sdkTaskGraph {
+ public:
+  //! func is called for disjoint subranges of [0, count), returns the index
+  //! of the node
+  int addLoop(int count, sdkTaskLoopFunc func, void *args) {
+    sdkTaskNode node = {SDK_TASK_NODE_LOOP, count, func, NULL, NULL, args,
+                        NULL};
+    nodes_.push_back(node);
+    return (int)nodes_.size() - 1;
+  }
+
+  //! *result = sum of func over disjoint subranges of [0, count)
+  int addReduce(int count, sdkTaskReduceFunc func, void *args,
+                double *result) {
+    sdkTaskNode node = {SDK_TASK_NODE_REDUCE, count, NULL, func, NULL, args,
+                        result};
+    nodes_.push_back(node);
+    return (int)nodes_.size() - 1;
+  }
+
+  int addHost(sdkTaskHostFunc func, void *args) {
+    sdkTaskNode node = {SDK_TASK_NODE_HOST, 1, NULL, NULL, func, args, NULL};
+    nodes_.push_back(node);
+    return (int)nodes_.size() - 1;
+  }
+
+  void clear() { nodes_.clear(); }
+
+  int numNodes() const { return (int)nodes_.size(); }
+
+  const sdkTaskNode &node(int i) const { return nodes_[i]; }
+
+ private:
+  std::vector<sdkTaskNode> nodes_;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//! Instantiated graph, owns the worker threads
+//////////////////////////////////////////////////////////////////////////////
+class sdkTaskGraphExec {
+ public:
+  sdkTaskGraphExec() : numThreads_(0), launchEpoch_(0), stop_(false) {}
+
+  ~sdkTaskGraphExec() { destroy(); }
+
+  //! numThreads <= 0 selects the number of hardware threads, which are
+  //! limited to the largest loop count of the graph
+  void instantiate(const sdkTaskGraph &graph, int numThreads = 0) {
+    destroy();
+
+    int maxCount = 1;
+
+    for (int i = 0; i < graph.numNodes(); i++)
+      maxCount = (std::max)(maxCount, graph.node(i).count);
+
+    if (numThreads <= 0)
+      numThreads = (std::max)(1, (int)std::thread::hardware_concurrency());
+
+    numThreads_ = (std::min)(numThreads, maxCount);
+    nodes_.resize(graph.numNodes());
+
+    for (int i = 0; i < graph.numNodes(); i++) nodes_[i] = graph.node(i);
+
+    partials_.assign(numThreads_ * kPad, 0.0);
+    barrierCount_ = 0;
+    barrierEpoch_ = 0;
+    launchEpoch_ = 0;
+    stop_ = false;
+
+    for (int t = 1; t < numThreads_; t++) {
+      try {
+        workers_.push_back(std::thread(&sdkTaskGraphExec::workerLoop, this, t));
+      } catch (const std::system_error &) {
+        // no thread support, the loops are split over fewer threads
+        break;
+      }
+    }
+
+    numThreads_ = (int)workers_.size() + 1;
+  }
+
+  //! Runs all nodes once on the calling thread and the workers
+  void launch() {
+    if (numThreads_ > 1) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        launchEpoch_.fetch_add(1, std::memory_order_release);
+      }
+      wake_.notify_all();
+    }
+
+    run(0);
+  }
+
+  //! New arguments (and result of a reduction) of an instantiated node,
+  //! must not be called during a launch
+  bool setNodeArgs(int node, void *args, double *result = NULL) {
+    if (node < 0 || node >= (int)nodes_.size()) return false;
+
+    nodes_[node].args = args;
+
+    if (nodes_[node].type == SDK_TASK_NODE_REDUCE && result)
+      nodes_[node].result = result;
+
+    return true;
+  }
+
+  //! Takes the functions and arguments of graph if it has the same node
+  //! types and loop counts as the instantiated graph, returns false and
+  //! leaves the schedule unchanged otherwise
+  bool update(const sdkTaskGraph &graph) {
+    if (graph.numNodes() != (int)nodes_.size()) return false;
+
+    for (int i = 0; i < graph.numNodes(); i++)
+      if (graph.node(i).type != nodes_[i].type ||
+          graph.node(i).count != nodes_[i].count)
+        return false;
+
+    for (int i = 0; i < graph.numNodes(); i++) nodes_[i] = graph.node(i);
+
+    return true;
+  }
+
+  int numThreads() const { return numThreads_; }
+
+  void destroy() {
+    if (!workers_.empty()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        launchEpoch_.fetch_add(1, std::memory_order_release);
+      }
+      wake_.notify_all();
+
+      for (size_t t = 0; t < workers_.size(); t++) workers_[t].join();
+
+      workers_.clear();
+    }
+
+    nodes_.clear();
+    numThreads_ = 0;
+  }
+
+ private:
+  // partial sums one cache line apart
+  static const int kPad = 8;
+
+  // spins before a waiting thread yields, and before a worker sleeps
+  // between launches
+  static const int kSpins = 64;
+  static const int kIdleYields = 4096;
+
+  sdkTaskGraphExec(const sdkTaskGraphExec &);
+  sdkTaskGraphExec &operator=(const sdkTaskGraphExec &);
+
+  void workerLoop(int t) {
+    unsigned seen = 0;
+
+    for (;;) {
+      // poll for the next launch for a while, then sleep
+      int polls = 0;
+
+      while (launchEpoch_.load(std::memory_order_acquire) == seen &&
+             polls < kIdleYields) {
+        if (++polls > kSpins) std::this_thread::yield();
+      }
+
+      if (launchEpoch_.load(std::memory_order_acquire) == seen) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&]() {
+          return launchEpoch_.load(std::memory_order_acquire) != seen;
+        });
+      }
+
+      seen = launchEpoch_.load(std::memory_order_acquire);
+
+      if (stop_) return;
+
+      run(t);
+    }
+  }
+
+  void barrier() {
+    if (numThreads_ == 1) return;
+
+    unsigned epoch = barrierEpoch_.load(std::memory_order_acquire);
+
+    if (barrierCount_.fetch_add(1, std::memory_order_acq_rel) ==
+        numThreads_ - 1) {
+      barrierCount_.store(0, std::memory_order_relaxed);
+      barrierEpoch_.fetch_add(1, std::memory_order_release);
+      return;
+    }
+
+    for (int spins = 0;
+         barrierEpoch_.load(std::memory_order_acquire) == epoch;) {
+      if (++spins > kSpins) std::this_thread::yield();
+    }
+  }
+
+  void run(int t) {
+    for (size_t i = 0; i < nodes_.size(); i++) {
+      const sdkTaskNode &node = nodes_[i];
+      const int begin = (int)((long long)node.count * t / numThreads_);
+      const int end = (int)((long long)node.count * (t + 1) / numThreads_);
+
+      switch (node.type) {
+        case SDK_TASK_NODE_LOOP:
+          if (begin < end) node.loop(begin, end, node.args);
+
+          break;
+
+        case SDK_TASK_NODE_REDUCE:
+          partials_[t * kPad] =
+              (begin < end) ? node.reduce(begin, end, node.args) : 0.0;
+          barrier();
+
+          if (t == 0) {
+            double sum = 0.0;
+
+            for (int k = 0; k < numThreads_; k++) sum += partials_[k * kPad];
+
+            *node.result = sum;
+          }
+
+          break;
+
+        case SDK_TASK_NODE_HOST:
+          if (t == 0) node.host(node.args);
+
+          break;
+      }
+
+      barrier();
+    }
+  }
+
+  int numThreads_;
+  std::vector<sdkTaskNode> nodes_;
+  std::vector<double> partials_;
+  std::vector<std::thread> workers_;
+
+  std::atomic<unsigned> launchEpoch_;
+  std::atomic<int> barrierCount_;
+  std::atomic<unsigned> barrierEpoch_;
+  bool stop_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+};
+
+#endif  // COMMON_HELPER_TASK_GRAPH_H_
@@ -0,0 +1,376 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Host matrix and image transposition.
+//
+//   sdkTranspose(dst, dstStride, src, srcStride, rows, cols)
+//       out-of-place, dst is cols x rows
+//   sdkTransposeInPlace(data, rows, cols)
+//       square matrices by swapping tiles, rectangular (contiguous) ones by
+//       following the permutation cycles
+//
+// Large matrices are split recursively along their longer side until a block
+// fits into the L1 cache (cache-oblivious). A block is transposed by register
+// kernels: 16x16 for 8-bit, 8x8 for 16-bit, 32-bit and 64-bit elements, using
+// SSE2 on x86 and a scalar loop the compiler unrolls elsewhere. The top level
+// tiles are distributed over threads.
+//
+// Strides are in elements. Any trivially copyable type can be transposed,
+// types of other sizes than 1, 2, 4 and 8 bytes use the scalar kernel.
+
+#ifndef COMMON_HELPER_TRANSPOSE_H_
+#define COMMON_HELPER_TRANSPOSE_H_
+
+// includes, system
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SDK_TRANSPOSE_SSE2 1
+#endif
+
+namespace sdkTransposeDetail {
+
+// side of the blocks transposed without further recursion, in elements
+const int kBlock = 64;
+
+// side of the tiles handed to the threads
+const int kTile = 256;
+
+template <size_t S>
+struct Kernel {
+  // register kernel side, 0 if there is none for this element size
+  static const int N = 0;
+  static void run(const char *, size_t, char *, size_t) {}
+};
+
+#if defined(SDK_TRANSPOSE_SSE2)
+
+// One round of the butterfly: out[2i], out[2i + 1] interleave in[i] and
+// in[i + n / 2]. log2(n) rounds transpose an n x n block of n-lane registers.
+#define SDK_TRANSPOSE_ROUND(unpack, n, in, out)           \
+  for (int i = 0; i < (n) / 2; i++) {                     \
+    out[2 * i] = _mm_unpacklo_##unpack(in[i], in[i + (n) / 2]); \
+    out[2 * i + 1] = _mm_unpackhi_##unpack(in[i], in[i + (n) / 2]); \
+  }
+
+inline void loadRows(__m128i *r, int n, const char *src, size_t srcPitch) {
+  for (int i = 0; i < n; i++) {
+    r[i] = _mm_loadu_si128((const __m128i *)(src + i * srcPitch));
+  }
+}
+
+inline void storeRows(const __m128i *r, int n, char *dst, size_t dstPitch) {
+  for (int i = 0; i < n; i++) {
+    _mm_storeu_si128((__m128i *)(dst + i * dstPitch), r[i]);
+  }
+}
+
+template <>
+struct Kernel<1> {
+  static const int N = 16;
+  static void run(const char *src, size_t srcPitch, char *dst,
+                  size_t dstPitch) {
+    __m128i a[16], b[16];
+    loadRows(a, 16, src, srcPitch);
+    SDK_TRANSPOSE_ROUND(epi8, 16, a, b)
+    SDK_TRANSPOSE_ROUND(epi8, 16, b, a)
+    SDK_TRANSPOSE_ROUND(epi8, 16, a, b)
+    SDK_TRANSPOSE_ROUND(epi8, 16, b, a)
+    storeRows(a, 16, dst, dstPitch);
+  }
+};
+
+template <>
+struct Kernel<2> {
+  static const int N = 8;
+  static void run(const char *src, size_t srcPitch, char *dst,
+                  size_t dstPitch) {
+    __m128i a[8], b[8];
+    loadRows(a, 8, src, srcPitch);
+    SDK_TRANSPOSE_ROUND(epi16, 8, a, b)
+    SDK_TRANSPOSE_ROUND(epi16, 8, b, a)
+    SDK_TRANSPOSE_ROUND(epi16, 8, a, b)
+    storeRows(b, 8, dst, dstPitch);
+  }
+};
+
+// 8x8 as four 4x4 register blocks, the off-diagonal blocks swap places
+template <>
+struct Kernel<4> {
+  static const int N = 8;
+  static void run(const char *src, size_t srcPitch, char *dst,
+                  size_t dstPitch) {
+    for (int bi = 0; bi < 2; bi++) {
+      for (int bj = 0; bj < 2; bj++) {
+        __m128i a[4], b[4];
+        loadRows(a, 4, src + 4 * bi * srcPitch + 16 * bj, srcPitch);
+        SDK_TRANSPOSE_ROUND(epi32, 4, a, b)
+        SDK_TRANSPOSE_ROUND(epi32, 4, b, a)
+        storeRows(a, 4, dst + 4 * bj * dstPitch + 16 * bi, dstPitch);
+      }
+    }
+  }
+};
+
+// 8x8 as sixteen 2x2 register blocks
+template <>
+struct Kernel<8> {
+  static const int N = 8;
+  static void run(const char *src, size_t srcPitch, char *dst,
+                  size_t dstPitch) {
+    for (int bi = 0; bi < 4; bi++) {
+      for (int bj = 0; bj < 4; bj++) {
+        const char *s = src + 2 * bi * srcPitch + 16 * bj;
+        char *d = dst + 2 * bj * dstPitch + 16 * bi;
+        __m128i r0 = _mm_loadu_si128((const __m128i *)s);
+        __m128i r1 = _mm_loadu_si128((const __m128i *)(s + srcPitch));
+        _mm_storeu_si128((__m128i *)d, _mm_unpacklo_epi64(r0, r1));
+        _mm_storeu_si128((__m128i *)(d + dstPitch),
+                         _mm_unpackhi_epi64(r0, r1));
+      }
+    }
+  }
+};
+
+#undef SDK_TRANSPOSE_ROUND
+
+#else
+
+// fixed size blocks, unrolled and vectorized by the compiler
+template <size_t S, int Side>
+struct ScalarKernel {
+  static const int N = Side;
+  static void run(const char *src, size_t srcPitch, char *dst,
+                  size_t dstPitch) {
+    for (int i = 0; i < Side; i++) {
+      for (int j = 0; j < Side; j++) {
+        memcpy(dst + j * dstPitch + i * S, src + i * srcPitch + j * S, S);
+      }
+    }
+  }
+};
+
+template <>
+struct Kernel<1> : ScalarKernel<1, 16> {};
+template <>
+struct Kernel<2> : ScalarKernel<2, 8> {};
+template <>
+struct Kernel<4> : ScalarKernel<4, 8> {};
+template <>
+struct Kernel<8> : ScalarKernel<8, 8> {};
+
+#endif
+
+// Block of at most kBlock x kBlock elements
+template <class T>
+inline void transposeBlock(T *dst, size_t dstStride, const T *src,
+                           size_t srcStride, int rows, int cols) {
+  typedef Kernel<sizeof(T)> K;
+  int r = 0, c = 0;
+
+  if (K::N > 0) {
+    const int rowsN = rows / K::N * K::N, colsN = cols / K::N * K::N;
+
+    for (r = 0; r < rowsN; r += K::N) {
+      for (c = 0; c < colsN; c += K::N) {
+        K::run((const char *)(src + r * srcStride + c),
+               srcStride * sizeof(T), (char *)(dst + c * dstStride + r),
+               dstStride * sizeof(T));
+      }
+    }
+
+    // right edge of the full rows
+    for (int i = 0; i < rowsN; i++) {
+      for (int j = colsN; j < cols; j++) {
+        dst[j * dstStride + i] = src[i * srcStride + j];
+      }
+    }
+
+    r = rowsN;
+  }
+
+  // bottom edge, or everything without a register kernel
+  for (int i = r; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      dst[j * dstStride + i] = src[i * srcStride + j];
+    }
+  }
+}
+
+// Cache-oblivious recursion, halves the longer side
+template <class T>
+inline void transposeRecursive(T *dst, size_t dstStride, const T *src,
+                               size_t srcStride, int rows, int cols) {
+  if (rows <= kBlock && cols <= kBlock) {
+    transposeBlock(dst, dstStride, src, srcStride, rows, cols);
+  } else if (rows >= cols) {
+    // split on a multiple of the block size, the kernels stay aligned
+    int half = (rows / 2 + kBlock - 1) / kBlock * kBlock;
+    transposeRecursive(dst, dstStride, src, srcStride, half, cols);
+    transposeRecursive(dst + half, dstStride, src + half * srcStride,
+                       srcStride, rows - half, cols);
+  } else {
+    int half = (cols / 2 + kBlock - 1) / kBlock * kBlock;
+    transposeRecursive(dst, dstStride, src, srcStride, rows, half);
+    transposeRecursive(dst + half * dstStride, dstStride, src + half,
+                       srcStride, rows, cols - half);
+  }
+}
+
+// Run fn(index) for index in [0, count) on up to numThreads threads
+template <class F>
+inline void parallelFor(int count, int numThreads, F fn) {
+  if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+  numThreads = (std::max)(1, (std::min)(numThreads, count));
+
+  std::atomic<int> next(0);
+  auto worker = [&]() {
+    int i;
+
+    while ((i = next++) < count) fn(i);
+  };
+
+  std::vector<std::thread> threads;
+
+  for (int t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker));
+    } catch (const std::system_error &) {
+      // no thread support, the calling thread does all the work
+      break;
+    }
+  }
+
+  worker();
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+
+}  // namespace sdkTransposeDetail
+
+//////////////////////////////////////////////////////////////////////////////
+//! Out-of-place transpose, dst(j, i) = src(i, j)
+//! @param dst         cols x rows matrix
+//! @param dstStride   row stride of dst in elements, at least rows
+//! @param src         rows x cols matrix
+//! @param srcStride   row stride of src in elements, at least cols
+//! @param numThreads  <= 0 selects the number of hardware threads
+//////////////////////////////////////////////////////////////////////////////
+template <class T>
+inline void sdkTranspose(T *dst, size_t dstStride, const T *src,
+                         size_t srcStride, int rows, int cols,
+                         int numThreads = 0) {
+  using namespace sdkTransposeDetail;
+  const int tilesY = (rows + kTile - 1) / kTile;
+  const int tilesX = (cols + kTile - 1) / kTile;
+
+  parallelFor(tilesY * tilesX, numThreads, [&](int tile) {
+    const int r = tile / tilesX * kTile, c = tile % tilesX * kTile;
+    transposeRecursive(dst + c * dstStride + r, dstStride,
+                       src + r * srcStride + c, srcStride,
+                       (std::min)(kTile, rows - r), (std::min)(kTile, cols - c));
+  });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//! In-place transpose of a rows x cols matrix stored contiguously (stride
+//! cols), it is a cols x rows matrix (stride rows) afterwards. Square
+//! matrices swap blocks through a per thread buffer and are threaded,
+//! rectangular ones follow the cycles of the permutation on one thread with
+//! one bit of extra storage per element.
+//////////////////////////////////////////////////////////////////////////////
+template <class T>
+inline void sdkTransposeInPlace(T *data, int rows, int cols,
+                                int numThreads = 0) {
+  using namespace sdkTransposeDetail;
+
+  if (rows == cols) {
+    // pairs (i, j), i <= j, of blocks of the upper triangle
+    const int n = rows, blocks = (n + kBlock - 1) / kBlock;
+    std::vector<int> pairs;
+
+    for (int i = 0; i < blocks; i++) {
+      for (int j = i; j < blocks; j++) pairs.push_back(i * blocks + j);
+    }
+
+    parallelFor((int)pairs.size(), numThreads, [&](int p) {
+      T tmp[kBlock * kBlock];
+      const int bi = pairs[p] / blocks, bj = pairs[p] % blocks;
+      const int r = bi * kBlock, c = bj * kBlock;
+      const int h = (std::min)(kBlock, n - r), w = (std::min)(kBlock, n - c);
+
+      // tmp = transpose(A(r, c)), A(r, c) = transpose(A(c, r)),
+      // A(c, r) = tmp
+      transposeBlock(tmp, kBlock, data + (size_t)r * n + c, n, h, w);
+
+      if (bi != bj) {
+        transposeBlock(data + (size_t)r * n + c, n, data + (size_t)c * n + r,
+                       n, w, h);
+      }
+
+      for (int i = 0; i < w; i++) {
+        memcpy(data + (size_t)(c + i) * n + r, tmp + i * kBlock,
+               h * sizeof(T));
+      }
+    });
+
+    return;
+  }
+
+  // the element at p moves to p * rows mod (N - 1), 0 and N - 1 stay
+  const size_t count = (size_t)rows * cols;
+
+  if (count < 3) return;
+
+  std::vector<bool> moved(count, false);
+  const size_t m = count - 1;
+
+  for (size_t start = 1; start < m; start++) {
+    if (moved[start]) continue;
+
+    T carry = data[start];
+    size_t p = start;
+
+    do {
+      p = (size_t)(((unsigned long long)p * rows) % m);
+      std::swap(carry, data[p]);
+      moved[p] = true;
+    } while (p != start);
+  }
+}
+
+#endif  // COMMON_HELPER_TRANSPOSE_H_
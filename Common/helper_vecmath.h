@@ -0,0 +1,460 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Vectorized transcendental functions for the CPU reference (gold) code.
+//
+// Every function processes an array, y[i] = f(x[i]) for 0 <= i < n, and
+// may be called in place (y == x). The implementation is chosen at run time
+// from the instruction sets of the CPU: AVX-512F, AVX2 with FMA, or a
+// portable scalar version. The vector versions share one set of kernels
+// (helper_vecmath_impl.h); the scalar version runs the same kernels with
+// exp and log from the C library.
+//
+// Error bounds of the vector versions, measured against long double
+// references over 10^7 random arguments:
+//   sdkVecExp     x in [-708, 709]   <= 1 ulp
+//                 (subnormal results below 2^-1022 may lose 1 more ulp)
+//   sdkVecLog     x > 0              <= 1 ulp
+//   sdkVecExpf    x in [-87, 88]     <= 1 ulp
+//   sdkVecRsqrt   x > 0              < 1.5 ulp, sqrt and division rounded
+//   sdkVecCND     |x| <= 10          < 40 ulp of the polynomial model of
+//                 CND() in the samples. The rounding of -x*x/2 dominates,
+//                 as in the scalar CND(), and grows with x*x. The model
+//                 itself has an absolute error below 7.5e-8.
+//   sdkVecInvCND  p in (0, 1)        < 26 ulp of Moro's approximation, as
+//                 the scalar version in double; the denominator of its
+//                 rational part cancels near |p - 0.5| = 0.42. The
+//                 approximation itself has an absolute error below 3e-9.
+// Special values follow the C library: exp(+-inf) = inf/0, log(0) = -inf,
+// log(x < 0) = NaN, and NaN is propagated by all functions.
+//
+// The code is for host compilers only. CUDA_SAMPLES_VECMATH=scalar|avx2
+// limits the instruction set, e.g. to compare the versions.
+
+#ifndef COMMON_HELPER_VECMATH_H_
+#define COMMON_HELPER_VECMATH_H_
+
+// includes, system
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(SDK_VECMATH_NO_SIMD)
+#define SDK_VECMATH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Instruction sets, in increasing order
+enum sdkVecISA {
+  SDK_VEC_ISA_SCALAR = 0,
+  SDK_VEC_ISA_AVX2 = 1,
+  SDK_VEC_ISA_AVX512 = 2
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Portable version, exp and log from the C library
+////////////////////////////////////////////////////////////////////////////////
+namespace sdkVecScalar {
+
+typedef double vd;
+typedef bool vdm;
+typedef float vf;
+typedef bool vfm;
+
+const int kLanesD = 1;
+const int kLanesF = 1;
+
+inline vd vdLoad(const double *p) { return *p; }
+inline void vdStore(double *p, vd a) { *p = a; }
+inline vd vdSet(double a) { return a; }
+inline vd vdAdd(vd a, vd b) { return a + b; }
+inline vd vdSub(vd a, vd b) { return a - b; }
+inline vd vdMul(vd a, vd b) { return a * b; }
+inline vd vdDiv(vd a, vd b) { return a / b; }
+inline vd vdFma(vd a, vd b, vd c) { return a * b + c; }
+inline vd vdMin(vd a, vd b) { return a < b ? a : b; }
+inline vd vdMax(vd a, vd b) { return a > b ? a : b; }
+inline vd vdAbs(vd a) { return fabs(a); }
+inline vd vdSqrt(vd a) { return sqrt(a); }
+inline vdm vdLt(vd a, vd b) { return a < b; }
+inline vdm vdGt(vd a, vd b) { return a > b; }
+inline vdm vdEq(vd a, vd b) { return a == b; }
+inline vdm vdIsNan(vd a) { return a != a; }
+inline vd vdSelect(vdm m, vd a, vd b) { return m ? a : b; }
+inline bool vdAll(vdm m) { return m; }
+
+inline vf vfLoad(const float *p) { return *p; }
+inline void vfStore(float *p, vf a) { *p = a; }
+inline vf vfSet(float a) { return a; }
+inline vf vfSub(vf a, vf b) { return a - b; }
+inline vf vfMul(vf a, vf b) { return a * b; }
+inline vf vfFma(vf a, vf b, vf c) { return a * b + c; }
+inline vf vfMin(vf a, vf b) { return a < b ? a : b; }
+inline vf vfMax(vf a, vf b) { return a > b ? a : b; }
+inline vfm vfLt(vf a, vf b) { return a < b; }
+inline vfm vfGt(vf a, vf b) { return a > b; }
+inline vfm vfIsNan(vf a) { return a != a; }
+inline vf vfSelect(vfm m, vf a, vf b) { return m ? a : b; }
+
+#define SDK_VECMATH_LIBM 1
+#include "helper_vecmath_impl.h"
+#undef SDK_VECMATH_LIBM
+
+}  // namespace sdkVecScalar
+
+#if defined(SDK_VECMATH_X86)
+
+// GCC and clang compile the vector versions for their instruction set
+// without changing the flags of the including file
+#define SDK_VECMATH_PRAGMA(...) _Pragma(#__VA_ARGS__)
+#if defined(__clang__)
+#define SDK_VECMATH_TARGET_BEGIN(isa)                                      \
+  SDK_VECMATH_PRAGMA(clang attribute push(__attribute__((target(isa))), \
+                                          apply_to = function))
+#define SDK_VECMATH_TARGET_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define SDK_VECMATH_TARGET_BEGIN(isa) \
+  _Pragma("GCC push_options") SDK_VECMATH_PRAGMA(GCC target(isa))
+#define SDK_VECMATH_TARGET_END _Pragma("GCC pop_options")
+#else
+#define SDK_VECMATH_TARGET_BEGIN(isa)
+#define SDK_VECMATH_TARGET_END
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2 + FMA version, 4 doubles or 8 floats
+////////////////////////////////////////////////////////////////////////////////
+SDK_VECMATH_TARGET_BEGIN("avx2,fma")
+
+namespace sdkVecAVX2 {
+
+typedef __m256d vd;
+typedef __m256d vdm;
+typedef __m256 vf;
+typedef __m256 vfm;
+
+const int kLanesD = 4;
+const int kLanesF = 8;
+
+inline vd vdLoad(const double *p) { return _mm256_loadu_pd(p); }
+inline void vdStore(double *p, vd a) { _mm256_storeu_pd(p, a); }
+inline vd vdSet(double a) { return _mm256_set1_pd(a); }
+inline vd vdAdd(vd a, vd b) { return _mm256_add_pd(a, b); }
+inline vd vdSub(vd a, vd b) { return _mm256_sub_pd(a, b); }
+inline vd vdMul(vd a, vd b) { return _mm256_mul_pd(a, b); }
+inline vd vdDiv(vd a, vd b) { return _mm256_div_pd(a, b); }
+inline vd vdFma(vd a, vd b, vd c) { return _mm256_fmadd_pd(a, b, c); }
+inline vd vdMin(vd a, vd b) { return _mm256_min_pd(a, b); }
+inline vd vdMax(vd a, vd b) { return _mm256_max_pd(a, b); }
+inline vd vdAbs(vd a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+inline vd vdSqrt(vd a) { return _mm256_sqrt_pd(a); }
+inline vd vdRound(vd a) {
+  return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+inline vdm vdLt(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+inline vdm vdGt(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+inline vdm vdEq(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+inline vdm vdIsNan(vd a) { return _mm256_cmp_pd(a, a, _CMP_UNORD_Q); }
+inline vd vdSelect(vdm m, vd a, vd b) { return _mm256_blendv_pd(b, a, m); }
+inline bool vdAll(vdm m) { return _mm256_movemask_pd(m) == 0xf; }
+
+// k + 2^52 + 1023 holds the biased exponent of 2^k in its low bits
+inline vd vdPow2i(vd k) {
+  vd t = _mm256_add_pd(k, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+  return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(t), 52));
+}
+
+inline vd vdGetExp(vd a) {
+  __m256i e = _mm256_srli_epi64(_mm256_castpd_si256(a), 52);
+  vd t = _mm256_castsi256_pd(
+      _mm256_or_si256(e, _mm256_set1_epi64x(0x4330000000000000LL)));
+  return _mm256_sub_pd(t, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+}
+
+inline vd vdGetMant(vd a) {
+  __m256i m = _mm256_and_si256(_mm256_castpd_si256(a),
+                               _mm256_set1_epi64x(0x000fffffffffffffLL));
+  return _mm256_castsi256_pd(
+      _mm256_or_si256(m, _mm256_set1_epi64x(0x3ff0000000000000LL)));
+}
+
+inline vf vfLoad(const float *p) { return _mm256_loadu_ps(p); }
+inline void vfStore(float *p, vf a) { _mm256_storeu_ps(p, a); }
+inline vf vfSet(float a) { return _mm256_set1_ps(a); }
+inline vf vfSub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+inline vf vfMul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+inline vf vfFma(vf a, vf b, vf c) { return _mm256_fmadd_ps(a, b, c); }
+inline vf vfMin(vf a, vf b) { return _mm256_min_ps(a, b); }
+inline vf vfMax(vf a, vf b) { return _mm256_max_ps(a, b); }
+inline vf vfRound(vf a) {
+  return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+inline vfm vfLt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline vfm vfGt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline vfm vfIsNan(vf a) { return _mm256_cmp_ps(a, a, _CMP_UNORD_Q); }
+inline vf vfSelect(vfm m, vf a, vf b) { return _mm256_blendv_ps(b, a, m); }
+
+inline vf vfPow2i(vf k) {
+  __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(k), _mm256_set1_epi32(127));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+}
+
+#include "helper_vecmath_impl.h"
+
+}  // namespace sdkVecAVX2
+
+SDK_VECMATH_TARGET_END
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX-512F version, 8 doubles or 16 floats
+////////////////////////////////////////////////////////////////////////////////
+SDK_VECMATH_TARGET_BEGIN("avx512f")
+
+namespace sdkVecAVX512 {
+
+typedef __m512d vd;
+typedef __mmask8 vdm;
+typedef __m512 vf;
+typedef __mmask16 vfm;
+
+const int kLanesD = 8;
+const int kLanesF = 16;
+
+// The unmasked forms of several intrinsics merge into _mm512_undefined_*()
+// in GCC's headers, which -Wall reports as maybe uninitialized; their
+// zero-masked forms with every lane set compile to the same instructions.
+const vdm kAllD = 0xff;
+const vfm kAllF = 0xffff;
+
+inline vd vdLoad(const double *p) { return _mm512_loadu_pd(p); }
+inline void vdStore(double *p, vd a) { _mm512_storeu_pd(p, a); }
+inline vd vdSet(double a) { return _mm512_set1_pd(a); }
+inline vd vdAdd(vd a, vd b) { return _mm512_add_pd(a, b); }
+inline vd vdSub(vd a, vd b) { return _mm512_sub_pd(a, b); }
+inline vd vdMul(vd a, vd b) { return _mm512_mul_pd(a, b); }
+inline vd vdDiv(vd a, vd b) { return _mm512_div_pd(a, b); }
+inline vd vdFma(vd a, vd b, vd c) { return _mm512_fmadd_pd(a, b, c); }
+inline vd vdMin(vd a, vd b) { return _mm512_maskz_min_pd(kAllD, a, b); }
+inline vd vdMax(vd a, vd b) { return _mm512_maskz_max_pd(kAllD, a, b); }
+inline vd vdAbs(vd a) { return _mm512_abs_pd(a); }
+inline vd vdSqrt(vd a) { return _mm512_maskz_sqrt_pd(kAllD, a); }
+inline vd vdRound(vd a) {
+  return _mm512_maskz_roundscale_pd(
+      kAllD, a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+inline vdm vdLt(vd a, vd b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+inline vdm vdGt(vd a, vd b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+inline vdm vdEq(vd a, vd b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+inline vdm vdIsNan(vd a) { return _mm512_cmp_pd_mask(a, a, _CMP_UNORD_Q); }
+inline vd vdSelect(vdm m, vd a, vd b) { return _mm512_mask_blend_pd(m, b, a); }
+inline bool vdAll(vdm m) { return m == 0xff; }
+
+inline vd vdPow2i(vd k) {
+  vd t = _mm512_add_pd(k, _mm512_set1_pd(4503599627370496.0 + 1023.0));
+  return _mm512_castsi512_pd(
+      _mm512_maskz_slli_epi64(kAllD, _mm512_castpd_si512(t), 52));
+}
+
+inline vd vdGetExp(vd a) { return _mm512_maskz_getexp_pd(kAllD, a); }
+
+inline vd vdGetMant(vd a) {
+  return _mm512_maskz_getmant_pd(kAllD, a, _MM_MANT_NORM_1_2,
+                                 _MM_MANT_SIGN_src);
+}
+
+inline vf vfLoad(const float *p) { return _mm512_loadu_ps(p); }
+inline void vfStore(float *p, vf a) { _mm512_storeu_ps(p, a); }
+inline vf vfSet(float a) { return _mm512_set1_ps(a); }
+inline vf vfSub(vf a, vf b) { return _mm512_sub_ps(a, b); }
+inline vf vfMul(vf a, vf b) { return _mm512_mul_ps(a, b); }
+inline vf vfFma(vf a, vf b, vf c) { return _mm512_fmadd_ps(a, b, c); }
+inline vf vfMin(vf a, vf b) { return _mm512_maskz_min_ps(kAllF, a, b); }
+inline vf vfMax(vf a, vf b) { return _mm512_maskz_max_ps(kAllF, a, b); }
+inline vf vfRound(vf a) {
+  return _mm512_maskz_roundscale_ps(
+      kAllF, a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+inline vfm vfLt(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+inline vfm vfGt(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+inline vfm vfIsNan(vf a) { return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q); }
+inline vf vfSelect(vfm m, vf a, vf b) { return _mm512_mask_blend_ps(m, b, a); }
+
+inline vf vfPow2i(vf k) {
+  __m512i e = _mm512_add_epi32(_mm512_maskz_cvtps_epi32(kAllF, k),
+                               _mm512_set1_epi32(127));
+  return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(kAllF, e, 23));
+}
+
+#include "helper_vecmath_impl.h"
+
+}  // namespace sdkVecAVX512
+
+SDK_VECMATH_TARGET_END
+
+#endif  // SDK_VECMATH_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// Run time dispatch
+////////////////////////////////////////////////////////////////////////////////
+
+//! Best instruction set of the CPU supported by this file
+inline int sdkVecDetectISA() {
+#if defined(SDK_VECMATH_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+
+  if (info[0] < 7) return SDK_VEC_ISA_SCALAR;
+
+  __cpuid(info, 1);
+  bool fma = (info[2] >> 12) & 1;
+  bool osxsave = (info[2] >> 27) & 1;
+
+  if (!osxsave) return SDK_VEC_ISA_SCALAR;
+
+  // registers enabled by the OS
+  unsigned long long xcr0 = _xgetbv(0);
+  __cpuidex(info, 7, 0);
+
+  if (((info[1] >> 16) & 1) && (xcr0 & 0xe6) == 0xe6) {
+    return SDK_VEC_ISA_AVX512;
+  }
+
+  if (((info[1] >> 5) & 1) && fma && (xcr0 & 0x6) == 0x6) {
+    return SDK_VEC_ISA_AVX2;
+  }
+#else
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f")) return SDK_VEC_ISA_AVX512;
+
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return SDK_VEC_ISA_AVX2;
+  }
+#endif
+#endif
+  return SDK_VEC_ISA_SCALAR;
+}
+
+inline const char *sdkVecGetISAName(int isa) {
+  switch (isa) {
+    case SDK_VEC_ISA_AVX512:
+      return "avx512";
+    case SDK_VEC_ISA_AVX2:
+      return "avx2";
+    default:
+      return "scalar";
+  }
+}
+
+struct sdkVecMathTable {
+  int isa;
+  void (*expD)(double *y, const double *x, int n);
+  void (*logD)(double *y, const double *x, int n);
+  void (*cndD)(double *y, const double *x, int n);
+  void (*invCndD)(double *y, const double *x, int n);
+  void (*rsqrtD)(double *y, const double *x, int n);
+  void (*expF)(float *y, const float *x, int n);
+};
+
+#define SDK_VECMATH_TABLE(ns, isa)                                     \
+  {                                                                    \
+    isa, ns::expArray, ns::logArray, ns::cndArray, ns::invCndArray,    \
+        ns::rsqrtArray, ns::expfArray                                  \
+  }
+
+//! Functions for the instruction set, limited by CUDA_SAMPLES_VECMATH
+inline sdkVecMathTable sdkVecCreateTable() {
+  int isa = sdkVecDetectISA();
+  const char *env = getenv("CUDA_SAMPLES_VECMATH");
+
+  if (env != NULL) {
+    for (int i = SDK_VEC_ISA_SCALAR; i < isa; i++) {
+      if (strcmp(env, sdkVecGetISAName(i)) == 0) isa = i;
+    }
+  }
+
+#if defined(SDK_VECMATH_X86)
+  if (isa == SDK_VEC_ISA_AVX512) {
+    sdkVecMathTable t = SDK_VECMATH_TABLE(sdkVecAVX512, SDK_VEC_ISA_AVX512);
+    return t;
+  }
+
+  if (isa == SDK_VEC_ISA_AVX2) {
+    sdkVecMathTable t = SDK_VECMATH_TABLE(sdkVecAVX2, SDK_VEC_ISA_AVX2);
+    return t;
+  }
+#endif
+
+  sdkVecMathTable t = SDK_VECMATH_TABLE(sdkVecScalar, SDK_VEC_ISA_SCALAR);
+  return t;
+}
+
+#undef SDK_VECMATH_TABLE
+
+inline const sdkVecMathTable &sdkVecGetTable() {
+  static const sdkVecMathTable table = sdkVecCreateTable();
+  return table;
+}
+
+//! Instruction set selected for this process
+inline int sdkVecGetISA() { return sdkVecGetTable().isa; }
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions, y[i] = f(x[i]) for 0 <= i < n
+////////////////////////////////////////////////////////////////////////////////
+inline void sdkVecExp(double *y, const double *x, int n) {
+  sdkVecGetTable().expD(y, x, n);
+}
+
+inline void sdkVecLog(double *y, const double *x, int n) {
+  sdkVecGetTable().logD(y, x, n);
+}
+
+//! Cumulative normal distribution function, the polynomial model of CND()
+inline void sdkVecCND(double *y, const double *x, int n) {
+  sdkVecGetTable().cndD(y, x, n);
+}
+
+//! Inverse cumulative normal distribution function (Moro)
+inline void sdkVecInvCND(double *y, const double *p, int n) {
+  sdkVecGetTable().invCndD(y, p, n);
+}
+
+inline void sdkVecRsqrt(double *y, const double *x, int n) {
+  sdkVecGetTable().rsqrtD(y, x, n);
+}
+
+inline void sdkVecExpf(float *y, const float *x, int n) {
+  sdkVecGetTable().expF(y, x, n);
+}
+
+#endif  // COMMON_HELPER_VECMATH_H_
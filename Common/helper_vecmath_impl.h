@@ -0,0 +1,247 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Kernels of helper_vecmath.h, written once against the vector operations
+// vd*/vf* of an instruction set. helper_vecmath.h includes this file inside
+// the namespace of every instruction set it supports; do not include it
+// directly.
+//
+// With SDK_VECMATH_LIBM defined the kernels of exp and log call the C
+// library, which is faster than the polynomials below without SIMD.
+
+////////////////////////////////////////////////////////////////////////////////
+// exp(x), Cody-Waite reduction x = k*ln2 + r, |r| <= ln2/2, and a degree 13
+// Taylor polynomial of e^r
+////////////////////////////////////////////////////////////////////////////////
+inline vd vdExp(vd x) {
+#if defined(SDK_VECMATH_LIBM)
+  return exp(x);
+#else
+  const vd ln2hi = vdSet(6.93147180369123816490e-01);
+  const vd ln2lo = vdSet(1.90821492927058770002e-10);
+
+  vd xc = vdMin(vdMax(x, vdSet(-746.0)), vdSet(710.0));
+  vd k = vdRound(vdMul(xc, vdSet(1.44269504088896340736)));
+  vd r = vdSub(vdSub(xc, vdMul(k, ln2hi)), vdMul(k, ln2lo));
+
+  vd p = vdSet(1.0 / 6227020800.0);
+  p = vdFma(p, r, vdSet(1.0 / 479001600.0));
+  p = vdFma(p, r, vdSet(1.0 / 39916800.0));
+  p = vdFma(p, r, vdSet(1.0 / 3628800.0));
+  p = vdFma(p, r, vdSet(1.0 / 362880.0));
+  p = vdFma(p, r, vdSet(1.0 / 40320.0));
+  p = vdFma(p, r, vdSet(1.0 / 5040.0));
+  p = vdFma(p, r, vdSet(1.0 / 720.0));
+  p = vdFma(p, r, vdSet(1.0 / 120.0));
+  p = vdFma(p, r, vdSet(1.0 / 24.0));
+  p = vdFma(p, r, vdSet(1.0 / 6.0));
+  p = vdFma(p, r, vdSet(0.5));
+  p = vdFma(p, r, vdSet(1.0));
+  p = vdFma(p, r, vdSet(1.0));
+
+  // 2^k in two steps, k can be out of the range of normal exponents
+  vd k1 = vdRound(vdMul(k, vdSet(0.5)));
+  vd y = vdMul(vdMul(p, vdPow2i(k1)), vdPow2i(vdSub(k, k1)));
+
+  y = vdSelect(vdGt(x, vdSet(709.782712893383973096)), vdSet(HUGE_VAL), y);
+  y = vdSelect(vdLt(x, vdSet(-745.133219101941108420)), vdSet(0.0), y);
+
+  return vdSelect(vdIsNan(x), x, y);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// log(x), x = 2^k * m with sqrt(2)/2 < m <= sqrt(2), and the fdlibm
+// polynomial of log(m) in s = (m - 1) / (m + 1)
+////////////////////////////////////////////////////////////////////////////////
+inline vd vdLog(vd x) {
+#if defined(SDK_VECMATH_LIBM)
+  return log(x);
+#else
+  const vd ln2hi = vdSet(6.93147180369123816490e-01);
+  const vd ln2lo = vdSet(1.90821492927058770002e-10);
+
+  // subnormal inputs are scaled by 2^54 to get a normal exponent
+  vdm tiny = vdLt(x, vdSet(2.2250738585072014e-308));
+  vd xs = vdSelect(tiny, vdMul(x, vdSet(18014398509481984.0)), x);
+  vd k = vdGetExp(xs);
+  vd m = vdGetMant(xs);
+  k = vdSelect(tiny, vdSub(k, vdSet(54.0)), k);
+
+  vdm big = vdGt(m, vdSet(1.41421356237309504880));
+  m = vdSelect(big, vdMul(m, vdSet(0.5)), m);
+  k = vdSelect(big, vdAdd(k, vdSet(1.0)), k);
+
+  vd f = vdSub(m, vdSet(1.0));
+  vd s = vdDiv(f, vdAdd(f, vdSet(2.0)));
+  vd z = vdMul(s, s);
+  vd w = vdMul(z, z);
+  vd t1 = vdFma(w, vdSet(1.531383769920937332e-01), vdSet(2.222219843214978396e-01));
+  t1 = vdMul(w, vdFma(w, t1, vdSet(3.999999999940941908e-01)));
+  vd t2 = vdFma(w, vdSet(1.479819860511658591e-01), vdSet(1.818357216161805012e-01));
+  t2 = vdFma(w, t2, vdSet(2.857142874366239149e-01));
+  t2 = vdMul(z, vdFma(w, t2, vdSet(6.666666666666735130e-01)));
+  vd R = vdAdd(t2, t1);
+  vd hfsq = vdMul(vdMul(vdSet(0.5), f), f);
+
+  vd y = vdFma(s, vdAdd(hfsq, R), vdMul(k, ln2lo));
+  y = vdSub(vdMul(k, ln2hi), vdSub(vdSub(hfsq, y), f));
+
+  y = vdSelect(vdEq(x, vdSet(HUGE_VAL)), x, y);
+  y = vdSelect(vdEq(x, vdSet(0.0)), vdSet(-HUGE_VAL), y);
+  y = vdSelect(vdLt(x, vdSet(0.0)), vdSet(NAN), y);
+
+  return vdSelect(vdIsNan(x), x, y);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Polynomial approximation of the cumulative normal distribution function
+// (Abramowitz & Stegun 26.2.17), the model of the CND() of the samples
+////////////////////////////////////////////////////////////////////////////////
+inline vd vdCND(vd d) {
+  vd K = vdDiv(vdSet(1.0), vdFma(vdSet(0.2316419), vdAbs(d), vdSet(1.0)));
+
+  vd p = vdFma(K, vdSet(1.330274429), vdSet(-1.821255978));
+  p = vdFma(K, p, vdSet(1.781477937));
+  p = vdFma(K, p, vdSet(-0.356563782));
+  p = vdFma(K, p, vdSet(0.31938153));
+  p = vdMul(K, p);
+
+  vd cnd = vdMul(vdSet(0.39894228040143267793994605993438),
+                 vdExp(vdMul(vdMul(vdSet(-0.5), d), d)));
+  cnd = vdMul(cnd, p);
+
+  return vdSelect(vdGt(d, vdSet(0.0)), vdSub(vdSet(1.0), cnd), cnd);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Inverse of the cumulative normal distribution function, Moro's
+// approximation: a rational function for |p - 0.5| < 0.42 and a Chebyshev
+// series in log(-log(p)) for the tails
+////////////////////////////////////////////////////////////////////////////////
+inline vd vdInvCND(vd p) {
+  vd q = vdSub(p, vdSet(0.5));
+  vd z = vdMul(q, q);
+
+  vd num = vdFma(vdSet(-25.44106049637), z, vdSet(41.39119773534));
+  num = vdFma(num, z, vdSet(-18.61500062529));
+  num = vdMul(q, vdFma(num, z, vdSet(2.50662823884)));
+  vd den = vdFma(vdSet(3.13082909833), z, vdSet(-21.06224101826));
+  den = vdFma(den, z, vdSet(23.08336743743));
+  den = vdFma(den, z, vdSet(-8.4735109309));
+  den = vdFma(den, z, vdSet(1.0));
+  vd body = vdDiv(num, den);
+
+  // the tails need two logarithms, skip them if no lane is in a tail
+  vdm central = vdLt(vdAbs(q), vdSet(0.42));
+
+  if (vdAll(central)) return body;
+
+  // probability of the lower tail, the result is reflected for p > 0.5
+  vdm lower = vdLt(q, vdSet(0.0));
+  vd t = vdSelect(lower, p, vdSub(vdSet(1.0), p));
+  t = vdLog(vdSub(vdSet(0.0), vdLog(t)));
+
+  vd tail = vdFma(vdSet(3.960315187E-07), t, vdSet(2.888167364E-07));
+  tail = vdFma(tail, t, vdSet(3.21767881768E-05));
+  tail = vdFma(tail, t, vdSet(3.951896511919E-04));
+  tail = vdFma(tail, t, vdSet(3.8405729373609E-03));
+  tail = vdFma(tail, t, vdSet(2.76438810333863E-02));
+  tail = vdFma(tail, t, vdSet(0.160797971491821));
+  tail = vdFma(tail, t, vdSet(0.976169019091719));
+  tail = vdFma(tail, t, vdSet(0.337475482272615));
+  tail = vdSelect(lower, vdSub(vdSet(0.0), tail), tail);
+
+  return vdSelect(central, body, tail);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 1 / sqrt(x)
+////////////////////////////////////////////////////////////////////////////////
+inline vd vdRsqrt(vd x) { return vdDiv(vdSet(1.0), vdSqrt(x)); }
+
+////////////////////////////////////////////////////////////////////////////////
+// Single precision exp(x), degree 7 Taylor polynomial after the reduction
+////////////////////////////////////////////////////////////////////////////////
+inline vf vfExp(vf x) {
+#if defined(SDK_VECMATH_LIBM)
+  return expf(x);
+#else
+  vf xc = vfMin(vfMax(x, vfSet(-104.0f)), vfSet(89.0f));
+  vf k = vfRound(vfMul(xc, vfSet(1.44269504088896341f)));
+  vf r = vfSub(vfSub(xc, vfMul(k, vfSet(0.693359375f))),
+               vfMul(k, vfSet(-2.12194440e-4f)));
+
+  vf p = vfSet(1.0f / 5040.0f);
+  p = vfFma(p, r, vfSet(1.0f / 720.0f));
+  p = vfFma(p, r, vfSet(1.0f / 120.0f));
+  p = vfFma(p, r, vfSet(1.0f / 24.0f));
+  p = vfFma(p, r, vfSet(1.0f / 6.0f));
+  p = vfFma(p, r, vfSet(0.5f));
+  p = vfFma(p, r, vfSet(1.0f));
+  p = vfFma(p, r, vfSet(1.0f));
+
+  vf k1 = vfRound(vfMul(k, vfSet(0.5f)));
+  vf y = vfMul(vfMul(p, vfPow2i(k1)), vfPow2i(vfSub(k, k1)));
+
+  y = vfSelect(vfGt(x, vfSet(88.7228390f)), vfSet(HUGE_VALF), y);
+  y = vfSelect(vfLt(x, vfSet(-103.972084f)), vfSet(0.0f), y);
+
+  return vfSelect(vfIsNan(x), x, y);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Array versions, the tail of an array is padded to a full vector
+////////////////////////////////////////////////////////////////////////////////
+#define SDK_VECMATH_MAP(name, type, lanes, load, store, kernel, pad)       \
+  inline void name(type *y, const type *x, int n) {                       \
+    int i = 0;                                                            \
+                                                                          \
+    for (; i + lanes <= n; i += lanes) store(y + i, kernel(load(x + i))); \
+                                                                          \
+    if (i < n) {                                                          \
+      type tx[lanes], ty[lanes];                                          \
+                                                                          \
+      for (int j = 0; j < lanes; j++) tx[j] = (i + j < n) ? x[i + j] : pad; \
+                                                                          \
+      store(ty, kernel(load(tx)));                                        \
+                                                                          \
+      for (int j = 0; i + j < n; j++) y[i + j] = ty[j];                   \
+    }                                                                     \
+  }
+
+SDK_VECMATH_MAP(expArray, double, kLanesD, vdLoad, vdStore, vdExp, 0.0)
+SDK_VECMATH_MAP(logArray, double, kLanesD, vdLoad, vdStore, vdLog, 1.0)
+SDK_VECMATH_MAP(cndArray, double, kLanesD, vdLoad, vdStore, vdCND, 0.0)
+SDK_VECMATH_MAP(invCndArray, double, kLanesD, vdLoad, vdStore, vdInvCND,
+                0.5)
+SDK_VECMATH_MAP(rsqrtArray, double, kLanesD, vdLoad, vdStore, vdRsqrt, 1.0)
+SDK_VECMATH_MAP(expfArray, float, kLanesF, vfLoad, vfStore, vfExp, 0.0f)
+
+#undef SDK_VECMATH_MAP
@@ -29,6 +29,11 @@
 
 #define COMMON_NVRTC_HELPER_H_ 1
 
+#ifdef CUDA_HOST_EXEC
+// kernels compiled into the executable and run on the CPU
+#include <helper_host_exec.h>
+#else
+
 #include <cuda.h>
 #include <helper_cuda_drvapi.h>
 #include <nvrtc.h>
@@ -208,4 +213,6 @@ CUmodule loadCUBIN(char *cubin, int argc, char **argv) {
   return module;
 }
 
+#endif  // CUDA_HOST_EXEC
+
 #endif  // COMMON_NVRTC_HELPER_H_
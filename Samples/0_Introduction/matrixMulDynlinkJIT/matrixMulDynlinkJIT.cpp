@@ -53,6 +53,7 @@
 #include "helper_cuda_drvapi.h"
 
 // includes, project
+#include <helper_gold_cache.h>
 #include "matrixMul.h"
 #include "matrixMul_kernel_32_ptxdump.h"
 #include "matrixMul_kernel_64_ptxdump.h"
@@ -324,9 +325,16 @@ int main(int argc, char **argv)
     // copy result from device to host
     checkCudaErrors(cuMemcpyDtoH((void *) h_C, d_C, mem_size_C));
 
-    // compute reference solution
-    float *reference = (float *) malloc(mem_size_C);
-    computeGold(reference, h_A, h_B, HA, WA, WB);
+    // compute reference solution, reused from the gold cache for identical
+    // runs
+    float *h_reference = (float *) malloc(mem_size_C);
+    sdkGoldCache goldCache("matrixMulDynlinkJIT/computeGold", argc, (const char **)argv);
+    goldCache.addInput(h_A, mem_size_A).addInput(h_B, mem_size_B);
+    goldCache.addParam(HA).addParam(WA).addParam(WB);
+    const float *reference = goldCache.compute(h_reference, size_C, [&]()
+    {
+        computeGold(h_reference, h_A, h_B, HA, WA, WB);
+    });
 
     // check result
     float diff=0.0f;
@@ -343,7 +351,7 @@ int main(int argc, char **argv)
     free(h_A);
     free(h_B);
     free(h_C);
-    free(reference);
+    free(h_reference);
     checkCudaErrors(cuMemFree(d_A));
     checkCudaErrors(cuMemFree(d_B));
     checkCudaErrors(cuMemFree(d_C));
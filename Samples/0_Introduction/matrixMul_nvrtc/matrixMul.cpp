@@ -46,7 +46,9 @@
 #include <assert.h>
 
 // CUDA runtime
+#ifndef CUDA_HOST_EXEC
 #include <cuda_runtime.h>
+#endif
 #include "nvrtc_helper.h"
 
 // Helper functions and utilities to work with CUDA
@@ -46,7 +46,9 @@
  * wA is A's width and wB is B's width
  */
 
+#ifndef CUDA_HOST_EXEC
 #include <cooperative_groups.h>
+#endif
 
 template <int BLOCK_SIZE>
 __device__ void matrixMulCUDA(float *C, float *A, float *B, int wA, int wB) {
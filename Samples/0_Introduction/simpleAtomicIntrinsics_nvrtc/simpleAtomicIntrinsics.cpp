@@ -60,6 +60,8 @@ void runTest(int argc, char **argv);
 
 extern "C" bool computeGold(int *gpuData, const int len);
 
+extern "C" bool runAtomicBenchmark(int maxThreads, int opsPerThread);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Program main
 ////////////////////////////////////////////////////////////////////////////////
@@ -67,7 +69,24 @@ extern "C" bool computeGold(int *gpuData, const int len);
 int main(int argc, char **argv) {
   printf("%s starting...\n", sampleName);
 
-  runTest(argc, argv);
+  // -benchmark measures the same atomic operations on the host under
+  // contention and does not need a device
+  if (checkCmdLineFlag(argc, (const char **)argv, "benchmark")) {
+    int maxThreads = 0;
+    int opsPerThread = 0;
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "threads")) {
+      maxThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+    }
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "ops")) {
+      opsPerThread = getCmdLineArgumentInt(argc, (const char **)argv, "ops");
+    }
+
+    testResult = runAtomicBenchmark(maxThreads, opsPerThread);
+  } else {
+    runTest(argc, argv);
+  }
 
   printf("%s completed, returned %s\n", sampleName,
          testResult ? "OK" : "ERROR!");
@@ -0,0 +1,553 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Host benchmark of atomic operations under contention.
+ *
+ * Every host thread plays the role of a contiguous range of CUDA threads of
+ * testKernel and applies the same eleven operations with one of three
+ * strategies:
+ *   naive      : every operation is an atomic on the shared word
+ *   aggregated : every thread reduces its range locally and issues a single
+ *                atomic per word (the host analog of warp-aggregated atomics)
+ *   sharded    : every thread updates its own cache line aligned counters,
+ *                the shards are merged once all threads have finished
+ * The result of every run is checked with computeGold.
+ */
+
+#include <stdio.h>
+#include <limits.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <helper_timer.h>
+
+extern "C" int computeGold(int *gpuData, const int len);
+
+////////////////////////////////////////////////////////////////////////////////
+// export C interface
+extern "C" bool runAtomicBenchmark(int maxThreads, int opsPerThread);
+
+namespace {
+
+const int kNumOps = 11;
+const int kNumStrategies = 3;
+const int kCacheLine = 64;
+
+// limits of atomicInc and atomicDec used by testKernel
+const unsigned int kIncLimit = 17;
+const unsigned int kDecLimit = 137;
+
+const char *opNames[kNumOps] = {"atomicAdd", "atomicSub", "atomicExch",
+                                "atomicMax", "atomicMin", "atomicInc",
+                                "atomicDec", "atomicCAS", "atomicAnd",
+                                "atomicOr",  "atomicXor"};
+
+const char *strategyNames[kNumStrategies] = {"naive", "aggregated",
+                                             "sharded"};
+
+enum Strategy { kNaive = 0, kAggregated = 1, kSharded = 2 };
+
+// The eleven words of testKernel share a cache line, as on the device
+struct alignas(kCacheLine) SharedData {
+  std::atomic<int> v[kNumOps];
+};
+
+// Private counters of a thread, padded to two cache lines so that the
+// counters of two shards never share a line, whatever the alignment
+struct Shard {
+  std::atomic<int> v[kNumOps];
+  char pad[2 * kCacheLine - kNumOps * sizeof(int)];
+};
+
+void initData(int *data) {
+  for (int i = 0; i < kNumOps; i++) data[i] = 0;
+
+  // To make the AND and XOR tests generate something other than 0...
+  data[8] = data[10] = 0xff;
+}
+
+// Neutral value of every word of a shard
+void initShard(Shard *s) {
+  for (int i = 0; i < kNumOps; i++) s->v[i].store(0, std::memory_order_relaxed);
+
+  s->v[2].store(-1, std::memory_order_relaxed);
+  s->v[3].store(INT_MIN, std::memory_order_relaxed);
+  s->v[4].store(INT_MAX, std::memory_order_relaxed);
+  s->v[8].store(~0, std::memory_order_relaxed);
+}
+
+// atomicInc and atomicDec applied count times, as one step each
+inline unsigned int incStep(unsigned int old) {
+  return (old >= kIncLimit) ? 0 : old + 1;
+}
+
+inline unsigned int decStep(unsigned int old) {
+  return ((old == 0) || (old > kDecLimit)) ? kDecLimit : old - 1;
+}
+
+unsigned int incN(unsigned int old, unsigned int count) {
+  if (count == 0) return old;
+
+  if (old > kIncLimit) {
+    old = 0;
+    count--;
+  }
+
+  return (old + count % (kIncLimit + 1)) % (kIncLimit + 1);
+}
+
+unsigned int decN(unsigned int old, unsigned int count) {
+  if (count == 0) return old;
+
+  if (old > kDecLimit) {
+    old = kDecLimit;
+    count--;
+  }
+
+  return (old + (kDecLimit + 1) - count % (kDecLimit + 1)) % (kDecLimit + 1);
+}
+
+template <class F>
+inline void atomicUpdate(std::atomic<int> &a, F f) {
+  int old = a.load(std::memory_order_relaxed);
+
+  while (!a.compare_exchange_weak(old, f(old), std::memory_order_relaxed)) {
+  }
+}
+
+inline void atomicMaxHost(std::atomic<int> &a, int val) {
+  int old = a.load(std::memory_order_relaxed);
+
+  while (old < val &&
+         !a.compare_exchange_weak(old, val, std::memory_order_relaxed)) {
+  }
+}
+
+inline void atomicMinHost(std::atomic<int> &a, int val) {
+  int old = a.load(std::memory_order_relaxed);
+
+  while (old > val &&
+         !a.compare_exchange_weak(old, val, std::memory_order_relaxed)) {
+  }
+}
+
+// operations of the CUDA threads [begin, end) on the shared words
+void runNaive(int op, int begin, int end, SharedData *g) {
+  std::atomic<int> &a = g->v[op];
+
+  switch (op) {
+    case 0:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_add(10, std::memory_order_relaxed);
+      break;
+
+    case 1:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_sub(10, std::memory_order_relaxed);
+      break;
+
+    case 2:
+      for (int tid = begin; tid < end; tid++)
+        a.exchange(tid, std::memory_order_relaxed);
+      break;
+
+    case 3:
+      for (int tid = begin; tid < end; tid++) atomicMaxHost(a, tid);
+      break;
+
+    case 4:
+      for (int tid = begin; tid < end; tid++) atomicMinHost(a, tid);
+      break;
+
+    case 5:
+      for (int tid = begin; tid < end; tid++)
+        atomicUpdate(a, [](int old) { return (int)incStep(old); });
+      break;
+
+    case 6:
+      for (int tid = begin; tid < end; tid++)
+        atomicUpdate(a, [](int old) { return (int)decStep(old); });
+      break;
+
+    case 7:
+      for (int tid = begin; tid < end; tid++) {
+        int expected = tid - 1;
+        a.compare_exchange_strong(expected, tid, std::memory_order_relaxed);
+      }
+      break;
+
+    case 8:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_and(2 * tid + 7, std::memory_order_relaxed);
+      break;
+
+    case 9:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_or((int)(1u << (tid & 31)), std::memory_order_relaxed);
+      break;
+
+    case 10:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_xor(tid, std::memory_order_relaxed);
+      break;
+  }
+}
+
+// the chain of compare-and-swaps of [begin, end) collapsed into one: if the
+// word is anywhere on the chain it ends up at end - 1
+void casRange(std::atomic<int> &a, int begin, int end) {
+  int old = a.load(std::memory_order_relaxed);
+
+  while (old >= begin - 1 && old < end - 1 &&
+         !a.compare_exchange_weak(old, end - 1, std::memory_order_relaxed)) {
+  }
+}
+
+// operations of the CUDA threads [begin, end) reduced locally, then one
+// atomic per thread
+void runAggregated(int op, int begin, int end, SharedData *g) {
+  std::atomic<int> &a = g->v[op];
+  int count = end - begin;
+
+  if (count <= 0) return;
+
+  switch (op) {
+    case 0:
+      a.fetch_add(10 * count, std::memory_order_relaxed);
+      break;
+
+    case 1:
+      a.fetch_sub(10 * count, std::memory_order_relaxed);
+      break;
+
+    case 2:
+      a.exchange(end - 1, std::memory_order_relaxed);
+      break;
+
+    case 3: {
+      int val = INT_MIN;
+      for (int tid = begin; tid < end; tid++) val = val > tid ? val : tid;
+      atomicMaxHost(a, val);
+    } break;
+
+    case 4: {
+      int val = INT_MAX;
+      for (int tid = begin; tid < end; tid++) val = val < tid ? val : tid;
+      atomicMinHost(a, val);
+    } break;
+
+    case 5:
+      atomicUpdate(a, [count](int old) { return (int)incN(old, count); });
+      break;
+
+    case 6:
+      atomicUpdate(a, [count](int old) { return (int)decN(old, count); });
+      break;
+
+    case 7:
+      casRange(a, begin, end);
+      break;
+
+    case 8: {
+      int val = ~0;
+      for (int tid = begin; tid < end; tid++) val &= 2 * tid + 7;
+      a.fetch_and(val, std::memory_order_relaxed);
+    } break;
+
+    case 9: {
+      unsigned int val = 0;
+      for (int tid = begin; tid < end; tid++) val |= 1u << (tid & 31);
+      a.fetch_or((int)val, std::memory_order_relaxed);
+    } break;
+
+    case 10: {
+      int val = 0;
+      for (int tid = begin; tid < end; tid++) val ^= tid;
+      a.fetch_xor(val, std::memory_order_relaxed);
+    } break;
+  }
+}
+
+// operations of the CUDA threads [begin, end) on the private shard s.
+// atomicInc and atomicDec count the steps, which are replayed by the merge.
+// A compare-and-swap chain cannot be merged, so it stays on the shared word.
+void runSharded(int op, int begin, int end, Shard *s, SharedData *g) {
+  std::atomic<int> &a = s->v[op];
+
+  switch (op) {
+    case 0:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_add(10, std::memory_order_relaxed);
+      break;
+
+    case 1:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_sub(10, std::memory_order_relaxed);
+      break;
+
+    case 2:
+      for (int tid = begin; tid < end; tid++)
+        a.exchange(tid, std::memory_order_relaxed);
+      break;
+
+    case 3:
+      for (int tid = begin; tid < end; tid++) atomicMaxHost(a, tid);
+      break;
+
+    case 4:
+      for (int tid = begin; tid < end; tid++) atomicMinHost(a, tid);
+      break;
+
+    case 5:
+    case 6:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_add(1, std::memory_order_relaxed);
+      break;
+
+    case 7:
+      runNaive(op, begin, end, g);
+      break;
+
+    case 8:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_and(2 * tid + 7, std::memory_order_relaxed);
+      break;
+
+    case 9:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_or((int)(1u << (tid & 31)), std::memory_order_relaxed);
+      break;
+
+    case 10:
+      for (int tid = begin; tid < end; tid++)
+        a.fetch_xor(tid, std::memory_order_relaxed);
+      break;
+  }
+}
+
+void mergeShards(int op, const Shard *shards, int numShards, SharedData *g) {
+  std::atomic<int> &a = g->v[op];
+  int val = a.load(std::memory_order_relaxed);
+
+  for (int t = 0; t < numShards; t++) {
+    int s = shards[t].v[op].load(std::memory_order_relaxed);
+
+    switch (op) {
+      case 0:
+      case 1:
+        val += s;
+        break;
+
+      case 2:
+        if (s >= 0) val = s;
+        break;
+
+      case 3:
+        val = val > s ? val : s;
+        break;
+
+      case 4:
+        val = val < s ? val : s;
+        break;
+
+      case 5:
+        val = incN(val, s);
+        break;
+
+      case 6:
+        val = decN(val, s);
+        break;
+
+      case 8:
+        val &= s;
+        break;
+
+      case 9:
+        val |= s;
+        break;
+
+      case 10:
+        val ^= s;
+        break;
+    }
+  }
+
+  a.store(val, std::memory_order_relaxed);
+}
+
+// Runs one operation with numThreads host threads, every one of them
+// standing for opsPerThread CUDA threads. Returns the elapsed time in ms.
+double runOp(Strategy strategy, int op, int numThreads, int opsPerThread,
+             SharedData *g, std::vector<Shard> &shards) {
+  std::atomic<int> ready(0);
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < numThreads; t++) initShard(&shards[t]);
+
+  for (int t = 0; t < numThreads; t++) {
+    threads.push_back(std::thread([&, t]() {
+      int begin = t * opsPerThread;
+      int end = begin + opsPerThread;
+
+      ready.fetch_add(1);
+
+      while (!go.load(std::memory_order_acquire)) {
+      }
+
+      if (strategy == kNaive)
+        runNaive(op, begin, end, g);
+      else if (strategy == kAggregated)
+        runAggregated(op, begin, end, g);
+      else
+        runSharded(op, begin, end, &shards[t], g);
+    }));
+  }
+
+  while (ready.load() < numThreads) {
+  }
+
+  StopWatchInterface *timer = NULL;
+  sdkCreateTimer(&timer);
+  sdkStartTimer(&timer);
+
+  go.store(true, std::memory_order_release);
+
+  for (int t = 0; t < numThreads; t++) threads[t].join();
+
+  if (strategy == kSharded && op != 7)
+    mergeShards(op, &shards[0], numThreads, g);
+
+  sdkStopTimer(&timer);
+  double ms = sdkGetTimerValue(&timer);
+  sdkDeleteTimer(&timer);
+
+  return ms;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+//! Run the host atomic contention benchmark
+//! @param maxThreads    largest number of host threads, the scaling curve
+//!                      doubles the number of threads up to this value
+//! @param opsPerThread  CUDA threads emulated by every host thread
+////////////////////////////////////////////////////////////////////////////////
+
+bool runAtomicBenchmark(int maxThreads, int opsPerThread) {
+  if (maxThreads <= 0) maxThreads = (int)std::thread::hardware_concurrency();
+
+  if (maxThreads <= 0) maxThreads = 1;
+
+  // atomicAdd accumulates 10 per CUDA thread and must not overflow
+  long long maxOps = (INT_MAX / 10) / maxThreads;
+
+  if (opsPerThread <= 0 || opsPerThread > maxOps) {
+    opsPerThread = (int)(maxOps < (1 << 18) ? maxOps : (1 << 18));
+    printf("opsPerThread set to %d\n", opsPerThread);
+  }
+
+  std::vector<int> threadCounts;
+
+  for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+
+  threadCounts.push_back(maxThreads);
+
+  printf("Host atomic benchmark: up to %d threads, %d operations per thread\n",
+         maxThreads, opsPerThread);
+  printf("%8s", "threads");
+
+  for (int s = 0; s < kNumStrategies; s++)
+    printf("  %12s", strategyNames[s]);
+
+  printf("   (Mops/s, all %d operations)\n", kNumOps);
+
+  SharedData data;
+  SharedData *g = &data;
+  std::vector<Shard> shards(maxThreads);
+  double msPerOp[kNumStrategies][kNumOps];
+  bool result = true;
+
+  for (size_t c = 0; c < threadCounts.size(); c++) {
+    int numThreads = threadCounts[c];
+    int len = numThreads * opsPerThread;
+
+    printf("%8d", numThreads);
+
+    for (int s = 0; s < kNumStrategies; s++) {
+      int hData[kNumOps];
+      double ms = 0.0;
+
+      initData(hData);
+
+      for (int i = 0; i < kNumOps; i++)
+        g->v[i].store(hData[i], std::memory_order_relaxed);
+
+      for (int op = 0; op < kNumOps; op++) {
+        msPerOp[s][op] =
+            runOp((Strategy)s, op, numThreads, opsPerThread, g, shards);
+        ms += msPerOp[s][op];
+      }
+
+      for (int i = 0; i < kNumOps; i++)
+        hData[i] = g->v[i].load(std::memory_order_relaxed);
+
+      printf("  %12.2f", (double)kNumOps * len / (ms * 1.0e3));
+
+      if (!computeGold(hData, len)) {
+        printf("\n%s strategy with %d threads failed verification\n",
+               strategyNames[s], numThreads);
+        result = false;
+      }
+    }
+
+    printf("\n");
+  }
+
+  // breakdown of the last run, the one with the most contention
+  int len = maxThreads * opsPerThread;
+
+  printf("\n%10s", "operation");
+
+  for (int s = 0; s < kNumStrategies; s++)
+    printf("  %12s", strategyNames[s]);
+
+  printf("   (Mops/s, %d threads)\n", maxThreads);
+
+  for (int op = 0; op < kNumOps; op++) {
+    printf("%10s", opNames[op]);
+
+    for (int s = 0; s < kNumStrategies; s++)
+      printf("  %12.2f", len / (msPerOp[s][op] * 1.0e3));
+
+    printf("\n");
+  }
+
+  return result;
+}
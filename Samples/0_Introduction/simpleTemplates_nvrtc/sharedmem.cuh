@@ -67,6 +67,14 @@
 //   }
 //****************************************************************************
 
+#ifdef CUDA_HOST_EXEC
+// On the host backend dynamic shared memory is a buffer of the worker that
+// runs the block, and any type can use it.
+template <typename T>
+struct SharedMemory {
+  __device__ T *getPointer() { return (T *)hostExecDynamicShared(); }
+};
+#else
 // This is the un-specialized struct.  Note that we prevent instantiation of
 // this
 // struct by putting an undefined symbol in the function body so it won't
@@ -174,4 +182,6 @@ struct SharedMemory<double> {
   }
 };
 
+#endif  // CUDA_HOST_EXEC
+
 #endif  //_SHAREDMEM_H_
@@ -38,7 +38,9 @@
 #include <math.h>
 
 // CUDA runtime
+#ifndef CUDA_HOST_EXEC
 #include <cuda_runtime.h>
+#endif
 
 // helper functions and utilities to work with CUDA
 #include <helper_functions.h>
@@ -37,8 +37,10 @@
 #include <cmath>
 
 // For the CUDA runtime routines (prefixed with "cuda_")
+#ifndef CUDA_HOST_EXEC
 #include <cuda.h>
 #include <cuda_runtime.h>
+#endif
 
 // helper functions and utilities to work with CUDA
 #include <helper_functions.h>
@@ -0,0 +1,896 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* This sample times the CPU reference implementations of the samples, the
+ * functions that check the GPU results, over a sweep of problem sizes. No
+ * GPU and no CUDA runtime are needed: the reference sources are compiled
+ * with the host compiler and linked into one executable.
+ *
+ * Every case runs a number of warmup calls followed by timed repetitions.
+ * The results are printed as a table and written as JSON, together with a
+ * fingerprint of the machine and the build, so that runs on the same
+ * machine can be compared as a CPU performance baseline. */
+
+// includes, system
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+// includes, project
+#include <helper_string.h>
+
+#include "FDTD3dReference.h"
+#include "binomialOptions_common.h"
+#include "convolutionFFT2D_common.h"
+#include "convolutionSeparable_common.h"
+#include "flowGold.h"
+#include "histogram_common.h"
+#include "mergeSort_common.h"
+#include "quasirandomGenerator_common.h"
+#include "scan_common.h"
+
+#ifndef HOSTBENCH_REVISION
+#define HOSTBENCH_REVISION ""
+#endif
+
+#ifndef HOSTBENCH_FLAGS
+#define HOSTBENCH_FLAGS ""
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Reference functions without a header of their own, computeGold of
+// matrixMulDynlinkJIT and boxFilter are renamed by the Makefile
+////////////////////////////////////////////////////////////////////////////////
+extern "C" void BlackScholesCPU(float *h_CallResult, float *h_PutResult,
+                                float *h_StockPrice, float *h_OptionStrike,
+                                float *h_OptionYears, float Riskfree,
+                                float Volatility, int optN);
+
+extern "C" void BlackScholesImpliedVolCPU(
+    float *h_ImpliedVol, float *h_PriceError, int *h_Iterations,
+    float *h_CallPrice, float *h_StockPrice, float *h_OptionStrike,
+    float *h_OptionYears, float Riskfree, int optN, int numThreads);
+
+extern "C" void binomialOptionsCPU(real &callResult, TOptionData optionData);
+
+extern "C" void matrixMulGold(float *C, const float *A, const float *B,
+                              unsigned int hA, unsigned int wA,
+                              unsigned int wB);
+
+extern "C" void boxFilterGold(float *image, float *temp, int w, int h, int r);
+
+extern "C" void initQuasirandomGenerator(
+    unsigned int table[QRNG_DIMENSIONS][QRNG_RESOLUTION]);
+
+extern "C" float getQuasirandomValue(
+    unsigned int table[QRNG_DIMENSIONS][QRNG_RESOLUTION], int i, int dim);
+
+extern "C" void MoroInvCNDcpuArray(double *output, const unsigned int *input,
+                                   int n);
+
+////////////////////////////////////////////////////////////////////////////////
+// Timing and statistics
+////////////////////////////////////////////////////////////////////////////////
+struct BenchResult {
+  std::string engine;
+  std::string size;
+  double items;       // units of work per call
+  std::string unit;   // name of the unit of work
+  std::vector<double> seconds;  // sorted times of the repetitions
+  double checksum;    // sum of the output, guards against dead code
+};
+
+struct BenchConfig {
+  int warmup;
+  int repetitions;
+  int numThreads;  // threads of the multithreaded engines, 0 = all
+  bool quick;      // smaller sweeps
+  const char *engine;  // run only the engines whose name contains it
+};
+
+// p-th percentile of sorted values, interpolated between the neighbours
+static double percentile(const std::vector<double> &sorted, double p) {
+  double pos = p * (double)(sorted.size() - 1);
+  size_t i = (size_t)pos;
+
+  if (i + 1 >= sorted.size()) return sorted.back();
+
+  return sorted[i] + (pos - (double)i) * (sorted[i + 1] - sorted[i]);
+}
+
+static double mean(const std::vector<double> &v) {
+  double sum = 0.0;
+
+  for (size_t i = 0; i < v.size(); i++) sum += v[i];
+
+  return sum / (double)v.size();
+}
+
+static double stddev(const std::vector<double> &v) {
+  double m = mean(v), sum = 0.0;
+
+  for (size_t i = 0; i < v.size(); i++) sum += (v[i] - m) * (v[i] - m);
+
+  return (v.size() > 1) ? sqrt(sum / (double)(v.size() - 1)) : 0.0;
+}
+
+template <class T>
+static double checksum(const T *data, size_t n) {
+  double sum = 0.0;
+
+  for (size_t i = 0; i < n; i++) sum += (double)data[i];
+
+  return sum;
+}
+
+class HostBench {
+ public:
+  explicit HostBench(const BenchConfig &config) : config_(config) {}
+
+  const BenchConfig &config() const { return config_; }
+
+  // number of sizes of a sweep of n, the quick sweep keeps the smallest
+  int sweep(int n) const { return config_.quick ? (std::min)(n, 2) : n; }
+
+  bool enabled(const char *engine) const {
+    return !config_.engine || strstr(engine, config_.engine);
+  }
+
+  // Runs f() config.warmup times, then times config.repetitions calls, the
+  // checksum is sum() of the output of the last call
+  template <class F, class C>
+  void run(const char *engine, const std::string &size, double items,
+           const char *unit, F f, C sum) {
+    BenchResult r;
+    r.engine = engine;
+    r.size = size;
+    r.items = items;
+    r.unit = unit;
+    r.checksum = 0.0;
+
+    for (int i = 0; i < config_.warmup; i++) f();
+
+    for (int i = 0; i < config_.repetitions; i++) {
+      std::chrono::steady_clock::time_point t0 =
+          std::chrono::steady_clock::now();
+      f();
+      std::chrono::duration<double> t = std::chrono::steady_clock::now() - t0;
+      r.seconds.push_back(t.count());
+    }
+
+    r.checksum = sum();
+    std::sort(r.seconds.begin(), r.seconds.end());
+    results_.push_back(r);
+  }
+
+  // prints the last result
+  void report() const {
+    const BenchResult &r = results_.back();
+    double p50 = percentile(r.seconds, 0.5);
+
+    printf("%-30s %-10s %10.3f ms %10.3f ms %12.4g %s/s\n", r.engine.c_str(),
+           r.size.c_str(), 1e3 * r.seconds.front(), 1e3 * p50, r.items / p50,
+           r.unit.c_str());
+    fflush(stdout);
+  }
+
+  const std::vector<BenchResult> &results() const { return results_; }
+
+ private:
+  BenchConfig config_;
+  std::vector<BenchResult> results_;
+};
+
+// Sends stdout to /dev/null while in scope, for the reference engines that
+// print progress on every call. Only the formatting of those lines is left
+// in their timings.
+class QuietStdout {
+ public:
+  QuietStdout() : saved_(-1) {
+#if defined(__linux__)
+    fflush(stdout);
+    int null = open("/dev/null", O_WRONLY);
+
+    if (null >= 0) {
+      saved_ = dup(STDOUT_FILENO);
+      dup2(null, STDOUT_FILENO);
+      close(null);
+    }
+#endif
+  }
+
+  ~QuietStdout() {
+#if defined(__linux__)
+    if (saved_ >= 0) {
+      fflush(stdout);
+      dup2(saved_, STDOUT_FILENO);
+      close(saved_);
+    }
+#endif
+  }
+
+ private:
+  int saved_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Input data, a fixed seed gives the same inputs and checksums on every run
+////////////////////////////////////////////////////////////////////////////////
+static unsigned int g_seed = 2024u;
+
+static inline unsigned int randomUint() {
+  g_seed = g_seed * 1664525u + 1013904223u;
+  return g_seed;
+}
+
+static inline float randomFloat(float low, float high) {
+  return low + (high - low) * (float)(randomUint() >> 8) * (1.0f / 16777216.0f);
+}
+
+static void fillRandom(std::vector<float> &v, float low, float high) {
+  for (size_t i = 0; i < v.size(); i++) v[i] = randomFloat(low, high);
+}
+
+static std::string sizeString(int a) {
+  char s[64];
+
+  if (a >= (1 << 20) && a % (1 << 20) == 0)
+    snprintf(s, sizeof(s), "%dM", a >> 20);
+  else if (a >= (1 << 10) && a % (1 << 10) == 0)
+    snprintf(s, sizeof(s), "%dK", a >> 10);
+  else
+    snprintf(s, sizeof(s), "%d", a);
+
+  return s;
+}
+
+static std::string sizeString(int a, int b) {
+  char s[64];
+  snprintf(s, sizeof(s), "%dx%d", a, b);
+  return s;
+}
+
+static std::string sizeString(int a, int b, int c) {
+  char s[64];
+  snprintf(s, sizeof(s), "%dx%dx%d", a, b, c);
+  return s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Engines, one function per reference source
+////////////////////////////////////////////////////////////////////////////////
+static void benchBlackScholes(HostBench &bench) {
+  const int sizes[] = {256 * 1024, 1024 * 1024, 4 * 1024 * 1024};
+  const float riskfree = 0.02f, volatility = 0.30f;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int optN = sizes[s];
+    std::vector<float> call(optN), put(optN), price(optN), strike(optN),
+        years(optN);
+    fillRandom(price, 5.0f, 30.0f);
+    fillRandom(strike, 1.0f, 100.0f);
+    fillRandom(years, 0.25f, 10.0f);
+
+    if (bench.enabled("BlackScholesCPU")) {
+      bench.run("BlackScholesCPU", sizeString(optN), optN, "options",
+                [&]() {
+                  BlackScholesCPU(&call[0], &put[0], &price[0], &strike[0],
+                                  &years[0], riskfree, volatility, optN);
+                },
+                [&]() {
+                  return checksum(&call[0], optN) + checksum(&put[0], optN);
+                });
+      bench.report();
+    }
+
+    if (bench.enabled("BlackScholesImpliedVolCPU") && s < 2) {
+      std::vector<float> vol(optN), error(optN);
+      std::vector<int> iterations(optN);
+      BlackScholesCPU(&call[0], &put[0], &price[0], &strike[0], &years[0],
+                      riskfree, volatility, optN);
+
+      bench.run("BlackScholesImpliedVolCPU", sizeString(optN), optN, "options",
+                [&]() {
+                  BlackScholesImpliedVolCPU(
+                      &vol[0], &error[0], &iterations[0], &call[0], &price[0],
+                      &strike[0], &years[0], riskfree, optN,
+                      bench.config().numThreads);
+                },
+                [&]() { return checksum(&vol[0], optN); });
+      bench.report();
+    }
+  }
+}
+
+static void benchBinomialOptions(HostBench &bench) {
+  const int sizes[] = {16, 64, 128};
+
+  if (!bench.enabled("binomialOptionsCPU")) return;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int optN = sizes[s];
+    std::vector<TOptionData> options(optN);
+    std::vector<real> result(optN);
+
+    for (int i = 0; i < optN; i++) {
+      options[i].S = randomFloat(5.0f, 30.0f);
+      options[i].X = randomFloat(1.0f, 100.0f);
+      options[i].T = randomFloat(0.25f, 10.0f);
+      options[i].R = 0.06f;
+      options[i].V = 0.10f;
+    }
+
+    bench.run("binomialOptionsCPU", sizeString(optN), optN, "options",
+              [&]() {
+                for (int i = 0; i < optN; i++)
+                  binomialOptionsCPU(result[i], options[i]);
+              },
+              [&]() { return checksum(&result[0], optN); });
+    bench.report();
+  }
+}
+
+static void benchHistogram(HostBench &bench) {
+  const int sizes[] = {1 << 20, 16 << 20, 64 << 20};
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int byteCount = sizes[s];
+    std::vector<uchar> data(byteCount);
+    std::vector<uint> histogram(HISTOGRAM256_BIN_COUNT);
+
+    for (int i = 0; i < byteCount; i++) data[i] = (uchar)(randomUint() >> 24);
+
+    if (bench.enabled("histogram64CPU")) {
+      bench.run("histogram64CPU", sizeString(byteCount), byteCount, "bytes",
+                [&]() { histogram64CPU(&histogram[0], &data[0], byteCount); },
+                [&]() {
+                  return checksum(&histogram[0], HISTOGRAM64_BIN_COUNT);
+                });
+      bench.report();
+    }
+
+    if (bench.enabled("histogram256CPU")) {
+      bench.run("histogram256CPU", sizeString(byteCount), byteCount, "bytes",
+                [&]() { histogram256CPU(&histogram[0], &data[0], byteCount); },
+                [&]() {
+                  return checksum(&histogram[0], HISTOGRAM256_BIN_COUNT);
+                });
+      bench.report();
+    }
+  }
+}
+
+static void benchScan(HostBench &bench) {
+  // batches of short arrays and one large array
+  const int batches[] = {1024, 64, 1};
+  const int lengths[] = {1024, 64 * 1024, 16 * 1024 * 1024};
+
+  if (!bench.enabled("scanExclusiveHost")) return;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const uint batchSize = batches[s], arrayLength = lengths[s];
+    const size_t n = (size_t)batchSize * arrayLength;
+    std::vector<uint> src(n), dst(n);
+
+    for (size_t i = 0; i < n; i++) src[i] = randomUint() >> 22;
+
+    bench.run("scanExclusiveHost",
+              sizeString(batchSize) + "x" + sizeString(arrayLength), (double)n,
+              "elements",
+              [&]() {
+                scanExclusiveHost(&dst[0], &src[0], batchSize, arrayLength);
+              },
+              [&]() { return checksum(&dst[0], n); });
+    bench.report();
+  }
+}
+
+static void benchMergeSort(HostBench &bench) {
+  const int sizes[] = {64 * 1024, 256 * 1024, 1024 * 1024};
+
+  if (!bench.enabled("mergeSortHost")) return;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const uint N = sizes[s];
+    std::vector<uint> srcKey(N), srcVal(N), dstKey(N), dstVal(N), bufKey(N),
+        bufVal(N);
+
+    for (uint i = 0; i < N; i++) {
+      srcKey[i] = randomUint() >> 16;
+      srcVal[i] = i;
+    }
+
+    bench.run("mergeSortHost", sizeString(N), N, "keys",
+              [&]() {
+                mergeSortHost(&dstKey[0], &dstVal[0], &bufKey[0], &bufVal[0],
+                              &srcKey[0], &srcVal[0], N, 1);
+              },
+              [&]() { return checksum(&dstVal[0], 16); });
+    bench.report();
+  }
+}
+
+static void benchFDTD3d(HostBench &bench) {
+  const int sizes[] = {48, 96, 128};
+  const int radius = 4, timesteps = 5;
+
+  if (!bench.enabled("fdtdReference")) return;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int dim = sizes[s];
+    const int outer = dim + 2 * radius;
+    const size_t volume = (size_t)outer * outer * outer;
+    std::vector<float> input(volume), output(volume), coeff(radius + 1);
+
+    generateRandomData(&input[0], outer, outer, outer, 0.0f, 1.0f);
+
+    for (int i = 0; i <= radius; i++) coeff[i] = 0.1f;
+
+    {
+      QuietStdout quiet;
+      bench.run("fdtdReference", sizeString(dim, dim, dim),
+                (double)dim * dim * dim * timesteps, "cells",
+                [&]() {
+                  fdtdReference(&output[0], &input[0], &coeff[0], dim, dim, dim,
+                                radius, timesteps);
+                },
+                [&]() { return checksum(&output[0], volume); });
+    }
+
+    bench.report();
+  }
+}
+
+static void benchOpticalFlow(HostBench &bench) {
+  const int widths[] = {160, 320, 640};
+  const int heights[] = {120, 240, 480};
+  // parameters of the HSOpticalFlow sample
+  const float alpha = 0.2f;
+  const int nLevels = 5, nWarpIters = 3, nSolverIters = 500;
+
+  if (!bench.enabled("ComputeFlowGold")) return;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int width = widths[s], height = heights[s];
+    const int stride = (width + 31) / 32 * 32;
+    std::vector<float> I0(stride * height), I1(stride * height),
+        u(stride * height), v(stride * height);
+
+    // smooth pattern, the second frame is shifted by (1.5, 0.5) pixels
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        I0[y * stride + x] = sinf(0.05f * x) * cosf(0.07f * y);
+        I1[y * stride + x] =
+            sinf(0.05f * (x - 1.5f)) * cosf(0.07f * (y - 0.5f));
+      }
+    }
+
+    {
+      QuietStdout quiet;
+      bench.run("ComputeFlowGold", sizeString(width, height),
+                (double)width * height, "pixels",
+                [&]() {
+                  ComputeFlowGold(&I0[0], &I1[0], width, height, stride, alpha,
+                                  nLevels, nWarpIters, nSolverIters, &u[0],
+                                  &v[0]);
+                },
+                [&]() {
+                  return checksum(&u[0], u.size()) + checksum(&v[0], v.size());
+                });
+    }
+
+    bench.report();
+  }
+}
+
+static void benchMatrixMul(HostBench &bench) {
+  const int sizes[] = {128, 256, 512};
+
+  if (!bench.enabled("matrixMulGold")) return;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int n = sizes[s];
+    std::vector<float> A(n * n), B(n * n), C(n * n);
+    fillRandom(A, 0.0f, 1.0f);
+    fillRandom(B, 0.0f, 1.0f);
+
+    bench.run("matrixMulGold", sizeString(n, n), 2.0 * n * n * n, "flop",
+              [&]() { matrixMulGold(&C[0], &A[0], &B[0], n, n, n); },
+              [&]() { return checksum(&C[0], C.size()); });
+    bench.report();
+  }
+}
+
+static void benchImageFilters(HostBench &bench) {
+  const int sizes[] = {512, 1024, 2048};
+  // radius of the boxFilter sample, kernel of the convolutionFFT2D sample
+  const int boxRadius = 14;
+  const int kernelH = 7, kernelW = 6, kernelY = 3, kernelX = 4;
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int n = sizes[s];
+    const double pixels = (double)n * n;
+    std::vector<float> src(n * n), dst(n * n), image(n * n);
+    std::vector<float> kernel(KERNEL_LENGTH), kernel2D(kernelH * kernelW);
+    fillRandom(src, 0.0f, 1.0f);
+    fillRandom(kernel, 0.0f, 1.0f);
+    fillRandom(kernel2D, 0.0f, 1.0f);
+
+    if (bench.enabled("boxFilterGold")) {
+      // the filter works in place, the checksum is taken from one more call
+      // on the source image so that it does not depend on -reps
+      image = src;
+      bench.run("boxFilterGold", sizeString(n, n), pixels, "pixels",
+                [&]() { boxFilterGold(&image[0], &dst[0], n, n, boxRadius); },
+                [&]() {
+                  image = src;
+                  boxFilterGold(&image[0], &dst[0], n, n, boxRadius);
+                  return checksum(&image[0], image.size());
+                });
+      bench.report();
+    }
+
+    if (bench.enabled("convolutionSeparableCPU")) {
+      bench.run("convolutionSeparableCPU", sizeString(n, n), pixels, "pixels",
+                [&]() {
+                  convolutionSeparableCPU(&dst[0], &src[0], &kernel[0], n, n,
+                                          KERNEL_RADIUS);
+                },
+                [&]() { return checksum(&dst[0], dst.size()); });
+      bench.report();
+    }
+
+    if (bench.enabled("convolutionClampToBorderCPU")) {
+      bench.run("convolutionClampToBorderCPU", sizeString(n, n), pixels,
+                "pixels",
+                [&]() {
+                  convolutionClampToBorderCPU(&dst[0], &src[0], &kernel2D[0],
+                                              n, n, kernelH, kernelW, kernelY,
+                                              kernelX);
+                },
+                [&]() { return checksum(&dst[0], dst.size()); });
+      bench.report();
+    }
+
+    // the 3x3 and 5x5 kernels of the Winograd path
+    for (int r = 3; r <= 5; r += 2) {
+      if (!bench.enabled("convolutionSmallKernelCPU")) break;
+
+      char name[64];
+      snprintf(name, sizeof(name), "convolutionSmallKernelCPU/%dx%d", r, r);
+      bench.run(name, sizeString(n, n), pixels, "pixels",
+                [&]() {
+                  convolutionSmallKernelCPU(&dst[0], &src[0], &kernel2D[0], n,
+                                            n, r, r, r / 2, r / 2, 1, 1,
+                                            WINOGRAD_AUTO,
+                                            bench.config().numThreads);
+                },
+                [&]() { return checksum(&dst[0], dst.size()); });
+      bench.report();
+    }
+  }
+}
+
+static void benchQuasirandom(HostBench &bench) {
+  const int sizes[] = {256 * 1024, 1024 * 1024, 4 * 1024 * 1024};
+  static unsigned int table[QRNG_DIMENSIONS][QRNG_RESOLUTION];
+
+  initQuasirandomGenerator(table);
+
+  for (int s = 0; s < bench.sweep(3); s++) {
+    const int N = sizes[s];
+    std::vector<unsigned int> input(N);
+    std::vector<double> normal(N);
+    std::vector<float> uniform(QRNG_DIMENSIONS * N);
+
+    for (int i = 0; i < N; i++) input[i] = randomUint();
+
+    if (bench.enabled("getQuasirandomValue")) {
+      bench.run("getQuasirandomValue", sizeString(N),
+                (double)QRNG_DIMENSIONS * N, "samples",
+                [&]() {
+                  for (int dim = 0; dim < QRNG_DIMENSIONS; dim++)
+                    for (int i = 0; i < N; i++)
+                      uniform[dim * N + i] =
+                          getQuasirandomValue(table, i, dim);
+                },
+                [&]() { return checksum(&uniform[0], uniform.size()); });
+      bench.report();
+    }
+
+    if (bench.enabled("MoroInvCNDcpuArray")) {
+      bench.run("MoroInvCNDcpuArray", sizeString(N), N, "samples",
+                [&]() { MoroInvCNDcpuArray(&normal[0], &input[0], N); },
+                [&]() { return checksum(&normal[0], N); });
+      bench.report();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Machine fingerprint
+////////////////////////////////////////////////////////////////////////////////
+static std::string jsonString(const std::string &s) {
+  std::string r = "\"";
+
+  for (size_t i = 0; i < s.size(); i++) {
+    unsigned char c = (unsigned char)s[i];
+
+    if (c == '"' || c == '\\') {
+      r += '\\';
+      r += (char)c;
+    } else if (c < 0x20) {
+      char e[8];
+      snprintf(e, sizeof(e), "\\u%04x", c);
+      r += e;
+    } else {
+      r += (char)c;
+    }
+  }
+
+  return r + "\"";
+}
+
+// first line of a file, empty if it cannot be read
+static std::string readLine(const char *file) {
+  char line[256] = "";
+  FILE *fp = fopen(file, "r");
+
+  if (!fp) return "";
+
+  if (!fgets(line, sizeof(line), fp)) line[0] = 0;
+
+  fclose(fp);
+  line[strcspn(line, "\n")] = 0;
+  return line;
+}
+
+// value of the first "key : value" line of /proc/cpuinfo with the given key
+static std::string cpuInfo(const char *key) {
+  char line[4096];
+  std::string value;
+  FILE *fp = fopen("/proc/cpuinfo", "r");
+
+  if (!fp) return value;
+
+  while (fgets(line, sizeof(line), fp)) {
+    char *colon = strchr(line, ':');
+
+    if (!colon || strncmp(line, key, strlen(key))) continue;
+
+    value = colon + 1;
+    value.erase(0, value.find_first_not_of(" \t"));
+    value.erase(value.find_last_not_of(" \t\n") + 1);
+    break;
+  }
+
+  fclose(fp);
+  return value;
+}
+
+static void writeMachine(FILE *fp) {
+  const char *features[] = {"sse2",   "sse4_2", "avx",  "avx2",
+                            "fma",    "avx512f", "asimd", "sve"};
+  std::string flags = " " + cpuInfo("flags") + " " + cpuInfo("Features") + " ";
+  std::string model = cpuInfo("model name");
+  std::string simd;
+  long cpus = (long)std::thread::hardware_concurrency(), affinity = cpus;
+  double memory = 0.0;
+  long caches[3] = {0, 0, 0};
+  std::string os, arch, host;
+
+  for (size_t i = 0; i < sizeof(features) / sizeof(features[0]); i++) {
+    if (flags.find(std::string(" ") + features[i] + " ") == std::string::npos)
+      continue;
+
+    simd += (simd.empty() ? "" : " ") + std::string(features[i]);
+  }
+
+#if defined(__linux__)
+  struct utsname name;
+
+  if (uname(&name) == 0) {
+    os = std::string(name.sysname) + " " + name.release;
+    arch = name.machine;
+    host = name.nodename;
+  }
+
+  cpu_set_t set;
+
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) affinity = CPU_COUNT(&set);
+
+  memory = (double)sysconf(_SC_PHYS_PAGES) * (double)sysconf(_SC_PAGESIZE);
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+  caches[0] = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+  caches[1] = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  caches[2] = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#endif
+
+  if (model.empty()) model = cpuInfo("Model");
+
+  time_t now = time(NULL);
+  char timestamp[32] = "";
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+  fprintf(fp, "  \"machine\": {\n");
+  fprintf(fp, "    \"cpu\": %s,\n", jsonString(model).c_str());
+  fprintf(fp, "    \"simd\": %s,\n", jsonString(simd).c_str());
+  fprintf(fp, "    \"logical_cpus\": %ld,\n", cpus);
+  fprintf(fp, "    \"affinity_cpus\": %ld,\n", affinity);
+  fprintf(fp, "    \"memory_bytes\": %.0f,\n", memory);
+  fprintf(fp, "    \"l1d_bytes\": %ld,\n", (std::max)(caches[0], 0L));
+  fprintf(fp, "    \"l2_bytes\": %ld,\n", (std::max)(caches[1], 0L));
+  fprintf(fp, "    \"l3_bytes\": %ld,\n", (std::max)(caches[2], 0L));
+  fprintf(fp, "    \"governor\": %s,\n",
+          jsonString(readLine("/sys/devices/system/cpu/cpu0/cpufreq/"
+                              "scaling_governor"))
+              .c_str());
+  fprintf(fp, "    \"os\": %s,\n", jsonString(os).c_str());
+  fprintf(fp, "    \"arch\": %s,\n", jsonString(arch).c_str());
+  fprintf(fp, "    \"host\": %s\n  },\n", jsonString(host).c_str());
+  fprintf(fp, "  \"build\": {\n");
+#if defined(__clang__)
+  fprintf(fp, "    \"compiler\": %s,\n", jsonString(__VERSION__).c_str());
+#elif defined(__GNUC__)
+  fprintf(fp, "    \"compiler\": %s,\n",
+          jsonString("GCC " __VERSION__).c_str());
+#else
+  fprintf(fp, "    \"compiler\": \"\",\n");
+#endif
+  fprintf(fp, "    \"flags\": %s,\n", jsonString(HOSTBENCH_FLAGS).c_str());
+  fprintf(fp, "    \"revision\": %s\n  },\n",
+          jsonString(HOSTBENCH_REVISION).c_str());
+  fprintf(fp, "  \"timestamp\": \"%s\",\n", timestamp);
+}
+
+static bool writeJSON(const char *file, const HostBench &bench) {
+  FILE *fp = fopen(file, "w");
+
+  if (!fp) return false;
+
+  const BenchConfig &config = bench.config();
+  const std::vector<BenchResult> &results = bench.results();
+
+  fprintf(fp, "{\n  \"benchmark\": \"host_reference\",\n");
+  writeMachine(fp);
+  fprintf(fp,
+          "  \"config\": {\"warmup\": %d, \"repetitions\": %d, "
+          "\"threads\": %d, \"quick\": %s},\n",
+          config.warmup, config.repetitions, config.numThreads,
+          config.quick ? "true" : "false");
+  fprintf(fp, "  \"results\": [\n");
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult &r = results[i];
+    const std::vector<double> &t = r.seconds;
+    double p50 = percentile(t, 0.5);
+
+    fprintf(fp,
+            "    {\"engine\": %s, \"size\": %s, \"items\": %.0f, "
+            "\"unit\": %s, \"repetitions\": %zu, \"min_ms\": %.6f, "
+            "\"p50_ms\": %.6f, \"p90_ms\": %.6f, \"p99_ms\": %.6f, "
+            "\"max_ms\": %.6f, \"mean_ms\": %.6f, \"stddev_ms\": %.6f, "
+            "\"throughput\": %.6g, \"best_throughput\": %.6g, "
+            "\"checksum\": %.9g}%s\n",
+            jsonString(r.engine).c_str(), jsonString(r.size).c_str(),
+            r.items, jsonString(r.unit + "/s").c_str(), t.size(),
+            1e3 * t.front(), 1e3 * p50, 1e3 * percentile(t, 0.9),
+            1e3 * percentile(t, 0.99), 1e3 * t.back(), 1e3 * mean(t),
+            1e3 * stddev(t), r.items / p50, r.items / t.front(), r.checksum,
+            (i + 1 < results.size()) ? "," : "");
+  }
+
+  fprintf(fp, "  ]\n}\n");
+  fclose(fp);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Program main
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv) {
+  const char **args = (const char **)argv;
+  BenchConfig config;
+  char *jsonFile = NULL, *engine = NULL;
+
+  printf("%s Starting...\n\n", argv[0]);
+
+  if (checkCmdLineFlag(argc, args, "help")) {
+    printf("Usage: %s [options]\n", argv[0]);
+    printf("  -json=<file>    JSON output (default hostBench.json)\n");
+    printf("  -reps=<n>       timed repetitions per case (default 5)\n");
+    printf("  -warmup=<n>     untimed calls before the repetitions "
+           "(default 1)\n");
+    printf("  -threads=<n>    threads of the multithreaded engines "
+           "(default all)\n");
+    printf("  -engine=<name>  run the engines whose name contains <name>\n");
+    printf("  -quick          run the two smallest sizes of every sweep\n");
+    exit(EXIT_SUCCESS);
+  }
+
+  config.repetitions = 5;
+  config.warmup = 1;
+  config.numThreads = 0;
+  config.quick = checkCmdLineFlag(argc, args, "quick");
+  config.engine = NULL;
+
+  if (checkCmdLineFlag(argc, args, "reps"))
+    config.repetitions = (std::max)(1, getCmdLineArgumentInt(argc, args,
+                                                             "reps"));
+
+  if (checkCmdLineFlag(argc, args, "warmup"))
+    config.warmup = (std::max)(0, getCmdLineArgumentInt(argc, args,
+                                                        "warmup"));
+
+  if (checkCmdLineFlag(argc, args, "threads"))
+    config.numThreads = getCmdLineArgumentInt(argc, args, "threads");
+
+  if (getCmdLineArgumentString(argc, args, "engine", &engine))
+    config.engine = engine;
+
+  if (!getCmdLineArgumentString(argc, args, "json", &jsonFile))
+    jsonFile = (char *)"hostBench.json";
+
+  printf("%-30s %-10s %13s %13s %15s\n", "Engine", "Size", "Min",
+         "Median", "Throughput");
+
+  HostBench bench(config);
+  benchBlackScholes(bench);
+  benchBinomialOptions(bench);
+  benchHistogram(bench);
+  benchScan(bench);
+  benchMergeSort(bench);
+  benchFDTD3d(bench);
+  benchOpticalFlow(bench);
+  benchMatrixMul(bench);
+  benchImageFilters(bench);
+  benchQuasirandom(bench);
+
+  if (!writeJSON(jsonFile, bench)) {
+    fprintf(stderr, "Cannot write %s\n", jsonFile);
+    exit(EXIT_FAILURE);
+  }
+
+  printf("\n%zu cases written to %s\n", bench.results().size(), jsonFile);
+  exit(EXIT_SUCCESS);
+}
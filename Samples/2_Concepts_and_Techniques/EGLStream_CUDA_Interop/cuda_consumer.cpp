@@ -32,13 +32,12 @@
 #include "cuda_consumer.h"
 #include <helper_cuda_drvapi.h>
 #include "eglstrm_common.h"
+#include "frame_source.h"
 
 #if defined(EXTENSION_LIST)
 EXTENSION_LIST(EXTLST_EXTERN)
 #endif
 
-int checkbuf(FILE *fp1, FILE *fp2);
-
 CUresult cudaConsumerTest(test_cuda_consumer_s *data, char *fileName) {
   CUresult cuStatus = CUDA_SUCCESS;
   CUarray cudaArr = NULL;
@@ -46,7 +45,7 @@ CUresult cudaConsumerTest(test_cuda_consumer_s *data, char *fileName) {
   CUgraphicsResource cudaResource;
   unsigned int i;
   int check_result;
-  FILE *pInFile1 = NULL, *pInFile2 = NULL, *file_p = NULL;
+  FILE *file_p = NULL;
   EGLint streamState = 0;
 
   if (!data) {
@@ -192,21 +191,11 @@ CUresult cudaConsumerTest(test_cuda_consumer_s *data, char *fileName) {
           }
         }
       }
-      pInFile1 = fopen(data->fileName1, "rb");
-      if (!pInFile1) {
-        printf("Failed to open file :%s\n", data->fileName1);
-        goto done;
-      }
-      pInFile2 = fopen(data->fileName2, "rb");
-      if (!pInFile2) {
-        printf("Failed to open file :%s\n", data->fileName2);
-        goto done;
-      }
-      rewind(file_p);
-      check_result = checkbuf(file_p, pInFile1);
+      // the output file is compared through mappings of both files
+      fflush(file_p);
+      check_result = compareFiles(fileName, data->fileName1, 0);
       if (check_result == -1) {
-        rewind(file_p);
-        check_result = checkbuf(file_p, pInFile2);
+        check_result = compareFiles(fileName, data->fileName2, 0);
         if (check_result == -1) {
           printf("Frame received does not match any valid image: FAILED\n");
         } else {
@@ -237,42 +226,9 @@ done:
     fclose(file_p);
     file_p = NULL;
   }
-  if (pInFile1) {
-    fclose(pInFile1);
-    pInFile1 = NULL;
-  }
-  if (pInFile1) {
-    fclose(pInFile2);
-    pInFile2 = NULL;
-  }
   return cuStatus;
 }
 
-int checkbuf(FILE *fp1, FILE *fp2) {
-  int match = 0;
-  int ch1, ch2;
-  if (fp1 == NULL) {
-    printf("Invalid file pointer for first file\n");
-    return -1;
-  } else if (fp2 == NULL) {
-    printf("Invalid file pointer for second file\n");
-    return -1;
-  } else {
-    ch1 = getc(fp1);
-    ch2 = getc(fp2);
-    while ((ch1 != EOF) && (ch2 != EOF) && (ch1 == ch2)) {
-      ch1 = getc(fp1);
-      ch2 = getc(fp2);
-    }
-    if (ch1 == ch2) {
-      match = 1;
-    } else if (ch1 != ch2) {
-      match = -1;
-    }
-  }
-  return match;
-}
-
 CUresult cudaDeviceCreateConsumer(test_cuda_consumer_s *cudaConsumer,
                                   CUdevice device) {
   CUresult status = CUDA_SUCCESS;
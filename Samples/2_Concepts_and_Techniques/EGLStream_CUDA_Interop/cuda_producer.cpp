@@ -33,114 +33,28 @@
 #include <helper_cuda_drvapi.h>
 #include "cudaEGL.h"
 #include "eglstrm_common.h"
+#include "frame_source.h"
 
 #if defined(EXTENSION_LIST)
 EXTENSION_LIST(EXTLST_EXTERN)
 #endif
 
-static CUresult cudaProducerReadYUVFrame(FILE *file, unsigned int frameNum,
-                                         unsigned int width,
-                                         unsigned int height,
-                                         unsigned char *pBuff) {
-  int bOrderUV = 0;
-  unsigned char *pYBuff, *pUBuff, *pVBuff, *pChroma;
-  unsigned int frameSize = (width * height * 3) / 2;
-  CUresult ret = CUDA_SUCCESS;
-  unsigned int i;
-
-  if (!pBuff || !file) return CUDA_ERROR_FILE_NOT_FOUND;
-
-  pYBuff = pBuff;
-
-  // YVU order in the buffer
-  pVBuff = pYBuff + width * height;
-  pUBuff = pVBuff + width * height / 4;
-
-  if (fseek(file, frameNum * frameSize, SEEK_SET)) {
-    printf("ReadYUVFrame: Error seeking file: %p\n", file);
-    ret = CUDA_ERROR_NOT_PERMITTED;
-    goto done;
-  }
-  // read Y U V separately
-  for (i = 0; i < height; i++) {
-    if (fread(pYBuff, width, 1, file) != 1) {
-      printf("ReadYUVFrame: Error reading file: %p\n", file);
-      ret = CUDA_ERROR_NOT_PERMITTED;
-      goto done;
-    }
-    pYBuff += width;
-  }
-
-  pChroma = bOrderUV ? pUBuff : pVBuff;
-  for (i = 0; i < height / 2; i++) {
-    if (fread(pChroma, width / 2, 1, file) != 1) {
-      printf("ReadYUVFrame: Error reading file: %p\n", file);
-      ret = CUDA_ERROR_NOT_PERMITTED;
-      goto done;
-    }
-    pChroma += width / 2;
-  }
-
-  pChroma = bOrderUV ? pVBuff : pUBuff;
-  for (i = 0; i < height / 2; i++) {
-    if (fread(pChroma, width / 2, 1, file) != 1) {
-      printf("ReadYUVFrame: Error reading file: %p\n", file);
-      ret = CUDA_ERROR_NOT_PERMITTED;
-      goto done;
-    }
-    pChroma += width / 2;
-  }
-done:
-  return ret;
-}
-
-static CUresult cudaProducerReadARGBFrame(FILE *file, unsigned int frameNum,
-                                          unsigned int width,
-                                          unsigned int height,
-                                          unsigned char *pBuff) {
-  unsigned int frameSize = width * height * 4;
-  CUresult ret = CUDA_SUCCESS;
-
-  if (!pBuff || !file) return CUDA_ERROR_FILE_NOT_FOUND;
-
-  if (fseek(file, frameNum * frameSize, SEEK_SET)) {
-    printf("ReadYUVFrame: Error seeking file: %p\n", file);
-    ret = CUDA_ERROR_NOT_PERMITTED;
-    goto done;
-  }
-
-  // read ARGB data
-  if (fread(pBuff, frameSize, 1, file) != 1) {
-    if (feof(file))
-      printf("ReadARGBFrame: file read to the end\n");
-    else
-      printf("ReadARGBFrame: Error reading file: %p\n", file);
-    ret = CUDA_ERROR_NOT_PERMITTED;
-    goto done;
-  }
-done:
-  return ret;
-}
-
 CUresult cudaProducerTest(test_cuda_producer_s *cudaProducer, char *file) {
-  int framenum = 0;
+  // the clip of file mapped by cudaProducerInit
+  const int clip = (file == cudaProducer->fileName2) ? 1 : 0;
+  const frame_source_s *frameSource = &cudaProducer->frameSource[clip];
+  unsigned int framenum = cudaProducer->frameNum[clip];
   CUarray cudaArr[3] = {0};
   CUdeviceptr cudaPtr[3] = {0, 0, 0};
   unsigned int bufferSize;
   CUresult cuStatus = CUDA_SUCCESS;
-  unsigned int i, surfNum, uvOffset[3] = {0};
+  unsigned int i, surfNum;
   unsigned int copyWidthInBytes[3] = {0, 0, 0}, copyHeight[3] = {0, 0, 0};
   CUeglColorFormat eglColorFormat;
-  FILE *file_p;
+  frame_plane_s planes[3];
   CUeglFrame cudaEgl;
   CUcontext oldContext;
 
-  file_p = fopen(file, "rb");
-  if (!file_p) {
-    printf("CudaProducer: Error opening file: %s\n", file);
-    goto done;
-  }
-
   if (cudaProducer->pitchLinearOutput) {
     if (cudaProducer->isARGB) {
       cudaPtr[0] = cudaProducer->cudaPtrARGB[0];
@@ -164,42 +78,26 @@ CUresult cudaProducerTest(test_cuda_producer_s *cudaProducer, char *file) {
       }
     }
   }
-  uvOffset[0] = 0;
-  if (cudaProducer->isARGB) {
-    if (CUDA_SUCCESS !=
-        cudaProducerReadARGBFrame(file_p, framenum, cudaProducer->width,
-                                  cudaProducer->height, cudaProducer->pBuff)) {
-      printf("cuda producer, read ARGB frame failed\n");
-      goto done;
-    }
-    copyWidthInBytes[0] = cudaProducer->width * 4;
-    copyHeight[0] = cudaProducer->height;
-    surfNum = 1;
-    eglColorFormat = CU_EGL_COLOR_FORMAT_ARGB;
-  } else {
-    if (CUDA_SUCCESS !=
-        cudaProducerReadYUVFrame(file_p, framenum, cudaProducer->width,
-                                 cudaProducer->height, cudaProducer->pBuff)) {
-      printf("cuda producer, reading YUV frame failed\n");
-      goto done;
-    }
-    surfNum = 3;
-    eglColorFormat = CU_EGL_COLOR_FORMAT_YUV420_PLANAR;
-    copyWidthInBytes[0] = cudaProducer->width;
-    copyHeight[0] = cudaProducer->height;
-    copyWidthInBytes[1] = cudaProducer->width / 2;
-    copyHeight[1] = cudaProducer->height / 2;
-    copyWidthInBytes[2] = cudaProducer->width / 2;
-    copyHeight[2] = cudaProducer->height / 2;
-    uvOffset[1] = cudaProducer->width * cudaProducer->height;
-    uvOffset[2] =
-        uvOffset[1] + cudaProducer->width / 2 * cudaProducer->height / 2;
+  // the planes are copied straight from the mapped file
+  surfNum = frameSourceGetPlanes(frameSource, framenum, planes);
+  if (surfNum == 0) {
+    printf("cuda producer, reading %s frame failed\n",
+           cudaProducer->isARGB ? "ARGB" : "YUV");
+    cuStatus = CUDA_ERROR_NOT_PERMITTED;
+    goto done;
+  }
+  frameSourcePrefetch(frameSource, framenum + 1, 1);
+
+  for (i = 0; i < surfNum; i++) {
+    copyWidthInBytes[i] = planes[i].widthInBytes;
+    copyHeight[i] = planes[i].height;
   }
+  eglColorFormat = cudaProducer->isARGB ? CU_EGL_COLOR_FORMAT_ARGB
+                                        : CU_EGL_COLOR_FORMAT_YUV420_PLANAR;
   if (cudaProducer->pitchLinearOutput) {
     for (i = 0; i < surfNum; i++) {
-      cuStatus =
-          cuMemcpy(cudaPtr[i], (CUdeviceptr)(cudaProducer->pBuff + uvOffset[i]),
-                   copyWidthInBytes[i] * copyHeight[i]);
+      cuStatus = cuMemcpy(cudaPtr[i], (CUdeviceptr)planes[i].data,
+                          copyWidthInBytes[i] * copyHeight[i]);
 
       if (cuStatus != CUDA_SUCCESS) {
         printf("Cuda producer: cuMemCpy pitchlinear failed, cuStatus =%d\n",
@@ -208,13 +106,13 @@ CUresult cudaProducerTest(test_cuda_producer_s *cudaProducer, char *file) {
       }
     }
   } else {
-    // copy cudaProducer->pBuff to cudaArray
+    // copy the mapped planes to cudaArray
     CUDA_MEMCPY3D cpdesc;
     for (i = 0; i < surfNum; i++) {
       memset(&cpdesc, 0, sizeof(cpdesc));
       cpdesc.srcXInBytes = cpdesc.srcY = cpdesc.srcZ = cpdesc.srcLOD = 0;
       cpdesc.srcMemoryType = CU_MEMORYTYPE_HOST;
-      cpdesc.srcHost = (void *)(cudaProducer->pBuff + uvOffset[i]);
+      cpdesc.srcHost = (const void *)planes[i].data;
       cpdesc.dstXInBytes = cpdesc.dstY = cpdesc.dstZ = cpdesc.dstLOD = 0;
       cpdesc.dstMemoryType = CU_MEMORYTYPE_ARRAY;
       cpdesc.dstArray = cudaArr[i];
@@ -270,12 +168,10 @@ CUresult cudaProducerTest(test_cuda_producer_s *cudaProducer, char *file) {
   }
   numFramesPresented++;
 
-done:
-  if (file_p) {
-    fclose(file_p);
-    file_p = NULL;
-  }
+  // the next call presents the next frame, the clip repeats at its end
+  cudaProducer->frameNum[clip] = (framenum + 1) % frameSource->numFrames;
 
+done:
   return cuStatus;
 }
 
@@ -365,11 +261,6 @@ CUresult cudaDeviceCreateProducer(test_cuda_producer_s *cudaProducer,
     }
   }
 
-  cudaProducer->pBuff = (unsigned char *)malloc((WIDTH * HEIGHT * 4));
-  if (!cudaProducer->pBuff) {
-    printf("CudaProducer: Failed to allocate image buffer\n");
-  }
-
   checkCudaErrors(cuCtxPopCurrent(&cudaProducer->context));
   return status;
 }
@@ -388,10 +279,22 @@ void cudaProducerInit(test_cuda_producer_s *cudaProducer, EGLDisplay eglDisplay,
   // Set cudaProducer default parameters
   cudaProducer->eglDisplay = eglDisplay;
   cudaProducer->eglStream = eglStream;
+
+  // Map both clips once for all the frames of this run; frameSourceOpen
+  // reports a clip that cannot be mapped and cudaProducerTest fails on it
+  for (int i = 0; i < 2; i++) {
+    frameSourceClose(&cudaProducer->frameSource[i]);
+    frameSourceOpen(&cudaProducer->frameSource[i],
+                    i ? cudaProducer->fileName2 : cudaProducer->fileName1,
+                    cudaProducer->width, cudaProducer->height,
+                    cudaProducer->isARGB);
+    cudaProducer->frameNum[i] = 0;
+  }
 }
 
 CUresult cudaProducerDeinit(test_cuda_producer_s *cudaProducer) {
-  if (cudaProducer->pBuff) free(cudaProducer->pBuff);
+  frameSourceClose(&cudaProducer->frameSource[0]);
+  frameSourceClose(&cudaProducer->frameSource[1]);
 
   checkCudaErrors(cuMemFree(cudaProducer->cudaPtrARGB[0]));
   checkCudaErrors(cuMemFree(cudaProducer->cudaPtrYUV[0]));
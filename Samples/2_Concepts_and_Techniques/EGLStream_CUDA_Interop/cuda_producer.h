@@ -35,6 +35,7 @@
 #include <EGL/eglext.h>
 #include "cudaEGL.h"
 #include "eglstrm_common.h"
+#include "frame_source.h"
 
 extern EGLStreamKHR eglStream;
 extern EGLDisplay g_display;
@@ -43,7 +44,6 @@ typedef struct _test_cuda_producer_s {
   //  Stream params
   char *fileName1;
   char *fileName2;
-  unsigned char *pBuff;
   int frameCount;
   bool isARGB;
   bool pitchLinearOutput;
@@ -57,6 +57,8 @@ typedef struct _test_cuda_producer_s {
   CUarray cudaArrYUV[3];
   EGLStreamKHR eglStream;
   EGLDisplay eglDisplay;
+  frame_source_s frameSource[2];  // clips of fileName1 and fileName2
+  unsigned int frameNum[2];       // next frame of each clip
 } test_cuda_producer_s;
 
 void cudaProducerInit(test_cuda_producer_s *cudaProducer, EGLDisplay eglDisplay,
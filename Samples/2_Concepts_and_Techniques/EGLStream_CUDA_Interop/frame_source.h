@@ -0,0 +1,252 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// DESCRIPTION:   Memory mapped YUV/ARGB frame files and parallel compare
+//
+// A frame source maps a raw clip of YUV 420 planar or ARGB frames once and
+// hands out plane views that point into the mapping, so frames are read by
+// the copies that upload them instead of by fread into a staging buffer.
+// Frames are addressed by index; frameSourcePrefetch() asks the kernel to
+// read the next frames ahead (madvise MADV_WILLNEED).
+//
+// compareFiles() maps two files and compares them in chunks on several
+// threads, stopping all threads at the first difference.
+//
+
+#ifndef _FRAME_SOURCE_H_
+#define _FRAME_SOURCE_H_
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "cuda.h"
+
+// bytes compared by one task of compareFiles()
+#define FRAME_COMPARE_CHUNK (1 << 20)
+
+typedef struct _frame_plane_s {
+  const unsigned char *data;
+  unsigned int widthInBytes;
+  unsigned int height;
+  unsigned int pitch;
+} frame_plane_s;
+
+typedef struct _frame_source_s {
+  unsigned char *data;  // NULL when closed
+  size_t size;
+  size_t frameSize;
+  unsigned int numFrames;
+  unsigned int width;
+  unsigned int height;
+  bool isARGB;
+} frame_source_s;
+
+// Maps file read-only, the size does not have to be a multiple of the frame
+// size, a trailing partial frame is ignored
+static inline void *frameMapFile(const char *file, size_t *size) {
+  struct stat st;
+  void *data;
+  int fd = open(file, O_RDONLY);
+
+  *size = 0;
+
+  if (fd < 0) return NULL;
+
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return NULL;
+  }
+
+  data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED) return NULL;
+
+  *size = (size_t)st.st_size;
+  return data;
+}
+
+static inline CUresult frameSourceOpen(frame_source_s *src, const char *file,
+                                       unsigned int width, unsigned int height,
+                                       bool isARGB) {
+  memset(src, 0, sizeof(*src));
+
+  src->width = width;
+  src->height = height;
+  src->isARGB = isARGB;
+  src->frameSize = isARGB ? (size_t)width * height * 4
+                          : (size_t)width * height * 3 / 2;
+  src->data = (unsigned char *)frameMapFile(file, &src->size);
+
+  if (!src->data) {
+    printf("FrameSource: Error mapping file: %s\n", file);
+    return CUDA_ERROR_FILE_NOT_FOUND;
+  }
+
+  src->numFrames = (unsigned int)(src->size / src->frameSize);
+
+  if (src->numFrames == 0) {
+    printf("FrameSource: %s is smaller than one frame\n", file);
+    munmap(src->data, src->size);
+    src->data = NULL;
+    return CUDA_ERROR_INVALID_VALUE;
+  }
+
+  madvise(src->data, src->size, MADV_SEQUENTIAL);
+  return CUDA_SUCCESS;
+}
+
+static inline void frameSourceClose(frame_source_s *src) {
+  if (src->data) munmap(src->data, src->size);
+
+  src->data = NULL;
+  src->size = 0;
+  src->numFrames = 0;
+}
+
+// Starts reading frames [first, first + count) in the background
+static inline void frameSourcePrefetch(const frame_source_s *src,
+                                       unsigned int first,
+                                       unsigned int count) {
+  if (!src->data || first >= src->numFrames) return;
+
+  count = std::min(count, src->numFrames - first);
+
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t begin = first * src->frameSize / page * page;
+  size_t end = (first + count) * src->frameSize;
+
+  madvise(src->data + begin, end - begin, MADV_WILLNEED);
+}
+
+// Views of the planes of frame frameNum, returns the number of planes (1 for
+// ARGB, 3 for YUV 420 planar in file order) or 0 if there is no such frame
+static inline unsigned int frameSourceGetPlanes(const frame_source_s *src,
+                                                unsigned int frameNum,
+                                                frame_plane_s planes[3]) {
+  if (!src->data || frameNum >= src->numFrames) return 0;
+
+  const unsigned char *frame = src->data + frameNum * src->frameSize;
+
+  if (src->isARGB) {
+    planes[0].data = frame;
+    planes[0].widthInBytes = src->width * 4;
+    planes[0].height = src->height;
+    planes[0].pitch = src->width * 4;
+    return 1;
+  }
+
+  planes[0].data = frame;
+  planes[0].widthInBytes = src->width;
+  planes[0].height = src->height;
+  planes[0].pitch = src->width;
+
+  for (int i = 1; i < 3; i++) {
+    planes[i].data = frame + (size_t)src->width * src->height +
+                     (i - 1) * (size_t)(src->width / 2) * (src->height / 2);
+    planes[i].widthInBytes = src->width / 2;
+    planes[i].height = src->height / 2;
+    planes[i].pitch = src->width / 2;
+  }
+
+  return 3;
+}
+
+// Returns 1 if both files have the same contents and -1 otherwise, as
+// checkbuf(); numThreads <= 0 selects the number of hardware threads
+static inline int compareFiles(const char *file1, const char *file2,
+                               int numThreads) {
+  size_t size1, size2;
+  const unsigned char *data1 =
+      (const unsigned char *)frameMapFile(file1, &size1);
+  const unsigned char *data2 =
+      (const unsigned char *)frameMapFile(file2, &size2);
+  int match = -1;
+
+  if (!data1) {
+    printf("Failed to map file :%s\n", file1);
+  } else if (!data2) {
+    printf("Failed to map file :%s\n", file2);
+  } else if (size1 == size2) {
+    const size_t numChunks =
+        (size1 + FRAME_COMPARE_CHUNK - 1) / FRAME_COMPARE_CHUNK;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<bool> differ(false);
+
+    auto worker = [&]() {
+      for (size_t c = nextChunk++; c < numChunks && !differ; c = nextChunk++) {
+        size_t offset = c * FRAME_COMPARE_CHUNK;
+        size_t bytes = std::min((size_t)FRAME_COMPARE_CHUNK, size1 - offset);
+
+        if (memcmp(data1 + offset, data2 + offset, bytes) != 0) differ = true;
+      }
+    };
+
+    if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+    numThreads = (int)std::min((size_t)std::max(numThreads, 1), numChunks);
+
+    madvise((void *)data1, size1, MADV_SEQUENTIAL);
+    madvise((void *)data2, size2, MADV_SEQUENTIAL);
+
+    std::vector<std::thread> threads;
+
+    for (int t = 1; t < numThreads; t++) {
+      try {
+        threads.push_back(std::thread(worker));
+      } catch (const std::system_error &) {
+        // no thread support, this thread compares the remaining chunks
+        break;
+      }
+    }
+
+    worker();
+
+    for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+    match = differ ? -1 : 1;
+  }
+
+  if (data1) munmap((void *)data1, size1);
+
+  if (data2) munmap((void *)data2, size2);
+
+  return match;
+}
+
+#endif
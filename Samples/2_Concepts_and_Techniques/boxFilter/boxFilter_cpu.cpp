@@ -25,6 +25,10 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <helper_transpose.h>
+
+#include <vector>
+
 ////////////////////////////////////////////////////////////////////////////////
 // export C interface
 extern "C" void computeGold(float *id, float *od, int w, int h, int r);
@@ -69,43 +73,14 @@ void hboxfilter_x(float *id, float *od, int w, int h, int r) {
   }
 }
 
+// the column pass is the row pass of the transposed image, the transposes
+// replace the strided column walks
 void hboxfilter_y(float *id, float *od, int w, int h, int r) {
-  float scale = 1.0f / (2 * r + 1);
-
-  for (int x = 0; x < w; x++) {
-    float t;
-    // do left edge
-    t = id[x] * r;
-
-    for (int y = 0; y < r + 1; y++) {
-      t += id[y * w + x];
-    }
-
-    od[x] = t * scale;
-
-    for (int y = 1; y < r + 1; y++) {
-      int c = y * w + x;
-      t += id[c + r * w];
-      t -= id[x];
-      od[c] = t * scale;
-    }
-
-    // main loop
-    for (int y = r + 1; y < h - r; y++) {
-      int c = y * w + x;
-      t += id[c + r * w];
-      t -= id[c - (r * w) - w];
-      od[c] = t * scale;
-    }
+  std::vector<float> t0((size_t)w * h), t1((size_t)w * h);
 
-    // do right edge
-    for (int y = h - r; y < h; y++) {
-      int c = y * w + x;
-      t += id[(h - 1) * w + x];
-      t -= id[c - (r * w) - w];
-      od[c] = t * scale;
-    }
-  }
+  sdkTranspose(&t0[0], h, id, w, h, w);
+  hboxfilter_x(&t0[0], &t1[0], h, w, r);
+  sdkTranspose(od, w, &t1[0], h, w, h);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
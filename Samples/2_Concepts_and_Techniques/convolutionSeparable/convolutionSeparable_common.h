@@ -34,12 +34,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Reference CPU convolution
 ////////////////////////////////////////////////////////////////////////////////
-extern "C" void convolutionRowCPU(float *h_Dst, float *h_Src, float *h_Kernel,
-                                  int imageW, int imageH, int kernelR);
-
-extern "C" void convolutionColumnCPU(float *h_Dst, float *h_Src,
-                                     float *h_Kernel, int imageW, int imageH,
-                                     int kernelR);
+extern "C" void convolutionSeparableCPU(float *h_Dst, float *h_Src,
+                                        float *h_Kernel, int imageW,
+                                        int imageH, int kernelR);
 
 ////////////////////////////////////////////////////////////////////////////////
 // GPU convolution
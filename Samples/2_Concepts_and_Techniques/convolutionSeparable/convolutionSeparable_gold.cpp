@@ -25,45 +25,27 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "convolutionSeparable_common.h"
-
-////////////////////////////////////////////////////////////////////////////////
-// Reference row convolution filter
-////////////////////////////////////////////////////////////////////////////////
-extern "C" void convolutionRowCPU(float *h_Dst, float *h_Src, float *h_Kernel,
-                                  int imageW, int imageH, int kernelR) {
-  for (int y = 0; y < imageH; y++)
-    for (int x = 0; x < imageW; x++) {
-      float sum = 0;
-
-      for (int k = -kernelR; k <= kernelR; k++) {
-        int d = x + k;
+#include <helper_pyramid.h>
 
-        if (d >= 0 && d < imageW)
-          sum += h_Src[y * imageW + d] * h_Kernel[kernelR - k];
-      }
+#include <algorithm>
+#include <vector>
 
-      h_Dst[y * imageW + x] = sum;
-    }
-}
+#include "convolutionSeparable_common.h"
 
 ////////////////////////////////////////////////////////////////////////////////
-// Reference column convolution filter
+// Reference separable convolution filter, the rows and the columns are
+// filtered in one pass (see helper_pyramid.h)
 ////////////////////////////////////////////////////////////////////////////////
-extern "C" void convolutionColumnCPU(float *h_Dst, float *h_Src,
-                                     float *h_Kernel, int imageW, int imageH,
-                                     int kernelR) {
-  for (int y = 0; y < imageH; y++)
-    for (int x = 0; x < imageW; x++) {
-      float sum = 0;
-
-      for (int k = -kernelR; k <= kernelR; k++) {
-        int d = y + k;
-
-        if (d >= 0 && d < imageH)
-          sum += h_Src[d * imageW + x] * h_Kernel[kernelR - k];
-      }
-
-      h_Dst[y * imageW + x] = sum;
-    }
+extern "C" void convolutionSeparableCPU(float *h_Dst, float *h_Src,
+                                        float *h_Kernel, int imageW,
+                                        int imageH, int kernelR) {
+  // the filter engine correlates, the kernel is applied reversed
+  std::vector<float> taps(h_Kernel, h_Kernel + 2 * kernelR + 1);
+  std::reverse(taps.begin(), taps.end());
+
+  const sdkPyramidFilter filter(&taps[0], 2 * kernelR + 1, kernelR, 1,
+                                SDK_PYRAMID_BORDER_ZERO);
+  const sdkPyramidLevel levels[2] = {{h_Src, imageW, imageH, imageW},
+                                     {h_Dst, imageW, imageH, imageW}};
+  sdkPyramidSweep(levels, 2, filter);
 }
@@ -39,17 +39,6 @@
 
 #include "convolutionSeparable_common.h"
 
-////////////////////////////////////////////////////////////////////////////////
-// Reference CPU convolution
-////////////////////////////////////////////////////////////////////////////////
-extern "C" void convolutionRowCPU(float *h_Result, float *h_Data,
-                                  float *h_Kernel, int imageW, int imageH,
-                                  int kernelR);
-
-extern "C" void convolutionColumnCPU(float *h_Result, float *h_Data,
-                                     float *h_Kernel, int imageW, int imageH,
-                                     int kernelR);
-
 ////////////////////////////////////////////////////////////////////////////////
 // Main program
 ////////////////////////////////////////////////////////////////////////////////
@@ -57,7 +46,7 @@ int main(int argc, char **argv) {
   // start logs
   printf("[%s] - Starting...\n", argv[0]);
 
-  float *h_Kernel, *h_Input, *h_Buffer, *h_OutputCPU, *h_OutputGPU;
+  float *h_Kernel, *h_Input, *h_OutputCPU, *h_OutputGPU;
 
   float *d_Input, *d_Output, *d_Buffer;
 
@@ -77,7 +66,6 @@ int main(int argc, char **argv) {
   printf("Allocating and initializing host arrays...\n");
   h_Kernel = (float *)malloc(KERNEL_LENGTH * sizeof(float));
   h_Input = (float *)malloc(imageW * imageH * sizeof(float));
-  h_Buffer = (float *)malloc(imageW * imageH * sizeof(float));
   h_OutputCPU = (float *)malloc(imageW * imageH * sizeof(float));
   h_OutputGPU = (float *)malloc(imageW * imageH * sizeof(float));
   srand(200);
@@ -133,12 +121,9 @@ int main(int argc, char **argv) {
                              cudaMemcpyDeviceToHost));
 
   printf("Checking the results...\n");
-  printf(" ...running convolutionRowCPU()\n");
-  convolutionRowCPU(h_Buffer, h_Input, h_Kernel, imageW, imageH, KERNEL_RADIUS);
-
-  printf(" ...running convolutionColumnCPU()\n");
-  convolutionColumnCPU(h_OutputCPU, h_Buffer, h_Kernel, imageW, imageH,
-                       KERNEL_RADIUS);
+  printf(" ...running convolutionSeparableCPU()\n");
+  convolutionSeparableCPU(h_OutputCPU, h_Input, h_Kernel, imageW, imageH,
+                          KERNEL_RADIUS);
 
   printf(" ...comparing the results\n");
   double sum = 0, delta = 0;
@@ -158,7 +143,6 @@ int main(int argc, char **argv) {
   checkCudaErrors(cudaFree(d_Input));
   free(h_OutputGPU);
   free(h_OutputCPU);
-  free(h_Buffer);
   free(h_Input);
   free(h_Kernel);
 
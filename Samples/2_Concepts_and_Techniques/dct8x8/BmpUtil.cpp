@@ -37,6 +37,8 @@
 #include "Common.h"
 #include "BmpUtil.h"
 
+#include <helper_image_quality.h>
+
 #if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
 #pragma warning(disable : 4996)  // disable deprecated warning
 #endif
@@ -424,17 +426,13 @@ void DumpBlock(byte *Plane, int Stride, char *Fname) {
 * \return Mean Square Error between images
 */
 float CalculateMSE(byte *Img1, byte *Img2, int Stride, ROI Size) {
-  uint32 Acc = 0;
+  sdkImageQualityParams Params;
+  sdkImageQualityResult Result;
 
-  for (int i = 0; i < Size.height; i++) {
-    for (int j = 0; j < Size.width; j++) {
-      int TmpDiff = Img1[i * Stride + j] - Img2[i * Stride + j];
-      TmpDiff *= TmpDiff;
-      Acc += TmpDiff;
-    }
-  }
-
-  return ((float)Acc) / (Size.height * Size.width);
+  Params.ssimRadius = 0;
+  sdkImageQuality(Img1, Stride, Img2, Stride, Size.width, Size.height, Params,
+                  Result);
+  return (float)Result.mse;
 }
 
 /**
@@ -453,3 +451,24 @@ float CalculatePSNR(byte *Img1, byte *Img2, int Stride, ROI Size) {
   float MSE = CalculateMSE(Img1, Img2, Stride, Size);
   return 10 * log10(255 * 255 / MSE);
 }
+
+/**
+**************************************************************************
+*  This function performs evaluation of the mean Structural Similarity Index
+*  between two images, over 7x7 windows centered at every pixel
+*
+* \param Img1           [IN] - Image 1
+* \param Img2           [IN] - Image 2
+* \param Stride         [IN] - Image stride
+* \param Size           [IN] - Image size
+*
+* \return Mean SSIM between images, 1 for identical images
+*/
+float CalculateSSIM(byte *Img1, byte *Img2, int Stride, ROI Size) {
+  sdkImageQualityParams Params;
+  sdkImageQualityResult Result;
+
+  sdkImageQuality(Img1, Stride, Img2, Stride, Size.width, Size.height, Params,
+                  Result);
+  return (float)Result.ssim;
+}
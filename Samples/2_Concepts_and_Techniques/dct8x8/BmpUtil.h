@@ -122,4 +122,5 @@ void DumpBlockF(float *PlaneF, int StrideF, char *Fname);
 void DumpBlock(byte *Plane, int Stride, char *Fname);
 float CalculateMSE(byte *Img1, byte *Img2, int Stride, ROI Size);
 float CalculatePSNR(byte *Img1, byte *Img2, int Stride, ROI Size);
+float CalculateSSIM(byte *Img1, byte *Img2, int Stride, ROI Size);
 }
@@ -633,6 +633,18 @@ int main(int argc, char **argv) {
   printf("PSNR CPU(Gold 2) <---> GPU(CUDA short): %f\n",
          PSNR_DstGold2_DstCUDA16b);
 
+  // structural similarity of the decoded images to the original
+  printf("SSIM Original    <---> CPU(Gold 1)    : %f\n",
+         CalculateSSIM(ImgSrc, ImgDstGold1, ImgStride, ImgSize));
+  printf("SSIM Original    <---> CPU(Gold 2)    : %f\n",
+         CalculateSSIM(ImgSrc, ImgDstGold2, ImgStride, ImgSize));
+  printf("SSIM Original    <---> GPU(CUDA 1)    : %f\n",
+         CalculateSSIM(ImgSrc, ImgDstCUDA1, ImgStride, ImgSize));
+  printf("SSIM Original    <---> GPU(CUDA 2)    : %f\n",
+         CalculateSSIM(ImgSrc, ImgDstCUDA2, ImgStride, ImgSize));
+  printf("SSIM Original    <---> GPU(CUDA short): %f\n",
+         CalculateSSIM(ImgSrc, ImgDstCUDAshort, ImgStride, ImgSize));
+
   bool bTestResult = (PSNR_DstGold1_DstCUDA1 > PSNR_THRESHOLD_EQUAL &&
                       PSNR_DstGold2_DstCUDA2 > PSNR_THRESHOLD_EQUAL &&
                       PSNR_DstGold2_DstCUDA16b > PSNR_THRESHOLD_EQUAL);
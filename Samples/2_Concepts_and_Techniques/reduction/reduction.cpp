@@ -59,6 +59,13 @@
    perform a CPU final reduction (default 1)
     "-type=<T>":       The datatype for the reduction, where T is "int",
    "float", or "double" (default int)
+    "--autotune":      Search the threads per block and maximum number of
+   blocks for the kernel and size when they are not in the autotuning cache
+    "--retune":        Search them even if they are in the cache
+
+    Unless --threads or --maxblocks is given, launch parameters found by an
+    earlier --autotune run on the same machine are loaded from the cache
+    (see Common/helper_autotune.h).
 */
 
 // CUDA Runtime
@@ -67,6 +74,7 @@
 // Utilities and system includes
 #include <helper_cuda.h>
 #include <helper_functions.h>
+#include <helper_autotune.h>
 #include <algorithm>
 
 // includes, project
@@ -320,6 +328,80 @@ T benchmarkReduce(int n, int numThreads, int numBlocks, int maxThreads,
   return gpu_result;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Load the threads per block and maximum number of blocks of a kernel for n
+// elements from the autotuning cache, or search for them if tune is set.
+// d_idata must hold n elements, h_odata and d_odata maxNumBlocks elements.
+// maxThreads and maxBlocks are left unchanged if no configuration is found.
+////////////////////////////////////////////////////////////////////////////////
+template <class T>
+bool getTunedLaunchParams(int whichKernel, int n, ReduceType datatype,
+                          bool tune, bool retune, bool verbose,
+                          int maxNumBlocks, T *h_odata, T *d_idata, T *d_odata,
+                          int &maxThreads, int &maxBlocks) {
+  cudaDeviceProp prop;
+  int device;
+  checkCudaErrors(cudaGetDevice(&device));
+  checkCudaErrors(cudaGetDeviceProperties(&prop, device));
+
+  char engine[512];
+  snprintf(engine, sizeof(engine), "reduction_%s_kernel%d_%s",
+           getReduceTypeString(datatype), whichKernel, prop.name);
+
+  sdkAutoTuner tuner(engine);
+  tuner.setVerbose(verbose);
+
+  // the first values are the defaults of runTest
+  std::vector<int> threadValues = {256, 64, 128, 512};
+
+  if (whichKernel >= 7 && prop.maxThreadsPerBlock >= 1024) {
+    threadValues.push_back(1024);
+  }
+
+  tuner.addParam("threads", threadValues);
+
+  // only kernels >= 6 observe the maximum number of blocks
+  if (whichKernel >= 6) {
+    tuner.addParam("maxblocks", {64, 16, 32, 128, 256, 512});
+  }
+
+  StopWatchInterface *timer = 0;
+  sdkCreateTimer(&timer);
+
+  sdkAutoTuner::TimeFunction run = [&](const std::vector<int> &config) {
+    int threads = 0, blocks = 0;
+    int configBlocks = (config.size() > 1) ? config[1] : maxBlocks;
+
+    getNumBlocksAndThreads(whichKernel, n, configBlocks, config[0], blocks,
+                           threads);
+
+    if (blocks > MAX_BLOCK_DIM_SIZE || blocks > maxNumBlocks) {
+      return -1.0f;
+    }
+
+    sdkResetTimer(&timer);
+    benchmarkReduce<T>(n, threads, blocks, config[0], configBlocks,
+                       whichKernel, 10, false, 1, timer, h_odata, d_idata,
+                       d_odata);
+
+    return sdkGetAverageTimerValue(&timer);
+  };
+
+  std::vector<int> config;
+  bool found = tune ? tuner.getConfig(n, run, config, retune)
+                    : tuner.lookup(n, config);
+
+  sdkDeleteTimer(&timer);
+
+  if (found) {
+    maxThreads = config[0];
+
+    if (config.size() > 1) maxBlocks = config[1];
+  }
+
+  return found;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // This function calls benchmarkReduce multiple times for a range of array sizes
 // and prints a report in CSV (comma-separated value) format that can be used
@@ -328,7 +410,7 @@ T benchmarkReduce(int n, int numThreads, int numBlocks, int maxThreads,
 ////////////////////////////////////////////////////////////////////////////////
 template <class T>
 void shmoo(int minN, int maxN, int maxThreads, int maxBlocks,
-           ReduceType datatype) {
+           ReduceType datatype, bool useTuner, bool tune, bool retune) {
   // create random input data on CPU
   unsigned int bytes = maxN * sizeof(T);
 
@@ -384,18 +466,27 @@ void shmoo(int minN, int maxN, int maxThreads, int maxBlocks,
     printf("\n%d", kernel);
 
     for (int i = minN; i <= maxN; i *= 2) {
+      int kernelThreads = maxThreads;
+      int kernelBlocks = maxBlocks;
+
+      if (useTuner) {
+        getTunedLaunchParams<T>(kernel, i, datatype, tune, retune, false,
+                                maxNumBlocks, h_odata, d_idata, d_odata,
+                                kernelThreads, kernelBlocks);
+      }
+
       sdkResetTimer(&timer);
       int numBlocks = 0;
       int numThreads = 0;
-      getNumBlocksAndThreads(kernel, i, maxBlocks, maxThreads, numBlocks,
+      getNumBlocksAndThreads(kernel, i, kernelBlocks, kernelThreads, numBlocks,
                              numThreads);
 
       float reduceTime;
 
       if (numBlocks <= MAX_BLOCK_DIM_SIZE) {
-        benchmarkReduce(i, numThreads, numBlocks, maxThreads, maxBlocks, kernel,
-                        testIterations, false, 1, timer, h_odata, d_idata,
-                        d_odata);
+        benchmarkReduce(i, numThreads, numBlocks, kernelThreads, kernelBlocks,
+                        kernel, testIterations, false, 1, timer, h_odata,
+                        d_idata, d_odata);
         reduceTime = sdkGetAverageTimerValue(&timer);
       } else {
         reduceTime = -1.0;
@@ -425,6 +516,7 @@ bool runTest(int argc, char **argv, ReduceType datatype) {
   int maxBlocks = 64;
   bool cpuFinalReduction = false;
   int cpuFinalThreshold = 1;
+  bool useTuner = true;
 
   if (checkCmdLineFlag(argc, (const char **)argv, "n")) {
     size = getCmdLineArgumentInt(argc, (const char **)argv, "n");
@@ -432,6 +524,7 @@ bool runTest(int argc, char **argv, ReduceType datatype) {
 
   if (checkCmdLineFlag(argc, (const char **)argv, "threads")) {
     maxThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+    useTuner = false;
   }
 
   if (checkCmdLineFlag(argc, (const char **)argv, "kernel")) {
@@ -440,8 +533,12 @@ bool runTest(int argc, char **argv, ReduceType datatype) {
 
   if (checkCmdLineFlag(argc, (const char **)argv, "maxblocks")) {
     maxBlocks = getCmdLineArgumentInt(argc, (const char **)argv, "maxblocks");
+    useTuner = false;
   }
 
+  bool retune = checkCmdLineFlag(argc, (const char **)argv, "retune");
+  bool tune = retune || checkCmdLineFlag(argc, (const char **)argv, "autotune");
+
   printf("%d elements\n", size);
   printf("%d threads (max)\n", maxThreads);
 
@@ -455,7 +552,8 @@ bool runTest(int argc, char **argv, ReduceType datatype) {
   bool runShmoo = checkCmdLineFlag(argc, (const char **)argv, "shmoo");
 
   if (runShmoo) {
-    shmoo<T>(1, 33554432, maxThreads, maxBlocks, datatype);
+    shmoo<T>(1, 33554432, maxThreads, maxBlocks, datatype, useTuner, tune,
+             retune);
   } else {
     // create random input data on CPU
     unsigned int bytes = size * sizeof(T);
@@ -471,6 +569,36 @@ bool runTest(int argc, char **argv, ReduceType datatype) {
       }
     }
 
+    // allocate device memory and data
+    T *d_idata = NULL;
+    T *d_odata = NULL;
+
+    checkCudaErrors(cudaMalloc((void **)&d_idata, bytes));
+
+    // copy data directly to device memory
+    checkCudaErrors(
+        cudaMemcpy(d_idata, h_idata, bytes, cudaMemcpyHostToDevice));
+
+    if (useTuner) {
+      // room for the partial sums of the smallest block size searched
+      int maxNumBlocks = (size + 63) / 64;
+      T *h_tuneData = (T *)malloc(maxNumBlocks * sizeof(T));
+      T *d_tuneData = NULL;
+
+      checkCudaErrors(
+          cudaMalloc((void **)&d_tuneData, maxNumBlocks * sizeof(T)));
+
+      if (getTunedLaunchParams<T>(whichKernel, size, datatype, tune, retune,
+                                  true, maxNumBlocks, h_tuneData, d_idata,
+                                  d_tuneData, maxThreads, maxBlocks)) {
+        printf("%d threads (max), %d blocks (max) from autotuning\n",
+               maxThreads, maxBlocks);
+      }
+
+      free(h_tuneData);
+      checkCudaErrors(cudaFree(d_tuneData));
+    }
+
     int numBlocks = 0;
     int numThreads = 0;
     getNumBlocksAndThreads(whichKernel, size, maxBlocks, maxThreads, numBlocks,
@@ -485,16 +613,7 @@ bool runTest(int argc, char **argv, ReduceType datatype) {
 
     printf("%d blocks\n\n", numBlocks);
 
-    // allocate device memory and data
-    T *d_idata = NULL;
-    T *d_odata = NULL;
-
-    checkCudaErrors(cudaMalloc((void **)&d_idata, bytes));
     checkCudaErrors(cudaMalloc((void **)&d_odata, numBlocks * sizeof(T)));
-
-    // copy data directly to device memory
-    checkCudaErrors(
-        cudaMemcpy(d_idata, h_idata, bytes, cudaMemcpyHostToDevice));
     checkCudaErrors(cudaMemcpy(d_odata, h_idata, numBlocks * sizeof(T),
                                cudaMemcpyHostToDevice));
 
@@ -35,6 +35,7 @@
 #include <cuda.h>
 #define CUDA_DRIVER_API
 #include "helper_cuda.h"
+#include "helper_membench.h"
 #include "compMalloc.h"
 
 __global__ void saxpy(const float a, const float4 *x, const float4 *y, float4 *z, const size_t n)
@@ -106,6 +107,49 @@ void launchSaxpy(const float a, float4 *x, float4 *y, float4 *z, const size_t n,
     printf("Running saxpy with %d blocks x %d threads = %.3f ms %.3f TB/s\n", blocks.x, threads.x, ms, (size*3)/ms/1e9);
 }
 
+// Host memory bandwidth suite, the CPU counterpart of the saxpy timing above.
+// Runs without a GPU.
+int runHostBenchmark(int argc, char **argv)
+{
+    sdkMemBenchConfig config;
+    char *jsonFile = NULL;
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "size"))
+    {
+        config.bytesPerArray = (size_t)getCmdLineArgumentInt(argc, (const char **)argv, "size") << 20;
+    }
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "threads"))
+    {
+        // 1, 2, 4, ... up to the given number of threads
+        int maxThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+        for (int t = 1; t < maxThreads; t *= 2)
+        {
+            config.threadCounts.push_back(t);
+        }
+        config.threadCounts.push_back(maxThreads > 0 ? maxThreads : 1);
+    }
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "reps"))
+    {
+        config.repetitions = getCmdLineArgumentInt(argc, (const char **)argv, "reps");
+    }
+
+    if (getCmdLineArgumentString(argc, (const char **)argv, "json", &jsonFile))
+    {
+        config.jsonFile = jsonFile;
+    }
+
+    if (config.bytesPerArray == 0 || config.repetitions < 1)
+    {
+        printf("Invalid -size or -reps\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<sdkMemBenchResult> results = sdkMemBenchRun(config);
+    return results.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv)
 {
     const size_t n = 10485760;
@@ -113,9 +157,16 @@ int main(int argc, char **argv)
     if (checkCmdLineFlag(argc, (const char **)argv, "help") ||
             checkCmdLineFlag(argc, (const char **)argv, "?")) {
         printf("Usage -device=n (n >= 0 for deviceID)\n");
+        printf("      -host [-size=MB] [-threads=n] [-reps=n] [-json=file]\n");
+        printf("            host memory benchmarks instead of the GPU saxpy\n");
         exit(EXIT_SUCCESS);
     }
 
+    if (checkCmdLineFlag(argc, (const char **)argv, "host"))
+    {
+        exit(runHostBenchmark(argc, argv));
+    }
+
     findCudaDevice(argc, (const char**)argv);
     CUdevice currentDevice;
     checkCudaErrors(cuCtxGetDevice(&currentDevice));
@@ -39,10 +39,15 @@
 
 #include <cuda_runtime.h>
 #include <helper_cuda.h>
+#include <helper_task_graph.h>
 #include <helper_timer.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
 #include "jacobi.h"
 
 // Run the Jacobi method for A*x = b on GPU with CUDA Graph -
@@ -71,6 +76,13 @@ void createLinearSystem(float *A, double *b);
 void JacobiMethodCPU(float *A, double *b, float conv_threshold, int max_iter,
                      int *numit, double *x);
 
+// Run the Jacobi method for A*x = b on CPU threads, with a host task graph
+// instantiated once (cpumethod 0 and 1) or with threads created for every
+// iteration (cpumethod 2).
+void JacobiMethodCPUThreads(float *A, double *b, float conv_threshold,
+                            int max_iter, int *numit, double *x, int cpumethod,
+                            int numThreads);
+
 int main(int argc, char **argv) {
   if (checkCmdLineFlag(argc, (const char **)argv, "help")) {
     printf("Command line: jacobiCudaGraphs [-option]\n");
@@ -80,6 +92,17 @@ int main(int argc, char **argv) {
         "JacobiMethodGpuCudaGraphExecKernelSetParams\n");
     printf("                       : 1 - JacobiMethodGpuCudaGraphExecUpdate\n");
     printf("                       : 2 - JacobiMethodGpu - Non CUDA Graph\n");
+    printf(
+        "-cpumethod=<0,1 or 2>  : also run the Jacobi method on CPU threads\n");
+    printf(
+        "                       : 0 - host task graph with "
+        "sdkTaskGraphExec::setNodeArgs\n");
+    printf(
+        "                       : 1 - host task graph with "
+        "sdkTaskGraphExec::update\n");
+    printf(
+        "                       : 2 - threads created for every iteration\n");
+    printf("-cputhreads=n          : number of CPU threads, default all\n");
     printf("-device=device_num     : cuda device id");
     printf("-help         : Output a help message\n");
     exit(EXIT_SUCCESS);
@@ -96,6 +119,22 @@ int main(int argc, char **argv) {
     }
   }
 
+  int cpumethod = -1;
+  if (checkCmdLineFlag(argc, (const char **)argv, "cpumethod")) {
+    cpumethod = getCmdLineArgumentInt(argc, (const char **)argv, "cpumethod");
+
+    if (cpumethod < 0 || cpumethod > 2) {
+      printf("Error: cpumethod must be 0 or 1 or 2, cpumethod=%d is invalid\n",
+             cpumethod);
+      exit(EXIT_SUCCESS);
+    }
+  }
+
+  int cputhreads = 0;
+  if (checkCmdLineFlag(argc, (const char **)argv, "cputhreads")) {
+    cputhreads = getCmdLineArgumentInt(argc, (const char **)argv, "cputhreads");
+  }
+
   int dev = findCudaDevice(argc, (const char **)argv);
 
   double *b = NULL;
@@ -132,6 +171,33 @@ int main(int argc, char **argv) {
   printf("CPU error : %.3e\n", sum);
   printf("CPU Processing time: %f (ms)\n", sdkGetTimerValue(&timerCPU));
 
+  if (cpumethod >= 0) {
+    static const char *cpuMethodNames[] = {"task graph, setNodeArgs",
+                                           "task graph, update",
+                                           "threads per iteration"};
+    double *xThreads = (double *)calloc(N_ROWS, sizeof(double));
+    int cntThreads = 0;
+
+    sdkResetTimer(&timerCPU);
+    sdkStartTimer(&timerCPU);
+    JacobiMethodCPUThreads(A, b, conv_threshold, max_iter, &cntThreads,
+                           xThreads, cpumethod, cputhreads);
+    sdkStopTimer(&timerCPU);
+
+    double sumThreads = 0.0;
+    for (int i = 0; i < N_ROWS; i++) {
+      sumThreads += fabs(xThreads[i] - 1.0);
+    }
+
+    printf("CPU threads (%s) iterations : %d\n", cpuMethodNames[cpumethod],
+           cntThreads);
+    printf("CPU threads error : %.3e\n", sumThreads);
+    printf("CPU threads Processing time: %f (ms), %f (us) per iteration\n",
+           sdkGetTimerValue(&timerCPU),
+           1000.0 * sdkGetTimerValue(&timerCPU) / cntThreads);
+    free(xThreads);
+  }
+
   float *d_A;
   double *d_b, *d_x, *d_x_new;
   cudaStream_t stream1;
@@ -213,3 +279,98 @@ void JacobiMethodCPU(float *A, double *b, float conv_threshold, int max_iter,
   *num_iter = k + 1;
   free(x_new);
 }
+
+// Arguments of one Jacobi iteration, x_new = x + D^-1 (b - A*x)
+struct JacobiIterationArgs {
+  const float *A;
+  const double *b;
+  const double *x;
+  double *x_new;
+};
+
+// Updates the rows [begin, end) and returns their sum of |x_new - x|
+static double JacobiRowsCPU(int begin, int end, void *args) {
+  const JacobiIterationArgs *p = (const JacobiIterationArgs *)args;
+  double sum = 0.0;
+
+  for (int i = begin; i < end; i++) {
+    const float *row = p->A + (size_t)i * N_ROWS;
+    double temp_dx = p->b[i];
+    for (int j = 0; j < N_ROWS; j++) temp_dx -= row[j] * p->x[j];
+    temp_dx /= row[i];
+    p->x_new[i] = p->x[i] + temp_dx;
+    sum += fabs(temp_dx);
+  }
+
+  return sum;
+}
+
+void JacobiMethodCPUThreads(float *A, double *b, float conv_threshold,
+                            int max_iter, int *num_iter, double *x,
+                            int cpumethod, int numThreads) {
+  double *x_new = (double *)calloc(N_ROWS, sizeof(double));
+  double sum = 0.0;
+  int k;
+
+  // x and x_new swap roles every iteration instead of being copied
+  JacobiIterationArgs args[2] = {{A, b, x, x_new}, {A, b, x_new, x}};
+
+  if (cpumethod == 2) {
+    if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+    numThreads = (std::max)(1, (std::min)(numThreads, N_ROWS));
+
+    std::vector<double> partial(numThreads);
+
+    for (k = 0; k < max_iter; k++) {
+      std::vector<std::thread> threads;
+
+      for (int t = 1; t < numThreads; t++) {
+        threads.push_back(std::thread([&, t]() {
+          partial[t] =
+              JacobiRowsCPU(N_ROWS * t / numThreads,
+                            N_ROWS * (t + 1) / numThreads, &args[k & 1]);
+        }));
+      }
+
+      partial[0] = JacobiRowsCPU(0, N_ROWS / numThreads, &args[k & 1]);
+
+      for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+      sum = 0.0;
+      for (int t = 0; t < numThreads; t++) sum += partial[t];
+
+      if (sum <= conv_threshold) break;
+    }
+  } else {
+    // one reduction node, recorded once and replayed every iteration
+    sdkTaskGraph graph;
+    sdkTaskGraphExec graphExec;
+    int node = graph.addReduce(N_ROWS, JacobiRowsCPU, &args[0], &sum);
+    graphExec.instantiate(graph, numThreads);
+
+    for (k = 0; k < max_iter; k++) {
+      if (cpumethod == 0) {
+        graphExec.setNodeArgs(node, &args[k & 1]);
+      } else {
+        // record the iteration again and update the instantiated graph
+        sdkTaskGraph iteration;
+        iteration.addReduce(N_ROWS, JacobiRowsCPU, &args[k & 1], &sum);
+
+        if (!graphExec.update(iteration)) {
+          graphExec.instantiate(iteration, numThreads);
+        }
+      }
+
+      graphExec.launch();
+
+      if (sum <= conv_threshold) break;
+    }
+  }
+
+  // the last iteration wrote x_new when k is even
+  if (k == max_iter) k--;
+  if ((k & 1) == 0) memcpy(x, x_new, N_ROWS * sizeof(double));
+
+  *num_iter = k + 1;
+  free(x_new);
+}
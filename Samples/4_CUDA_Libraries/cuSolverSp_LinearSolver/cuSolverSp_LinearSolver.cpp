@@ -69,6 +69,16 @@
  condition number of A.
  *     The relative error on residual should be close to machine zero,
  i.e. 1.e-15.
+ *
+ *  Mixed-precision iterative refinement (-ir)
+ *     B is factored once in single precision with the low level host API,
+ *     then
+ *        r = Q*b - B*z     (double, threaded host SpMV)
+ *        B*d = r           (single, reusing the factor)
+ *        z = z + d         (double)
+ *     is repeated until |r|/(|B|*|z| + |b|) <= ir_tol. For well-conditioned
+ *     systems a few sweeps reach double precision accuracy while the factor
+ *     moves half of the memory traffic of the double factor.
  */
 
 #include <assert.h>
@@ -77,9 +87,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <thread>
+#include <vector>
+
 #include <cuda_runtime.h>
 
 #include "cusolverSp.h"
+#include "cusolverSp_LOWLEVEL_PREVIEW.h"
 #include "cusparse.h"
 
 #include "helper_cuda.h"
@@ -103,10 +117,203 @@ void UsageSP(void) {
   printf("              metis  (nested dissection)\n");
   printf("-file=<filename> : filename containing a matrix in MM format\n");
   printf("-device=<device_id> : <device_id> if want to run on specific GPU\n");
+  printf("-ir         : also run mixed-precision iterative refinement on CPU\n");
+  printf("-ir_tol=<tol>   : tolerance of |b - A*x|/(|A|*|x| + |b|), 1.e-14 by default\n");
+  printf("-ir_maxit=<n>   : maximum number of refinement sweeps, 20 by default\n");
+  printf("-threads=<n>    : number of threads of the host SpMV\n");
 
   exit(0);
 }
 
+/* r = b - B*z in double, one contiguous band of rows per thread */
+static void csrResidualHost(int n, int baseB, const double *csrValB,
+                            const int *csrRowPtrB, const int *csrColIndB,
+                            const double *b, const double *z, double *r,
+                            int numThreads) {
+  auto band = [&](int rowStart, int rowEnd) {
+    for (int row = rowStart; row < rowEnd; row++) {
+      double sum = b[row];
+      for (int p = csrRowPtrB[row] - baseB; p < csrRowPtrB[row + 1] - baseB;
+           p++) {
+        sum -= csrValB[p] * z[csrColIndB[p] - baseB];
+      }
+      r[row] = sum;
+    }
+  };
+
+  if (numThreads <= 1) {
+    band(0, n);
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < numThreads; t++) {
+    workers.push_back(std::thread(band, (int)((long long)n * t / numThreads),
+                                  (int)((long long)n * (t + 1) / numThreads)));
+  }
+  for (int t = 0; t < numThreads; t++) {
+    workers[t].join();
+  }
+}
+
+/*
+ * Solves B*z = Qb by iterative refinement on top of a single precision
+ * factorization of B. Returns the number of refinement sweeps, or -1 if the
+ * factorization failed. time_factor and time_refine are in seconds.
+ */
+static int refineMixedPrecisionHost(
+    cusolverSpHandle_t handle, const char *testFunc, int n, int nnz,
+    cusparseMatDescr_t descrB, const double *h_csrValB,
+    const int *h_csrRowPtrB, const int *h_csrColIndB, const double *h_Qb,
+    double *h_z, double ir_tol, int ir_maxit, int numThreads,
+    double *time_factor, double *time_refine, double *backward_error) {
+  const int baseB =
+      (CUSPARSE_INDEX_BASE_ONE == cusparseGetMatIndexBase(descrB)) ? 1 : 0;
+  const float tol = 1.e-6f;
+  const float pivot_threshold = 1.0f;
+  const float mu = 0.0f;
+  int singularity = 0;
+  int iters = 0;
+  double start;
+
+  csrcholInfoHost_t chol_info = NULL;
+  csrluInfoHost_t lu_info = NULL;
+  csrqrInfoHost_t qr_info = NULL;
+  size_t size_internal = 0;
+  size_t size_work = 0;
+  void *buffer = NULL;
+
+  float *h_csrValBf = (float *)malloc(sizeof(float) * nnz);
+  float *h_rf = (float *)malloc(sizeof(float) * n);
+  float *h_df = (float *)malloc(sizeof(float) * n);
+  double *h_r = (double *)malloc(sizeof(double) * n);
+  assert(NULL != h_csrValBf);
+  assert(NULL != h_rf);
+  assert(NULL != h_df);
+  assert(NULL != h_r);
+
+  start = second();
+  for (int j = 0; j < nnz; j++) {
+    h_csrValBf[j] = (float)h_csrValB[j];
+  }
+
+  if (0 == strcmp(testFunc, "chol")) {
+    checkCudaErrors(cusolverSpCreateCsrcholInfoHost(&chol_info));
+    checkCudaErrors(cusolverSpXcsrcholAnalysisHost(
+        handle, n, nnz, descrB, h_csrRowPtrB, h_csrColIndB, chol_info));
+    checkCudaErrors(cusolverSpScsrcholBufferInfoHost(
+        handle, n, nnz, descrB, h_csrValBf, h_csrRowPtrB, h_csrColIndB,
+        chol_info, &size_internal, &size_work));
+    buffer = malloc(size_work);
+    assert(NULL != buffer);
+    checkCudaErrors(cusolverSpScsrcholFactorHost(
+        handle, n, nnz, descrB, h_csrValBf, h_csrRowPtrB, h_csrColIndB,
+        chol_info, buffer));
+    checkCudaErrors(cusolverSpScsrcholZeroPivotHost(handle, chol_info, tol,
+                                                    &singularity));
+  } else if (0 == strcmp(testFunc, "lu")) {
+    checkCudaErrors(cusolverSpCreateCsrluInfoHost(&lu_info));
+    checkCudaErrors(cusolverSpXcsrluAnalysisHost(
+        handle, n, nnz, descrB, h_csrRowPtrB, h_csrColIndB, lu_info));
+    checkCudaErrors(cusolverSpScsrluBufferInfoHost(
+        handle, n, nnz, descrB, h_csrValBf, h_csrRowPtrB, h_csrColIndB,
+        lu_info, &size_internal, &size_work));
+    buffer = malloc(size_work);
+    assert(NULL != buffer);
+    checkCudaErrors(cusolverSpScsrluFactorHost(
+        handle, n, nnz, descrB, h_csrValBf, h_csrRowPtrB, h_csrColIndB,
+        lu_info, pivot_threshold, buffer));
+    checkCudaErrors(
+        cusolverSpScsrluZeroPivotHost(handle, lu_info, tol, &singularity));
+  } else {
+    checkCudaErrors(cusolverSpCreateCsrqrInfoHost(&qr_info));
+    checkCudaErrors(cusolverSpXcsrqrAnalysisHost(
+        handle, n, n, nnz, descrB, h_csrRowPtrB, h_csrColIndB, qr_info));
+    checkCudaErrors(cusolverSpScsrqrBufferInfoHost(
+        handle, n, n, nnz, descrB, h_csrValBf, h_csrRowPtrB, h_csrColIndB,
+        qr_info, &size_internal, &size_work));
+    buffer = malloc(size_work);
+    assert(NULL != buffer);
+    checkCudaErrors(cusolverSpScsrqrSetupHost(handle, n, n, nnz, descrB,
+                                              h_csrValBf, h_csrRowPtrB,
+                                              h_csrColIndB, mu, qr_info));
+    checkCudaErrors(cusolverSpScsrqrFactorHost(handle, n, n, nnz, NULL, NULL,
+                                               qr_info, buffer));
+    checkCudaErrors(
+        cusolverSpScsrqrZeroPivotHost(handle, qr_info, tol, &singularity));
+  }
+  *time_factor = second() - start;
+
+  if (0 <= singularity) {
+    printf("WARNING: the single precision factor is singular at row %d\n",
+           singularity);
+    iters = -1;
+  } else {
+    start = second();
+    const double b_inf = vec_norminf(n, h_Qb);
+    double B_inf = 0.0;
+    for (int row = 0; row < n; row++) {
+      double sum = 0.0;
+      for (int p = h_csrRowPtrB[row] - baseB; p < h_csrRowPtrB[row + 1] - baseB;
+           p++) {
+        sum += fabs(h_csrValB[p]);
+      }
+      B_inf = (B_inf > sum) ? B_inf : sum;
+    }
+
+    memset(h_z, 0, sizeof(double) * n);
+    for (;;) {
+      /* r = Q*b - B*z in double */
+      csrResidualHost(n, baseB, h_csrValB, h_csrRowPtrB, h_csrColIndB, h_Qb,
+                      h_z, h_r, numThreads);
+      *backward_error =
+          vec_norminf(n, h_r) / (B_inf * vec_norminf(n, h_z) + b_inf);
+      printf("        sweep %2d: |b - A*x|/(|A|*|x| + |b|) = %E\n", iters,
+             *backward_error);
+      if ((*backward_error <= ir_tol) || (iters >= ir_maxit)) {
+        break;
+      }
+
+      /* B*d = r in single, z = z + d in double */
+      for (int row = 0; row < n; row++) {
+        h_rf[row] = (float)h_r[row];
+      }
+      if (chol_info) {
+        checkCudaErrors(cusolverSpScsrcholSolveHost(handle, n, h_rf, h_df,
+                                                    chol_info, buffer));
+      } else if (lu_info) {
+        checkCudaErrors(
+            cusolverSpScsrluSolveHost(handle, n, h_rf, h_df, lu_info, buffer));
+      } else {
+        checkCudaErrors(cusolverSpScsrqrSolveHost(handle, n, n, h_rf, h_df,
+                                                  qr_info, buffer));
+      }
+      for (int row = 0; row < n; row++) {
+        h_z[row] += (double)h_df[row];
+      }
+      iters++;
+    }
+    *time_refine = second() - start;
+  }
+
+  if (chol_info) {
+    checkCudaErrors(cusolverSpDestroyCsrcholInfoHost(chol_info));
+  }
+  if (lu_info) {
+    checkCudaErrors(cusolverSpDestroyCsrluInfoHost(lu_info));
+  }
+  if (qr_info) {
+    checkCudaErrors(cusolverSpDestroyCsrqrInfoHost(qr_info));
+  }
+  free(buffer);
+  free(h_csrValBf);
+  free(h_rf);
+  free(h_df);
+  free(h_r);
+
+  return iters;
+}
+
 void parseCommandLineArguments(int argc, char *argv[], struct testOpts &opts) {
   memset(&opts, 0, sizeof(opts));
 
@@ -230,8 +437,24 @@ int main(int argc, char *argv[]) {
   double time_solve_cpu;
   double time_solve_gpu;
 
+  bool refine = false;  /* mixed-precision iterative refinement */
+  double ir_tol = 1.e-14;
+  int ir_maxit = 20;
+  int numThreads = (int)std::thread::hardware_concurrency();
+
   parseCommandLineArguments(argc, argv, opts);
 
+  refine = checkCmdLineFlag(argc, (const char **)argv, "ir");
+  if (checkCmdLineFlag(argc, (const char **)argv, "ir_tol")) {
+    ir_tol = getCmdLineArgumentFloat(argc, (const char **)argv, "ir_tol");
+  }
+  if (checkCmdLineFlag(argc, (const char **)argv, "ir_maxit")) {
+    ir_maxit = getCmdLineArgumentInt(argc, (const char **)argv, "ir_maxit");
+  }
+  if (checkCmdLineFlag(argc, (const char **)argv, "threads")) {
+    numThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+  }
+
   if (NULL == opts.testFunc) {
     opts.testFunc =
         "chol"; /* By default running Cholesky as NO solver selected with -R
@@ -521,6 +744,41 @@ int main(int argc, char *argv[]) {
   printf("(CPU) |b - A*x|/(|A|*|x| + |b|) = %E \n",
          r_inf / (A_inf * x_inf + b_inf));
 
+  if (refine) {
+    double time_factor = 0.0;
+    double time_refine = 0.0;
+    double backward_error = 0.0;
+    double *h_xir = (double *)malloc(sizeof(double) * colsA);
+    assert(NULL != h_xir);
+
+    printf("step 6.1: solve A*x = b on CPU by mixed-precision refinement\n");
+    const int iters = refineMixedPrecisionHost(
+        handle, opts.testFunc, rowsA, nnzA, descrA, h_csrValB, h_csrRowPtrB,
+        h_csrColIndB, h_Qb, h_z, ir_tol, ir_maxit, numThreads, &time_factor,
+        &time_refine, &backward_error);
+
+    if (0 <= iters) {
+      /* Q*x = z */
+      double diff_inf = 0.0;
+      for (int row = 0; row < rowsA; row++) {
+        h_xir[h_Q[row]] = h_z[row];
+      }
+      for (int j = 0; j < colsA; j++) {
+        double d = fabs(h_xir[j] - h_x[j]);
+        diff_inf = (diff_inf > d) ? diff_inf : d;
+      }
+      printf("(CPU IR) |x_ir - x_double|/|x_double| = %E \n",
+             diff_inf / x_inf);
+      fprintf(stdout,
+              "timing %s: CPU double = %10.6f sec , CPU float factor + IR = "
+              "%10.6f sec (factor %10.6f sec, %d sweeps, %s)\n",
+              opts.testFunc, time_solve_cpu, time_factor + time_refine,
+              time_factor, iters,
+              (backward_error <= ir_tol) ? "converged" : "not converged");
+    }
+    free(h_xir);
+  }
+
   printf("step 7: solve A*x = b on GPU\n");
   start = second();
 
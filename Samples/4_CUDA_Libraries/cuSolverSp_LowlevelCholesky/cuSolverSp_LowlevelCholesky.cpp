@@ -24,6 +24,8 @@
 #include "helper_cuda.h"
 #include "helper_cusolver.h"
 
+#include "supernodalCholHost.h"
+
 template <typename T_ELEM>
 int loadMMSparseMatrix(
     char *filename,
@@ -43,6 +45,9 @@ void UsageSP(void)
     printf( "-h          : display this help\n");
     printf( "-file=<filename> : filename containing a matrix in MM format\n");
     printf( "-device=<device_id> : <device_id> if want to run on specific GPU\n");
+    printf( "-threads=<n> : number of threads of the host supernodal Cholesky\n");
+    printf( "-nsolves=<n> : number of solves reusing the host supernodal factor\n");
+    printf( "-cpuonly     : only run the host supernodal Cholesky, no GPU needed\n");
 
     exit( 0 );
 }
@@ -73,6 +78,116 @@ void parseCommandLineArguments(int argc, char *argv[], struct testOpts &opts)
     }
 }
 
+/*
+ * Host supernodal Cholesky with the same phases as csrchol:
+ * analysis, buffer size, factorization, zero pivot and solve.
+ * The analysis is reused by a second factorization and the factor is
+ * reused by nsolves solves, as a FEM code would do for new loads or
+ * new material values on the same mesh.
+ */
+int solveSupernodalHost(int rowsA, int nnzA, int baseA,
+                        const double *h_csrValA, const int *h_csrRowPtrA,
+                        const int *h_csrColIndA, const double *h_b,
+                        double *h_x, double *h_r, int numThreads, int nsolves,
+                        double tol)
+{
+    scholInfoHost_t info = NULL;
+    size_t size_internal = 0;
+    size_t size_chol = 0;
+    void *buffer = NULL;
+    int singularity = 0;
+    int numSupernodes = 0;
+    int maxSupernodeCols = 0;
+    long long nnzL = 0;
+    double flops = 0.0;
+    double start, stop;
+    double time_analysis, time_factor, time_refactor, time_solve;
+
+    printf("step 8.1: supernodal analysis of chol(A) on the host\n");
+    start = second();
+    if (scholCreateInfoHost(&info) ||
+        scholAnalysisHost(rowsA, nnzA, baseA, h_csrRowPtrA, h_csrColIndA, info))
+    {
+        fprintf(stderr, "Error: supernodal analysis failed\n");
+        return 1;
+    }
+    time_analysis = second() - start;
+    scholGetStatsHost(info, &numSupernodes, &maxSupernodeCols, &nnzL, &flops);
+    printf("(HOST) %d supernodes, widest has %d columns, nnz(L) = %lld\n",
+           numSupernodes, maxSupernodeCols, nnzL);
+
+    printf("step 8.2: workspace for supernodal chol(A)\n");
+    scholBufferInfoHost(info, numThreads, &size_internal, &size_chol);
+    buffer = malloc(size_chol);
+    assert(NULL != buffer);
+
+    printf("step 8.3: compute P*A*P' = L*L' (factor, then refactor reusing the analysis)\n");
+    start = second();
+    scholFactorHost(rowsA, nnzA, h_csrValA, h_csrRowPtrA, h_csrColIndA, info,
+                    numThreads, buffer);
+    stop = second();
+    time_factor = stop - start;
+
+    start = second();
+    scholFactorHost(rowsA, nnzA, h_csrValA, h_csrRowPtrA, h_csrColIndA, info,
+                    numThreads, buffer);
+    stop = second();
+    time_refactor = stop - start;
+
+    scholZeroPivotHost(info, tol, &singularity);
+    if ( 0 <= singularity)
+    {
+        fprintf(stderr, "Error: A is not invertible, singularity=%d\n", singularity);
+        scholDestroyInfoHost(info);
+        free(buffer);
+        return 1;
+    }
+
+    printf("step 8.4: solve A*x = b %d times reusing L\n", nsolves);
+    start = second();
+    for (int i = 0; i < nsolves; i++)
+    {
+        scholSolveHost(rowsA, h_b, h_x, info, buffer);
+    }
+    stop = second();
+    time_solve = (stop - start) / nsolves;
+
+    // r = b - A*x
+    for (int row = 0; row < rowsA; row++)
+    {
+        double sum = h_b[row];
+        for (int p = h_csrRowPtrA[row] - baseA; p < h_csrRowPtrA[row + 1] - baseA; p++)
+        {
+            sum -= h_csrValA[p] * h_x[h_csrColIndA[p] - baseA];
+        }
+        h_r[row] = sum;
+    }
+
+    const double x_inf = vec_norminf(rowsA, h_x);
+    const double r_inf = vec_norminf(rowsA, h_r);
+    double A_inf = 0.0;
+    for (int row = 0; row < rowsA; row++)
+    {
+        double sum = 0.0;
+        for (int p = h_csrRowPtrA[row] - baseA; p < h_csrRowPtrA[row + 1] - baseA; p++)
+        {
+            sum += fabs(h_csrValA[p]);
+        }
+        A_inf = (A_inf > sum) ? A_inf : sum;
+    }
+
+    printf("(HOST) analysis %.3f ms, factor %.3f ms (%.2f GFlops), refactor %.3f ms, solve %.3f ms\n",
+           time_analysis * 1000.0, time_factor * 1000.0,
+           flops / time_factor * 1.e-9, time_refactor * 1000.0,
+           time_solve * 1000.0);
+    printf("(HOST) |b - A*x| = %E \n", r_inf);
+    printf("(HOST) |b - A*x|/(|A|*|x|) = %E \n", r_inf/(A_inf * x_inf));
+
+    scholDestroyInfoHost(info);
+    free(buffer);
+
+    return 0;
+}
 
 int main (int argc, char *argv[])
 {
@@ -125,9 +240,27 @@ int main (int argc, char *argv[])
     double A_inf = 0.0; // |A|
     int errors = 0;
 
+    int numThreads = 0; // 0 = one thread per core
+    int nsolves = 10;
+    bool cpuOnly = false;
+
     parseCommandLineArguments(argc, argv, opts);
 
-    findCudaDevice(argc, (const char **)argv);
+    if (checkCmdLineFlag(argc, (const char **)argv, "threads"))
+    {
+        numThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+    }
+    if (checkCmdLineFlag(argc, (const char **)argv, "nsolves"))
+    {
+        nsolves = getCmdLineArgumentInt(argc, (const char **)argv, "nsolves");
+        nsolves = (nsolves > 0) ? nsolves : 1;
+    }
+    cpuOnly = checkCmdLineFlag(argc, (const char **)argv, "cpuonly");
+
+    if (!cpuOnly)
+    {
+        findCudaDevice(argc, (const char **)argv);
+    }
 
     if (opts.sparse_mat_filename == NULL)
     {
@@ -167,6 +300,33 @@ int main (int argc, char *argv[])
 
     printf("sparse matrix A is %d x %d with %d nonzeros, base=%d\n", rowsA, colsA, nnzA, baseA);
 
+    if (cpuOnly)
+    {
+        h_x = (double*)malloc(sizeof(double)*colsA);
+        h_b = (double*)malloc(sizeof(double)*rowsA);
+        h_r = (double*)malloc(sizeof(double)*rowsA);
+        assert(NULL != h_x);
+        assert(NULL != h_b);
+        assert(NULL != h_r);
+
+        for(int row = 0 ; row < rowsA ; row++)
+        {
+            h_b[row] = 1.0;
+        }
+
+        errors = solveSupernodalHost(rowsA, nnzA, baseA, h_csrValA, h_csrRowPtrA,
+                                     h_csrColIndA, h_b, h_x, h_r, numThreads,
+                                     nsolves, tol);
+
+        free(h_csrValA);
+        free(h_csrRowPtrA);
+        free(h_csrColIndA);
+        free(h_x);
+        free(h_b);
+        free(h_r);
+        return errors;
+    }
+
     checkCudaErrors(cusolverSpCreate(&cusolverSpH));
 
     checkCudaErrors(cusparseCreate(&cusparseH));
@@ -306,6 +466,13 @@ int main (int argc, char *argv[])
     printf("(CPU) |x| = %E \n", x_inf);
     printf("(CPU) |b - A*x|/(|A|*|x|) = %E \n", r_inf/(A_inf * x_inf));
 
+    if (solveSupernodalHost(rowsA, nnzA, baseA, h_csrValA, h_csrRowPtrA,
+                            h_csrColIndA, h_b, h_x, h_r, numThreads, nsolves,
+                            tol))
+    {
+        return 1;
+    }
+
     printf("step 9: create opaque info structure\n");
     checkCudaErrors(cusolverSpCreateCsrcholInfo(&d_info));
 
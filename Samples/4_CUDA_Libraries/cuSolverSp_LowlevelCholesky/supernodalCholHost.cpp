@@ -0,0 +1,868 @@
+/*
+ * Copyright 2015 NVIDIA Corporation.  All rights reserved.
+ *
+ * Please refer to the NVIDIA end user license agreement (EULA) associated
+ * with this source code for terms and conditions that govern your use of
+ * this software. Any use, reproduction, disclosure, or distribution of
+ * this software and related documentation outside the terms of the EULA
+ * is strictly prohibited.
+ *
+ */
+
+/*
+ *  Left-looking supernodal Cholesky on the host.
+ *
+ *  Analysis (pattern only)
+ *     1. elimination tree of A (Liu's algorithm with path compression)
+ *     2. postorder of the tree, used as symmetric permutation P, so that
+ *        every subtree occupies a contiguous range of columns
+ *     3. column counts of L by row-subtree traversal
+ *     4. supernodes: column j joins the supernode of column j-1 if j is
+ *        the parent of j-1 and either struct(L(:,j-1)) = {j-1} +
+ *        struct(L(:,j)) (fundamental supernode) or the explicit zeros stored
+ *        in the merged dense block stay small (relaxed amalgamation)
+ *     5. row structure of each supernode and the list of descendant
+ *        supernodes which update it
+ *
+ *  Factorization
+ *     Every supernode s is stored as a dense column-major block with
+ *     rows(s) rows and cols(s) columns. A supernode becomes ready when all
+ *     of its children in the supernodal elimination tree are done; worker
+ *     threads pick up ready supernodes and
+ *       - scatter the lower triangle of A into the block,
+ *       - apply the update L_d * L_d' of every descendant d (GEMM + scatter),
+ *       - factor the block with a blocked right-looking dense Cholesky
+ *         (panel factorization + GEMM trailing update).
+ *     A supernode only writes to its own block and only reads finished
+ *     descendants, so no locking is required besides the ready queue.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "supernodalCholHost.h"
+
+// column block size of the dense Cholesky kernel
+#define SCHOL_BLOCK 32
+// widest supernode created by relaxed amalgamation
+#define SCHOL_MAX_COLS 128
+
+struct scholInfoHost
+{
+    int n;
+    int baseA;
+    int nnzA;
+    bool analyzed;
+    bool factored;
+
+    std::vector<int> perm;   // perm[k] = column of A which is the k-th pivot
+    std::vector<int> iperm;  // iperm[perm[k]] = k
+    std::vector<int> parent; // elimination tree of P*A*P'
+
+    // lower triangle of P*A*P' by columns, aSrc maps to the position in csrValA
+    std::vector<int> aColPtr;
+    std::vector<int> aRowInd;
+    std::vector<int> aSrc;
+
+    // supernode s owns columns superCol[s], ..., superCol[s+1]-1
+    int nsuper;
+    int maxCols;
+    std::vector<int> superCol;
+    std::vector<int> colToSuper;
+    std::vector<int> superParent;
+    std::vector<int> superRowPtr; // rows of s are superRowInd[superRowPtr[s]:]
+    std::vector<int> superRowInd;
+    std::vector<size_t> superValPtr;
+
+    // descendants updating s are updSuper[updPtr[s]:updPtr[s+1]], and their
+    // first row inside s is at offset updFirst[] in their row structure
+    std::vector<int> updPtr;
+    std::vector<int> updSuper;
+    std::vector<int> updFirst;
+
+    size_t tmpDoubles; // size of the GEMM result buffer per thread
+    long long nnzL;
+    double flops;
+
+    std::vector<double> Lval;
+    std::atomic<int> zeroPivot; // smallest permuted column with pivot <= 0
+};
+
+static int scholNumThreads(int numThreads)
+{
+    if (numThreads > 0)
+    {
+        return numThreads;
+    }
+    int hw = (int)std::thread::hardware_concurrency();
+    return (hw > 0) ? hw : 1;
+}
+
+// per-thread workspace: GEMM result buffer followed by the relative row map
+static size_t scholThreadBytes(const scholInfoHost *info)
+{
+    size_t bytes = sizeof(double) * info->tmpDoubles + sizeof(int) * info->n;
+    return (bytes + 63) & ~((size_t)63);
+}
+
+// fraction of explicit zeros allowed in a relaxed supernode with cols columns
+static double relaxedZeros(double cols)
+{
+    if (cols <= 4)
+    {
+        return 1.0;
+    }
+    if (cols <= 16)
+    {
+        return 0.8;
+    }
+    if (cols <= 48)
+    {
+        return 0.1;
+    }
+    return 0.05;
+}
+
+int scholCreateInfoHost(scholInfoHost_t *info)
+{
+    if (NULL == info)
+    {
+        return 1;
+    }
+    *info = new scholInfoHost;
+    (*info)->n = 0;
+    (*info)->baseA = 0;
+    (*info)->nnzA = 0;
+    (*info)->analyzed = false;
+    (*info)->factored = false;
+    (*info)->nsuper = 0;
+    (*info)->maxCols = 0;
+    (*info)->tmpDoubles = 0;
+    (*info)->nnzL = 0;
+    (*info)->flops = 0.0;
+    (*info)->zeroPivot = -1;
+    return 0;
+}
+
+int scholDestroyInfoHost(scholInfoHost_t info)
+{
+    delete info;
+    return 0;
+}
+
+int scholAnalysisHost(int n, int nnzA, int baseA, const int *csrRowPtrA,
+                      const int *csrColIndA, scholInfoHost_t info)
+{
+    if ((NULL == info) || (n <= 0) || (nnzA < 0) || (NULL == csrRowPtrA) ||
+        (NULL == csrColIndA) || ((0 != baseA) && (1 != baseA)))
+    {
+        return 1;
+    }
+    if ((csrRowPtrA[0] != baseA) || (csrRowPtrA[n] - baseA != nnzA))
+    {
+        return 1;
+    }
+
+    info->n = n;
+    info->baseA = baseA;
+    info->nnzA = nnzA;
+    info->analyzed = false;
+    info->factored = false;
+
+    // step 1: elimination tree of A, row i of A is column i of A
+    std::vector<int> parent(n, -1);
+    std::vector<int> ancestor(n, -1);
+    for (int k = 0; k < n; k++)
+    {
+        for (int p = csrRowPtrA[k] - baseA; p < csrRowPtrA[k + 1] - baseA; p++)
+        {
+            int i = csrColIndA[p] - baseA;
+            if ((i < 0) || (i >= n))
+            {
+                return 1;
+            }
+            while ((-1 != i) && (i < k))
+            {
+                int inext = ancestor[i];
+                ancestor[i] = k;
+                if (-1 == inext)
+                {
+                    parent[i] = k;
+                }
+                i = inext;
+            }
+        }
+    }
+
+    // step 2: postorder of the elimination tree (children before parents)
+    std::vector<int> head(n, -1);
+    std::vector<int> next(n, -1);
+    for (int j = n - 1; j >= 0; j--)
+    {
+        if (-1 != parent[j])
+        {
+            next[j] = head[parent[j]];
+            head[parent[j]] = j;
+        }
+    }
+    info->perm.resize(n);
+    info->iperm.resize(n);
+    std::vector<int> stack(n);
+    int k = 0;
+    for (int root = 0; root < n; root++)
+    {
+        if (-1 != parent[root])
+        {
+            continue;
+        }
+        int top = 0;
+        stack[0] = root;
+        while (top >= 0)
+        {
+            int j = stack[top];
+            int child = head[j];
+            if (-1 == child)
+            {
+                top--;
+                info->perm[k++] = j;
+            }
+            else
+            {
+                head[j] = next[child];
+                stack[++top] = child;
+            }
+        }
+    }
+    assert(k == n);
+    for (k = 0; k < n; k++)
+    {
+        info->iperm[info->perm[k]] = k;
+    }
+    info->parent.resize(n);
+    for (k = 0; k < n; k++)
+    {
+        int p = parent[info->perm[k]];
+        info->parent[k] = (-1 == p) ? -1 : info->iperm[p];
+    }
+
+    // lower triangle of P*A*P' by columns, sorted by row
+    info->aColPtr.assign(n + 1, 0);
+    for (k = 0; k < n; k++)
+    {
+        const int row = info->perm[k];
+        for (int p = csrRowPtrA[row] - baseA; p < csrRowPtrA[row + 1] - baseA; p++)
+        {
+            if (info->iperm[csrColIndA[p] - baseA] >= k)
+            {
+                info->aColPtr[k + 1]++;
+            }
+        }
+    }
+    for (k = 0; k < n; k++)
+    {
+        info->aColPtr[k + 1] += info->aColPtr[k];
+    }
+    info->aRowInd.resize(info->aColPtr[n]);
+    info->aSrc.resize(info->aColPtr[n]);
+    std::vector<std::pair<int, int> > entries;
+    for (k = 0; k < n; k++)
+    {
+        const int row = info->perm[k];
+        entries.clear();
+        for (int p = csrRowPtrA[row] - baseA; p < csrRowPtrA[row + 1] - baseA; p++)
+        {
+            int r = info->iperm[csrColIndA[p] - baseA];
+            if (r >= k)
+            {
+                entries.push_back(std::make_pair(r, p));
+            }
+        }
+        std::sort(entries.begin(), entries.end());
+        for (size_t e = 0; e < entries.size(); e++)
+        {
+            info->aRowInd[info->aColPtr[k] + e] = entries[e].first;
+            info->aSrc[info->aColPtr[k] + e] = entries[e].second;
+        }
+    }
+
+    // step 3: column counts, row i of L is the row subtree of A(i, 0:i-1)
+    std::vector<int> colCount(n, 1);
+    std::vector<int> mark(n, -1);
+    for (int i = 0; i < n; i++)
+    {
+        mark[i] = i;
+        const int row = info->perm[i];
+        for (int p = csrRowPtrA[row] - baseA; p < csrRowPtrA[row + 1] - baseA; p++)
+        {
+            int j = info->iperm[csrColIndA[p] - baseA];
+            if (j >= i)
+            {
+                continue;
+            }
+            while (mark[j] != i)
+            {
+                mark[j] = i;
+                colCount[j]++;
+                j = info->parent[j];
+            }
+        }
+    }
+
+    // step 4: supernodes, column j joins the supernode of column j-1 if j is
+    // the parent of j-1 and the explicit zeros stay within the relaxation
+    info->superCol.clear();
+    info->colToSuper.resize(n);
+    info->maxCols = 0;
+    double superNnz = 0.0;
+    for (int j = 0; j < n; j++)
+    {
+        bool merge = false;
+        if ((j > 0) && (info->parent[j - 1] == j))
+        {
+            const double cols = j - info->superCol.back() + 1;
+            const double rows = cols + colCount[j] - 1;
+            const double entries = rows * cols - cols * (cols - 1) / 2;
+            const double zeros = entries - (superNnz + colCount[j]);
+            merge = (zeros == 0.0) ||
+                    ((cols <= SCHOL_MAX_COLS) && (zeros <= relaxedZeros(cols) * entries));
+        }
+        if (merge)
+        {
+            superNnz += colCount[j];
+        }
+        else
+        {
+            info->superCol.push_back(j);
+            superNnz = colCount[j];
+        }
+        info->colToSuper[j] = (int)info->superCol.size() - 1;
+    }
+    info->superCol.push_back(n);
+    const int nsuper = (int)info->superCol.size() - 1;
+    info->nsuper = nsuper;
+
+    info->superParent.resize(nsuper);
+    info->superRowPtr.resize(nsuper + 1);
+    info->superValPtr.resize(nsuper + 1);
+    info->superRowPtr[0] = 0;
+    info->superValPtr[0] = 0;
+    info->nnzL = 0;
+    info->flops = 0.0;
+    for (int s = 0; s < nsuper; s++)
+    {
+        const int first = info->superCol[s];
+        const int last = info->superCol[s + 1] - 1;
+        const int cols = last - first + 1;
+        const int rows = cols + colCount[last] - 1;
+        info->maxCols = std::max(info->maxCols, cols);
+        info->superParent[s] = (-1 == info->parent[last])
+                                   ? -1
+                                   : info->colToSuper[info->parent[last]];
+        info->superRowPtr[s + 1] = info->superRowPtr[s] + rows;
+        info->superValPtr[s + 1] = info->superValPtr[s] + (size_t)rows * cols;
+        for (int j = first; j <= last; j++)
+        {
+            info->nnzL += colCount[j];
+            info->flops += (double)colCount[j] * colCount[j];
+        }
+    }
+
+    // step 5: row structure of supernodes, rows arrive in increasing order
+    info->superRowInd.resize(info->superRowPtr[nsuper]);
+    std::vector<int> fill(info->superRowPtr.begin(), info->superRowPtr.end() - 1);
+    std::vector<int> superMark(nsuper, -1);
+    std::fill(mark.begin(), mark.end(), -1);
+    for (int i = 0; i < n; i++)
+    {
+        mark[i] = i;
+        const int own = info->colToSuper[i];
+        superMark[own] = i;
+        info->superRowInd[fill[own]++] = i;
+
+        const int row = info->perm[i];
+        for (int p = csrRowPtrA[row] - baseA; p < csrRowPtrA[row + 1] - baseA; p++)
+        {
+            int j = info->iperm[csrColIndA[p] - baseA];
+            if (j >= i)
+            {
+                continue;
+            }
+            while (mark[j] != i)
+            {
+                mark[j] = i;
+                const int s = info->colToSuper[j];
+                if (superMark[s] != i)
+                {
+                    superMark[s] = i;
+                    info->superRowInd[fill[s]++] = i;
+                }
+                j = info->parent[j];
+            }
+        }
+    }
+    for (int s = 0; s < nsuper; s++)
+    {
+        assert(fill[s] == info->superRowPtr[s + 1]);
+    }
+
+    // descendants updating each supernode and the size of the GEMM buffer
+    std::vector<int> updCount(nsuper + 1, 0);
+    for (int d = 0; d < nsuper; d++)
+    {
+        const int cols = info->superCol[d + 1] - info->superCol[d];
+        int last = -1;
+        for (int p = info->superRowPtr[d] + cols; p < info->superRowPtr[d + 1]; p++)
+        {
+            const int t = info->colToSuper[info->superRowInd[p]];
+            if (t != last)
+            {
+                updCount[t + 1]++;
+                last = t;
+            }
+        }
+    }
+    for (int s = 0; s < nsuper; s++)
+    {
+        updCount[s + 1] += updCount[s];
+    }
+    info->updPtr = updCount;
+    info->updSuper.resize(updCount[nsuper]);
+    info->updFirst.resize(updCount[nsuper]);
+    info->tmpDoubles = 1;
+    for (int d = 0; d < nsuper; d++)
+    {
+        const int cols = info->superCol[d + 1] - info->superCol[d];
+        const int end = info->superRowPtr[d + 1];
+        int p = info->superRowPtr[d] + cols;
+        while (p < end)
+        {
+            const int t = info->colToSuper[info->superRowInd[p]];
+            const int pos = updCount[t]++;
+            info->updSuper[pos] = d;
+            info->updFirst[pos] = p - info->superRowPtr[d];
+            int p2 = p;
+            while ((p2 < end) && (info->colToSuper[info->superRowInd[p2]] == t))
+            {
+                p2++;
+            }
+            info->tmpDoubles = std::max(info->tmpDoubles,
+                                        (size_t)(end - p) * (size_t)(p2 - p));
+            p = p2;
+        }
+    }
+
+    info->analyzed = true;
+    return 0;
+}
+
+int scholBufferInfoHost(scholInfoHost_t info, int numThreads,
+                        size_t *internalDataInBytes, size_t *workspaceInBytes)
+{
+    if ((NULL == info) || !info->analyzed || (NULL == internalDataInBytes) ||
+        (NULL == workspaceInBytes))
+    {
+        return 1;
+    }
+    numThreads = scholNumThreads(numThreads);
+    *internalDataInBytes = sizeof(double) * info->superValPtr[info->nsuper];
+    // the solve only needs one vector of length n
+    *workspaceInBytes = std::max(numThreads * scholThreadBytes(info),
+                                 sizeof(double) * info->n);
+    return 0;
+}
+
+// C(m x n) -= A(m x k) * B(n x k)', column-major
+static void gemmMinusNT(int m, int n, int k, const double *A, int lda,
+                        const double *B, int ldb, double *C, int ldc)
+{
+    for (int j = 0; j < n; j++)
+    {
+        double *c = C + (size_t)j * ldc;
+        int l = 0;
+        for (; l + 3 < k; l += 4)
+        {
+            const double b0 = B[j + (size_t)(l + 0) * ldb];
+            const double b1 = B[j + (size_t)(l + 1) * ldb];
+            const double b2 = B[j + (size_t)(l + 2) * ldb];
+            const double b3 = B[j + (size_t)(l + 3) * ldb];
+            const double *a0 = A + (size_t)(l + 0) * lda;
+            const double *a1 = A + (size_t)(l + 1) * lda;
+            const double *a2 = A + (size_t)(l + 2) * lda;
+            const double *a3 = A + (size_t)(l + 3) * lda;
+            for (int i = 0; i < m; i++)
+            {
+                c[i] -= a0[i] * b0 + a1[i] * b1 + a2[i] * b2 + a3[i] * b3;
+            }
+        }
+        for (; l < k; l++)
+        {
+            const double b0 = B[j + (size_t)l * ldb];
+            const double *a0 = A + (size_t)l * lda;
+            for (int i = 0; i < m; i++)
+            {
+                c[i] -= a0[i] * b0;
+            }
+        }
+    }
+}
+
+// Blocked Cholesky of the rows x cols supernode block L (leading dimension
+// rows): the top cols x cols block becomes L11, the rows below become
+// L21 = A21 * inv(L11'). Returns the first column with a non-positive pivot.
+static int denseCholesky(int rows, int cols, double *L)
+{
+    int badPivot = -1;
+    for (int kb = 0; kb < cols; kb += SCHOL_BLOCK)
+    {
+        const int nb = std::min(SCHOL_BLOCK, cols - kb);
+
+        // panel factorization, unblocked on columns kb:kb+nb-1
+        for (int k = kb; k < kb + nb; k++)
+        {
+            double *lk = L + (size_t)k * rows;
+            double d = lk[k];
+            if (!(d > 0.0))
+            {
+                if (-1 == badPivot)
+                {
+                    badPivot = k;
+                }
+                d = 1.0;
+            }
+            d = sqrt(d);
+            lk[k] = d;
+            const double rd = 1.0 / d;
+            for (int i = k + 1; i < rows; i++)
+            {
+                lk[i] *= rd;
+            }
+            for (int j = k + 1; j < kb + nb; j++)
+            {
+                const double ljk = lk[j];
+                double *lj = L + (size_t)j * rows;
+                for (int i = j; i < rows; i++)
+                {
+                    lj[i] -= lk[i] * ljk;
+                }
+            }
+        }
+
+        // trailing update L(j:, j) -= L(j:, kb:kb+nb) * L(j, kb:kb+nb)'
+        for (int jb = kb + nb; jb < cols; jb += SCHOL_BLOCK)
+        {
+            const int nj = std::min(SCHOL_BLOCK, cols - jb);
+            gemmMinusNT(rows - jb, nj, nb, L + jb + (size_t)kb * rows, rows,
+                        L + jb + (size_t)kb * rows, rows,
+                        L + jb + (size_t)jb * rows, rows);
+        }
+    }
+
+    // the trailing update also touches the strict upper triangle of L11
+    for (int j = 1; j < cols; j++)
+    {
+        memset(L + (size_t)j * rows, 0, sizeof(double) * j);
+    }
+    return badPivot;
+}
+
+static void factorSupernode(scholInfoHost_t info, const double *csrValA, int s,
+                            double *tmp, int *relMap)
+{
+    const int first = info->superCol[s];
+    const int cols = info->superCol[s + 1] - first;
+    const int *rowInd = &info->superRowInd[info->superRowPtr[s]];
+    const int rows = info->superRowPtr[s + 1] - info->superRowPtr[s];
+    double *Ls = &info->Lval[info->superValPtr[s]];
+
+    for (int i = 0; i < rows; i++)
+    {
+        relMap[rowInd[i]] = i;
+    }
+
+    // Ls = tril(A(rows, cols))
+    memset(Ls, 0, sizeof(double) * rows * cols);
+    for (int j = 0; j < cols; j++)
+    {
+        const int col = first + j;
+        for (int p = info->aColPtr[col]; p < info->aColPtr[col + 1]; p++)
+        {
+            Ls[relMap[info->aRowInd[p]] + (size_t)j * rows] = csrValA[info->aSrc[p]];
+        }
+    }
+
+    // Ls -= L_d * L_d' for every descendant d
+    for (int u = info->updPtr[s]; u < info->updPtr[s + 1]; u++)
+    {
+        const int d = info->updSuper[u];
+        const int p1 = info->updFirst[u];
+        const int dcols = info->superCol[d + 1] - info->superCol[d];
+        const int *drow = &info->superRowInd[info->superRowPtr[d]];
+        const int drows = info->superRowPtr[d + 1] - info->superRowPtr[d];
+        const double *Ld = &info->Lval[info->superValPtr[d]];
+
+        int p2 = p1;
+        while ((p2 < drows) && (drow[p2] < first + cols))
+        {
+            p2++;
+        }
+        const int m = drows - p1;
+        const int nc = p2 - p1;
+
+        // tmp = -L_d(p1:, :) * L_d(p1:p2, :)'
+        memset(tmp, 0, sizeof(double) * m * nc);
+        gemmMinusNT(m, nc, dcols, Ld + p1, drows, Ld + p1, drows, tmp, m);
+
+        for (int jj = 0; jj < nc; jj++)
+        {
+            double *ls = Ls + (size_t)(drow[p1 + jj] - first) * rows;
+            const double *t = tmp + (size_t)jj * m;
+            for (int ii = jj; ii < m; ii++)
+            {
+                ls[relMap[drow[p1 + ii]]] += t[ii];
+            }
+        }
+    }
+
+    int bad = denseCholesky(rows, cols, Ls);
+    if (-1 != bad)
+    {
+        int col = first + bad;
+        int current = info->zeroPivot.load();
+        while (((-1 == current) || (col < current)) &&
+               !info->zeroPivot.compare_exchange_weak(current, col))
+        {
+        }
+    }
+}
+
+int scholFactorHost(int n, int nnzA, const double *csrValA,
+                    const int *csrRowPtrA, const int *csrColIndA,
+                    scholInfoHost_t info, int numThreads, void *pBuffer)
+{
+    if ((NULL == info) || !info->analyzed || (n != info->n) ||
+        (nnzA != info->nnzA) || (NULL == csrValA) || (NULL == pBuffer))
+    {
+        return 1;
+    }
+    (void)csrRowPtrA;
+    (void)csrColIndA;
+
+    numThreads = std::min(scholNumThreads(numThreads), info->nsuper);
+    const size_t threadBytes = scholThreadBytes(info);
+    char *buffer = (char *)pBuffer;
+
+    info->Lval.resize(info->superValPtr[info->nsuper]);
+    info->zeroPivot = -1;
+    info->factored = false;
+
+    if (1 == numThreads)
+    {
+        // postorder already puts every child before its parent
+        double *tmp = (double *)buffer;
+        int *relMap = (int *)(tmp + info->tmpDoubles);
+        for (int s = 0; s < info->nsuper; s++)
+        {
+            factorSupernode(info, csrValA, s, tmp, relMap);
+        }
+        info->factored = true;
+        return 0;
+    }
+
+    // tree-parallel schedule, a supernode is ready once all children are done
+    std::vector<int> pending(info->nsuper, 0);
+    for (int s = 0; s < info->nsuper; s++)
+    {
+        if (-1 != info->superParent[s])
+        {
+            pending[info->superParent[s]]++;
+        }
+    }
+    std::vector<int> ready;
+    for (int s = info->nsuper - 1; s >= 0; s--)
+    {
+        if (0 == pending[s])
+        {
+            ready.push_back(s);
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable wakeup;
+    int done = 0;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++)
+    {
+        workers.push_back(std::thread([&, t]() {
+            double *tmp = (double *)(buffer + t * threadBytes);
+            int *relMap = (int *)(tmp + info->tmpDoubles);
+            std::unique_lock<std::mutex> guard(lock);
+            for (;;)
+            {
+                wakeup.wait(guard, [&]() {
+                    return !ready.empty() || (done == info->nsuper);
+                });
+                if (ready.empty())
+                {
+                    return;
+                }
+                const int s = ready.back();
+                ready.pop_back();
+                guard.unlock();
+
+                factorSupernode(info, csrValA, s, tmp, relMap);
+
+                guard.lock();
+                done++;
+                const int p = info->superParent[s];
+                if ((-1 != p) && (0 == --pending[p]))
+                {
+                    ready.push_back(p);
+                    wakeup.notify_one();
+                }
+                if (done == info->nsuper)
+                {
+                    wakeup.notify_all();
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < numThreads; t++)
+    {
+        workers[t].join();
+    }
+
+    info->factored = true;
+    return 0;
+}
+
+int scholZeroPivotHost(scholInfoHost_t info, double tol, int *position)
+{
+    if ((NULL == info) || !info->factored || (NULL == position))
+    {
+        return 1;
+    }
+    int col = info->zeroPivot.load();
+    for (int s = 0; s < info->nsuper; s++)
+    {
+        const int first = info->superCol[s];
+        if ((-1 != col) && (first >= col))
+        {
+            break;
+        }
+        const int cols = info->superCol[s + 1] - first;
+        const int rows = info->superRowPtr[s + 1] - info->superRowPtr[s];
+        const double *Ls = &info->Lval[info->superValPtr[s]];
+        for (int j = 0; j < cols; j++)
+        {
+            if (Ls[j + (size_t)j * rows] <= tol)
+            {
+                if ((-1 == col) || (first + j < col))
+                {
+                    col = first + j;
+                }
+                break;
+            }
+        }
+    }
+    *position = (-1 == col) ? -1 : info->perm[col];
+    return 0;
+}
+
+int scholSolveHost(int n, const double *b, double *x, scholInfoHost_t info,
+                   void *pBuffer)
+{
+    if ((NULL == info) || !info->factored || (n != info->n) || (NULL == b) ||
+        (NULL == x) || (NULL == pBuffer))
+    {
+        return 1;
+    }
+    double *y = (double *)pBuffer;
+
+    for (int k = 0; k < n; k++)
+    {
+        y[k] = b[info->perm[k]];
+    }
+
+    // y = L \ y
+    for (int s = 0; s < info->nsuper; s++)
+    {
+        const int first = info->superCol[s];
+        const int cols = info->superCol[s + 1] - first;
+        const int *rowInd = &info->superRowInd[info->superRowPtr[s]];
+        const int rows = info->superRowPtr[s + 1] - info->superRowPtr[s];
+        const double *Ls = &info->Lval[info->superValPtr[s]];
+        for (int k = 0; k < cols; k++)
+        {
+            const double *lk = Ls + (size_t)k * rows;
+            const double yk = y[first + k] / lk[k];
+            y[first + k] = yk;
+            for (int i = k + 1; i < rows; i++)
+            {
+                y[rowInd[i]] -= lk[i] * yk;
+            }
+        }
+    }
+
+    // y = L' \ y
+    for (int s = info->nsuper - 1; s >= 0; s--)
+    {
+        const int first = info->superCol[s];
+        const int cols = info->superCol[s + 1] - first;
+        const int *rowInd = &info->superRowInd[info->superRowPtr[s]];
+        const int rows = info->superRowPtr[s + 1] - info->superRowPtr[s];
+        const double *Ls = &info->Lval[info->superValPtr[s]];
+        for (int k = cols - 1; k >= 0; k--)
+        {
+            const double *lk = Ls + (size_t)k * rows;
+            double yk = y[first + k];
+            for (int i = k + 1; i < rows; i++)
+            {
+                yk -= lk[i] * y[rowInd[i]];
+            }
+            y[first + k] = yk / lk[k];
+        }
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        x[info->perm[k]] = y[k];
+    }
+    return 0;
+}
+
+int scholGetStatsHost(scholInfoHost_t info, int *numSupernodes,
+                      int *maxSupernodeCols, long long *nnzL, double *flops)
+{
+    if ((NULL == info) || !info->analyzed)
+    {
+        return 1;
+    }
+    if (numSupernodes)
+    {
+        *numSupernodes = info->nsuper;
+    }
+    if (maxSupernodeCols)
+    {
+        *maxSupernodeCols = info->maxCols;
+    }
+    if (nnzL)
+    {
+        *nnzL = info->nnzL;
+    }
+    if (flops)
+    {
+        *flops = info->flops;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2015 NVIDIA Corporation.  All rights reserved.
+ *
+ * Please refer to the NVIDIA end user license agreement (EULA) associated
+ * with this source code for terms and conditions that govern your use of
+ * this software. Any use, reproduction, disclosure, or distribution of
+ * this software and related documentation outside the terms of the EULA
+ * is strictly prohibited.
+ *
+ */
+
+/*
+ * Host supernodal Cholesky factorization P*A*P' = L*L'.
+ *
+ * The phases mirror the csrchol low level API of cuSolverSp:
+ *   scholAnalysisHost   : elimination tree, postorder P, symbolic L, supernodes
+ *   scholBufferInfoHost : size of L and of the workspace
+ *   scholFactorHost     : numeric factorization, supernodes are scheduled as
+ *                         tasks over the supernodal elimination tree
+ *   scholZeroPivotHost  : first column whose pivot is not larger than tol
+ *   scholSolveHost      : x = A \ b with the computed factor
+ *
+ * The analysis only depends on the sparsity pattern, so it can be reused by
+ * any number of factorizations with new values, and a factorization can be
+ * reused by any number of solves.
+ *
+ * A is a CSR matrix holding both triangles of a symmetric positive definite
+ * matrix (as returned by loadMMSparseMatrix(..., extendSymMatrix = 1)).
+ * Only the lower triangle is referenced.
+ *
+ * All functions return 0 on success and a non-zero value on invalid input.
+ */
+
+#ifndef SUPERNODAL_CHOL_HOST_H
+#define SUPERNODAL_CHOL_HOST_H
+
+#include <stddef.h>
+
+typedef struct scholInfoHost *scholInfoHost_t;
+
+int scholCreateInfoHost(scholInfoHost_t *info);
+
+int scholDestroyInfoHost(scholInfoHost_t info);
+
+int scholAnalysisHost(int n, int nnzA, int baseA, const int *csrRowPtrA,
+                      const int *csrColIndA, scholInfoHost_t info);
+
+// numThreads <= 0 selects the number of hardware threads
+int scholBufferInfoHost(scholInfoHost_t info, int numThreads,
+                        size_t *internalDataInBytes, size_t *workspaceInBytes);
+
+int scholFactorHost(int n, int nnzA, const double *csrValA,
+                    const int *csrRowPtrA, const int *csrColIndA,
+                    scholInfoHost_t info, int numThreads, void *pBuffer);
+
+// position = -1 if all pivots are larger than tol, otherwise the row of A
+// where the first small pivot was found
+int scholZeroPivotHost(scholInfoHost_t info, double tol, int *position);
+
+int scholSolveHost(int n, const double *b, double *x, scholInfoHost_t info,
+                   void *pBuffer);
+
+// statistics of the analysis and of the last factorization
+int scholGetStatsHost(scholInfoHost_t info, int *numSupernodes,
+                      int *maxSupernodeCols, long long *nnzL, double *flops);
+
+#endif  // SUPERNODAL_CHOL_HOST_H
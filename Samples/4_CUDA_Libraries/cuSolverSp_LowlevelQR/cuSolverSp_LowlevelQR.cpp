@@ -36,6 +36,7 @@
 #include "cusolverSp_LOWLEVEL_PREVIEW.h"
 #include "helper_cuda.h"
 #include "helper_cusolver.h"
+#include "multifrontalQRHost.h"
 
 template <typename T_ELEM>
 int loadMMSparseMatrix(char *filename, char elem_type, bool csrFormat, int *m,
@@ -47,6 +48,9 @@ void UsageSP(void) {
   printf("-h          : display this help\n");
   printf("-file=<filename> : filename containing a matrix in MM format\n");
   printf("-device=<device_id> : <device_id> if want to run on specific GPU\n");
+  printf("-threads=<n> : number of threads of the host multifrontal QR\n");
+  printf("-cpuonly     : only run the host multifrontal QR, no GPU needed\n");
+  printf("              (rectangular m > n matrices always run on the host)\n");
 
   exit(0);
 }
@@ -71,6 +75,113 @@ void parseCommandLineArguments(int argc, char *argv[], struct testOpts &opts) {
   }
 }
 
+/*
+ * Host multifrontal QR with the same phases as csrqr: analysis, buffer
+ * size, factorization, zero pivot, then x = R \ (Q'*b) with the implicit Q.
+ * For m > n, x is the least-squares solution of min |b - A*x|.
+ */
+int solveMultifrontalQRHost(int rowsA, int colsA, int nnzA, int baseA,
+                            const double *h_csrValA, const int *h_csrRowPtrA,
+                            const int *h_csrColIndA, const double *h_b,
+                            double *h_x, int numThreads, double tol) {
+  mfqrInfoHost_t info = NULL;
+  size_t size_internal = 0;
+  size_t size_qr = 0;
+  void *buffer = NULL;
+  int singularity = 0;
+  int numFronts = 0;
+  int maxFrontRows = 0;
+  int maxFrontCols = 0;
+  long long nnzR = 0;
+  double flops = 0.0;
+  double rnorm = 0.0;
+  double start, stop;
+  double time_analysis, time_factor, time_solve;
+
+  printf("step 8.1: multifrontal analysis of qr(A) on the host\n");
+  start = second();
+  if (mfqrCreateInfoHost(&info) ||
+      mfqrAnalysisHost(rowsA, colsA, nnzA, baseA, h_csrRowPtrA, h_csrColIndA,
+                       info)) {
+    fprintf(stderr, "Error: multifrontal analysis failed\n");
+    return 1;
+  }
+  time_analysis = second() - start;
+  mfqrGetStatsHost(info, &numFronts, &maxFrontRows, &maxFrontCols, &nnzR,
+                   &flops);
+  printf("(HOST) %d fronts, largest is %d x %d, nnz(R) = %lld\n", numFronts,
+         maxFrontRows, maxFrontCols, nnzR);
+
+  printf("step 8.2: workspace for multifrontal qr(A)\n");
+  mfqrBufferInfoHost(info, numThreads, &size_internal, &size_qr);
+  buffer = malloc(size_qr);
+  assert(NULL != buffer);
+
+  printf("step 8.3: compute A*P = Q*R \n");
+  start = second();
+  mfqrFactorHost(rowsA, colsA, nnzA, h_csrValA, h_csrRowPtrA, h_csrColIndA,
+                 info, numThreads, buffer);
+  stop = second();
+  time_factor = stop - start;
+
+  mfqrZeroPivotHost(info, tol, &singularity);
+  if (0 <= singularity) {
+    fprintf(stderr, "Error: A is rank deficient, singularity=%d\n",
+            singularity);
+    mfqrDestroyInfoHost(info);
+    free(buffer);
+    return 1;
+  }
+
+  printf("step 8.4: solve min |b - A*x| with x = R \\ (Q'*b) \n");
+  start = second();
+  mfqrSolveHost(rowsA, colsA, h_b, h_x, &rnorm, info, buffer);
+  stop = second();
+  time_solve = stop - start;
+
+  // r = b - A*x and A'*r, which vanishes at the least-squares solution
+  double *h_r = (double *)malloc(sizeof(double) * rowsA);
+  double *h_Atr = (double *)calloc(colsA, sizeof(double));
+  assert(NULL != h_r);
+  assert(NULL != h_Atr);
+  double A_inf = 0.0;
+  for (int row = 0; row < rowsA; row++) {
+    double sum = h_b[row];
+    double abs_sum = 0.0;
+    for (int p = h_csrRowPtrA[row] - baseA; p < h_csrRowPtrA[row + 1] - baseA;
+         p++) {
+      sum -= h_csrValA[p] * h_x[h_csrColIndA[p] - baseA];
+      abs_sum += fabs(h_csrValA[p]);
+    }
+    h_r[row] = sum;
+    A_inf = (A_inf > abs_sum) ? A_inf : abs_sum;
+  }
+  for (int row = 0; row < rowsA; row++) {
+    for (int p = h_csrRowPtrA[row] - baseA; p < h_csrRowPtrA[row + 1] - baseA;
+         p++) {
+      h_Atr[h_csrColIndA[p] - baseA] += h_csrValA[p] * h_r[row];
+    }
+  }
+  const double x_inf = vec_norminf(colsA, h_x);
+  const double r_inf = vec_norminf(rowsA, h_r);
+  const double Atr_inf = vec_norminf(colsA, h_Atr);
+
+  printf("(HOST) analysis %.3f ms, factor %.3f ms (%.2f GFlops), solve %.3f ms\n",
+         time_analysis * 1000.0, time_factor * 1000.0,
+         flops / time_factor * 1.e-9, time_solve * 1000.0);
+  printf("(HOST) |b - A*x| = %E \n", r_inf);
+  printf("(HOST) |b - A*x|_2 from Q'*b = %E \n", rnorm);
+  printf("(HOST) |b - A*x|/(|A|*|x|) = %E \n", r_inf / (A_inf * x_inf));
+  printf("(HOST) |A'*(b - A*x)| = %E \n", Atr_inf);
+
+  free(h_r);
+  free(h_Atr);
+  mfqrDestroyInfoHost(info);
+  free(buffer);
+
+  return 0;
+}
+
 int main(int argc, char *argv[]) {
   struct testOpts opts;
   cusolverSpHandle_t cusolverSpH =
@@ -125,9 +236,19 @@ int main(int argc, char *argv[]) {
   double r_inf = 0.0;  // |r|
   double A_inf = 0.0;  // |A|
 
+  int numThreads = 0;  // 0 = one thread per core
+  bool cpuOnly = false;
+
   parseCommandLineArguments(argc, argv, opts);
 
-  findCudaDevice(argc, (const char **)argv);
+  if (checkCmdLineFlag(argc, (const char **)argv, "threads")) {
+    numThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+  }
+  cpuOnly = checkCmdLineFlag(argc, (const char **)argv, "cpuonly");
+
+  if (!cpuOnly) {
+    findCudaDevice(argc, (const char **)argv);
+  }
 
   if (opts.sparse_mat_filename == NULL) {
     opts.sparse_mat_filename = sdkFindFilePath("lap2D_5pt_n32.mtx", argv[0]);
@@ -153,14 +274,38 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
-  if (rowsA != colsA) {
-    fprintf(stderr, "Error: only support square matrix\n");
+  if (rowsA < colsA) {
+    fprintf(stderr, "Error: only support matrix with rows >= columns\n");
     return 1;
   }
 
   printf("sparse matrix A is %d x %d with %d nonzeros, base=%d\n", rowsA, colsA,
          nnzA, baseA);
 
+  if (cpuOnly || (rowsA != colsA)) {
+    int errors = 0;
+
+    h_x = (double *)malloc(sizeof(double) * colsA);
+    h_b = (double *)malloc(sizeof(double) * rowsA);
+    assert(NULL != h_x);
+    assert(NULL != h_b);
+
+    for (int row = 0; row < rowsA; row++) {
+      h_b[row] = 1.0;
+    }
+
+    errors = solveMultifrontalQRHost(rowsA, colsA, nnzA, baseA, h_csrValA,
+                                     h_csrRowPtrA, h_csrColIndA, h_b, h_x,
+                                     numThreads, tol);
+
+    free(h_csrValA);
+    free(h_csrRowPtrA);
+    free(h_csrColIndA);
+    free(h_x);
+    free(h_b);
+    return errors;
+  }
+
   checkCudaErrors(cusolverSpCreate(&cusolverSpH));
   checkCudaErrors(cusparseCreate(&cusparseH));
   checkCudaErrors(cudaStreamCreate(&stream));
@@ -301,6 +446,12 @@ int main(int argc, char *argv[]) {
   printf("(CPU) |x| = %E \n", x_inf);
   printf("(CPU) |b - A*x|/(|A|*|x|) = %E \n", r_inf / (A_inf * x_inf));
 
+  if (solveMultifrontalQRHost(rowsA, colsA, nnzA, baseA, h_csrValA,
+                              h_csrRowPtrA, h_csrColIndA, h_bcopy, h_x,
+                              numThreads, tol)) {
+    return 1;
+  }
+
   printf("step 9: create opaque info structure\n");
   checkCudaErrors(cusolverSpCreateCsrqrInfo(&d_info));
 
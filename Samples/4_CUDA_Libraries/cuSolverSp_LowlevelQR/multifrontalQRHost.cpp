@@ -0,0 +1,883 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *  Multifrontal sparse QR on the host.
+ *
+ *  Analysis (pattern only)
+ *     1. column elimination tree, i.e. the elimination tree of A'*A,
+ *        computed from A without forming A'*A
+ *     2. postorder of the tree, used as column permutation P
+ *     3. every row of A is assigned to the column of its leftmost nonzero,
+ *        the structure of row j of R is the union of the rows assigned to j
+ *        and of the structures of the children of j
+ *     4. columns are merged into (relaxed) supernodes, every supernode is
+ *        one front with the pivotal columns of the supernode followed by
+ *        the structure of its last row of R
+ *
+ *  Factorization
+ *     A front is assembled from the rows of A assigned to it and from the
+ *     contribution blocks (the upper trapezoidal rows below R) of its
+ *     children, then it is factored in place by a blocked Householder QR
+ *     (compact WY, Y*T*Y'). R stays above the diagonal, the Householder
+ *     vectors below it, so Q'*b is applied by replaying the same assembly
+ *     on b. Fronts are tasks over the elimination tree, a front is ready
+ *     once all of its children are factored.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "multifrontalQRHost.h"
+
+// column block size of the dense Householder QR
+#define MFQR_BLOCK 32
+// widest front created by relaxed amalgamation
+#define MFQR_MAX_COLS 128
+
+struct mfqrInfoHost {
+  int m;
+  int n;
+  int nnzA;
+  bool analyzed;
+  bool factored;
+
+  std::vector<int> perm;   // perm[k] = column of A which is the k-th pivot
+  std::vector<int> iperm;  // iperm[perm[k]] = k
+  std::vector<int> parent;  // column elimination tree of A*P
+
+  // front s owns pivots superCol[s], ..., superCol[s+1]-1 and the columns
+  // frontColInd[frontColPtr[s]:frontColPtr[s+1]] (pivots first)
+  int nsuper;
+  std::vector<int> superCol;
+  std::vector<int> superParent;
+  std::vector<int> frontColPtr;
+  std::vector<int> frontColInd;
+
+  // rows of A assembled into s, then the children of s
+  std::vector<int> rowPtr;
+  std::vector<int> rowInd;
+  std::vector<int> childPtr;
+  std::vector<int> childInd;
+  std::vector<int> emptyRows;
+
+  std::vector<int> frontRows;     // rows of the front
+  std::vector<int> frontPivRows;  // rows of R = min(rows, pivots)
+  std::vector<int> frontContRows;  // rows of the contribution block
+  std::vector<size_t> frontValPtr;
+  std::vector<size_t> frontTauPtr;
+  std::vector<size_t> frontRhsPtr;
+
+  int maxFrontRows;
+  int maxFrontCols;
+  long long nnzR;
+  double flops;
+
+  std::vector<double> Fval;  // fronts, R above and Householder vectors below
+  std::vector<double> tau;
+};
+
+static int mfqrNumThreads(int numThreads) {
+  if (numThreads > 0) {
+    return numThreads;
+  }
+  int hw = (int)std::thread::hardware_concurrency();
+  return (hw > 0) ? hw : 1;
+}
+
+// per-thread workspace of the factorization: column map and T/W blocks
+static size_t mfqrThreadBytes(const mfqrInfoHost *info) {
+  size_t bytes = sizeof(double) * MFQR_BLOCK *
+                     (MFQR_BLOCK + (size_t)info->maxFrontCols) +
+                 sizeof(int) * info->n;
+  return (bytes + 63) & ~((size_t)63);
+}
+
+// fraction of explicit zeros allowed in a relaxed front with cols pivots
+static double relaxedZeros(double cols) {
+  if (cols <= 4) {
+    return 1.0;
+  }
+  if (cols <= 16) {
+    return 0.8;
+  }
+  if (cols <= 48) {
+    return 0.1;
+  }
+  return 0.05;
+}
+
+// Runs task(s, thread) for every node s of the tree given by parent, children
+// before parents. Nodes are numbered in postorder.
+static void runTreeTasks(int nnodes, const std::vector<int> &parent,
+                         int numThreads,
+                         const std::function<void(int, int)> &task) {
+  numThreads = std::min(numThreads, nnodes);
+  if (numThreads <= 1) {
+    for (int s = 0; s < nnodes; s++) {
+      task(s, 0);
+    }
+    return;
+  }
+
+  std::vector<int> pending(nnodes, 0);
+  for (int s = 0; s < nnodes; s++) {
+    if (-1 != parent[s]) {
+      pending[parent[s]]++;
+    }
+  }
+  std::vector<int> ready;
+  for (int s = nnodes - 1; s >= 0; s--) {
+    if (0 == pending[s]) {
+      ready.push_back(s);
+    }
+  }
+
+  std::mutex lock;
+  std::condition_variable wakeup;
+  int done = 0;
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < numThreads; t++) {
+    workers.push_back(std::thread([&, t]() {
+      std::unique_lock<std::mutex> guard(lock);
+      for (;;) {
+        wakeup.wait(guard, [&]() { return !ready.empty() || (done == nnodes); });
+        if (ready.empty()) {
+          return;
+        }
+        const int s = ready.back();
+        ready.pop_back();
+        guard.unlock();
+
+        task(s, t);
+
+        guard.lock();
+        done++;
+        const int p = parent[s];
+        if ((-1 != p) && (0 == --pending[p])) {
+          ready.push_back(p);
+          wakeup.notify_one();
+        }
+        if (done == nnodes) {
+          wakeup.notify_all();
+        }
+      }
+    }));
+  }
+  for (int t = 0; t < numThreads; t++) {
+    workers[t].join();
+  }
+}
+
+int mfqrCreateInfoHost(mfqrInfoHost_t *info) {
+  if (NULL == info) {
+    return 1;
+  }
+  *info = new mfqrInfoHost;
+  (*info)->m = 0;
+  (*info)->n = 0;
+  (*info)->nnzA = 0;
+  (*info)->analyzed = false;
+  (*info)->factored = false;
+  (*info)->nsuper = 0;
+  (*info)->maxFrontRows = 0;
+  (*info)->maxFrontCols = 0;
+  (*info)->nnzR = 0;
+  (*info)->flops = 0.0;
+  return 0;
+}
+
+int mfqrDestroyInfoHost(mfqrInfoHost_t info) {
+  delete info;
+  return 0;
+}
+
+int mfqrAnalysisHost(int m, int n, int nnzA, int baseA, const int *csrRowPtrA,
+                     const int *csrColIndA, mfqrInfoHost_t info) {
+  if ((NULL == info) || (n <= 0) || (m < n) || (nnzA < 0) ||
+      (NULL == csrRowPtrA) || (NULL == csrColIndA) ||
+      ((0 != baseA) && (1 != baseA))) {
+    return 1;
+  }
+  if ((csrRowPtrA[0] != baseA) || (csrRowPtrA[m] - baseA != nnzA)) {
+    return 1;
+  }
+  for (int p = 0; p < nnzA; p++) {
+    if ((csrColIndA[p] - baseA < 0) || (csrColIndA[p] - baseA >= n)) {
+      return 1;
+    }
+  }
+
+  info->m = m;
+  info->n = n;
+  info->nnzA = nnzA;
+  info->analyzed = false;
+  info->factored = false;
+
+  // CSC pattern of A
+  std::vector<int> cscColPtr(n + 1, 0);
+  std::vector<int> cscRowInd(nnzA);
+  for (int p = 0; p < nnzA; p++) {
+    cscColPtr[csrColIndA[p] - baseA + 1]++;
+  }
+  for (int j = 0; j < n; j++) {
+    cscColPtr[j + 1] += cscColPtr[j];
+  }
+  {
+    std::vector<int> fill(cscColPtr.begin(), cscColPtr.end() - 1);
+    for (int i = 0; i < m; i++) {
+      for (int p = csrRowPtrA[i] - baseA; p < csrRowPtrA[i + 1] - baseA; p++) {
+        cscRowInd[fill[csrColIndA[p] - baseA]++] = i;
+      }
+    }
+  }
+
+  // step 1: column elimination tree, prev[i] is the last column of row i
+  std::vector<int> parent(n, -1);
+  std::vector<int> ancestor(n, -1);
+  std::vector<int> prev(m, -1);
+  for (int k = 0; k < n; k++) {
+    for (int p = cscColPtr[k]; p < cscColPtr[k + 1]; p++) {
+      const int row = cscRowInd[p];
+      for (int i = prev[row]; (-1 != i) && (i < k);) {
+        int inext = ancestor[i];
+        ancestor[i] = k;
+        if (-1 == inext) {
+          parent[i] = k;
+        }
+        i = inext;
+      }
+      prev[row] = k;
+    }
+  }
+
+  // step 2: postorder of the column elimination tree
+  std::vector<int> head(n, -1);
+  std::vector<int> next(n, -1);
+  for (int j = n - 1; j >= 0; j--) {
+    if (-1 != parent[j]) {
+      next[j] = head[parent[j]];
+      head[parent[j]] = j;
+    }
+  }
+  info->perm.resize(n);
+  info->iperm.resize(n);
+  std::vector<int> stack(n);
+  int k = 0;
+  for (int root = 0; root < n; root++) {
+    if (-1 != parent[root]) {
+      continue;
+    }
+    int top = 0;
+    stack[0] = root;
+    while (top >= 0) {
+      int j = stack[top];
+      int child = head[j];
+      if (-1 == child) {
+        top--;
+        info->perm[k++] = j;
+      } else {
+        head[j] = next[child];
+        stack[++top] = child;
+      }
+    }
+  }
+  assert(k == n);
+  for (k = 0; k < n; k++) {
+    info->iperm[info->perm[k]] = k;
+  }
+  info->parent.resize(n);
+  for (k = 0; k < n; k++) {
+    int p = parent[info->perm[k]];
+    info->parent[k] = (-1 == p) ? -1 : info->iperm[p];
+  }
+
+  // step 3: leftmost column of every row and the row structure of R
+  std::vector<int> leftmost(m, -1);
+  std::vector<int> colRowPtr(n + 1, 0);
+  info->emptyRows.clear();
+  for (int i = 0; i < m; i++) {
+    for (int p = csrRowPtrA[i] - baseA; p < csrRowPtrA[i + 1] - baseA; p++) {
+      const int j = info->iperm[csrColIndA[p] - baseA];
+      leftmost[i] = (-1 == leftmost[i]) ? j : std::min(leftmost[i], j);
+    }
+    if (-1 == leftmost[i]) {
+      info->emptyRows.push_back(i);
+    } else {
+      colRowPtr[leftmost[i] + 1]++;
+    }
+  }
+  for (int j = 0; j < n; j++) {
+    colRowPtr[j + 1] += colRowPtr[j];
+  }
+  std::vector<int> colRowInd(colRowPtr[n]);
+  {
+    std::vector<int> fill(colRowPtr.begin(), colRowPtr.end() - 1);
+    for (int i = 0; i < m; i++) {
+      if (-1 != leftmost[i]) {
+        colRowInd[fill[leftmost[i]]++] = i;
+      }
+    }
+  }
+
+  for (int j = 0; j < n; j++) {
+    head[j] = -1;
+  }
+  for (int j = n - 1; j >= 0; j--) {
+    if (-1 != info->parent[j]) {
+      next[j] = head[info->parent[j]];
+      head[info->parent[j]] = j;
+    }
+  }
+  std::vector<int> rStructPtr(n + 1, 0);
+  std::vector<int> rStructInd;
+  std::vector<int> mark(n, -1);
+  for (int j = 0; j < n; j++) {
+    const int start = (int)rStructInd.size();
+    mark[j] = j;
+    rStructInd.push_back(j);
+    for (int q = colRowPtr[j]; q < colRowPtr[j + 1]; q++) {
+      const int i = colRowInd[q];
+      for (int p = csrRowPtrA[i] - baseA; p < csrRowPtrA[i + 1] - baseA; p++) {
+        const int c = info->iperm[csrColIndA[p] - baseA];
+        if (mark[c] != j) {
+          mark[c] = j;
+          rStructInd.push_back(c);
+        }
+      }
+    }
+    for (int child = head[j]; -1 != child; child = next[child]) {
+      for (int q = rStructPtr[child] + 1; q < rStructPtr[child + 1]; q++) {
+        const int c = rStructInd[q];
+        if (mark[c] != j) {
+          mark[c] = j;
+          rStructInd.push_back(c);
+        }
+      }
+    }
+    std::sort(rStructInd.begin() + start, rStructInd.end());
+    rStructPtr[j + 1] = (int)rStructInd.size();
+  }
+
+  // step 4: relaxed supernodes, every supernode is one front
+  info->superCol.clear();
+  double superNnz = 0.0;
+  for (int j = 0; j < n; j++) {
+    const int count = rStructPtr[j + 1] - rStructPtr[j];
+    bool merge = false;
+    if ((j > 0) && (info->parent[j - 1] == j)) {
+      const double cols = j - info->superCol.back() + 1;
+      const double rows = cols + count - 1;
+      const double entries = rows * cols - cols * (cols - 1) / 2;
+      const double zeros = entries - (superNnz + count);
+      merge = (zeros == 0.0) || ((cols <= MFQR_MAX_COLS) &&
+                                 (zeros <= relaxedZeros(cols) * entries));
+    }
+    if (merge) {
+      superNnz += count;
+    } else {
+      info->superCol.push_back(j);
+      superNnz = count;
+    }
+  }
+  info->superCol.push_back(n);
+  const int nsuper = (int)info->superCol.size() - 1;
+  info->nsuper = nsuper;
+
+  std::vector<int> colToSuper(n);
+  for (int s = 0; s < nsuper; s++) {
+    for (int j = info->superCol[s]; j < info->superCol[s + 1]; j++) {
+      colToSuper[j] = s;
+    }
+  }
+
+  // fronts: columns, assembled rows of A, children and dimensions
+  info->superParent.resize(nsuper);
+  info->frontColPtr.assign(nsuper + 1, 0);
+  info->frontColInd.clear();
+  info->rowPtr.assign(nsuper + 1, 0);
+  info->rowInd.clear();
+  info->childPtr.assign(nsuper + 1, 0);
+  for (int s = 0; s < nsuper; s++) {
+    const int first = info->superCol[s];
+    const int last = info->superCol[s + 1] - 1;
+    info->superParent[s] =
+        (-1 == info->parent[last]) ? -1 : colToSuper[info->parent[last]];
+    if (-1 != info->superParent[s]) {
+      info->childPtr[info->superParent[s] + 1]++;
+    }
+    for (int j = first; j < last; j++) {
+      info->frontColInd.push_back(j);
+    }
+    for (int q = rStructPtr[last]; q < rStructPtr[last + 1]; q++) {
+      info->frontColInd.push_back(rStructInd[q]);
+    }
+    info->frontColPtr[s + 1] = (int)info->frontColInd.size();
+    for (int j = first; j <= last; j++) {
+      for (int q = colRowPtr[j]; q < colRowPtr[j + 1]; q++) {
+        info->rowInd.push_back(colRowInd[q]);
+      }
+    }
+    info->rowPtr[s + 1] = (int)info->rowInd.size();
+  }
+  for (int s = 0; s < nsuper; s++) {
+    info->childPtr[s + 1] += info->childPtr[s];
+  }
+  info->childInd.resize(info->childPtr[nsuper]);
+  {
+    std::vector<int> fill(info->childPtr.begin(), info->childPtr.end() - 1);
+    for (int s = 0; s < nsuper; s++) {
+      if (-1 != info->superParent[s]) {
+        info->childInd[fill[info->superParent[s]]++] = s;
+      }
+    }
+  }
+
+  info->frontRows.resize(nsuper);
+  info->frontPivRows.resize(nsuper);
+  info->frontContRows.resize(nsuper);
+  info->frontValPtr.resize(nsuper + 1);
+  info->frontTauPtr.resize(nsuper + 1);
+  info->frontRhsPtr.resize(nsuper + 1);
+  info->frontValPtr[0] = 0;
+  info->frontTauPtr[0] = 0;
+  info->frontRhsPtr[0] = 0;
+  info->maxFrontRows = 0;
+  info->maxFrontCols = 0;
+  info->nnzR = 0;
+  info->flops = 0.0;
+  for (int s = 0; s < nsuper; s++) {
+    const int piv = info->superCol[s + 1] - info->superCol[s];
+    const int cols = info->frontColPtr[s + 1] - info->frontColPtr[s];
+    int rows = info->rowPtr[s + 1] - info->rowPtr[s];
+    for (int c = info->childPtr[s]; c < info->childPtr[s + 1]; c++) {
+      rows += info->frontContRows[info->childInd[c]];
+    }
+    const int kmax = std::min(rows, cols);
+    info->frontRows[s] = rows;
+    info->frontPivRows[s] = std::min(rows, piv);
+    info->frontContRows[s] = kmax - info->frontPivRows[s];
+    info->frontValPtr[s + 1] = info->frontValPtr[s] + (size_t)rows * cols;
+    info->frontTauPtr[s + 1] = info->frontTauPtr[s] + kmax;
+    info->frontRhsPtr[s + 1] = info->frontRhsPtr[s] + rows;
+    info->maxFrontRows = std::max(info->maxFrontRows, rows);
+    info->maxFrontCols = std::max(info->maxFrontCols, cols);
+    for (int p = 0; p < info->frontPivRows[s]; p++) {
+      info->nnzR += cols - p;
+    }
+    for (int p = 0; p < kmax; p++) {
+      info->flops += 4.0 * (rows - p) * (cols - p);
+    }
+  }
+
+  info->analyzed = true;
+  return 0;
+}
+
+int mfqrBufferInfoHost(mfqrInfoHost_t info, int numThreads,
+                       size_t *internalDataInBytes, size_t *workspaceInBytes) {
+  if ((NULL == info) || !info->analyzed || (NULL == internalDataInBytes) ||
+      (NULL == workspaceInBytes)) {
+    return 1;
+  }
+  numThreads = mfqrNumThreads(numThreads);
+  *internalDataInBytes =
+      sizeof(double) * (info->frontValPtr[info->nsuper] +
+                        info->frontTauPtr[info->nsuper]);
+  // Q'*b keeps one right-hand side per front plus c in pivot order
+  *workspaceInBytes = std::max(
+      numThreads * mfqrThreadBytes(info),
+      sizeof(double) * (info->frontRhsPtr[info->nsuper] + info->n));
+  return 0;
+}
+
+// Generates the Householder reflector H = I - tau*v*v' with H*x = beta*e1,
+// v(0) = 1 is implicit and v(1:len-1) overwrites x(1:len-1).
+static double householder(int len, double *x) {
+  double sigma = 0.0;
+  for (int i = 1; i < len; i++) {
+    sigma += x[i] * x[i];
+  }
+  if (0.0 == sigma) {
+    return 0.0;
+  }
+  const double alpha = x[0];
+  const double beta =
+      (alpha >= 0.0) ? -sqrt(alpha * alpha + sigma) : sqrt(alpha * alpha + sigma);
+  const double scale = 1.0 / (alpha - beta);
+  for (int i = 1; i < len; i++) {
+    x[i] *= scale;
+  }
+  x[0] = beta;
+  return (beta - alpha) / beta;
+}
+
+// Blocked Householder QR of the m x n column-major F, tau has min(m,n)
+// entries. T is MFQR_BLOCK^2 and W is MFQR_BLOCK*n doubles.
+static void householderQR(int m, int n, double *F, double *tau, double *T,
+                          double *W) {
+  const int kmax = std::min(m, n);
+  for (int kb = 0; kb < kmax; kb += MFQR_BLOCK) {
+    const int nb = std::min(MFQR_BLOCK, kmax - kb);
+
+    // panel factorization, unblocked on columns kb:kb+nb-1
+    for (int k = kb; k < kb + nb; k++) {
+      double *v = F + k + (size_t)k * m;
+      const int len = m - k;
+      tau[k] = householder(len, v);
+      if (0.0 == tau[k]) {
+        continue;
+      }
+      for (int j = k + 1; j < kb + nb; j++) {
+        double *c = F + k + (size_t)j * m;
+        double w = c[0];
+        for (int i = 1; i < len; i++) {
+          w += v[i] * c[i];
+        }
+        w *= tau[k];
+        c[0] -= w;
+        for (int i = 1; i < len; i++) {
+          c[i] -= w * v[i];
+        }
+      }
+    }
+
+    const int nc = n - (kb + nb);
+    if (nc <= 0) {
+      continue;
+    }
+
+    // T (nb x nb upper triangular) with H_kb * ... * H_kb+nb-1 = I - V*T*V'
+    const int len = m - kb;
+    const double *V = F + kb + (size_t)kb * m;
+    for (int i = 0; i < nb; i++) {
+      T[i + i * MFQR_BLOCK] = tau[kb + i];
+      // T(0:i-1, i) = -tau(i) * T(0:i-1, 0:i-1) * V(:, 0:i-1)' * v_i
+      for (int j = 0; j < i; j++) {
+        const double *vj = V + (size_t)j * m;
+        const double *vi = V + (size_t)i * m;
+        double dot = vj[i];
+        for (int r = i + 1; r < len; r++) {
+          dot += vj[r] * vi[r];
+        }
+        W[j] = -tau[kb + i] * dot;
+      }
+      for (int j = 0; j < i; j++) {
+        double sum = 0.0;
+        for (int l = j; l < i; l++) {
+          sum += T[j + l * MFQR_BLOCK] * W[l];
+        }
+        T[j + i * MFQR_BLOCK] = sum;
+      }
+    }
+
+    // C = (I - V*T'*V') * C, C = F(kb:m-1, kb+nb:n-1)
+    double *C = F + kb + (size_t)(kb + nb) * m;
+    // W = V' * C
+    for (int c = 0; c < nc; c++) {
+      const double *cc = C + (size_t)c * m;
+      for (int j = 0; j < nb; j++) {
+        const double *vj = V + (size_t)j * m;
+        double sum = cc[j];
+        for (int r = j + 1; r < len; r++) {
+          sum += vj[r] * cc[r];
+        }
+        W[j + c * MFQR_BLOCK] = sum;
+      }
+    }
+    // W = T' * W
+    for (int c = 0; c < nc; c++) {
+      double *wc = W + c * MFQR_BLOCK;
+      for (int j = nb - 1; j >= 0; j--) {
+        double sum = 0.0;
+        for (int l = 0; l <= j; l++) {
+          sum += T[l + j * MFQR_BLOCK] * wc[l];
+        }
+        wc[j] = sum;
+      }
+    }
+    // C = C - V * W
+    for (int c = 0; c < nc; c++) {
+      double *cc = C + (size_t)c * m;
+      const double *wc = W + c * MFQR_BLOCK;
+      for (int j = 0; j < nb; j++) {
+        const double *vj = V + (size_t)j * m;
+        const double w = wc[j];
+        cc[j] -= w;
+        for (int r = j + 1; r < len; r++) {
+          cc[r] -= w * vj[r];
+        }
+      }
+    }
+  }
+}
+
+static void factorFront(mfqrInfoHost_t info, const double *csrValA,
+                        const int *csrRowPtrA, const int *csrColIndA,
+                        int baseA, int s, double *work, int *colMap) {
+  const int rows = info->frontRows[s];
+  const int *colInd = &info->frontColInd[info->frontColPtr[s]];
+  const int cols = info->frontColPtr[s + 1] - info->frontColPtr[s];
+  double *F = &info->Fval[info->frontValPtr[s]];
+
+  for (int q = 0; q < cols; q++) {
+    colMap[colInd[q]] = q;
+  }
+  memset(F, 0, sizeof(double) * rows * cols);
+
+  // rows of A assigned to the front
+  int r = 0;
+  for (int q = info->rowPtr[s]; q < info->rowPtr[s + 1]; q++, r++) {
+    const int i = info->rowInd[q];
+    for (int p = csrRowPtrA[i] - baseA; p < csrRowPtrA[i + 1] - baseA; p++) {
+      const int c = colMap[info->iperm[csrColIndA[p] - baseA]];
+      F[r + (size_t)c * rows] += csrValA[p];
+    }
+  }
+
+  // contribution blocks of the children, upper trapezoidal
+  for (int q = info->childPtr[s]; q < info->childPtr[s + 1]; q++) {
+    const int child = info->childInd[q];
+    const int crows = info->frontRows[child];
+    const int *ccol = &info->frontColInd[info->frontColPtr[child]];
+    const int ccols = info->frontColPtr[child + 1] - info->frontColPtr[child];
+    const int first = info->frontPivRows[child];
+    const int count = info->frontContRows[child];
+    const double *Fc = &info->Fval[info->frontValPtr[child]];
+    for (int c = first; c < ccols; c++) {
+      double *f = F + (size_t)colMap[ccol[c]] * rows + r;
+      const double *fc = Fc + (size_t)c * crows + first;
+      const int len = std::min(count, c - first + 1);
+      for (int t = 0; t < len; t++) {
+        f[t] = fc[t];
+      }
+    }
+    r += count;
+  }
+  assert(r == rows);
+
+  householderQR(rows, cols, F, &info->tau[info->frontTauPtr[s]], work,
+                work + MFQR_BLOCK * MFQR_BLOCK);
+}
+
+int mfqrFactorHost(int m, int n, int nnzA, const double *csrValA,
+                   const int *csrRowPtrA, const int *csrColIndA,
+                   mfqrInfoHost_t info, int numThreads, void *pBuffer) {
+  if ((NULL == info) || !info->analyzed || (m != info->m) || (n != info->n) ||
+      (nnzA != info->nnzA) || (NULL == csrValA) || (NULL == csrRowPtrA) ||
+      (NULL == csrColIndA) || (NULL == pBuffer)) {
+    return 1;
+  }
+  const int baseA = csrRowPtrA[0];
+  const size_t threadBytes = mfqrThreadBytes(info);
+  char *buffer = (char *)pBuffer;
+
+  info->Fval.resize(info->frontValPtr[info->nsuper]);
+  info->tau.resize(info->frontTauPtr[info->nsuper]);
+
+  runTreeTasks(info->nsuper, info->superParent, mfqrNumThreads(numThreads),
+               [&](int s, int t) {
+                 double *work = (double *)(buffer + t * threadBytes);
+                 int *colMap =
+                     (int *)(work + MFQR_BLOCK * (MFQR_BLOCK +
+                                                  (size_t)info->maxFrontCols));
+                 factorFront(info, csrValA, csrRowPtrA, csrColIndA, baseA, s,
+                             work, colMap);
+               });
+
+  info->factored = true;
+  return 0;
+}
+
+int mfqrZeroPivotHost(mfqrInfoHost_t info, double tol, int *position) {
+  if ((NULL == info) || !info->factored || (NULL == position)) {
+    return 1;
+  }
+  *position = -1;
+  for (int s = 0; s < info->nsuper; s++) {
+    const int first = info->superCol[s];
+    const int piv = info->superCol[s + 1] - first;
+    const int rows = info->frontRows[s];
+    const double *F = &info->Fval[info->frontValPtr[s]];
+    for (int p = 0; p < piv; p++) {
+      if ((p >= info->frontPivRows[s]) ||
+          (fabs(F[p + (size_t)p * rows]) <= tol)) {
+        *position = info->perm[first + p];
+        return 0;
+      }
+    }
+  }
+  return 0;
+}
+
+int mfqrApplyQtHost(int m, const double *b, double *c, double *rnorm,
+                    mfqrInfoHost_t info, void *pBuffer) {
+  if ((NULL == info) || !info->factored || (m != info->m) || (NULL == b) ||
+      (NULL == c) || (NULL == pBuffer)) {
+    return 1;
+  }
+  double *rhs = (double *)pBuffer;
+  double rnorm2 = 0.0;
+
+  for (size_t e = 0; e < info->emptyRows.size(); e++) {
+    rnorm2 += b[info->emptyRows[e]] * b[info->emptyRows[e]];
+  }
+
+  // replay the assembly of every front on b and apply its reflectors
+  for (int s = 0; s < info->nsuper; s++) {
+    const int rows = info->frontRows[s];
+    const int cols = info->frontColPtr[s + 1] - info->frontColPtr[s];
+    const int kmax = std::min(rows, cols);
+    const double *F = &info->Fval[info->frontValPtr[s]];
+    const double *tau = &info->tau[info->frontTauPtr[s]];
+    double *y = rhs + info->frontRhsPtr[s];
+
+    int r = 0;
+    for (int q = info->rowPtr[s]; q < info->rowPtr[s + 1]; q++) {
+      y[r++] = b[info->rowInd[q]];
+    }
+    for (int q = info->childPtr[s]; q < info->childPtr[s + 1]; q++) {
+      const int child = info->childInd[q];
+      const double *yc = rhs + info->frontRhsPtr[child];
+      for (int t = 0; t < info->frontContRows[child]; t++) {
+        y[r++] = yc[info->frontPivRows[child] + t];
+      }
+    }
+
+    for (int k = 0; k < kmax; k++) {
+      if (0.0 == tau[k]) {
+        continue;
+      }
+      const double *v = F + k + (size_t)k * rows;
+      double w = y[k];
+      for (int i = 1; i < rows - k; i++) {
+        w += v[i] * y[k + i];
+      }
+      w *= tau[k];
+      y[k] -= w;
+      for (int i = 1; i < rows - k; i++) {
+        y[k + i] -= w * v[i];
+      }
+    }
+
+    const int first = info->superCol[s];
+    const int piv = info->superCol[s + 1] - first;
+    for (int p = 0; p < piv; p++) {
+      c[info->perm[first + p]] = (p < info->frontPivRows[s]) ? y[p] : 0.0;
+    }
+    for (int i = kmax; i < rows; i++) {
+      rnorm2 += y[i] * y[i];
+    }
+  }
+
+  if (rnorm) {
+    *rnorm = sqrt(rnorm2);
+  }
+  return 0;
+}
+
+int mfqrSolveRHost(int n, const double *c, double *x, mfqrInfoHost_t info,
+                   void *pBuffer) {
+  if ((NULL == info) || !info->factored || (n != info->n) || (NULL == c) ||
+      (NULL == x) || (NULL == pBuffer)) {
+    return 1;
+  }
+  // x in pivot order, placed after the right-hand sides of the fronts
+  double *xp = (double *)pBuffer + info->frontRhsPtr[info->nsuper];
+
+  for (int s = info->nsuper - 1; s >= 0; s--) {
+    const int first = info->superCol[s];
+    const int piv = info->superCol[s + 1] - first;
+    const int rows = info->frontRows[s];
+    const int *colInd = &info->frontColInd[info->frontColPtr[s]];
+    const int cols = info->frontColPtr[s + 1] - info->frontColPtr[s];
+    const double *F = &info->Fval[info->frontValPtr[s]];
+
+    for (int p = piv - 1; p >= 0; p--) {
+      if (p >= info->frontPivRows[s]) {
+        xp[first + p] = 0.0;
+        continue;
+      }
+      double sum = c[info->perm[first + p]];
+      for (int q = p + 1; q < cols; q++) {
+        sum -= F[p + (size_t)q * rows] * xp[colInd[q]];
+      }
+      xp[first + p] = sum / F[p + (size_t)p * rows];
+    }
+  }
+
+  for (int k = 0; k < n; k++) {
+    x[info->perm[k]] = xp[k];
+  }
+  return 0;
+}
+
+int mfqrSolveHost(int m, int n, const double *b, double *x, double *rnorm,
+                  mfqrInfoHost_t info, void *pBuffer) {
+  if ((NULL == info) || (n != info->n) || (NULL == x)) {
+    return 1;
+  }
+  std::vector<double> c(n);
+  if (mfqrApplyQtHost(m, b, &c[0], rnorm, info, pBuffer)) {
+    return 1;
+  }
+  return mfqrSolveRHost(n, &c[0], x, info, pBuffer);
+}
+
+int mfqrGetStatsHost(mfqrInfoHost_t info, int *numFronts, int *maxFrontRows,
+                     int *maxFrontCols, long long *nnzR, double *flops) {
+  if ((NULL == info) || !info->analyzed) {
+    return 1;
+  }
+  if (numFronts) {
+    *numFronts = info->nsuper;
+  }
+  if (maxFrontRows) {
+    *maxFrontRows = info->maxFrontRows;
+  }
+  if (maxFrontCols) {
+    *maxFrontCols = info->maxFrontCols;
+  }
+  if (nnzR) {
+    *nnzR = info->nnzR;
+  }
+  if (flops) {
+    *flops = info->flops;
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host multifrontal sparse QR, A*P = Q*R, for m >= n.
+ *
+ * The phases follow the csrqr low level API of cuSolverSp:
+ *   mfqrAnalysisHost   : column elimination tree, postorder P, fronts
+ *   mfqrBufferInfoHost : size of the fronts and of the workspace
+ *   mfqrFactorHost     : blocked Householder QR of every front, the fronts
+ *                        are scheduled as tasks over the elimination tree
+ *   mfqrZeroPivotHost  : first column whose |R(j,j)| is not larger than tol
+ *   mfqrApplyQtHost    : c = Q'*b with the implicitly stored Q
+ *   mfqrSolveHost      : least-squares solution x = argmin |b - A*x|
+ *
+ * Q is never formed, every front keeps its Householder vectors below the
+ * diagonal and R above it.
+ *
+ * All functions return 0 on success and a non-zero value on invalid input.
+ */
+
+#ifndef MULTIFRONTAL_QR_HOST_H
+#define MULTIFRONTAL_QR_HOST_H
+
+#include <stddef.h>
+
+typedef struct mfqrInfoHost *mfqrInfoHost_t;
+
+int mfqrCreateInfoHost(mfqrInfoHost_t *info);
+
+int mfqrDestroyInfoHost(mfqrInfoHost_t info);
+
+int mfqrAnalysisHost(int m, int n, int nnzA, int baseA, const int *csrRowPtrA,
+                     const int *csrColIndA, mfqrInfoHost_t info);
+
+// numThreads <= 0 selects the number of hardware threads
+int mfqrBufferInfoHost(mfqrInfoHost_t info, int numThreads,
+                       size_t *internalDataInBytes, size_t *workspaceInBytes);
+
+int mfqrFactorHost(int m, int n, int nnzA, const double *csrValA,
+                   const int *csrRowPtrA, const int *csrColIndA,
+                   mfqrInfoHost_t info, int numThreads, void *pBuffer);
+
+// position = -1 if all |R(j,j)| are larger than tol, otherwise the column
+// of A where the first small pivot was found
+int mfqrZeroPivotHost(mfqrInfoHost_t info, double tol, int *position);
+
+// c(0:n-1) = (Q'*b)(0:n-1), indexed by the columns of A, and
+// rnorm = |(Q'*b)(n:m-1)|, the norm of the least-squares residual
+int mfqrApplyQtHost(int m, const double *b, double *c, double *rnorm,
+                    mfqrInfoHost_t info, void *pBuffer);
+
+// x = R \ c for c returned by mfqrApplyQtHost
+int mfqrSolveRHost(int n, const double *c, double *x, mfqrInfoHost_t info,
+                   void *pBuffer);
+
+// x = argmin |b - A*x|, rnorm = |b - A*x| (may be NULL)
+int mfqrSolveHost(int m, int n, const double *b, double *x, double *rnorm,
+                  mfqrInfoHost_t info, void *pBuffer);
+
+int mfqrGetStatsHost(mfqrInfoHost_t info, int *numFronts, int *maxFrontRows,
+                     int *maxFrontCols, long long *nnzR, double *flops);
+
+#endif  // MULTIFRONTAL_QR_HOST_H
@@ -58,6 +58,7 @@
 
 #include <helper_cuda.h>
 #include <helper_functions.h>
+#include <helper_golden.h>
 #include <math_constants.h>
 
 #if defined(__APPLE__) || defined(MACOSX)
@@ -459,9 +460,9 @@ void runCudaTest(char *exec_path) {
     sdkDumpBin((void *)hptr, meshSize * meshSize * sizeof(float),
                "spatialDomain.bin");
 
-    if (!sdkCompareBin2BinFloat("spatialDomain.bin", "ref_spatialDomain.bin",
-                                meshSize * meshSize, MAX_EPSILON, THRESHOLD,
-                                exec_path)) {
+    if (!sdkCompareBin2BinGoldenFloat(
+            "spatialDomain.bin", "ref_spatialDomain.bin", meshSize * meshSize,
+            MAX_EPSILON, THRESHOLD, exec_path)) {
       g_TotalErrors++;
     }
 
@@ -477,9 +478,9 @@ void runCudaTest(char *exec_path) {
                meshSize * meshSize * sizeof(float2), cudaMemcpyDeviceToHost);
     sdkDumpBin(sptr, meshSize * meshSize * sizeof(float2), "slopeShading.bin");
 
-    if (!sdkCompareBin2BinFloat("slopeShading.bin", "ref_slopeShading.bin",
-                                meshSize * meshSize * 2, MAX_EPSILON, THRESHOLD,
-                                exec_path)) {
+    if (!sdkCompareBin2BinGoldenFloat(
+            "slopeShading.bin", "ref_slopeShading.bin", meshSize * meshSize * 2,
+            MAX_EPSILON, THRESHOLD, exec_path)) {
       g_TotalErrors++;
     }
 
@@ -31,6 +31,8 @@
  * See supplied whitepaper for more explanations.
  */
 
+#include <float.h>
+
 #include <cuda_runtime.h>
 #include <nvrtc_helper.h>
 
@@ -45,6 +47,11 @@ extern "C" void BlackScholesCPU(float *h_CallResult, float *h_PutResult,
                                 float *h_OptionYears, float Riskfree,
                                 float Volatility, int optN);
 
+extern "C" void BlackScholesImpliedVolCPU(
+    float *h_ImpliedVol, float *h_PriceError, int *h_Iterations,
+    float *h_CallPrice, float *h_StockPrice, float *h_OptionStrike,
+    float *h_OptionYears, float Riskfree, int optN, int numThreads);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Process an array of OptN options on GPU
 ////////////////////////////////////////////////////////////////////////////////
@@ -59,6 +66,21 @@ float RandFloat(float low, float high) {
   return (1.0f - t) * low + t * high;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Call price and vega in double precision, to reprice implied volatilities
+////////////////////////////////////////////////////////////////////////////////
+
+static double CallPrice(double S, double X, double T, double R, double V,
+                        double *vega) {
+  double sqrtT = sqrt(T);
+  double d1 = (log(S / X) + (R + 0.5 * V * V) * T) / (V * sqrtT);
+  double d2 = d1 - V * sqrtT;
+
+  *vega = S * sqrtT * 0.39894228040143267794 * exp(-0.5 * d1 * d1);
+  return S * 0.5 * erfc(-d1 * 0.70710678118654752440) -
+         X * exp(-R * T) * 0.5 * erfc(-d2 * 0.70710678118654752440);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Data configuration
 ////////////////////////////////////////////////////////////////////////////////
@@ -235,6 +257,66 @@ int main(int argc, char **argv) {
   printf("L1 norm: %E\n", L1norm);
   printf("Max absolute error: %E\n\n", max_delta);
 
+  int ivFailures = 0;
+
+  if (checkCmdLineFlag(argc, (const char **)argv, "impliedvol")) {
+    // Invert the CPU call prices back to the volatility they were priced at
+    float *h_ImpliedVol = (float *)malloc(OPT_SZ);
+    float *h_PriceError = (float *)malloc(OPT_SZ);
+    int *h_Iterations = (int *)malloc(OPT_N * sizeof(int));
+    int numThreads =
+        getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+
+    printf("Computing implied volatilities on CPU...\n");
+    sdkResetTimer(&hTimer);
+    sdkStartTimer(&hTimer);
+    BlackScholesImpliedVolCPU(h_ImpliedVol, h_PriceError, h_Iterations,
+                              h_CallResultCPU, h_StockPrice, h_OptionStrike,
+                              h_OptionYears, RISKFREE, OPT_N, numThreads);
+    sdkStopTimer(&hTimer);
+
+    double ivTime = sdkGetTimerValue(&hTimer), sum_iterations = 0;
+    double max_error = 0, max_reprice = 0;
+    int max_iterations = 0, solved = 0, within = 0;
+
+    for (i = 0; i < OPT_N; i++) {
+      if (!(h_ImpliedVol[i] > 0)) continue;
+
+      solved++;
+      sum_iterations += h_Iterations[i];
+      max_iterations = (h_Iterations[i] > max_iterations) ? h_Iterations[i]
+                                                          : max_iterations;
+      max_error = (h_PriceError[i] > max_error) ? h_PriceError[i] : max_error;
+      within += (fabs(h_ImpliedVol[i] - VOLATILITY) < 1e-4) ? 1 : 0;
+
+      // The quote priced at the returned volatility, which is only exact up
+      // to its rounding to float
+      double vega, V = h_ImpliedVol[i];
+      double reprice = fabs(CallPrice(h_StockPrice[i], h_OptionStrike[i],
+                                      h_OptionYears[i], RISKFREE, V, &vega) -
+                            h_CallResultCPU[i]);
+      max_reprice = (reprice > max_reprice) ? reprice : max_reprice;
+      ivFailures +=
+          (reprice > vega * V * FLT_EPSILON + 1e-12 * h_StockPrice[i]) ? 1
+                                                                        : 0;
+    }
+
+    printf("BlackScholesImpliedVolCPU() time: %f msec\n", ivTime);
+    printf("Quotes per second             : %E\n",
+           (double)OPT_N / (ivTime * 1E-3));
+    printf("Quotes solved                 : %i of %i\n", solved, OPT_N);
+    printf("Iterations, mean / max        : %.2f / %i\n",
+           sum_iterations / (solved ? solved : 1), max_iterations);
+    printf("Max absolute price error      : %E\n", max_error);
+    printf("Within 1e-4 of the volatility : %i\n", within);
+    printf("Max absolute repricing error  : %E\n", max_reprice);
+    printf("Quotes not repriced           : %i\n\n", ivFailures);
+
+    free(h_Iterations);
+    free(h_PriceError);
+    free(h_ImpliedVol);
+  }
+
   printf("Shutting down...\n");
   printf("...releasing GPU memory.\n");
 
@@ -259,7 +341,7 @@ int main(int argc, char **argv) {
 
   printf("\n[%s] - Test Summary\n", argv[0]);
 
-  if (L1norm > 1e-6) {
+  if (L1norm > 1e-6 || ivFailures > 0) {
     printf("Test failed!\n");
     exit(EXIT_FAILURE);
   }
@@ -25,52 +25,61 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <float.h>
 #include <math.h>
 
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <helper_vecmath.h>
+
 ///////////////////////////////////////////////////////////////////////////////
-// Polynomial approximation of cumulative normal distribution function
+// Black-Scholes formula for both call and put
+//
+// The options are processed in chunks: d1, d2 and the discount factors of a
+// chunk are computed first, then log, exp and the polynomial approximation of
+// the cumulative normal distribution function run over the whole chunk with
+// the vector math helpers.
 ///////////////////////////////////////////////////////////////////////////////
+static const int BS_CHUNK = 256;
 
-static double CND(double d) {
-  const double A1 = 0.31938153;
-  const double A2 = -0.356563782;
-  const double A3 = 1.781477937;
-  const double A4 = -1.821255978;
-  const double A5 = 1.330274429;
-  const double RSQRT2PI = 0.39894228040143267793994605993438;
-
-  double K = 1.0 / (1.0 + 0.2316419 * fabs(d));
+static void BlackScholesChunkCPU(float *callResult, float *putResult,
+                                 const float *Sf,  // Stock price
+                                 const float *Xf,  // Option strike
+                                 const float *Tf,  // Option years
+                                 float Rf,         // Riskless rate
+                                 float Vf,         // Volatility rate
+                                 int n) {
+  double logSX[BS_CHUNK], d1[BS_CHUNK], d2[BS_CHUNK], expRT[BS_CHUNK];
+  const double R = Rf, V = Vf;
 
-  double cnd = RSQRT2PI * exp(-0.5 * d * d) *
-               (K * (A1 + K * (A2 + K * (A3 + K * (A4 + K * A5)))));
+  for (int i = 0; i < n; i++) logSX[i] = (double)Sf[i] / (double)Xf[i];
 
-  if (d > 0) cnd = 1.0 - cnd;
+  sdkVecLog(logSX, logSX, n);
 
-  return cnd;
-}
+  for (int i = 0; i < n; i++) {
+    double T = Tf[i];
+    double sqrtT = sqrt(T);
+    d1[i] = (logSX[i] + (R + 0.5 * V * V) * T) / (V * sqrtT);
+    d2[i] = d1[i] - V * sqrtT;
+    expRT[i] = -R * T;
+  }
 
-///////////////////////////////////////////////////////////////////////////////
-// Black-Scholes formula for both call and put
-///////////////////////////////////////////////////////////////////////////////
-static void BlackScholesBodyCPU(float &callResult, float &putResult,
-                                float Sf,  // Stock price
-                                float Xf,  // Option strike
-                                float Tf,  // Option years
-                                float Rf,  // Riskless rate
-                                float Vf  // Volatility rate
-                                ) {
-  double S = Sf, X = Xf, T = Tf, R = Rf, V = Vf;
-  double sqrtT = sqrt(T);
-  double d1 = (log(S / X) + (R + 0.5 * V * V) * T) / (V * sqrtT);
-  double d2 = d1 - V * sqrtT;
-  double CNDD1 = CND(d1);
-  double CNDD2 = CND(d2);
+  sdkVecCND(d1, d1, n);
+  sdkVecCND(d2, d2, n);
+  sdkVecExp(expRT, expRT, n);
 
   // Calculate Call and Put simultaneously
-  double expRT = exp(-R * T);
+  for (int i = 0; i < n; i++) {
+    double S = Sf[i], X = Xf[i];
+    double CNDD1 = d1[i];
+    double CNDD2 = d2[i];
 
-  callResult = (float)(S * CNDD1 - X * expRT * CNDD2);
-  putResult = (float)(X * expRT * (1.0 - CNDD2) - S * (1.0 - CNDD1));
+    callResult[i] = (float)(S * CNDD1 - X * expRT[i] * CNDD2);
+    putResult[i] = (float)(X * expRT[i] * (1.0 - CNDD2) - S * (1.0 - CNDD1));
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -81,8 +90,262 @@ extern "C" void BlackScholesCPU(float *h_CallResult, float *h_PutResult,
                                 float *h_StockPrice, float *h_OptionStrike,
                                 float *h_OptionYears, float Riskfree,
                                 float Volatility, int optN) {
-  for (int opt = 0; opt < optN; opt++)
-    BlackScholesBodyCPU(h_CallResult[opt], h_PutResult[opt], h_StockPrice[opt],
-                        h_OptionStrike[opt], h_OptionYears[opt], Riskfree,
-                        Volatility);
+  for (int opt = 0; opt < optN; opt += BS_CHUNK) {
+    int n = (optN - opt < BS_CHUNK) ? optN - opt : BS_CHUNK;
+
+    BlackScholesChunkCPU(h_CallResult + opt, h_PutResult + opt,
+                         h_StockPrice + opt, h_OptionStrike + opt,
+                         h_OptionYears + opt, Riskfree, Volatility, n);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Implied volatility of call prices
+//
+// Every quote is normalized as in Jaeckel, "Let's be rational": with the
+// forward F = S * exp(RT), x = log(F / X) and the total volatility s = V *
+// sqrt(T), the price C * exp(RT) / sqrt(F * X) is
+//   b(x, s) = exp(x / 2) * N(x / s + s / 2) - exp(-x / 2) * N(x / s - s / 2)
+// In the money calls are turned into out of the money calls by subtracting
+// the intrinsic value, so x <= 0. b is convex in s below the inflection
+// point sc = sqrt(-2x) and concave above it. Quotes below b(x, sc) are
+// solved for log(b), the others for b, with third order Householder steps
+// from a rational guess, inside a bracket that falls back to bisection.
+//
+// A chunk of quotes runs its iterations together: the lanes that have not
+// converged are kept in a list, and exp and log of the list run with the
+// vector math helpers.
+///////////////////////////////////////////////////////////////////////////////
+static const int IV_MAX_ITERATIONS = 32;
+
+// N(d), accurate in the tails
+static inline double NormalCDF(double d) {
+  return 0.5 * erfc(-d * 0.70710678118654752440);
+}
+
+// b(x, s), and in *noise the rounding error of the difference
+static inline double NormalizedCall(double x, double ex2, double emx2, double s,
+                                    double *noise = NULL) {
+  double b1 = ex2 * NormalCDF(x / s + 0.5 * s);
+
+  if (noise) *noise = 8.0 * DBL_EPSILON * b1;
+
+  return b1 - emx2 * NormalCDF(x / s - 0.5 * s);
+}
+
+static void ImpliedVolChunkCPU(float *volResult, float *priceError,
+                               int *iterations, const float *Cf,
+                               const float *Sf,  // Stock price
+                               const float *Xf,  // Option strike
+                               const float *Tf,  // Option years
+                               float Rf,         // Riskless rate
+                               int n) {
+  double x[BS_CHUNK], ex2[BS_CHUNK], emx2[BS_CHUNK], beta[BS_CHUNK];
+  double logBeta[BS_CHUNK], scale[BS_CHUNK], s[BS_CHUNK];
+  double lo[BS_CHUNK], hi[BS_CHUNK];
+  double t0[BS_CHUNK], t1[BS_CHUNK], t2[BS_CHUNK], noise[BS_CHUNK];
+  bool lower[BS_CHUNK];
+  int active[BS_CHUNK], m = 0;
+  const double R = Rf;
+
+  // Forward, moneyness and normalized price
+  for (int i = 0; i < n; i++) t0[i] = R * Tf[i];
+
+  sdkVecExp(t0, t0, n);
+
+  for (int i = 0; i < n; i++) {
+    double F = Sf[i] * t0[i], X = Xf[i];
+    x[i] = F / X;
+    scale[i] = sqrt(F * X) / t0[i];
+    beta[i] = Cf[i] / scale[i];
+  }
+
+  sdkVecLog(x, x, n);
+
+  for (int i = 0; i < n; i++) t1[i] = 0.5 * x[i];
+
+  sdkVecExp(t1, t1, n);
+
+  for (int i = 0; i < n; i++) {
+    ex2[i] = t1[i];
+    emx2[i] = 1.0 / t1[i];
+
+    if (x[i] > 0) {
+      beta[i] -= ex2[i] - emx2[i];
+      x[i] = -x[i];
+      ex2[i] = emx2[i];
+      emx2[i] = t1[i];
+    }
+
+    iterations[i] = 0;
+
+    if (!(Tf[i] > 0) || !(beta[i] < ex2[i])) {
+      // At or above the stock price, or not a valid quote
+      volResult[i] = NAN;
+      priceError[i] = NAN;
+    } else if (!(beta[i] > 0)) {
+      // At or below the intrinsic value
+      volResult[i] = 0;
+      priceError[i] = (float)(-beta[i] * scale[i]);
+    } else {
+      active[m++] = i;
+    }
+  }
+
+  // Branch, bracket and initial guess
+  for (int k = 0; k < m; k++) {
+    int i = active[k];
+    double sc = sqrt(-2.0 * x[i]);
+
+    lower[i] =
+        (sc > 0) && (beta[i] < NormalizedCall(x[i], ex2[i], emx2[i], sc));
+    // b(x, s) <= b(0, s) <= s / sqrt(2 pi) bounds the root from below, and
+    // keeps the guess positive at the money, where sc is 0
+    lo[i] = (std::max)(lower[i] ? 0.0 : sc, 2.50662827463100050242 * beta[i]);
+    hi[i] = lower[i] ? sc : HUGE_VAL;
+    s[i] = lower[i] ? sc : lo[i];
+    t0[k] = beta[i];
+    t1[k] = (ex2[i] - beta[i]) / (ex2[i] + emx2[i]);
+  }
+
+  sdkVecLog(t0, t0, m);
+  sdkVecInvCND(t1, t1, m);
+
+  for (int k = 0; k < m; k++) {
+    int i = active[k];
+    logBeta[i] = t0[k];
+
+    if (lower[i]) {
+      // b(x, s) < exp(-x^2 / 2s^2), the guess is below the root
+      s[i] = (std::min)(-x[i] / sqrt(-2.0 * t0[k]), s[i]);
+    } else {
+      // exact at the money, where exp(x / 2) - b = 2 N(-s / 2), unless
+      // 1 - beta rounds to 1
+      s[i] = (std::max)(-2.0 * t1[k], s[i]);
+    }
+  }
+
+  // Householder iterations over the lanes that have not converged
+  for (int iter = 1; m > 0; iter++) {
+    for (int k = 0; k < m; k++) {
+      int i = active[k];
+      double xs = x[i] / s[i];
+      t0[k] = NormalizedCall(x[i], ex2[i], emx2[i], s[i], &noise[k]);
+      t1[k] = -0.5 * (xs * xs + 0.25 * s[i] * s[i]);
+    }
+
+    sdkVecExp(t1, t1, m);
+    sdkVecLog(t2, t0, m);
+
+    int next = 0;
+
+    for (int k = 0; k < m; k++) {
+      int i = active[k];
+      double b = t0[k], si = s[i], xs = x[i] / si;
+      double db = 0.39894228040143267794 * t1[k];
+
+      // second and third derivative of b over the first
+      double h2 = xs * xs / si - 0.25 * si;
+      double h3 = h2 * h2 - 3.0 * xs * xs / (si * si) - 0.25;
+      double nu, H2, H3;
+
+      if (lower[i]) {
+        double q = db / b;
+        nu = (logBeta[i] - t2[k]) / q;
+        H2 = h2 - q;
+        H3 = h3 - 3.0 * h2 * q + 2.0 * q * q;
+      } else {
+        nu = (beta[i] - b) / db;
+        H2 = h2;
+        H3 = h3;
+      }
+
+      // done when b is within rounding of the quote, or at the last step
+      const double err = fabs(b - beta[i]);
+      bool done = err <= noise[k] || iter == IV_MAX_ITERATIONS;
+
+      if (!done) {
+        if (b > beta[i]) {
+          hi[i] = si;
+        } else {
+          lo[i] = si;
+        }
+
+        double sn = si + nu * (1.0 + 0.5 * H2 * nu) /
+                             (1.0 + nu * (H2 + nu * H3 * (1.0 / 6.0)));
+
+        if (sn > lo[i] && sn < hi[i]) {
+          // or when the Householder step vanishes
+          done = fabs(sn - si) <= 4.0 * DBL_EPSILON * si;
+        } else if (hi[i] - lo[i] <= 4.0 * DBL_EPSILON * hi[i]) {
+          // or when the bracket vanishes
+          done = true;
+        } else {
+          sn = (hi[i] < HUGE_VAL) ? 0.5 * (lo[i] + hi[i]) : 2.0 * si;
+        }
+
+        s[i] = sn;
+      }
+
+      // si is the last volatility b was priced at
+      if (done) {
+        volResult[i] = (float)(si / sqrt((double)Tf[i]));
+        priceError[i] = (float)(err * scale[i]);
+        iterations[i] = iter;
+      } else {
+        active[next++] = i;
+      }
+    }
+
+    m = next;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Implied volatility of an array of optN call prices, e.g. as computed by
+// BlackScholesCPU(). h_PriceError returns the absolute difference between
+// the price of every quote and the price at its implied volatility, and
+// h_Iterations the number of Householder steps. Prices at or below the
+// intrinsic value return 0, prices at or above the stock price return NaN.
+// numThreads <= 0 selects the number of hardware threads.
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" void BlackScholesImpliedVolCPU(
+    float *h_ImpliedVol, float *h_PriceError, int *h_Iterations,
+    float *h_CallPrice, float *h_StockPrice, float *h_OptionStrike,
+    float *h_OptionYears, float Riskfree, int optN, int numThreads) {
+  const int numChunks = (optN + BS_CHUNK - 1) / BS_CHUNK;
+  std::atomic<int> nextChunk(0);
+
+  auto worker = [&]() {
+    for (int c = nextChunk++; c < numChunks; c = nextChunk++) {
+      int opt = c * BS_CHUNK;
+      int n = (optN - opt < BS_CHUNK) ? optN - opt : BS_CHUNK;
+
+      ImpliedVolChunkCPU(h_ImpliedVol + opt, h_PriceError + opt,
+                         h_Iterations + opt, h_CallPrice + opt,
+                         h_StockPrice + opt, h_OptionStrike + opt,
+                         h_OptionYears + opt, Riskfree, n);
+    }
+  };
+
+  if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+  // at least 16 chunks per thread
+  numThreads = (std::min)(numThreads, numChunks / 16);
+
+  std::vector<std::thread> threads;
+
+  for (int t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker));
+    } catch (const std::system_error &) {
+      // no thread support, this thread takes the remaining chunks
+      break;
+    }
+  }
+
+  worker();
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
 }
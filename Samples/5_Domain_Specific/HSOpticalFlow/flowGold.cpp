@@ -25,6 +25,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <helper_pyramid.h>
+
 #include "common.h"
 #include "flowGold.h"
 
@@ -117,21 +119,10 @@ inline float Tex2Di(const float *src, int w, int h, int s, int x, int y) {
 ///////////////////////////////////////////////////////////////////////////////
 static void Downscale(const float *src, int width, int height, int stride,
                       int newWidth, int newHeight, int newStride, float *out) {
-  for (int i = 0; i < newHeight; ++i) {
-    for (int j = 0; j < newWidth; ++j) {
-      const int srcX = j * 2;
-      const int srcY = i * 2;
-      // average 4 neighbouring pixels
-      float sum;
-      sum = Tex2Di(src, width, height, stride, srcX + 0, srcY + 0);
-      sum += Tex2Di(src, width, height, stride, srcX + 0, srcY + 1);
-      sum += Tex2Di(src, width, height, stride, srcX + 1, srcY + 0);
-      sum += Tex2Di(src, width, height, stride, srcX + 1, srcY + 1);
-      // normalize
-      sum *= 0.25f;
-      out[j + i * newStride] = sum;
-    }
-  }
+  // average 4 neighbouring pixels, out of range pixels are mirrored
+  const sdkPyramidLevel levels[2] = {{(float *)src, width, height, stride},
+                                     {out, newWidth, newHeight, newStride}};
+  sdkPyramidSweep(levels, 2, sdkPyramidFilter::box2());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -260,10 +251,14 @@ static void ComputeDerivatives(const float *I0, const float *I1, int w, int h,
 /// \param[in]  alpha   degree of smoothness
 /// \param[out] du1     new horizontal displacement approximation
 /// \param[out] dv1     new vertical displacement approximation
+/// \return largest change of the displacement, which is the residual of the
+/// linear system scaled by the inverse of its diagonal
 ///////////////////////////////////////////////////////////////////////////////
-static void SolveForUpdate(const float *du0, const float *dv0, const float *Ix,
-                           const float *Iy, const float *Iz, int w, int h,
-                           int s, float alpha, float *du1, float *dv1) {
+static float SolveForUpdate(const float *du0, const float *dv0, const float *Ix,
+                            const float *Iy, const float *Iz, int w, int h,
+                            int s, float alpha, float *du1, float *dv1) {
+  float change = 0.0f;
+
   for (int i = 0; i < h; ++i) {
     for (int j = 0; j < w; ++j) {
       const int pos = j + i * s;
@@ -298,7 +293,51 @@ static void SolveForUpdate(const float *du0, const float *dv0, const float *Ix,
 
       du1[pos] = sumU - Ix[pos] * frac;
       dv1[pos] = sumV - Iy[pos] * frac;
+
+      change = fmaxf(change, fabsf(du1[pos] - du0[pos]));
+      change = fmaxf(change, fabsf(dv1[pos] - dv0[pos]));
+    }
+  }
+
+  return change;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief restrict one component of a displacement field to the coarsest
+/// level of a pyramid
+/// \param[in,out] f        field component, finest level on input,
+///                         coarsest level on output
+/// \param[in]  nLevels     number of levels in the pyramid
+/// \param[in]  pW          level widths
+/// \param[in]  pH          level heights
+/// \param[in]  pS          level strides
+/// \param[in]  pDim        level sizes along the component (pW or pH)
+/// \param[in]  scratch0    temporary storage of the finest level size
+/// \param[in]  scratch1    temporary storage of the finest level size
+///////////////////////////////////////////////////////////////////////////////
+static void RestrictField(float *f, int nLevels, int toLevel, const int *pW,
+                          const int *pH, const int *pS, const int *pDim,
+                          float *scratch0, float *scratch1) {
+  const float *src = f;
+  float *dst = scratch0;
+
+  for (int level = nLevels - 1; level > toLevel; --level) {
+    Downscale(src, pW[level], pH[level], pS[level], pW[level - 1],
+              pH[level - 1], pS[level - 1], dst);
+
+    // displacements shrink with the image
+    const float scale = (float)pDim[level - 1] / (float)pDim[level];
+
+    for (int i = 0; i < pH[level - 1] * pS[level - 1]; ++i) {
+      dst[i] *= scale;
     }
+
+    src = dst;
+    dst = (dst == scratch0) ? scratch1 : scratch0;
+  }
+
+  if (src != f) {
+    memcpy(f, src, pH[toLevel] * pS[toLevel] * sizeof(float));
   }
 }
 
@@ -314,14 +353,25 @@ static void SolveForUpdate(const float *du0, const float *dv0, const float *Ix,
 /// \param[in]  alpha        degree of displacement field smoothness
 /// \param[in]  nLevels      number of levels in a pyramid
 /// \param[in]  nWarpIters   number of warping iterations per pyramid level
-/// \param[in]  nSolverIters number of solver iterations (Jacobi iterations)
-/// \param[out] u            horizontal displacement
-/// \param[out] v            vertical displacement
+/// \param[in]  nSolverIters maximum number of solver iterations (Jacobi
+///                          iterations)
+/// \param[in]  tol          solver iterations stop once the largest change
+///                          of the displacement is below tol, 0 disables the
+///                          test
+/// \param[in]  nWarmLevels  0 starts from zero flow on the coarsest level,
+///                          otherwise u and v hold an initial flow on input
+///                          and only the nWarmLevels finest levels are
+///                          processed
+/// \param[in,out] u         horizontal displacement
+/// \param[in,out] v         vertical displacement
+/// \return number of solver iterations over all levels and warps
 ///////////////////////////////////////////////////////////////////////////////
-void ComputeFlowGold(const float *I0, const float *I1, int width, int height,
-                     int stride, float alpha, int nLevels, int nWarpIters,
-                     int nSolverIters, float *u, float *v) {
-  printf("Computing optical flow on CPU...\n");
+static int ComputeFlowGoldImpl(const float *I0, const float *I1, int width,
+                               int height, int stride, float alpha,
+                               int nLevels, int nWarpIters, int nSolverIters,
+                               float tol, int nWarmLevels, float *u,
+                               float *v) {
+  int nTotalIters = 0;
 
   float *u0 = u;
   float *v0 = v;
@@ -362,20 +412,36 @@ void ComputeFlowGold(const float *I0, const float *I1, int width, int height,
     pI0[currentLevel - 1] = new float[ns * nh];
     pI1[currentLevel - 1] = new float[ns * nh];
 
-    Downscale(pI0[currentLevel], pW[currentLevel], pH[currentLevel],
-              pS[currentLevel], nw, nh, ns, (float *)pI0[currentLevel - 1]);
-
-    Downscale(pI1[currentLevel], pW[currentLevel], pH[currentLevel],
-              pS[currentLevel], nw, nh, ns, (float *)pI1[currentLevel - 1]);
-
     pW[currentLevel - 1] = nw;
     pH[currentLevel - 1] = nh;
     pS[currentLevel - 1] = ns;
   }
 
+  // all levels of each image pyramid in one sweep, finest level first
+  std::vector<sdkPyramidLevel> levels0(nLevels), levels1(nLevels);
+
+  for (int level = 0; level < nLevels; ++level) {
+    const int i = nLevels - 1 - level;
+    const sdkPyramidLevel level0 = {(float *)pI0[i], pW[i], pH[i], pS[i]};
+    const sdkPyramidLevel level1 = {(float *)pI1[i], pW[i], pH[i], pS[i]};
+    levels0[level] = level0;
+    levels1[level] = level1;
+  }
+
+  sdkPyramidSweep(&levels0[0], nLevels, sdkPyramidFilter::box2());
+  sdkPyramidSweep(&levels1[0], nLevels, sdkPyramidFilter::box2());
+
   // initial approximation
-  memset(u, 0, stride * height * sizeof(float));
-  memset(v, 0, stride * height * sizeof(float));
+  if (nWarmLevels > 0) {
+    // the initial flow already holds the large displacements the coarse
+    // levels are meant to find, it seeds the coarsest level processed
+    currentLevel = nLevels - (nWarmLevels < nLevels ? nWarmLevels : nLevels);
+    RestrictField(u, nLevels, currentLevel, pW, pH, pS, pW, nu, tmp);
+    RestrictField(v, nLevels, currentLevel, pW, pH, pS, pH, nv, tmp);
+  } else {
+    memset(u, 0, stride * height * sizeof(float));
+    memset(v, 0, stride * height * sizeof(float));
+  }
 
   // compute flow
   for (; currentLevel < nLevels; ++currentLevel) {
@@ -395,10 +461,15 @@ void ComputeFlowGold(const float *I0, const float *I1, int width, int height,
                          pH[currentLevel], pS[currentLevel], Ix, Iy, Iz);
 
       for (int iter = 0; iter < nSolverIters; ++iter) {
-        SolveForUpdate(du0, dv0, Ix, Iy, Iz, pW[currentLevel], pH[currentLevel],
-                       pS[currentLevel], alpha, du1, dv1);
+        float change = SolveForUpdate(du0, dv0, Ix, Iy, Iz, pW[currentLevel],
+                                      pH[currentLevel], pS[currentLevel],
+                                      alpha, du1, dv1);
         Swap(du0, du1);
         Swap(dv0, dv1);
+
+        ++nTotalIters;
+
+        if (change < tol) break;
       }
 
       // update u, v
@@ -459,4 +530,34 @@ void ComputeFlowGold(const float *I0, const float *I1, int width, int height,
   delete[] Iz;
   delete[] nu;
   delete[] nv;
+
+  return nTotalIters;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief compute optical flow from zero initial flow with a fixed number of
+/// solver iterations
+///////////////////////////////////////////////////////////////////////////////
+void ComputeFlowGold(const float *I0, const float *I1, int width, int height,
+                     int stride, float alpha, int nLevels, int nWarpIters,
+                     int nSolverIters, float *u, float *v) {
+  printf("Computing optical flow on CPU...\n");
+
+  ComputeFlowGoldImpl(I0, I1, width, height, stride, alpha, nLevels,
+                      nWarpIters, nSolverIters, 0.0f, 0, u, v);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief compute optical flow starting from the flow given in u and v, e.g.
+/// the flow of the previous frame pair of a video sequence, on the
+/// nWarmLevels finest pyramid levels, and stop the solver iterations early
+/// once the displacement changes less than tol
+///////////////////////////////////////////////////////////////////////////////
+int ComputeFlowGoldWarm(const float *I0, const float *I1, int width,
+                        int height, int stride, float alpha, int nLevels,
+                        int nWarmLevels, int nWarpIters, int nSolverIters,
+                        float tol, float *u, float *v) {
+  return ComputeFlowGoldImpl(I0, I1, width, height, stride, alpha, nLevels,
+                             nWarpIters, nSolverIters, tol,
+                             nWarmLevels > 0 ? nWarmLevels : nLevels, u, v);
 }
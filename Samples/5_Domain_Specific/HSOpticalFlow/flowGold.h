@@ -41,4 +41,20 @@ void ComputeFlowGold(
     float *u,         // output horizontal flow
     float *v);        // output vertical flow
 
+// returns the number of solver iterations over all levels and warps
+int ComputeFlowGoldWarm(
+    const float *I0,  // source frame
+    const float *I1,  // tracked frame
+    int width,        // frame width
+    int height,       // frame height
+    int stride,       // row access stride
+    float alpha,      // smoothness coefficient
+    int nLevels,      // number of levels in pyramid
+    int nWarmLevels,  // number of finest levels refining the initial flow
+    int nWarpIters,   // number of warping iterations per pyramid level
+    int nIters,       // maximum number of solver iterations per warp
+    float tol,        // stop once the flow update is smaller than tol
+    float *u,         // initial / output horizontal flow
+    float *v);        // initial / output vertical flow
+
 #endif
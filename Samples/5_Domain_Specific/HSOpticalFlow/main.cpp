@@ -37,6 +37,87 @@ const float THRESHOLD = 0.05f;
 #include "flowCUDA.h"
 
 #include <helper_functions.h>
+#include <helper_gold_cache.h>
+#include <helper_image_quality.h>
+
+// tag of the .flo format, "PIEH" read as a float
+const float FloTag = 202021.25f;
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief append optical flow to a stream in format described on
+/// vision.middlebury.edu/flow
+///
+/// A .flo stream is a sequence of such frames. u and v are interleaved one
+/// row at a time, so every row takes a single write.
+/// \param[in] stream  output stream
+/// \param[in] w       optical flow field width
+/// \param[in] h       optical flow field height
+/// \param[in] s       optical flow field row stride
+/// \param[in] u       horizontal displacement
+/// \param[in] v       vertical displacement
+/// \return true if the frame is successfully written
+///////////////////////////////////////////////////////////////////////////////
+bool WriteFloFrame(FILE *stream, int w, int h, int s, const float *u,
+                   const float *v) {
+  float data = FloTag;
+  bool ok = fwrite(&data, sizeof(float), 1, stream) == 1;
+  ok = ok && fwrite(&w, sizeof(w), 1, stream) == 1;
+  ok = ok && fwrite(&h, sizeof(h), 1, stream) == 1;
+
+  float *row = new float[2 * w];
+
+  for (int i = 0; ok && i < h; ++i) {
+    for (int j = 0; j < w; ++j) {
+      const int pos = j + i * s;
+      row[2 * j + 0] = u[pos];
+      row[2 * j + 1] = v[pos];
+    }
+
+    ok = fwrite(row, sizeof(float), 2 * w, stream) == (size_t)(2 * w);
+  }
+
+  delete[] row;
+
+  return ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief read the next optical flow frame of a .flo stream
+/// \param[in]  stream  input stream
+/// \param[in]  w       expected optical flow field width
+/// \param[in]  h       expected optical flow field height
+/// \param[in]  s       optical flow field row stride
+/// \param[out] u       horizontal displacement
+/// \param[out] v       vertical displacement
+/// \return true if a frame of the expected size is successfully read
+///////////////////////////////////////////////////////////////////////////////
+bool ReadFloFrame(FILE *stream, int w, int h, int s, float *u, float *v) {
+  float data = 0.0f;
+  int fw = 0, fh = 0;
+  bool ok = fread(&data, sizeof(float), 1, stream) == 1;
+  ok = ok && fread(&fw, sizeof(fw), 1, stream) == 1;
+  ok = ok && fread(&fh, sizeof(fh), 1, stream) == 1;
+
+  if (!ok || data != FloTag || fw != w || fh != h) {
+    return false;
+  }
+
+  float *row = new float[2 * w];
+
+  for (int i = 0; ok && i < h; ++i) {
+    ok = fread(row, sizeof(float), 2 * w, stream) == (size_t)(2 * w);
+
+    for (int j = 0; ok && j < w; ++j) {
+      const int pos = j + i * s;
+      u[pos] = row[2 * j + 0];
+      v[pos] = row[2 * j + 1];
+    }
+  }
+
+  delete[] row;
+
+  return ok;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 /// \brief save optical flow in format described on vision.middlebury.edu/flow
@@ -57,17 +138,8 @@ void WriteFloFile(const char *name, int w, int h, int s, const float *u,
     return;
   }
 
-  float data = 202021.25f;
-  fwrite(&data, sizeof(float), 1, stream);
-  fwrite(&w, sizeof(w), 1, stream);
-  fwrite(&h, sizeof(h), 1, stream);
-
-  for (int i = 0; i < h; ++i) {
-    for (int j = 0; j < w; ++j) {
-      const int pos = j + i * s;
-      fwrite(u + pos, sizeof(float), 1, stream);
-      fwrite(v + pos, sizeof(float), 1, stream);
-    }
+  if (!WriteFloFrame(stream, w, h, s, u, v)) {
+    printf("Could not save flow to \"%s\"\n", name);
   }
 
   fclose(stream);
@@ -124,6 +196,9 @@ bool LoadImageAsFP32(float *&img_data, int &img_w, int &img_h, int &img_s,
 
 ///////////////////////////////////////////////////////////////////////////////
 /// \brief compare given flow field with gold (L1 norm)
+///
+/// Also reports the mean and largest endpoint error and the tile of
+/// 64 x 64 pixels with the largest mean endpoint error.
 /// \param[in] width    optical flow field width
 /// \param[in] height   optical flow field height
 /// \param[in] stride   optical flow field row stride
@@ -135,22 +210,200 @@ bool LoadImageAsFP32(float *&img_data, int &img_w, int &img_h, int &img_s,
 ///////////////////////////////////////////////////////////////////////////////
 bool CompareWithGold(int width, int height, int stride, const float *h_uGold,
                      const float *h_vGold, const float *h_u, const float *h_v) {
-  float error = 0.0f;
+  sdkImageQualityParams params;
+  sdkImageQualityResult result;
 
-  for (int i = 0; i < height; ++i) {
-    for (int j = 0; j < width; ++j) {
-      const int pos = j + i * stride;
-      error += fabsf(h_u[pos] - h_uGold[pos]) + fabsf(h_v[pos] - h_vGold[pos]);
-    }
-  }
+  sdkFlowQuality(h_u, h_v, h_uGold, h_vGold, stride * sizeof(float), width,
+                 height, params, result);
+
+  const float error = (float)result.l1;
+  const sdkImageQualityTile *worst = &result.tiles[0];
 
-  error /= (float)(width * height);
+  for (size_t i = 1; i < result.tiles.size(); ++i) {
+    if (result.tiles[i].epe > worst->epe) worst = &result.tiles[i];
+  }
 
   printf("L1 error : %.6f\n", error);
+  printf("Endpoint error : mean %.6f, max %.6f, worst tile (%d, %d) %.6f\n",
+         result.epe, result.maxEpe, worst->x, worst->y, worst->epe);
 
   return (error < THRESHOLD);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// \brief compute optical flow on the host for consecutive frames of a video
+///
+/// Frame names are generated from a printf pattern, e.g. "frame%02d.ppm".
+/// The flow of every pair seeds the pyramid of the next pair, which then
+/// only needs its finest levels to refine it, and solver iterations stop
+/// once the flow update is below a tolerance. All flow fields are appended
+/// to a single .flo stream.
+/// \param[in] argc  number of command line arguments
+/// \param[in] argv  command line arguments
+/// \return true if all frames are processed
+///////////////////////////////////////////////////////////////////////////////
+bool RunSequence(int argc, char **argv) {
+  char *pattern = 0;
+  char *outName = 0;
+  char *initName = 0;
+  int first = 10;
+  int nFrames = 2;
+  int nWarmLevels = 2;
+  float tol = 1e-4f;
+
+  getCmdLineArgumentString(argc, (const char **)argv, "sequence", &pattern);
+  getCmdLineArgumentString(argc, (const char **)argv, "out", &outName);
+  getCmdLineArgumentString(argc, (const char **)argv, "initflow", &initName);
+
+  if (checkCmdLineFlag(argc, (const char **)argv, "first")) {
+    first = getCmdLineArgumentInt(argc, (const char **)argv, "first");
+  }
+
+  if (checkCmdLineFlag(argc, (const char **)argv, "frames")) {
+    nFrames = getCmdLineArgumentInt(argc, (const char **)argv, "frames");
+  }
+
+  if (checkCmdLineFlag(argc, (const char **)argv, "warmlevels")) {
+    nWarmLevels = getCmdLineArgumentInt(argc, (const char **)argv,
+                                        "warmlevels");
+  }
+
+  if (checkCmdLineFlag(argc, (const char **)argv, "tol")) {
+    tol = getCmdLineArgumentFloat(argc, (const char **)argv, "tol");
+  }
+
+  // cold start of every pair, for comparison
+  const bool noWarm = checkCmdLineFlag(argc, (const char **)argv, "nowarm");
+
+  if (pattern == 0 || nFrames < 2) {
+    printf("-sequence=<pattern> needs at least two frames\n");
+    return false;
+  }
+
+  if (outName == 0) {
+    outName = (char *)"FlowSequenceCPU.flo";
+  }
+
+  // same parameters as the frame pair test
+  const float alpha = 0.2f;
+  const int nLevels = 5;
+  const int nSolverIters = 500;
+  const int nWarpIters = 3;
+
+  char name[1024];
+  int width, height, stride;
+  float *h_source = 0;
+  float *h_target = 0;
+
+  snprintf(name, sizeof(name), pattern, first);
+
+  if (!LoadImageAsFP32(h_source, width, height, stride, name, argv[0])) {
+    return false;
+  }
+
+  float *h_u = new float[stride * height];
+  float *h_v = new float[stride * height];
+
+  memset(h_u, 0, stride * height * sizeof(float));
+  memset(h_v, 0, stride * height * sizeof(float));
+
+  // the first pair runs the whole pyramid, unless an initial flow is given
+  bool warm = false;
+
+  if (initName) {
+    FILE *init = fopen(initName, "rb");
+
+    if (init == 0 || !ReadFloFrame(init, width, height, stride, h_u, h_v)) {
+      printf("Could not read initial flow from \"%s\"\n", initName);
+      memset(h_u, 0, stride * height * sizeof(float));
+      memset(h_v, 0, stride * height * sizeof(float));
+    } else {
+      warm = true;
+    }
+
+    if (init) fclose(init);
+  }
+
+  FILE *out = fopen(outName, "wb");
+
+  if (out == 0) {
+    printf("Could not save flow to \"%s\"\n", outName);
+  }
+
+  printf("Computing optical flow on CPU for %d frames, tolerance %g%s...\n",
+         nFrames, tol, noWarm ? ", no warm start" : "");
+
+  StopWatchInterface *timer = 0;
+  sdkCreateTimer(&timer);
+
+  bool status = true;
+  long long totalIters = 0;
+
+  for (int k = first + 1; k < first + nFrames; ++k) {
+    int w, h, s;
+    snprintf(name, sizeof(name), pattern, k);
+
+    if (!LoadImageAsFP32(h_target, w, h, s, name, argv[0])) {
+      status = false;
+      break;
+    }
+
+    if (w != width || h != height) {
+      printf("Frame size changes within the sequence\n");
+      delete[] h_target;
+      status = false;
+      break;
+    }
+
+    if (noWarm) {
+      memset(h_u, 0, stride * height * sizeof(float));
+      memset(h_v, 0, stride * height * sizeof(float));
+      warm = false;
+    }
+
+    sdkResetTimer(&timer);
+    sdkStartTimer(&timer);
+
+    int nIters = ComputeFlowGoldWarm(h_source, h_target, width, height, stride,
+                                     alpha, nLevels,
+                                     warm ? nWarmLevels : nLevels, nWarpIters,
+                                     nSolverIters, tol, h_u, h_v);
+    warm = true;
+
+    sdkStopTimer(&timer);
+    totalIters += nIters;
+
+    printf("frames %d-%d: %d solver iterations, %.2f ms\n", k - 1, k, nIters,
+           sdkGetTimerValue(&timer));
+
+    if (out && !WriteFloFrame(out, width, height, stride, h_u, h_v)) {
+      printf("Could not save flow to \"%s\"\n", outName);
+      fclose(out);
+      out = 0;
+    }
+
+    // the target is the source of the next pair
+    Swap(h_source, h_target);
+    delete[] h_target;
+    h_target = 0;
+  }
+
+  if (status) {
+    printf("%lld solver iterations in total, %d without early stopping\n",
+           totalIters, (nFrames - 1) * nLevels * nWarpIters * nSolverIters);
+  }
+
+  sdkDeleteTimer(&timer);
+
+  if (out) fclose(out);
+
+  delete[] h_u;
+  delete[] h_v;
+  delete[] h_source;
+
+  return status;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// application entry point
 ///////////////////////////////////////////////////////////////////////////////
@@ -158,6 +411,11 @@ int main(int argc, char **argv) {
   // welcome message
   printf("%s Starting...\n\n", sSDKsample);
 
+  // host only processing of a video sequence
+  if (checkCmdLineFlag(argc, (const char **)argv, "sequence")) {
+    exit(RunSequence(argc, argv) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
   // pick GPU
   findCudaDevice(argc, (const char **)argv);
 
@@ -186,9 +444,9 @@ int main(int argc, char **argv) {
     exit(EXIT_FAILURE);
   }
 
-  // allocate host memory for CPU results
-  float *h_uGold = new float[stride * height];
-  float *h_vGold = new float[stride * height];
+  // allocate host memory for CPU results, u and v are kept in one buffer
+  // so that the gold cache stores them together
+  float *h_uvGold = new float[2 * stride * height];
 
   // allocate host memory for GPU results
   float *h_u = new float[stride * height];
@@ -208,8 +466,25 @@ int main(int argc, char **argv) {
   // number of warping iterations
   const int nWarpIters = 3;
 
-  ComputeFlowGold(h_source, h_target, width, height, stride, alpha, nLevels,
-                  nWarpIters, nSolverIters, h_uGold, h_vGold);
+  // the CPU flow is reused from the gold cache for identical runs
+  sdkGoldCache goldCache("HSOpticalFlow/ComputeFlowGold", argc,
+                         (const char **)argv);
+  goldCache.addInput(h_source, stride * height * sizeof(float))
+      .addInput(h_target, stride * height * sizeof(float))
+      .addParam(width)
+      .addParam(height)
+      .addParam(stride)
+      .addParam(alpha)
+      .addParam(nLevels)
+      .addParam(nWarpIters)
+      .addParam(nSolverIters);
+  const float *h_uGold =
+      goldCache.compute(h_uvGold, 2 * stride * height, [&]() {
+        ComputeFlowGold(h_source, h_target, width, height, stride, alpha,
+                        nLevels, nWarpIters, nSolverIters, h_uvGold,
+                        h_uvGold + stride * height);
+      });
+  const float *h_vGold = h_uGold + stride * height;
 
   ComputeFlowCUDA(h_source, h_target, width, height, stride, alpha, nLevels,
                   nWarpIters, nSolverIters, h_u, h_v);
@@ -223,8 +498,7 @@ int main(int argc, char **argv) {
   WriteFloFile("FlowCPU.flo", width, height, stride, h_uGold, h_vGold);
 
   // free resources
-  delete[] h_uGold;
-  delete[] h_vGold;
+  delete[] h_uvGold;
 
   delete[] h_u;
   delete[] h_v;
@@ -91,6 +91,11 @@ int adjustGridSize(int GPUIndex, int defaultGridSize) {
 extern "C" void MonteCarloCPU(TOptionValue &callValue, TOptionData optionData,
                               float *h_Random, int pathN);
 
+extern "C" void MonteCarloCPUReduced(TOptionValue &callValue,
+                                     TOptionData optionData, float *h_Random,
+                                     int pathN, TVarianceReduction mode,
+                                     TMonteCarloStats *stats);
+
 // Black-Scholes formula for call options
 extern "C" void BlackScholesCall(float &CallResult, TOptionData optionData);
 
@@ -213,6 +218,45 @@ void usage() {
   printf(
       "        weak   : problem size scales with number of available GPUs "
       "[default]\n");
+  printf(
+      "--variance     : compare the variance reduction modes of the CPU "
+      "pricer\n");
+}
+
+// Price the first options on the CPU with every variance reduction mode
+static void compareVarianceReduction(const TOptionData *optionData, int optN,
+                                     int pathN) {
+  static const char *modeName[MC_VARIANCE_REDUCTION_COUNT] = {
+      "plain", "antithetic", "control S_T", "control BS delta",
+      "moment matching"};
+  const int n = (optN < 16) ? optN : 16;
+
+  printf("main(): CPU variance reduction, %i options, %i paths\n", n, pathN);
+  printf("%-18s %12s %12s %12s %16s\n", "mode", "L1 vs BS", "confidence",
+         "reduction", "eff. paths/sec");
+
+  for (int mode = 0; mode < MC_VARIANCE_REDUCTION_COUNT; mode++) {
+    double sumDelta = 0, sumRef = 0, sumConf = 0, sumReduction = 0,
+           sumEffective = 0;
+
+    for (int i = 0; i < n; i++) {
+      TOptionValue callValue;
+      TMonteCarloStats stats;
+      float callValueBS;
+
+      MonteCarloCPUReduced(callValue, optionData[i], NULL, pathN,
+                           (TVarianceReduction)mode, &stats);
+      BlackScholesCall(callValueBS, optionData[i]);
+      sumDelta += fabs(callValueBS - callValue.Expected);
+      sumRef += fabs(callValueBS);
+      sumConf += callValue.Confidence;
+      sumReduction += stats.VarianceReduction;
+      sumEffective += stats.EffectivePathsPerSec;
+    }
+
+    printf("%-18s %12E %12f %12.2f %16E\n", modeName[mode], sumDelta / sumRef,
+           sumConf / n, sumReduction / n, sumEffective / n);
+  }
 }
 
 int main(int argc, char **argv) {
@@ -442,6 +486,10 @@ int main(int argc, char **argv) {
     sumReserve /= OPT_N;
   }
 
+  if (checkCmdLineFlag(argc, (const char **)argv, "variance")) {
+    compareVarianceReduction(optionData, OPT_N, PATH_N);
+  }
+
 #ifdef DO_CPU
   printf("main(): running CPU MonteCarlo...\n");
   TOptionValue callValueCPU;
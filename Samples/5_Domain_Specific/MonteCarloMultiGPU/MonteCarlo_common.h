@@ -50,6 +50,29 @@ typedef struct
   float Confidence;
 } TOptionValue;
 
+// Variance reduction of the CPU Monte Carlo pricer
+typedef enum {
+  MC_PLAIN = 0,             // plain path average
+  MC_ANTITHETIC,            // path pairs with the samples z and -z
+  MC_CONTROL_ASSET,         // control variate on the terminal asset price,
+                            // coefficient estimated from the paths
+  MC_CONTROL_BLACKSCHOLES,  // same control with the Black-Scholes delta as
+                            // coefficient
+  MC_MOMENT_MATCHING,       // samples of every batch shifted and scaled to
+                            // mean 0 and variance 1
+  MC_VARIANCE_REDUCTION_COUNT
+} TVarianceReduction;
+
+typedef struct {
+  // variance of the plain estimator over the variance of this one, for the
+  // same number of payoff evaluations
+  double VarianceReduction;
+  // payoff evaluations per second
+  double PathsPerSec;
+  // plain paths per second that would reach the same confidence width
+  double EffectivePathsPerSec;
+} TMonteCarloStats;
+
 // GPU outputs before CPU postprocessing
 typedef struct {
   real Expected;
@@ -29,6 +29,9 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include <helper_timer.h>
+#include <helper_vecmath.h>
+
 #include <curand.h>
 
 //#include "curand_kernel.h"
@@ -83,14 +86,55 @@ extern "C" void BlackScholesCall(float &callValue, TOptionData optionData) {
 ////////////////////////////////////////////////////////////////////////////////
 // CPU Monte Carlo
 ////////////////////////////////////////////////////////////////////////////////
-static double endCallValue(double S, double X, double r, double MuByT,
-                           double VBySqrtT) {
-  double callValue = S * exp(MuByT + VBySqrtT * r) - X;
-  return (callValue > 0) ? callValue : 0;
+// Payoffs of a chunk of paths, the exponentials run over the whole chunk.
+// The terminal asset prices are returned in assetValue unless it is NULL.
+static const int MC_CHUNK = 256;
+
+static void endCallValues(double *callValue, double *assetValue, double S,
+                          double X, const float *r, double MuByT,
+                          double VBySqrtT, int n) {
+  for (int i = 0; i < n; i++) callValue[i] = MuByT + VBySqrtT * r[i];
+
+  sdkVecExp(callValue, callValue, n);
+
+  for (int i = 0; i < n; i++) {
+    double v = S * callValue[i] - X;
+
+    if (assetValue) assetValue[i] = S * callValue[i];
+
+    callValue[i] = (v > 0) ? v : 0;
+  }
 }
 
-extern "C" void MonteCarloCPU(TOptionValue &callValue, TOptionData optionData,
-                              float *h_Samples, int pathN) {
+// Paths per batch of the moment matching, the batch estimates give its
+// variance
+static const int MC_BATCH = 8192;
+
+// Sums of the payoffs y and of the controls c over the paths
+struct MCSums {
+  double n, y, y2, c, c2, yc;
+
+  MCSums() : n(0), y(0), y2(0), c(0), c2(0), yc(0) {}
+
+  void add(double yi, double ci) {
+    n += 1;
+    y += yi;
+    y2 += yi * yi;
+    c += ci;
+    c2 += ci * ci;
+    yc += yi * ci;
+  }
+
+  double varY() const { return (n * y2 - y * y) / (n * (n - 1)); }
+  double varC() const { return (n * c2 - c * c) / (n * (n - 1)); }
+  double covYC() const { return (n * yc - y * c) / (n * (n - 1)); }
+};
+
+// Sums over the payoffs of pathN samples, the estimator of the expected
+// payoff and its variance
+static void MonteCarloPaths(MCSums &plain, double &expected, double &variance,
+                            const TOptionData &optionData, const float *samples,
+                            int pathN, TVarianceReduction mode) {
   const double S = optionData.S;
   const double X = optionData.X;
   const double T = optionData.T;
@@ -98,6 +142,121 @@ extern "C" void MonteCarloCPU(TOptionValue &callValue, TOptionData optionData,
   const double V = optionData.V;
   const double MuByT = (R - 0.5 * V * V) * T;
   const double VBySqrtT = V * sqrt(T);
+  double payoff[MC_CHUNK], asset[MC_CHUNK], payoffNeg[MC_CHUNK];
+  MCSums sums;
+
+  switch (mode) {
+    case MC_ANTITHETIC:
+      // the pair average is one sample of the estimator
+      for (int pos = 0; pos < pathN; pos += MC_CHUNK) {
+        int n = (pathN - pos < MC_CHUNK) ? pathN - pos : MC_CHUNK;
+
+        endCallValues(payoff, NULL, S, X, samples + pos, MuByT, VBySqrtT, n);
+        endCallValues(payoffNeg, NULL, S, X, samples + pos, MuByT, -VBySqrtT,
+                      n);
+
+        for (int i = 0; i < n; i++) {
+          sums.add(0.5 * (payoff[i] + payoffNeg[i]), 0);
+          plain.add(payoff[i], 0);
+          plain.add(payoffNeg[i], 0);
+        }
+      }
+
+      expected = sums.y / sums.n;
+      variance = sums.varY() / sums.n;
+      break;
+
+    case MC_CONTROL_ASSET:
+    case MC_CONTROL_BLACKSCHOLES: {
+      for (int pos = 0; pos < pathN; pos += MC_CHUNK) {
+        int n = (pathN - pos < MC_CHUNK) ? pathN - pos : MC_CHUNK;
+
+        endCallValues(payoff, asset, S, X, samples + pos, MuByT, VBySqrtT, n);
+
+        for (int i = 0; i < n; i++) sums.add(payoff[i], asset[i]);
+      }
+
+      plain = sums;
+
+      // E[S_T] = S * exp(R * T), the Black-Scholes delta N(d1) hedges the
+      // payoff against S_T
+      const double expectedAsset = S * exp(R * T);
+      double beta = sums.covYC() / sums.varC();
+
+      if (mode == MC_CONTROL_BLACKSCHOLES) {
+        double d1 = (log(S / X) + (R + 0.5 * V * V) * T) / VBySqrtT;
+        beta = CND(d1);
+      }
+
+      expected = (sums.y - beta * (sums.c - sums.n * expectedAsset)) / sums.n;
+      variance = (sums.varY() - 2 * beta * sums.covYC() +
+                  beta * beta * sums.varC()) /
+                 sums.n;
+    } break;
+
+    case MC_MOMENT_MATCHING: {
+      MCSums batches;
+
+      for (int begin = 0; begin < pathN; begin += MC_BATCH) {
+        int batchN = (pathN - begin < MC_BATCH) ? pathN - begin : MC_BATCH;
+        double m = 0, m2 = 0;
+
+        for (int i = 0; i < batchN; i++) {
+          m += samples[begin + i];
+          m2 += (double)samples[begin + i] * samples[begin + i];
+        }
+
+        m /= batchN;
+        double sd = sqrt(m2 / batchN - m * m);
+
+        if (!(sd > 0)) sd = 1;
+
+        // z' = (z - m) / sd
+        const double mu = MuByT - VBySqrtT * m / sd, vol = VBySqrtT / sd;
+        double batchSum = 0;
+
+        for (int pos = 0; pos < batchN; pos += MC_CHUNK) {
+          int n = (batchN - pos < MC_CHUNK) ? batchN - pos : MC_CHUNK;
+
+          endCallValues(payoff, NULL, S, X, samples + begin + pos, mu, vol, n);
+
+          for (int i = 0; i < n; i++) {
+            batchSum += payoff[i];
+            plain.add(payoff[i], 0);
+          }
+        }
+
+        batches.add(batchSum / batchN, 0);
+      }
+
+      // the matched payoffs are not independent, the variance comes from
+      // the spread of the batch estimates (full batches weigh the same)
+      expected = plain.y / plain.n;
+      variance = (batches.n > 1) ? batches.varY() / batches.n
+                                 : plain.varY() / plain.n;
+    } break;
+
+    default:
+      for (int pos = 0; pos < pathN; pos += MC_CHUNK) {
+        int n = (pathN - pos < MC_CHUNK) ? pathN - pos : MC_CHUNK;
+
+        endCallValues(payoff, NULL, S, X, samples + pos, MuByT, VBySqrtT, n);
+
+        for (int i = 0; i < n; i++) plain.add(payoff[i], 0);
+      }
+
+      expected = plain.y / plain.n;
+      variance = plain.varY() / plain.n;
+      break;
+  }
+}
+
+extern "C" void MonteCarloCPUReduced(TOptionValue &callValue,
+                                     TOptionData optionData, float *h_Samples,
+                                     int pathN, TVarianceReduction mode,
+                                     TMonteCarloStats *stats) {
+  const double T = optionData.T;
+  const double R = optionData.R;
 
   float *samples;
   curandGenerator_t gen;
@@ -115,26 +274,40 @@ extern "C" void MonteCarloCPU(TOptionValue &callValue, TOptionData optionData,
 
   // for(int i=0; i<10; i++) printf("CPU sample = %f\n", samples[i]);
 
-  double sum = 0, sum2 = 0;
+  StopWatchInterface *timer = NULL;
+  sdkCreateTimer(&timer);
+  sdkStartTimer(&timer);
 
-  for (int pos = 0; pos < pathN; pos++) {
-    double sample = samples[pos];
-    double callValue = endCallValue(S, X, sample, MuByT, VBySqrtT);
-    sum += callValue;
-    sum2 += callValue * callValue;
-  }
+  MCSums plain;
+  double expected, variance;
+  MonteCarloPaths(plain, expected, variance, optionData, samples, pathN, mode);
+
+  sdkStopTimer(&timer);
+  double seconds = 1e-3 * sdkGetTimerValue(&timer);
+  sdkDeleteTimer(&timer);
 
   if (h_Samples == NULL) free(samples);
 
   checkCudaErrors(curandDestroyGenerator(gen));
 
-  // Derive average from the total sum and discount by riskfree rate
-  callValue.Expected = (float)(exp(-R * T) * sum / (double)pathN);
-  // Standard deviation
-  double stdDev = sqrt(((double)pathN * sum2 - sum * sum) /
-                       ((double)pathN * (double)(pathN - 1)));
+  // Discount the average by riskfree rate
+  callValue.Expected = (float)(exp(-R * T) * expected);
   // Confidence width; in 95% of all cases theoretical value lies within these
   // borders
-  callValue.Confidence =
-      (float)(exp(-R * T) * 1.96 * stdDev / sqrt((double)pathN));
+  callValue.Confidence = (float)(exp(-R * T) * 1.96 * sqrt(variance));
+
+  if (stats) {
+    // the plain estimator over the same payoff evaluations
+    double plainVariance = plain.varY() / plain.n;
+
+    stats->VarianceReduction = (variance > 0) ? plainVariance / variance : 0;
+    stats->PathsPerSec = (seconds > 0) ? plain.n / seconds : 0;
+    stats->EffectivePathsPerSec = stats->PathsPerSec * stats->VarianceReduction;
+  }
+}
+
+extern "C" void MonteCarloCPU(TOptionValue &callValue, TOptionData optionData,
+                              float *h_Samples, int pathN) {
+  MonteCarloCPUReduced(callValue, optionData, h_Samples, pathN, MC_PLAIN,
+                       NULL);
 }
@@ -28,6 +28,8 @@
 #include <math.h>
 #include <string.h>
 
+#include <helper_vecmath.h>
+
 ////////////////////////////////////////////////////////////////////////////////
 // export C interface
 #define EPSILON 1e-3
@@ -54,11 +56,13 @@ void updateGaussianGold(float delta, int radius) {
   }
 }
 
-float heuclideanLen(float4 a, float4 b, float d) {
+// exponent of the euclidean color distance weight, the exponentials of a
+// whole window are computed at once with sdkVecExpf()
+float heuclideanLenArg(float4 a, float4 b, float d) {
   float mod = (b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y) +
               (b.z - a.z) * (b.z - a.z) + (b.w - a.w) * (b.w - a.w);
 
-  return expf(-mod / (2 * d * d));
+  return -mod / (2 * d * d);
 }
 
 unsigned int hrgbaFloatToInt(float4 rgba) {
@@ -102,7 +106,7 @@ float4 add4(float4 a, float4 b) {
 void bilateralFilterGold(unsigned int *pSrc, unsigned int *pDest, float e_d,
                          int w, int h, int r) {
   float4 *hImage = new float4[w * h];
-  float domainDist, colorDist, factor;
+  float domainDist, factor;
 
   for (int y = 0; y < h; y++) {
     for (int x = 0; x < w; x++) {
@@ -110,10 +114,14 @@ void bilateralFilterGold(unsigned int *pSrc, unsigned int *pDest, float e_d,
     }
   }
 
+  // color distance weights of the window of one pixel
+  float *colorDist = new float[(2 * r + 1) * (2 * r + 1)];
+
   for (int y = 0; y < h; y++) {
     for (int x = 0; x < w; x++) {
       float4 t(0.0f);
       float sum = 0.0f;
+      int k = 0;
 
       for (int i = -r; i <= r; i++) {
         int neighborY = y + i;
@@ -125,10 +133,36 @@ void bilateralFilterGold(unsigned int *pSrc, unsigned int *pDest, float e_d,
           neighborY = h - 1;
         }
 
+        for (int j = -r; j <= r; j++) {
+          // clamp the neighbor pixel, prevent overflow
+          int neighborX = x + j;
+
+          if (neighborX < 0) {
+            neighborX = 0;
+          } else if (neighborX >= w) {
+            neighborX = w - 1;
+          }
+
+          colorDist[k++] = heuclideanLenArg(
+              hImage[neighborY * w + neighborX], hImage[y * w + x], e_d);
+        }
+      }
+
+      sdkVecExpf(colorDist, colorDist, k);
+      k = 0;
+
+      for (int i = -r; i <= r; i++) {
+        int neighborY = y + i;
+
+        if (neighborY < 0) {
+          neighborY = 0;
+        } else if (neighborY >= h) {
+          neighborY = h - 1;
+        }
+
         for (int j = -r; j <= r; j++) {
           domainDist = gaussian[r + i] * gaussian[r + j];
 
-          // clamp the neighbor pixel, prevent overflow
           int neighborX = x + j;
 
           if (neighborX < 0) {
@@ -137,9 +171,7 @@ void bilateralFilterGold(unsigned int *pSrc, unsigned int *pDest, float e_d,
             neighborX = w - 1;
           }
 
-          colorDist = heuclideanLen(hImage[neighborY * w + neighborX],
-                                    hImage[y * w + x], e_d);
-          factor = domainDist * colorDist;
+          factor = domainDist * colorDist[k++];
           sum += factor;
           t = add4(t, mul(factor, hImage[neighborY * w + neighborX]));
         }
@@ -149,5 +181,6 @@ void bilateralFilterGold(unsigned int *pSrc, unsigned int *pDest, float e_d,
     }
   }
 
+  delete[] colorDist;
   delete[] hImage;
 }
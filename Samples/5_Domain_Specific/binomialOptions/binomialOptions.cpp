@@ -39,6 +39,7 @@
 
 #include <helper_functions.h>
 #include <helper_cuda.h>
+#include <helper_gold_cache.h>
 
 #include "binomialOptions_common.h"
 #include "realtype.h"
@@ -54,6 +55,19 @@ extern "C" void BlackScholesCall(real &callResult, TOptionData optionData);
 ////////////////////////////////////////////////////////////////////////////////
 extern "C" void binomialOptionsCPU(real &callResult, TOptionData optionData);
 
+////////////////////////////////////////////////////////////////////////////////
+// Process single option on CPU with a given lattice and number of steps, or
+// with the number of steps chosen for a target error
+////////////////////////////////////////////////////////////////////////////////
+extern "C" void binomialOptionsCPULattice(real &callResult,
+                                          TOptionData optionData, int numSteps,
+                                          TLatticeMethod method);
+
+extern "C" void binomialOptionsCPUTarget(real &callResult,
+                                         TOptionData optionData,
+                                         TLatticeMethod method,
+                                         double targetError, int *numSteps);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Process an array of OptN options on GPU
 ////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +83,76 @@ real randData(real low, real high) {
   return ((real)1.0 - t) * low + t * high;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Accuracy against Black-Scholes and CPU time of the lattices, for a range of
+// step counts and for the step counts chosen by a target error
+////////////////////////////////////////////////////////////////////////////////
+static real latticeL1(const real *callValue, const real *callValueBS,
+                      int optN) {
+  real sumDelta = 0, sumRef = 0;
+
+  for (int i = 0; i < optN; i++) {
+    sumDelta += fabs(callValueBS[i] - callValue[i]);
+    sumRef += fabs(callValueBS[i]);
+  }
+
+  return sumDelta / sumRef;
+}
+
+static void compareLattices(const TOptionData *optionData,
+                            const real *callValueBS, int optN,
+                            double targetError, StopWatchInterface *hTimer) {
+  static const char *methodName[LATTICE_METHOD_COUNT] = {
+      "CRR", "CRR smoothed", "Leisen-Reimer"};
+  real callValue[MAX_OPTIONS];
+
+  printf("CPU lattices vs. Black-Scholes, %i options\n", optN);
+  printf("%-14s %6s %12s %12s\n", "lattice", "steps", "L1 norm", "msec");
+
+  for (int method = 0; method < LATTICE_METHOD_COUNT; method++) {
+    for (int numSteps = 32; numSteps <= NUM_STEPS; numSteps *= 2) {
+      sdkResetTimer(&hTimer);
+      sdkStartTimer(&hTimer);
+
+      for (int opt = 0; opt < optN; opt++) {
+        binomialOptionsCPULattice(callValue[opt], optionData[opt], numSteps,
+                                  (TLatticeMethod)method);
+      }
+
+      sdkStopTimer(&hTimer);
+      printf("%-14s %6i %12E %12f\n", methodName[method], numSteps,
+             (double)latticeL1(callValue, callValueBS, optN),
+             sdkGetTimerValue(&hTimer));
+    }
+  }
+
+  // CRR does not converge monotonically, doubling its steps is no estimate
+  printf("\nTarget error %E * S\n", targetError);
+  printf("%-14s %6s %12s %12s\n", "lattice", "steps", "L1 norm", "msec");
+
+  for (int method = LATTICE_CRR_SMOOTHED; method < LATTICE_METHOD_COUNT;
+       method++) {
+    double sumSteps = 0;
+
+    sdkResetTimer(&hTimer);
+    sdkStartTimer(&hTimer);
+
+    for (int opt = 0; opt < optN; opt++) {
+      int numSteps;
+      binomialOptionsCPUTarget(callValue[opt], optionData[opt],
+                               (TLatticeMethod)method, targetError, &numSteps);
+      sumSteps += numSteps;
+    }
+
+    sdkStopTimer(&hTimer);
+    printf("%-14s %6.0f %12E %12f\n", methodName[method], sumSteps / optN,
+           (double)latticeL1(callValue, callValueBS, optN),
+           sdkGetTimerValue(&hTimer));
+  }
+
+  printf("\n");
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Main program
 ////////////////////////////////////////////////////////////////////////////////
@@ -120,8 +204,21 @@ int main(int argc, char **argv) {
 
   printf("Running CPU binomial tree...\n");
 
-  for (i = 0; i < OPT_N; i++) {
-    binomialOptionsCPU(callValueCPU[i], optionData[i]);
+  // the CPU results are reused from the gold cache for identical runs
+  {
+    sdkGoldCache goldCache("binomialOptions/binomialOptionsCPU", argc,
+                           (const char **)argv);
+    goldCache.addInput(optionData, OPT_N * sizeof(TOptionData))
+        .addParam(NUM_STEPS);
+    const real *cached = goldCache.compute(callValueCPU, OPT_N, [&]() {
+      for (int opt = 0; opt < OPT_N; opt++) {
+        binomialOptionsCPU(callValueCPU[opt], optionData[opt]);
+      }
+    });
+
+    if (cached != callValueCPU) {
+      memcpy(callValueCPU, cached, OPT_N * sizeof(real));
+    }
   }
 
   printf("Comparing the results...\n");
@@ -170,6 +267,16 @@ int main(int argc, char **argv) {
     printf("Avg. diff: %E\n", (double)(sumDelta / (real)OPT_N));
   }
 
+  if (checkCmdLineFlag(argc, (const char **)argv, "lattice")) {
+    double targetError = 1e-6;
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "target")) {
+      targetError = getCmdLineArgumentFloat(argc, (const char **)argv, "target");
+    }
+
+    compareLattices(optionData, callValueBS, OPT_N, targetError, hTimer);
+  }
+
   printf("Shutting down...\n");
 
   sdkDeleteTimer(&hTimer);
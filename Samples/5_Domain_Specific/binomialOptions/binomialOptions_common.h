@@ -41,6 +41,18 @@ typedef struct {
   real V;
 } TOptionData;
 
+// Lattices of the CPU pricer with a variable number of steps
+typedef enum {
+  // Cox-Ross-Rubinstein, as binomialOptionsCPU()
+  LATTICE_CRR,
+  // CRR with Black-Scholes values one step before expiry and Richardson
+  // extrapolation from n / 2 and n steps (Broadie-Detemple BBSR)
+  LATTICE_CRR_SMOOTHED,
+  // Leisen-Reimer with Peizer-Pratt inversion, odd step counts
+  LATTICE_LEISEN_REIMER,
+  LATTICE_METHOD_COUNT
+} TLatticeMethod;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Global parameters
 ////////////////////////////////////////////////////////////////////////////////
@@ -27,6 +27,7 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <vector>
 #include "binomialOptions_common.h"
 #include "realtype.h"
 
@@ -118,3 +119,151 @@ extern "C" void binomialOptionsCPU(real &callResult, TOptionData optionData) {
 
   callResult = (real)Call[0];
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// Lattices with a variable number of steps, computed in double precision.
+// The CRR price oscillates around the Black-Scholes value with an error of
+// O(1 / n). Smoothing the last step and extrapolating, or placing the strike
+// in the middle of the terminal nodes as Leisen and Reimer do, gives a
+// monotone O(1 / n^2) error.
+////////////////////////////////////////////////////////////////////////////////
+static const int LATTICE_MIN_STEPS = 16;
+static const int LATTICE_MAX_STEPS = 1 << 16;
+
+static double NormalCDF(double d) {
+  return 0.5 * erfc(-d * 0.70710678118654752440);
+}
+
+static double BlackScholesCallDouble(double S, double X, double T, double R,
+                                     double V) {
+  double sqrtT = sqrt(T);
+  double d1 = (log(S / X) + (R + 0.5 * V * V) * T) / (V * sqrtT);
+  double d2 = d1 - V * sqrtT;
+
+  return S * NormalCDF(d1) - X * exp(-R * T) * NormalCDF(d2);
+}
+
+// Walk backwards from the values at step n, Call[j] for 0 <= j <= n
+static double walkBackwards(std::vector<double> &Call, int n, double puByDf,
+                            double pdByDf) {
+  double *c = Call.data();
+
+  for (int i = n; i > 0; i--)
+    for (int j = 0; j <= i - 1; j++) c[j] = puByDf * c[j + 1] + pdByDf * c[j];
+
+  return c[0];
+}
+
+static double latticeCRR(const TOptionData &optionData, int n, bool smooth) {
+  const double S = optionData.S, X = optionData.X, T = optionData.T;
+  const double R = optionData.R, V = optionData.V;
+  const double dt = T / n;
+  const double vDt = V * sqrt(dt);
+  const double u = exp(vDt), d = exp(-vDt);
+  const double pu = (exp(R * dt) - d) / (u - d);
+  const double Df = exp(-R * dt);
+  std::vector<double> Call(n + 1);
+
+  if (!smooth) {
+    for (int j = 0; j <= n; j++) {
+      double e = S * exp(vDt * (2 * j - n)) - X;
+      Call[j] = (e > 0) ? e : 0;
+    }
+
+    return walkBackwards(Call, n, pu * Df, (1.0 - pu) * Df);
+  }
+
+  // Black-Scholes values of the nodes one step before expiry
+  for (int j = 0; j <= n - 1; j++) {
+    Call[j] = BlackScholesCallDouble(S * exp(vDt * (2 * j - (n - 1))), X, dt,
+                                     R, V);
+  }
+
+  return walkBackwards(Call, n - 1, pu * Df, (1.0 - pu) * Df);
+}
+
+// Peizer-Pratt method 2 inversion of the binomial distribution
+static double peizerPratt(double z, int n) {
+  double a = z / (n + 1.0 / 3.0 + 0.1 / (n + 1));
+  double h = 0.5 * sqrt(1.0 - exp(-a * a * (n + 1.0 / 6.0)));
+
+  return (z > 0) ? 0.5 + h : 0.5 - h;
+}
+
+static double latticeLeisenReimer(const TOptionData &optionData, int n) {
+  const double S = optionData.S, X = optionData.X, T = optionData.T;
+  const double R = optionData.R, V = optionData.V;
+  const double dt = T / n;
+  const double sqrtT = sqrt(T);
+  const double d1 = (log(S / X) + (R + 0.5 * V * V) * T) / (V * sqrtT);
+  const double d2 = d1 - V * sqrtT;
+  const double If = exp(R * dt);
+  const double p = peizerPratt(d2, n);
+  const double u = If * peizerPratt(d1, n) / p;
+  const double d = (If - p * u) / (1.0 - p);
+  const double logU = log(u), logD = log(d);
+  std::vector<double> Call(n + 1);
+
+  for (int j = 0; j <= n; j++) {
+    double e = S * exp(j * logU + (n - j) * logD) - X;
+    Call[j] = (e > 0) ? e : 0;
+  }
+
+  return walkBackwards(Call, n, p / If, (1.0 - p) / If);
+}
+
+static double latticePrice(const TOptionData &optionData, int numSteps,
+                           TLatticeMethod method) {
+  switch (method) {
+    case LATTICE_CRR_SMOOTHED:
+      return 2.0 * latticeCRR(optionData, numSteps, true) -
+             latticeCRR(optionData, numSteps / 2, true);
+
+    case LATTICE_LEISEN_REIMER:
+      return latticeLeisenReimer(optionData, numSteps | 1);
+
+    default:
+      return latticeCRR(optionData, numSteps, false);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Price a single option with the given lattice and number of steps
+////////////////////////////////////////////////////////////////////////////////
+extern "C" void binomialOptionsCPULattice(real &callResult,
+                                          TOptionData optionData,
+                                          int numSteps,
+                                          TLatticeMethod method) {
+  if (numSteps < LATTICE_MIN_STEPS) numSteps = LATTICE_MIN_STEPS;
+
+  callResult = (real)latticePrice(optionData, numSteps, method);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Price a single option with the given lattice, doubling the number of steps
+// until the estimated error is below targetError * S. The estimate is the
+// change of the last doubling, divided by 3 for the O(1 / n^2) lattices.
+// Returns the number of steps of the last lattice in *numSteps (may be NULL).
+////////////////////////////////////////////////////////////////////////////////
+extern "C" void binomialOptionsCPUTarget(real &callResult,
+                                         TOptionData optionData,
+                                         TLatticeMethod method,
+                                         double targetError, int *numSteps) {
+  const double tolerance = targetError * optionData.S;
+  const double scale = (method == LATTICE_CRR) ? 1.0 : 1.0 / 3.0;
+  int n = LATTICE_MIN_STEPS;
+  double previous = latticePrice(optionData, n, method), value = previous;
+
+  while (n < LATTICE_MAX_STEPS) {
+    n *= 2;
+    value = latticePrice(optionData, n, method);
+
+    if (fabs(value - previous) * scale <= tolerance) break;
+
+    previous = value;
+  }
+
+  callResult = (real)value;
+
+  if (numSteps) *numSteps = (method == LATTICE_LEISEN_REIMER) ? (n | 1) : n;
+}
@@ -53,6 +53,37 @@ extern "C" void convolutionClampToBorderCPU(float *h_Result, float *h_Data,
                                             int dataW, int kernelH, int kernelW,
                                             int kernelY, int kernelX);
 
+// Tile sizes of the host Winograd convolution, F(m x m, r x r) computes an
+// m x m output tile of an r x r kernel from an (m + r - 1)^2 input tile
+typedef enum {
+  WINOGRAD_AUTO = 0,  // selected by the kernel size
+  WINOGRAD_NONE,      // direct convolution
+  WINOGRAD_F2X2_3X3,
+  WINOGRAD_F4X4_3X3,
+  WINOGRAD_F4X4_5X5
+} TWinogradTile;
+
+extern "C" int convolutionSmallKernelCPU(float *h_Result, float *h_Data,
+                                         float *h_Kernel, int dataH, int dataW,
+                                         int kernelH, int kernelW, int kernelY,
+                                         int kernelX, int numInputs,
+                                         int numOutputs, int tile,
+                                         int numThreads);
+
+extern "C" void padKernelCPU(float *h_PaddedKernel, float *h_Kernel, int fftH,
+                             int fftW, int kernelH, int kernelW, int kernelY,
+                             int kernelX);
+
+extern "C" void padDataClampToBorderCPU(float *h_PaddedData, float *h_Data,
+                                        int fftH, int fftW, int dataH,
+                                        int dataW, int kernelY, int kernelX);
+
+extern "C" void convolutionFFTCPU(float *h_Result, float *h_Data,
+                                  float *h_Kernel, int dataH, int dataW,
+                                  int kernelH, int kernelW, int kernelY,
+                                  int kernelX, int fftH, int fftW,
+                                  int numThreads);
+
 extern "C" void padKernel(float *d_PaddedKernel, float *d_Kernel, int fftH,
                           int fftW, int kernelH, int kernelW, int kernelY,
                           int kernelX);
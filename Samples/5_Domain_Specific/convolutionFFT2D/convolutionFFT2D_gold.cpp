@@ -26,6 +26,17 @@
  */
 
 #include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <helper_fft.h>
+
 #include "convolutionFFT2D_common.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -59,3 +70,424 @@ extern "C" void convolutionClampToBorderCPU(float *h_Result, float *h_Data,
       h_Result[y * dataW + x] = (float)sum;
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// Winograd convolution of small kernels
+////////////////////////////////////////////////////////////////////////////////
+#define WINOGRAD_MAX_M 4
+#define WINOGRAD_MAX_R 5
+#define WINOGRAD_MAX_ALPHA (WINOGRAD_MAX_M + WINOGRAD_MAX_R - 1)
+
+// Output tiles of a tile row handled by one work item, the transformed tiles
+// of all channels are stored tile-minor so that every step vectorizes over
+// the tiles of a block
+#define WINOGRAD_TILE_BLOCK 32
+
+// Y = AT [(G g GT) . (BT d B)] A for an alpha x alpha input tile d and an
+// r x r kernel g, built with the Cook-Toom construction from alpha - 1
+// interpolation points and the point at infinity
+struct WinogradTransform {
+  int m, r, alpha;
+  float AT[WINOGRAD_MAX_M][WINOGRAD_MAX_ALPHA];
+  float BT[WINOGRAD_MAX_ALPHA][WINOGRAD_MAX_ALPHA];
+  double G[WINOGRAD_MAX_ALPHA][WINOGRAD_MAX_R];
+};
+
+static void initWinogradTransform(WinogradTransform &w, int m, int r) {
+  static const double points[WINOGRAD_MAX_ALPHA - 1] = {0.0, 1.0,  -1.0, 2.0,
+                                                         -2.0, 0.5, -0.5};
+  const int alpha = m + r - 1;
+  double V[WINOGRAD_MAX_ALPHA][2 * WINOGRAD_MAX_ALPHA];
+  double f[WINOGRAD_MAX_ALPHA];
+
+  w.m = m;
+  w.r = r;
+  w.alpha = alpha;
+
+  // Vandermonde matrix of the points, the last row evaluates at infinity
+  for (int j = 0; j < alpha; j++) {
+    for (int i = 0; i < alpha; i++) {
+      V[j][i] = (j < alpha - 1) ? pow(points[j], i) : (i == alpha - 1);
+      V[j][alpha + i] = (i == j);
+    }
+
+    f[j] = 1.0;
+
+    for (int l = 0; l < alpha - 1; l++)
+      if (j < alpha - 1 && l != j) f[j] *= points[j] - points[l];
+  }
+
+  // V^-1 by Gauss-Jordan elimination with partial pivoting
+  for (int c = 0; c < alpha; c++) {
+    int p = c;
+
+    for (int j = c + 1; j < alpha; j++)
+      if (fabs(V[j][c]) > fabs(V[p][c])) p = j;
+
+    for (int i = 0; i < 2 * alpha; i++) std::swap(V[c][i], V[p][i]);
+
+    double s = 1.0 / V[c][c];
+
+    for (int i = 0; i < 2 * alpha; i++) V[c][i] *= s;
+
+    for (int j = 0; j < alpha; j++)
+      if (j != c && V[j][c] != 0.0) {
+        double t = V[j][c];
+
+        for (int i = 0; i < 2 * alpha; i++) V[j][i] -= t * V[c][i];
+      }
+  }
+
+  // The interpolation matrix V^-1 is scaled by f so that BT has small
+  // integer (or dyadic) entries, and G carries 1 / f in double precision
+  for (int j = 0; j < alpha; j++) {
+    for (int i = 0; i < alpha; i++)
+      w.BT[j][i] = (float)(V[i][alpha + j] * f[j]);
+
+    for (int k = 0; k < r; k++)
+      w.G[j][k] =
+          ((j < alpha - 1) ? pow(points[j], k) : (double)(k == r - 1)) / f[j];
+  }
+
+  for (int i = 0; i < m; i++)
+    for (int j = 0; j < alpha; j++)
+      w.AT[i][j] = (j < alpha - 1) ? (float)pow(points[j], i)
+                                   : (float)(i == m - 1);
+}
+
+// Y[i][j] = sum_k L[i][k] X[k][j] for the tile-minor blocks X and Y, zero
+// coefficients are skipped
+static void winogradRowsTransform(float *Y, const float *X, const float *L,
+                                  int lda, int rows, int inner, int cols,
+                                  int nT) {
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++) {
+      float *y = Y + (i * cols + j) * WINOGRAD_TILE_BLOCK;
+
+      for (int t = 0; t < nT; t++) y[t] = 0.0f;
+
+      for (int k = 0; k < inner; k++) {
+        const float c = L[i * lda + k];
+
+        if (c == 0.0f) continue;
+
+        const float *x = X + (k * cols + j) * WINOGRAD_TILE_BLOCK;
+
+        for (int t = 0; t < nT; t++) y[t] += c * x[t];
+      }
+    }
+}
+
+// Y[i][j] = sum_k X[i][k] L[j][k], the right hand side product
+static void winogradColsTransform(float *Y, int ldy, const float *X,
+                                  const float *L, int lda, int rows, int inner,
+                                  int cols, int nT) {
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++) {
+      float *y = Y + (i * cols + j) * ldy;
+
+      for (int t = 0; t < nT; t++) y[t] = 0.0f;
+
+      for (int k = 0; k < inner; k++) {
+        const float c = L[j * lda + k];
+
+        if (c == 0.0f) continue;
+
+        const float *x = X + (i * inner + k) * WINOGRAD_TILE_BLOCK;
+
+        for (int t = 0; t < nT; t++) y[t] += c * x[t];
+      }
+    }
+}
+
+static void convolutionWinogradCPU(float *h_Result, const float *h_Data,
+                                   const float *h_Kernel, int dataH, int dataW,
+                                   int kernelH, int kernelW, int kernelY,
+                                   int kernelX, int numInputs, int numOutputs,
+                                   int m, int r, int numThreads) {
+  WinogradTransform w;
+  initWinogradTransform(w, m, r);
+
+  const int alpha = w.alpha;
+  const int alpha2 = alpha * alpha;
+  const int C = numInputs;
+  const int K = numOutputs;
+  const int tilesY = iDivUp(dataH, m);
+  const int tilesX = iDivUp(dataW, m);
+  const int blocksX = iDivUp(tilesX, WINOGRAD_TILE_BLOCK);
+  const int numItems = tilesY * blocksX;
+
+  // The kernels are zero padded to r x r in the bottom right corner and
+  // flipped, since the transform computes a correlation.
+  // U[e][k][c] = (G g(k, c) GT)[e]
+  std::vector<float> U((size_t)alpha2 * K * C);
+
+  for (int k = 0; k < K; k++)
+    for (int c = 0; c < C; c++) {
+      const float *kernel = h_Kernel + ((size_t)k * C + c) * kernelH * kernelW;
+      double g[WINOGRAD_MAX_R][WINOGRAD_MAX_R] = {};
+      double Gg[WINOGRAD_MAX_ALPHA][WINOGRAD_MAX_R];
+
+      for (int a = 0; a < kernelH; a++)
+        for (int b = 0; b < kernelW; b++)
+          g[a][b] = kernel[(kernelH - 1 - a) * kernelW + (kernelW - 1 - b)];
+
+      for (int i = 0; i < alpha; i++)
+        for (int b = 0; b < r; b++) {
+          Gg[i][b] = 0.0;
+
+          for (int a = 0; a < r; a++) Gg[i][b] += w.G[i][a] * g[a][b];
+        }
+
+      for (int i = 0; i < alpha; i++)
+        for (int j = 0; j < alpha; j++) {
+          double u = 0.0;
+
+          for (int b = 0; b < r; b++) u += Gg[i][b] * w.G[j][b];
+
+          U[((size_t)(i * alpha + j) * K + k) * C + c] = (float)u;
+        }
+    }
+
+  // Clamped source column of every input tile column, shifted by the anchor
+  const int offY = kernelH - kernelY - 1;
+  const int offX = kernelW - kernelX - 1;
+  std::vector<int> colIndex(tilesX * m + alpha);
+
+  for (int x = 0; x < (int)colIndex.size(); x++)
+    colIndex[x] = (std::min)((std::max)(x - offX, 0), dataW - 1);
+
+  std::atomic<int> nextItem(0);
+
+  auto worker = [&]() {
+    const size_t blockSize = (size_t)alpha2 * WINOGRAD_TILE_BLOCK;
+    std::vector<float> d(blockSize), tmp(blockSize);
+    std::vector<float> V(blockSize * C), M(blockSize * K);
+    const float *rows[WINOGRAD_MAX_ALPHA];
+
+    for (int item = nextItem++; item < numItems; item = nextItem++) {
+      const int ty = item / blocksX;
+      const int tx0 = (item % blocksX) * WINOGRAD_TILE_BLOCK;
+      const int nT = (std::min)(WINOGRAD_TILE_BLOCK, tilesX - tx0);
+      const int *cols = &colIndex[tx0 * m];
+
+      // V[e][c] = BT d(c) B for all tiles of the block
+      for (int c = 0; c < C; c++) {
+        const float *data = h_Data + (size_t)c * dataH * dataW;
+
+        for (int i = 0; i < alpha; i++) {
+          int y = (std::min)((std::max)(ty * m - offY + i, 0), dataH - 1);
+          rows[i] = data + (size_t)y * dataW;
+        }
+
+        for (int i = 0; i < alpha; i++)
+          for (int j = 0; j < alpha; j++) {
+            float *dst = &d[(i * alpha + j) * WINOGRAD_TILE_BLOCK];
+
+            for (int t = 0; t < nT; t++) dst[t] = rows[i][cols[t * m + j]];
+          }
+
+        winogradRowsTransform(&tmp[0], &d[0], &w.BT[0][0], WINOGRAD_MAX_ALPHA,
+                              alpha, alpha, alpha, nT);
+        winogradColsTransform(&V[(size_t)c * WINOGRAD_TILE_BLOCK],
+                              C * WINOGRAD_TILE_BLOCK, &tmp[0], &w.BT[0][0],
+                              WINOGRAD_MAX_ALPHA, alpha, alpha, alpha, nT);
+      }
+
+      // M[e][k] = sum_c U[e][k][c] V[e][c], one K x C by C x nT product per
+      // element of the transformed tile
+      for (int e = 0; e < alpha2; e++)
+        for (int k = 0; k < K; k++) {
+          const float *u = &U[((size_t)e * K + k) * C];
+          float *acc = &M[((size_t)e * K + k) * WINOGRAD_TILE_BLOCK];
+
+          for (int t = 0; t < nT; t++) acc[t] = 0.0f;
+
+          for (int c = 0; c < C; c++) {
+            const float *v = &V[((size_t)e * C + c) * WINOGRAD_TILE_BLOCK];
+            const float uc = u[c];
+
+            for (int t = 0; t < nT; t++) acc[t] += uc * v[t];
+          }
+        }
+
+      // Y(k) = AT M(k) A, stored to the output tiles inside the image
+      for (int k = 0; k < K; k++) {
+        float *result = h_Result + (size_t)k * dataH * dataW;
+
+        for (int e = 0; e < alpha2; e++)
+          memcpy(&d[e * WINOGRAD_TILE_BLOCK],
+                 &M[((size_t)e * K + k) * WINOGRAD_TILE_BLOCK],
+                 nT * sizeof(float));
+
+        winogradRowsTransform(&tmp[0], &d[0], &w.AT[0][0], WINOGRAD_MAX_ALPHA,
+                              m, alpha, alpha, nT);
+        winogradColsTransform(&d[0], WINOGRAD_TILE_BLOCK, &tmp[0],
+                              &w.AT[0][0], WINOGRAD_MAX_ALPHA, m, alpha, m,
+                              nT);
+
+        for (int i = 0; i < m && ty * m + i < dataH; i++) {
+          float *dst = result + (size_t)(ty * m + i) * dataW + tx0 * m;
+          const int width = (std::min)(nT * m, dataW - tx0 * m);
+
+          for (int x = 0; x < width; x++)
+            dst[x] = d[(i * m + x % m) * WINOGRAD_TILE_BLOCK + x / m];
+        }
+      }
+    }
+  };
+
+  if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+
+  numThreads = (std::min)(numThreads, numItems);
+
+  std::vector<std::thread> threads;
+
+  for (int t = 1; t < numThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker));
+    } catch (const std::system_error &) {
+      // no thread support, this thread takes the remaining tiles
+      break;
+    }
+  }
+
+  worker();
+
+  for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Clamp to border convolution of numInputs channels of dataH x dataW with
+// numOutputs x numInputs kernels of kernelH x kernelW, the result channel k
+// is the sum over c of the convolutions of channel c with kernel (k, c).
+// h_Data is numInputs planes, h_Kernel numOutputs x numInputs kernels and
+// h_Result numOutputs planes. WINOGRAD_AUTO uses F(4x4, 3x3) for kernels up
+// to 3x3, F(4x4, 5x5) up to 5x5 and the direct convolution for larger
+// kernels. Returns the tile size that was used.
+////////////////////////////////////////////////////////////////////////////////
+extern "C" int convolutionSmallKernelCPU(float *h_Result, float *h_Data,
+                                         float *h_Kernel, int dataH, int dataW,
+                                         int kernelH, int kernelW, int kernelY,
+                                         int kernelX, int numInputs,
+                                         int numOutputs, int tile,
+                                         int numThreads) {
+  const int kernelSize = (std::max)(kernelH, kernelW);
+
+  if (tile == WINOGRAD_AUTO) {
+    tile = (kernelSize <= 3) ? WINOGRAD_F4X4_3X3
+                             : (kernelSize <= 5) ? WINOGRAD_F4X4_5X5
+                                                 : WINOGRAD_NONE;
+  }
+
+  int m = (tile == WINOGRAD_F2X2_3X3) ? 2 : 4;
+  int r = (tile == WINOGRAD_F4X4_5X5) ? 5 : 3;
+
+  if (tile == WINOGRAD_NONE || kernelSize > r) {
+    std::vector<float> plane((size_t)dataH * dataW);
+
+    for (int k = 0; k < numOutputs; k++) {
+      float *result = h_Result + (size_t)k * dataH * dataW;
+
+      for (int c = 0; c < numInputs; c++) {
+        convolutionClampToBorderCPU(
+            c ? &plane[0] : result, h_Data + (size_t)c * dataH * dataW,
+            h_Kernel + ((size_t)k * numInputs + c) * kernelH * kernelW, dataH,
+            dataW, kernelH, kernelW, kernelY, kernelX);
+
+        if (c)
+          for (size_t i = 0; i < plane.size(); i++) result[i] += plane[i];
+      }
+    }
+
+    return WINOGRAD_NONE;
+  }
+
+  convolutionWinogradCPU(h_Result, h_Data, h_Kernel, dataH, dataW, kernelH,
+                         kernelW, kernelY, kernelX, numInputs, numOutputs, m,
+                         r, numThreads);
+
+  return tile;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Host counterparts of padKernel() and padDataClampToBorder()
+////////////////////////////////////////////////////////////////////////////////
+extern "C" void padKernelCPU(float *h_PaddedKernel, float *h_Kernel, int fftH,
+                             int fftW, int kernelH, int kernelW, int kernelY,
+                             int kernelX) {
+  memset(h_PaddedKernel, 0, (size_t)fftH * fftW * sizeof(float));
+
+  for (int y = 0; y < kernelH; y++)
+    for (int x = 0; x < kernelW; x++) {
+      int ky = y - kernelY;
+      int kx = x - kernelX;
+
+      if (ky < 0) ky += fftH;
+
+      if (kx < 0) kx += fftW;
+
+      h_PaddedKernel[ky * fftW + kx] = h_Kernel[y * kernelW + x];
+    }
+}
+
+extern "C" void padDataClampToBorderCPU(float *h_PaddedData, float *h_Data,
+                                        int fftH, int fftW, int dataH,
+                                        int dataW, int kernelY, int kernelX) {
+  const int borderH = dataH + kernelY;
+  const int borderW = dataW + kernelX;
+
+  for (int y = 0; y < fftH; y++)
+    for (int x = 0; x < fftW; x++) {
+      int dy = (y < dataH) ? y : (y < borderH) ? dataH - 1 : 0;
+      int dx = (x < dataW) ? x : (x < borderW) ? dataW - 1 : 0;
+
+      h_PaddedData[y * fftW + x] = h_Data[dy * dataW + dx];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Host FFT convolution with the padding, transforms and modulation of the GPU
+// path, using the cached plans of helper_fft.h. h_Result is dataH x dataW.
+////////////////////////////////////////////////////////////////////////////////
+extern "C" void convolutionFFTCPU(float *h_Result, float *h_Data,
+                                  float *h_Kernel, int dataH, int dataW,
+                                  int kernelH, int kernelW, int kernelY,
+                                  int kernelX, int fftH, int fftW,
+                                  int numThreads) {
+  const int n[2] = {fftH, fftW};
+  const size_t spectrumSize = (size_t)fftH * (fftW / 2 + 1);
+  std::vector<float> paddedKernel((size_t)fftH * fftW);
+  std::vector<float> paddedData((size_t)fftH * fftW);
+  std::vector<sdkFftComplex> kernelSpectrum(spectrumSize);
+  std::vector<sdkFftComplex> dataSpectrum(spectrumSize);
+
+  padKernelCPU(&paddedKernel[0], h_Kernel, fftH, fftW, kernelH, kernelW,
+               kernelY, kernelX);
+  padDataClampToBorderCPU(&paddedData[0], h_Data, fftH, fftW, dataH, dataW,
+                          kernelY, kernelX);
+
+  std::shared_ptr<const sdkFftPlan> planFwd =
+      sdkFftGetPlan(2, n, SDK_FFT_R2C);
+  std::shared_ptr<const sdkFftPlan> planInv =
+      sdkFftGetPlan(2, n, SDK_FFT_C2R);
+
+  planFwd->execR2C(&paddedKernel[0], &kernelSpectrum[0], numThreads);
+  planFwd->execR2C(&paddedData[0], &dataSpectrum[0], numThreads);
+
+  const float c = 1.0f / (float)(fftH * fftW);
+
+  for (size_t i = 0; i < spectrumSize; i++) {
+    sdkFftComplex a = dataSpectrum[i];
+    sdkFftComplex b = kernelSpectrum[i];
+
+    dataSpectrum[i].x = c * (a.x * b.x - a.y * b.y);
+    dataSpectrum[i].y = c * (a.y * b.x + a.x * b.y);
+  }
+
+  planInv->execC2R(&dataSpectrum[0], &paddedData[0], numThreads);
+
+  for (int y = 0; y < dataH; y++)
+    memcpy(h_Result + (size_t)y * dataW, &paddedData[(size_t)y * fftW],
+           dataW * sizeof(float));
+}
@@ -44,6 +44,8 @@
 // Helper functions for CUDA
 #include <helper_functions.h>
 #include <helper_cuda.h>
+#include <helper_fft.h>
+#include <helper_gold_cache.h>
 
 #include "convolutionFFT2D_common.h"
 
@@ -78,6 +80,48 @@ int snapTransformSize(int dataSize) {
 
 float getRand(void) { return (float)(rand() % 16); }
 
+double relativeL2(const float *h_Reference, const float *h_Result, size_t n) {
+  double sum_delta2 = 0;
+  double sum_ref2 = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    double delta = (double)h_Reference[i] - (double)h_Result[i];
+    sum_delta2 += delta * delta;
+    sum_ref2 += (double)h_Reference[i] * (double)h_Reference[i];
+  }
+
+  return sqrt(sum_delta2 / sum_ref2);
+}
+
+// command line, for the gold cache options
+static int g_argc = 0;
+static const char **g_argv = NULL;
+
+// convolutionClampToBorderCPU(), reused from the gold cache for identical
+// inputs
+void convolutionReferenceCPU(float *h_Result, float *h_Data, float *h_Kernel,
+                             int dataH, int dataW, int kernelH, int kernelW,
+                             int kernelY, int kernelX) {
+  sdkGoldCache goldCache("convolutionFFT2D/convolutionClampToBorderCPU",
+                         g_argc, g_argv);
+  goldCache.addInput(h_Data, dataH * dataW * sizeof(float))
+      .addInput(h_Kernel, kernelH * kernelW * sizeof(float))
+      .addParam(dataH)
+      .addParam(dataW)
+      .addParam(kernelH)
+      .addParam(kernelW)
+      .addParam(kernelY)
+      .addParam(kernelX);
+  const float *reference = goldCache.compute(h_Result, dataH * dataW, [&]() {
+    convolutionClampToBorderCPU(h_Result, h_Data, h_Kernel, dataH, dataW,
+                                kernelH, kernelW, kernelY, kernelX);
+  });
+
+  if (reference != h_Result) {
+    memcpy(h_Result, reference, dataH * dataW * sizeof(float));
+  }
+}
+
 bool test0(void) {
   float *h_Data, *h_Kernel, *h_ResultCPU, *h_ResultGPU;
 
@@ -159,6 +203,31 @@ bool test0(void) {
   checkCudaErrors(cufftExecR2C(fftPlanFwd, (cufftReal *)d_PaddedKernel,
                                (cufftComplex *)d_KernelSpectrum));
 
+  // The kernel spectrum is compared with the host FFT of the same padded
+  // kernel, so transform errors are not hidden by the convolution
+  printf("...validating kernel spectrum against the host FFT: ");
+  const int fftDims[2] = {fftH, fftW};
+  const size_t spectrumFloats = 2 * (size_t)fftH * (fftW / 2 + 1);
+  float *h_PaddedKernel = (float *)malloc(fftH * fftW * sizeof(float));
+  float *h_SpectrumGPU = (float *)malloc(spectrumFloats * sizeof(float));
+  float *h_SpectrumCPU = (float *)malloc(spectrumFloats * sizeof(float));
+
+  checkCudaErrors(cudaMemcpy(h_PaddedKernel, d_PaddedKernel,
+                             fftH * fftW * sizeof(float),
+                             cudaMemcpyDeviceToHost));
+  checkCudaErrors(cudaMemcpy(h_SpectrumGPU, d_KernelSpectrum,
+                             spectrumFloats * sizeof(float),
+                             cudaMemcpyDeviceToHost));
+  sdkFftGetPlan(2, fftDims, SDK_FFT_R2C)
+      ->execR2C(h_PaddedKernel, (sdkFftComplex *)h_SpectrumCPU);
+  double spectrumL2 =
+      relativeL2(h_SpectrumCPU, h_SpectrumGPU, spectrumFloats);
+  printf("rel L2 = %E\n", spectrumL2);
+
+  free(h_SpectrumCPU);
+  free(h_SpectrumGPU);
+  free(h_PaddedKernel);
+
   printf("...running GPU FFT convolution: ");
   checkCudaErrors(cudaDeviceSynchronize());
   sdkResetTimer(&hTimer);
@@ -181,8 +250,8 @@ bool test0(void) {
                              cudaMemcpyDeviceToHost));
 
   printf("...running reference CPU convolution\n");
-  convolutionClampToBorderCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
-                              kernelH, kernelW, kernelY, kernelX);
+  convolutionReferenceCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
+                          kernelH, kernelW, kernelY, kernelX);
 
   printf("...comparing the results: ");
   double sum_delta2 = 0;
@@ -206,7 +275,7 @@ bool test0(void) {
 
   double L2norm = sqrt(sum_delta2 / sum_ref2);
   printf("rel L2 = %E (max delta = %E)\n", L2norm, sqrt(max_delta_ref));
-  bRetVal = (L2norm < 1e-6) ? true : false;
+  bRetVal = (L2norm < 1e-6 && spectrumL2 < 1e-5) ? true : false;
   printf(bRetVal ? "L2norm Error OK\n" : "L2norm Error too high!\n");
 
   printf("...shutting down\n");
@@ -351,8 +420,8 @@ bool test1(void) {
                              cudaMemcpyDeviceToHost));
 
   printf("...running reference CPU convolution\n");
-  convolutionClampToBorderCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
-                              kernelH, kernelW, kernelY, kernelX);
+  convolutionReferenceCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
+                          kernelH, kernelW, kernelY, kernelX);
 
   printf("...comparing the results: ");
   double sum_delta2 = 0;
@@ -505,8 +574,8 @@ bool test2(void) {
                              cudaMemcpyDeviceToHost));
 
   printf("...running reference CPU convolution\n");
-  convolutionClampToBorderCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
-                              kernelH, kernelW, kernelY, kernelX);
+  convolutionReferenceCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
+                          kernelH, kernelW, kernelY, kernelX);
 
   printf("...comparing the results: ");
   double sum_delta2 = 0;
@@ -553,9 +622,247 @@ bool test2(void) {
   return bRetVal;
 }
 
+// GPU FFT convolution of a single channel as in test0(), returns the time of
+// the forward and inverse transforms in ms
+double convolutionFFTGPU(float *h_Result, float *h_Data, float *h_Kernel,
+                         int dataH, int dataW, int kernelH, int kernelW,
+                         int kernelY, int kernelX) {
+  float *d_Data, *d_PaddedData, *d_Kernel, *d_PaddedKernel;
+  fComplex *d_DataSpectrum, *d_KernelSpectrum;
+  cufftHandle fftPlanFwd, fftPlanInv;
+  StopWatchInterface *hTimer = NULL;
+  sdkCreateTimer(&hTimer);
+
+  const int fftH = snapTransformSize(dataH + kernelH - 1);
+  const int fftW = snapTransformSize(dataW + kernelW - 1);
+
+  checkCudaErrors(cudaMalloc((void **)&d_Data, dataH * dataW * sizeof(float)));
+  checkCudaErrors(
+      cudaMalloc((void **)&d_Kernel, kernelH * kernelW * sizeof(float)));
+  checkCudaErrors(
+      cudaMalloc((void **)&d_PaddedData, fftH * fftW * sizeof(float)));
+  checkCudaErrors(
+      cudaMalloc((void **)&d_PaddedKernel, fftH * fftW * sizeof(float)));
+  checkCudaErrors(cudaMalloc((void **)&d_DataSpectrum,
+                             fftH * (fftW / 2 + 1) * sizeof(fComplex)));
+  checkCudaErrors(cudaMalloc((void **)&d_KernelSpectrum,
+                             fftH * (fftW / 2 + 1) * sizeof(fComplex)));
+
+  checkCudaErrors(cufftPlan2d(&fftPlanFwd, fftH, fftW, CUFFT_R2C));
+  checkCudaErrors(cufftPlan2d(&fftPlanInv, fftH, fftW, CUFFT_C2R));
+
+  checkCudaErrors(cudaMemcpy(d_Kernel, h_Kernel,
+                             kernelH * kernelW * sizeof(float),
+                             cudaMemcpyHostToDevice));
+  checkCudaErrors(cudaMemcpy(d_Data, h_Data, dataH * dataW * sizeof(float),
+                             cudaMemcpyHostToDevice));
+  checkCudaErrors(cudaMemset(d_PaddedKernel, 0, fftH * fftW * sizeof(float)));
+  checkCudaErrors(cudaMemset(d_PaddedData, 0, fftH * fftW * sizeof(float)));
+
+  padKernel(d_PaddedKernel, d_Kernel, fftH, fftW, kernelH, kernelW, kernelY,
+            kernelX);
+  padDataClampToBorder(d_PaddedData, d_Data, fftH, fftW, dataH, dataW, kernelH,
+                       kernelW, kernelY, kernelX);
+  checkCudaErrors(cufftExecR2C(fftPlanFwd, (cufftReal *)d_PaddedKernel,
+                               (cufftComplex *)d_KernelSpectrum));
+
+  checkCudaErrors(cudaDeviceSynchronize());
+  sdkResetTimer(&hTimer);
+  sdkStartTimer(&hTimer);
+  checkCudaErrors(cufftExecR2C(fftPlanFwd, (cufftReal *)d_PaddedData,
+                               (cufftComplex *)d_DataSpectrum));
+  modulateAndNormalize(d_DataSpectrum, d_KernelSpectrum, fftH, fftW, 1);
+  checkCudaErrors(cufftExecC2R(fftPlanInv, (cufftComplex *)d_DataSpectrum,
+                               (cufftReal *)d_PaddedData));
+  checkCudaErrors(cudaDeviceSynchronize());
+  sdkStopTimer(&hTimer);
+  double gpuTime = sdkGetTimerValue(&hTimer);
+
+  checkCudaErrors(cudaMemcpy2D(h_Result, dataW * sizeof(float), d_PaddedData,
+                               fftW * sizeof(float), dataW * sizeof(float),
+                               dataH, cudaMemcpyDeviceToHost));
+
+  sdkDeleteTimer(&hTimer);
+  checkCudaErrors(cufftDestroy(fftPlanInv));
+  checkCudaErrors(cufftDestroy(fftPlanFwd));
+  checkCudaErrors(cudaFree(d_KernelSpectrum));
+  checkCudaErrors(cudaFree(d_DataSpectrum));
+  checkCudaErrors(cudaFree(d_PaddedKernel));
+  checkCudaErrors(cudaFree(d_PaddedData));
+  checkCudaErrors(cudaFree(d_Kernel));
+  checkCudaErrors(cudaFree(d_Data));
+
+  return gpuTime;
+}
+
+// Host Winograd convolution of small kernels against the direct CPU
+// convolution and, for single channels, the GPU FFT convolution
+bool test3(int numThreads) {
+  static const struct {
+    int dataH, dataW, kernelH, kernelW, kernelY, kernelX, numInputs,
+        numOutputs;
+  } cases[] = {
+      {2000, 2000, 3, 3, 1, 1, 1, 1},  {2000, 2000, 5, 5, 2, 2, 1, 1},
+      {2000, 2000, 2, 3, 0, 2, 1, 1},  {256, 256, 3, 3, 1, 1, 16, 16},
+      {256, 256, 5, 5, 2, 2, 16, 16},
+  };
+  static const char *tileNames[] = {"auto", "direct", "F(2x2,3x3)",
+                                    "F(4x4,3x3)", "F(4x4,5x5)"};
+
+  StopWatchInterface *hTimer = NULL;
+  sdkCreateTimer(&hTimer);
+  bool bRetVal = true;
+
+  printf("Testing host Winograd convolution of small kernels\n");
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    const int dataH = cases[i].dataH;
+    const int dataW = cases[i].dataW;
+    const int kernelH = cases[i].kernelH;
+    const int kernelW = cases[i].kernelW;
+    const int kernelY = cases[i].kernelY;
+    const int kernelX = cases[i].kernelX;
+    const int C = cases[i].numInputs;
+    const int K = cases[i].numOutputs;
+    const size_t dataSize = (size_t)dataH * dataW;
+    const double mpix = (double)dataSize * K * 1e-6;
+
+    float *h_Data = (float *)malloc(C * dataSize * sizeof(float));
+    float *h_Kernel =
+        (float *)malloc(K * C * kernelH * kernelW * sizeof(float));
+    float *h_ResultCPU = (float *)malloc(K * dataSize * sizeof(float));
+    float *h_ResultWinograd = (float *)malloc(K * dataSize * sizeof(float));
+
+    srand(2010);
+
+    for (size_t j = 0; j < C * dataSize; j++) {
+      h_Data[j] = getRand();
+    }
+
+    for (int j = 0; j < K * C * kernelH * kernelW; j++) {
+      h_Kernel[j] = getRand();
+    }
+
+    printf("...%i x %i, %i -> %i channels, %i x %i kernel\n", dataH, dataW, C,
+           K, kernelH, kernelW);
+
+    sdkResetTimer(&hTimer);
+    sdkStartTimer(&hTimer);
+    convolutionSmallKernelCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
+                              kernelH, kernelW, kernelY, kernelX, C, K,
+                              WINOGRAD_NONE, 1);
+    sdkStopTimer(&hTimer);
+    double cpuTime = sdkGetTimerValue(&hTimer);
+    printf("   direct CPU      : %f MPix/s (%f ms)\n", mpix / (cpuTime * 0.001),
+           cpuTime);
+
+    sdkResetTimer(&hTimer);
+    sdkStartTimer(&hTimer);
+    int tile = convolutionSmallKernelCPU(
+        h_ResultWinograd, h_Data, h_Kernel, dataH, dataW, kernelH, kernelW,
+        kernelY, kernelX, C, K, WINOGRAD_AUTO, numThreads);
+    sdkStopTimer(&hTimer);
+    double winogradTime = sdkGetTimerValue(&hTimer);
+    double L2norm = relativeL2(h_ResultCPU, h_ResultWinograd, K * dataSize);
+    printf("   %-16s: %f MPix/s (%f ms), rel L2 = %E\n", tileNames[tile],
+           mpix / (winogradTime * 0.001), winogradTime, L2norm);
+
+    if (L2norm > 1e-6) {
+      bRetVal = false;
+    }
+
+    if (C == 1 && K == 1) {
+      double gpuTime =
+          convolutionFFTGPU(h_ResultWinograd, h_Data, h_Kernel, dataH, dataW,
+                            kernelH, kernelW, kernelY, kernelX);
+      printf("   GPU FFT         : %f MPix/s (%f ms), rel L2 = %E\n",
+             mpix / (gpuTime * 0.001), gpuTime,
+             relativeL2(h_ResultCPU, h_ResultWinograd, dataSize));
+    }
+
+    free(h_ResultWinograd);
+    free(h_ResultCPU);
+    free(h_Kernel);
+    free(h_Data);
+  }
+
+  printf(bRetVal ? "L2norm Error OK\n" : "L2norm Error too high!\n");
+  sdkDeleteTimer(&hTimer);
+
+  return bRetVal;
+}
+
+// Host FFT convolution of the test0() data against the direct CPU
+// convolution
+bool test4(int numThreads) {
+  const int kernelH = 7;
+  const int kernelW = 6;
+  const int kernelY = 3;
+  const int kernelX = 4;
+  const int dataH = 2000;
+  const int dataW = 2000;
+  const int fftH = snapTransformSize(dataH + kernelH - 1);
+  const int fftW = snapTransformSize(dataW + kernelW - 1);
+  const size_t dataSize = (size_t)dataH * dataW;
+
+  StopWatchInterface *hTimer = NULL;
+  sdkCreateTimer(&hTimer);
+
+  printf("Testing host R2C / C2R FFT-based convolution\n");
+  float *h_Data = (float *)malloc(dataSize * sizeof(float));
+  float *h_Kernel = (float *)malloc(kernelH * kernelW * sizeof(float));
+  float *h_ResultCPU = (float *)malloc(dataSize * sizeof(float));
+  float *h_ResultFFT = (float *)malloc(dataSize * sizeof(float));
+
+  srand(2010);
+
+  for (size_t i = 0; i < dataSize; i++) {
+    h_Data[i] = getRand();
+  }
+
+  for (int i = 0; i < kernelH * kernelW; i++) {
+    h_Kernel[i] = getRand();
+  }
+
+  // the first call creates and caches the plans
+  printf("...creating host R2C & C2R FFT plans for %i x %i\n", fftH, fftW);
+  convolutionFFTCPU(h_ResultFFT, h_Data, h_Kernel, dataH, dataW, kernelH,
+                    kernelW, kernelY, kernelX, fftH, fftW, numThreads);
+
+  printf("...running host FFT convolution: ");
+  sdkResetTimer(&hTimer);
+  sdkStartTimer(&hTimer);
+  convolutionFFTCPU(h_ResultFFT, h_Data, h_Kernel, dataH, dataW, kernelH,
+                    kernelW, kernelY, kernelX, fftH, fftW, numThreads);
+  sdkStopTimer(&hTimer);
+  double fftTime = sdkGetTimerValue(&hTimer);
+  printf("%f MPix/s (%f ms)\n", (double)dataSize * 1e-6 / (fftTime * 0.001),
+         fftTime);
+
+  printf("...running reference CPU convolution\n");
+  convolutionReferenceCPU(h_ResultCPU, h_Data, h_Kernel, dataH, dataW,
+                          kernelH, kernelW, kernelY, kernelX);
+
+  double L2norm = relativeL2(h_ResultCPU, h_ResultFFT, dataSize);
+  printf("...comparing the results: rel L2 = %E\n", L2norm);
+  bool bRetVal = (L2norm < 1e-6) ? true : false;
+  printf(bRetVal ? "L2norm Error OK\n" : "L2norm Error too high!\n");
+
+  sdkDeleteTimer(&hTimer);
+  free(h_ResultFFT);
+  free(h_ResultCPU);
+  free(h_Kernel);
+  free(h_Data);
+
+  return bRetVal;
+}
+
 int main(int argc, char **argv) {
   printf("[%s] - Starting...\n", argv[0]);
 
+  g_argc = argc;
+  g_argv = (const char **)argv;
+
   // Use command-line specified CUDA device, otherwise use device with highest
   // Gflops/s
   findCudaDevice(argc, (const char **)argv);
@@ -574,6 +881,30 @@ int main(int argc, char **argv) {
     nFailures++;
   }
 
+  if (checkCmdLineFlag(argc, (const char **)argv, "winograd")) {
+    int numThreads = 0;
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "threads")) {
+      numThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+    }
+
+    if (!test3(numThreads)) {
+      nFailures++;
+    }
+  }
+
+  if (checkCmdLineFlag(argc, (const char **)argv, "hostfft")) {
+    int numThreads = 0;
+
+    if (checkCmdLineFlag(argc, (const char **)argv, "threads")) {
+      numThreads = getCmdLineArgumentInt(argc, (const char **)argv, "threads");
+    }
+
+    if (!test4(numThreads)) {
+      nFailures++;
+    }
+  }
+
   printf("Test Summary: %d errors\n", nFailures);
 
   if (nFailures > 0) {
@@ -33,6 +33,7 @@ namespace cg = cooperative_groups;
 #include <helper_functions.h>
 #include <helper_cuda.h>
 
+#include <helper_dxt.h>
 #include <helper_math.h>
 #include <float.h>  // for FLT_MAX
 
@@ -458,108 +459,6 @@ __global__ void compress(const uint *permutations, const uint *image,
   }
 }
 
-// Helper structs and functions to validate the output of the compressor.
-// We cannot simply do a bitwise compare, because different compilers produce
-// different
-// results for different targets due to floating point arithmetic.
-
-union Color32 {
-  struct {
-    unsigned char b, g, r, a;
-  };
-  unsigned int u;
-};
-
-union Color16 {
-  struct {
-    unsigned short b : 5;
-    unsigned short g : 6;
-    unsigned short r : 5;
-  };
-  unsigned short u;
-};
-
-struct BlockDXT1 {
-  Color16 col0;
-  Color16 col1;
-  union {
-    unsigned char row[4];
-    unsigned int indices;
-  };
-
-  void decompress(Color32 colors[16]) const;
-};
-
-void BlockDXT1::decompress(Color32 *colors) const {
-  Color32 palette[4];
-
-  // Does bit expansion before interpolation.
-  palette[0].b = (col0.b << 3) | (col0.b >> 2);
-  palette[0].g = (col0.g << 2) | (col0.g >> 4);
-  palette[0].r = (col0.r << 3) | (col0.r >> 2);
-  palette[0].a = 0xFF;
-
-  palette[1].r = (col1.r << 3) | (col1.r >> 2);
-  palette[1].g = (col1.g << 2) | (col1.g >> 4);
-  palette[1].b = (col1.b << 3) | (col1.b >> 2);
-  palette[1].a = 0xFF;
-
-  if (col0.u > col1.u) {
-    // Four-color block: derive the other two colors.
-    palette[2].r = (2 * palette[0].r + palette[1].r) / 3;
-    palette[2].g = (2 * palette[0].g + palette[1].g) / 3;
-    palette[2].b = (2 * palette[0].b + palette[1].b) / 3;
-    palette[2].a = 0xFF;
-
-    palette[3].r = (2 * palette[1].r + palette[0].r) / 3;
-    palette[3].g = (2 * palette[1].g + palette[0].g) / 3;
-    palette[3].b = (2 * palette[1].b + palette[0].b) / 3;
-    palette[3].a = 0xFF;
-  } else {
-    // Three-color block: derive the other color.
-    palette[2].r = (palette[0].r + palette[1].r) / 2;
-    palette[2].g = (palette[0].g + palette[1].g) / 2;
-    palette[2].b = (palette[0].b + palette[1].b) / 2;
-    palette[2].a = 0xFF;
-
-    palette[3].r = 0x00;
-    palette[3].g = 0x00;
-    palette[3].b = 0x00;
-    palette[3].a = 0x00;
-  }
-
-  for (int i = 0; i < 16; i++) {
-    colors[i] = palette[(indices >> (2 * i)) & 0x3];
-  }
-}
-
-static int compareColors(const Color32 *b0, const Color32 *b1) {
-  int sum = 0;
-
-  for (int i = 0; i < 16; i++) {
-    int r = (b0[i].r - b1[i].r);
-    int g = (b0[i].g - b1[i].g);
-    int b = (b0[i].b - b1[i].b);
-    sum += r * r + g * g + b * b;
-  }
-
-  return sum;
-}
-
-static int compareBlock(const BlockDXT1 *b0, const BlockDXT1 *b1) {
-  Color32 colors0[16];
-  Color32 colors1[16];
-
-  if (memcmp(b0, b1, sizeof(BlockDXT1)) == 0) {
-    return 0;
-  } else {
-    b0->decompress(colors0);
-    b1->decompress(colors1);
-
-    return compareColors(colors0, colors1);
-  }
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 // Program main
 ////////////////////////////////////////////////////////////////////////////////
@@ -747,26 +646,32 @@ int main(int argc, char **argv) {
   fclose(fp);
 
   printf("\nChecking accuracy...\n");
-  float rms = 0;
-
-  for (uint y = 0; y < h; y += 4) {
-    for (uint x = 0; x < w; x += 4) {
-      uint referenceBlockIdx = ((y / 4) * (W / 4) + (x / 4));
-      uint resultBlockIdx = ((y / 4) * (w / 4) + (x / 4));
-
-      int cmp = compareBlock(((BlockDXT1 *)h_result) + resultBlockIdx,
-                             ((BlockDXT1 *)reference) + referenceBlockIdx);
-
-      if (cmp != 0.0f) {
-        printf("Deviation at (%4d,%4d):\t%f rms\n", x / 4, y / 4,
+  // The result and the reference are decoded and compared in one pass, we
+  // cannot simply do a bitwise compare, because different compilers produce
+  // different results for different targets due to floating point arithmetic.
+  const uint blocksW = w / 4, blocksH = h / 4;
+  uint *blockErrors = (uint *)malloc(blocksW * blocksH * sizeof(uint));
+  sdkBC1Error error;
+  sdkCompareBC1(h_result, reference, w, h, error, blockErrors);
+
+  for (uint by = 0; by < blocksH; by++) {
+    for (uint bx = 0; bx < blocksW; bx++) {
+      uint cmp = blockErrors[by * blocksW + bx];
+
+      if (cmp != 0) {
+        printf("Deviation at (%4d,%4d):\t%f rms\n", bx, by,
                float(cmp) / 16 / 3);
       }
-
-      rms += cmp;
     }
   }
 
-  rms /= w * h * 3;
+  float rms = (float)error.mse;
+
+  // Quality of the compressed image against the source image.
+  sdkBC1Error sourceError;
+  sdkCompareBC1Image(h_result, w, h, data, W * 4, sourceError);
+  printf("PSNR(source, result) = %f dB (max error %u)\n", sourceError.psnr,
+         sourceError.maxError);
 
   // Free allocated resources and exit
   checkCudaErrors(cudaFree(d_permutations));
@@ -777,6 +682,7 @@ int main(int argc, char **argv) {
   free(block_image);
   free(h_result);
   free(reference);
+  free(blockErrors);
   sdkDeleteTimer(&timer);
 
   printf("RMS(reference, result) = %f\n\n", rms);
@@ -102,6 +102,7 @@
 #include <helper_functions.h>
 
 #include "defines.h"
+#include "spanSpaceIndex.h"
 
 #if defined(__APPLE__) || defined(MACOSX)
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
@@ -116,6 +117,13 @@ extern "C" void launch_classifyVoxel(dim3 grid, dim3 threads, uint *voxelVerts,
                                      uint3 gridSizeMask, uint numVoxels,
                                      float3 voxelSize, float isoValue);
 
+extern "C" void launch_classifyBricks(dim3 grid, dim3 threads,
+                                      uint *voxelVerts, uint *voxelOccupied,
+                                      uchar *volume, uint3 gridSize,
+                                      uint3 gridSizeShift, float3 voxelSize,
+                                      float isoValue, uint *brickList,
+                                      uint numBricks, uint3 brickCount);
+
 extern "C" void launch_compactVoxels(dim3 grid, dim3 threads,
                                      uint *compactedVoxelArray,
                                      uint *voxelOccupied,
@@ -175,6 +183,22 @@ uint *d_voxelOccupied = 0;
 uint *d_voxelOccupiedScan = 0;
 uint *d_compVoxelArray;
 
+#if SAMPLE_VOLUME
+// Span space index of the volume bricks. The classification on the device
+// is kept between calls; a new isovalue reclassifies only the bricks with a
+// sample value between the old and the new isovalue, or clears the arrays
+// and classifies only the bricks whose range contains the new isovalue.
+SpanSpaceIndex spanSpace;
+bool useSpanSpace = true;
+float classifiedIsoValue = -1.0f;  // < 0 if nothing is classified
+std::vector<uint> h_changedBricks, h_activeBricks;
+uint *d_brickList = 0;
+unsigned long long bricksClassified = 0, bricksTotal = 0;
+
+// rounding of the normalized volume texture values
+#define ISO_MARGIN 1e-6f
+#endif
+
 // tables
 uint *d_numVertsTable = 0;
 uint *d_edgeTable = 0;
@@ -461,6 +485,18 @@ void initMC(int argc, char **argv) {
   uchar *volume = loadRawFile(path, size);
   checkCudaErrors(cudaMalloc((void **)&d_volume, size));
   checkCudaErrors(cudaMemcpy(d_volume, volume, size, cudaMemcpyHostToDevice));
+
+  useSpanSpace = !checkCmdLineFlag(argc, (const char **)argv, "noindex");
+
+  if (useSpanSpace) {
+    spanSpace.build(volume, gridSize);
+    h_changedBricks.resize(spanSpace.getNumBricks());
+    h_activeBricks.resize(spanSpace.getNumBricks());
+    checkCudaErrors(cudaMalloc((void **)&d_brickList,
+                               spanSpace.getNumBricks() * sizeof(uint)));
+    printf("span space index: %d bricks\n", spanSpace.getNumBricks());
+  }
+
   free(volume);
 
   createVolumeTexture(d_volume, size);
@@ -518,6 +554,17 @@ void cleanup() {
   if (d_volume) {
     checkCudaErrors(cudaFree(d_volume));
   }
+
+#if SAMPLE_VOLUME
+  if (d_brickList) {
+    checkCudaErrors(cudaFree(d_brickList));
+  }
+
+  if (bricksTotal > 0) {
+    printf("span space index: %.1f%% of the bricks classified\n",
+           100.0 * bricksClassified / bricksTotal);
+  }
+#endif
 }
 
 void initMenus() {
@@ -573,6 +620,80 @@ void runGraphicsTest(int argc, char **argv) {
 
 #define DEBUG_BUFFERS 0
 
+enum { CLASSIFY_ALL, CLASSIFY_BRICKS, CLASSIFY_CACHED };
+
+#if SAMPLE_VOLUME
+////////////////////////////////////////////////////////////////////////////////
+//! Classify the voxels for isoValue with the span space index. Returns
+//! CLASSIFY_ALL if every voxel must be classified, CLASSIFY_BRICKS if the
+//! classification is up to date, and CLASSIFY_CACHED if it was already up to
+//! date, so the scans can be skipped too.
+////////////////////////////////////////////////////////////////////////////////
+int classifyWithIndex() {
+  if (!useSpanSpace) {
+    return CLASSIFY_ALL;
+  }
+
+  const uint numBricks = spanSpace.getNumBricks();
+  uint numChanged = numBricks + 1;
+
+  // bricks with a sample value whose comparison differs between the two
+  // isovalues
+  if (classifiedIsoValue >= 0.0f) {
+    uint lo = SpanSpaceIndex::threshold(
+        std::min(classifiedIsoValue, isoValue) - ISO_MARGIN);
+    uint hi = SpanSpaceIndex::threshold(
+        std::max(classifiedIsoValue, isoValue) + ISO_MARGIN);
+    numChanged = spanSpace.query(lo, hi, &h_changedBricks[0]);
+  }
+
+  // bricks that can contain the isosurface, all others have no vertices
+  uint numActive = spanSpace.query(
+      SpanSpaceIndex::threshold(isoValue - ISO_MARGIN),
+      SpanSpaceIndex::threshold(isoValue + ISO_MARGIN), &h_activeBricks[0]);
+
+  classifiedIsoValue = isoValue;
+  bricksTotal += numBricks;
+
+  if (numChanged == 0) {
+    return CLASSIFY_CACHED;
+  }
+
+  uint *bricks = &h_changedBricks[0];
+  uint numBrickList = numChanged;
+
+  if (numActive < numChanged) {
+    checkCudaErrors(cudaMemset(d_voxelVerts, 0, numVoxels * sizeof(uint)));
+    checkCudaErrors(cudaMemset(d_voxelOccupied, 0, numVoxels * sizeof(uint)));
+    bricks = &h_activeBricks[0];
+    numBrickList = numActive;
+  }
+
+  bricksClassified += numBrickList;
+
+  if (numBrickList > 0) {
+    uint3 brickSize = spanSpace.getBrickSize();
+    dim3 grid(numBrickList, 1, 1);
+
+    // get around maximum grid size of 65535 in each dimension
+    while (grid.x > 65535) {
+      grid.x = (grid.x + 1) / 2;
+      grid.y *= 2;
+    }
+
+    checkCudaErrors(cudaMemcpy(d_brickList, bricks,
+                               numBrickList * sizeof(uint),
+                               cudaMemcpyHostToDevice));
+    launch_classifyBricks(grid, dim3(brickSize.x, brickSize.y, brickSize.z),
+                          d_voxelVerts, d_voxelOccupied, d_volume, gridSize,
+                          gridSizeShift, voxelSize, isoValue, d_brickList,
+                          numBrickList, spanSpace.getBrickCount());
+  }
+
+  return CLASSIFY_BRICKS;
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 //! Run the Cuda part of the computation
 ////////////////////////////////////////////////////////////////////////////////
@@ -586,69 +707,87 @@ void computeIsosurface() {
     grid.x = 32768;
   }
 
-  // calculate number of vertices need per voxel
-  launch_classifyVoxel(grid, threads, d_voxelVerts, d_voxelOccupied, d_volume,
-                       gridSize, gridSizeShift, gridSizeMask, numVoxels,
-                       voxelSize, isoValue);
+  int classification = CLASSIFY_ALL;
+
+#if SAMPLE_VOLUME
+  classification = classifyWithIndex();
+#endif
+
+  if (classification == CLASSIFY_ALL) {
+    // calculate number of vertices need per voxel
+    launch_classifyVoxel(grid, threads, d_voxelVerts, d_voxelOccupied,
+                         d_volume, gridSize, gridSizeShift, gridSizeMask,
+                         numVoxels, voxelSize, isoValue);
+  }
+
 #if DEBUG_BUFFERS
   printf("voxelVerts:\n");
   dumpBuffer(d_voxelVerts, numVoxels, sizeof(uint));
 #endif
 
+  // the scans, active voxels and vertex count of the last call still hold
+  if (classification == CLASSIFY_CACHED) {
 #if SKIP_EMPTY_VOXELS
-  // scan voxel occupied array
-  ThrustScanWrapper(d_voxelOccupiedScan, d_voxelOccupied, numVoxels);
+    if (activeVoxels == 0) {
+      return;
+    }
+#endif
+  } else {
+#if SKIP_EMPTY_VOXELS
+    // scan voxel occupied array
+    ThrustScanWrapper(d_voxelOccupiedScan, d_voxelOccupied, numVoxels);
 
 #if DEBUG_BUFFERS
-  printf("voxelOccupiedScan:\n");
-  dumpBuffer(d_voxelOccupiedScan, numVoxels, sizeof(uint));
+    printf("voxelOccupiedScan:\n");
+    dumpBuffer(d_voxelOccupiedScan, numVoxels, sizeof(uint));
 #endif
 
-  // read back values to calculate total number of non-empty voxels
-  // since we are using an exclusive scan, the total is the last value of
-  // the scan result plus the last value in the input array
-  {
-    uint lastElement, lastScanElement;
-    checkCudaErrors(cudaMemcpy((void *)&lastElement,
-                               (void *)(d_voxelOccupied + numVoxels - 1),
-                               sizeof(uint), cudaMemcpyDeviceToHost));
-    checkCudaErrors(cudaMemcpy((void *)&lastScanElement,
-                               (void *)(d_voxelOccupiedScan + numVoxels - 1),
-                               sizeof(uint), cudaMemcpyDeviceToHost));
-    activeVoxels = lastElement + lastScanElement;
-  }
-
-  if (activeVoxels == 0) {
-    // return if there are no full voxels
-    totalVerts = 0;
-    return;
-  }
+    // read back values to calculate total number of non-empty voxels
+    // since we are using an exclusive scan, the total is the last value of
+    // the scan result plus the last value in the input array
+    {
+      uint lastElement, lastScanElement;
+      checkCudaErrors(cudaMemcpy((void *)&lastElement,
+                                 (void *)(d_voxelOccupied + numVoxels - 1),
+                                 sizeof(uint), cudaMemcpyDeviceToHost));
+      checkCudaErrors(cudaMemcpy((void *)&lastScanElement,
+                                 (void *)(d_voxelOccupiedScan + numVoxels - 1),
+                                 sizeof(uint), cudaMemcpyDeviceToHost));
+      activeVoxels = lastElement + lastScanElement;
+    }
 
-  // compact voxel index array
-  launch_compactVoxels(grid, threads, d_compVoxelArray, d_voxelOccupied,
-                       d_voxelOccupiedScan, numVoxels);
-  getLastCudaError("compactVoxels failed");
+    if (activeVoxels == 0) {
+      // return if there are no full voxels
+      totalVerts = 0;
+      return;
+    }
+
+    // compact voxel index array
+    launch_compactVoxels(grid, threads, d_compVoxelArray, d_voxelOccupied,
+                         d_voxelOccupiedScan, numVoxels);
+    getLastCudaError("compactVoxels failed");
 
 #endif  // SKIP_EMPTY_VOXELS
 
-  // scan voxel vertex count array
-  ThrustScanWrapper(d_voxelVertsScan, d_voxelVerts, numVoxels);
+    // scan voxel vertex count array
+    ThrustScanWrapper(d_voxelVertsScan, d_voxelVerts, numVoxels);
 
 #if DEBUG_BUFFERS
-  printf("voxelVertsScan:\n");
-  dumpBuffer(d_voxelVertsScan, numVoxels, sizeof(uint));
+    printf("voxelVertsScan:\n");
+    dumpBuffer(d_voxelVertsScan, numVoxels, sizeof(uint));
 #endif
 
-  // readback total number of vertices
-  {
-    uint lastElement, lastScanElement;
-    checkCudaErrors(cudaMemcpy((void *)&lastElement,
-                               (void *)(d_voxelVerts + numVoxels - 1),
-                               sizeof(uint), cudaMemcpyDeviceToHost));
-    checkCudaErrors(cudaMemcpy((void *)&lastScanElement,
-                               (void *)(d_voxelVertsScan + numVoxels - 1),
-                               sizeof(uint), cudaMemcpyDeviceToHost));
-    totalVerts = lastElement + lastScanElement;
+    // readback total number of vertices
+    {
+      uint lastElement, lastScanElement;
+      checkCudaErrors(cudaMemcpy((void *)&lastElement,
+                                 (void *)(d_voxelVerts + numVoxels - 1),
+                                 sizeof(uint), cudaMemcpyDeviceToHost));
+      checkCudaErrors(cudaMemcpy((void *)&lastScanElement,
+                                 (void *)(d_voxelVertsScan + numVoxels - 1),
+                                 sizeof(uint), cudaMemcpyDeviceToHost));
+      totalVerts = lastElement + lastScanElement;
+    }
   }
 
   // generate triangles, writing to vertex buffers
@@ -170,19 +170,11 @@ __device__ uint3 calcGridPos(uint i, uint3 gridSizeShift, uint3 gridSizeMask) {
   return gridPos;
 }
 
-// classify voxel based on number of vertices it will generate
-// one thread per voxel
-__global__ void classifyVoxel(uint *voxelVerts, uint *voxelOccupied,
-                              uchar *volume, uint3 gridSize,
-                              uint3 gridSizeShift, uint3 gridSizeMask,
-                              uint numVoxels, float3 voxelSize, float isoValue,
-                              cudaTextureObject_t numVertsTex,
-                              cudaTextureObject_t volumeTex) {
-  uint blockId = __mul24(blockIdx.y, gridDim.x) + blockIdx.x;
-  uint i = __mul24(blockId, blockDim.x) + threadIdx.x;
-
-  uint3 gridPos = calcGridPos(i, gridSizeShift, gridSizeMask);
-
+// number of vertices the voxel at gridPos will generate
+__device__ uint classifyCell(uint3 gridPos, uchar *volume, uint3 gridSize,
+                             float3 voxelSize, float isoValue,
+                             cudaTextureObject_t numVertsTex,
+                             cudaTextureObject_t volumeTex) {
 // read field values at neighbouring grid vertices
 #if SAMPLE_VOLUME
   float field[8];
@@ -230,7 +222,24 @@ __global__ void classifyVoxel(uint *voxelVerts, uint *voxelOccupied,
   cubeindex += uint(field[7] < isoValue) * 128;
 
   // read number of vertices from texture
-  uint numVerts = tex1Dfetch<uint>(numVertsTex, cubeindex);
+  return tex1Dfetch<uint>(numVertsTex, cubeindex);
+}
+
+// classify voxel based on number of vertices it will generate
+// one thread per voxel
+__global__ void classifyVoxel(uint *voxelVerts, uint *voxelOccupied,
+                              uchar *volume, uint3 gridSize,
+                              uint3 gridSizeShift, uint3 gridSizeMask,
+                              uint numVoxels, float3 voxelSize, float isoValue,
+                              cudaTextureObject_t numVertsTex,
+                              cudaTextureObject_t volumeTex) {
+  uint blockId = __mul24(blockIdx.y, gridDim.x) + blockIdx.x;
+  uint i = __mul24(blockId, blockDim.x) + threadIdx.x;
+
+  uint3 gridPos = calcGridPos(i, gridSizeShift, gridSizeMask);
+
+  uint numVerts = classifyCell(gridPos, volume, gridSize, voxelSize, isoValue,
+                               numVertsTex, volumeTex);
 
   if (i < numVoxels) {
     voxelVerts[i] = numVerts;
@@ -238,6 +247,41 @@ __global__ void classifyVoxel(uint *voxelVerts, uint *voxelOccupied,
   }
 }
 
+// classify the voxels of a list of bricks, one block per brick and one
+// thread per voxel of the brick
+__global__ void classifyBricks(uint *voxelVerts, uint *voxelOccupied,
+                               uchar *volume, uint3 gridSize,
+                               uint3 gridSizeShift, float3 voxelSize,
+                               float isoValue, uint *brickList, uint numBricks,
+                               uint3 brickCount,
+                               cudaTextureObject_t numVertsTex,
+                               cudaTextureObject_t volumeTex) {
+  uint blockId = __mul24(blockIdx.y, gridDim.x) + blockIdx.x;
+
+  if (blockId >= numBricks) return;
+
+  uint brick = brickList[blockId];
+  uint3 gridPos;
+  gridPos.x = (brick % brickCount.x) * blockDim.x + threadIdx.x;
+  gridPos.y =
+      ((brick / brickCount.x) % brickCount.y) * blockDim.y + threadIdx.y;
+  gridPos.z =
+      (brick / (brickCount.x * brickCount.y)) * blockDim.z + threadIdx.z;
+
+  if (gridPos.x >= gridSize.x || gridPos.y >= gridSize.y ||
+      gridPos.z >= gridSize.z) {
+    return;
+  }
+
+  uint i = (gridPos.z << gridSizeShift.z) | (gridPos.y << gridSizeShift.y) |
+           gridPos.x;
+  uint numVerts = classifyCell(gridPos, volume, gridSize, voxelSize, isoValue,
+                               numVertsTex, volumeTex);
+
+  voxelVerts[i] = numVerts;
+  voxelOccupied[i] = (numVerts > 0);
+}
+
 extern "C" void launch_classifyVoxel(dim3 grid, dim3 threads, uint *voxelVerts,
                                      uint *voxelOccupied, uchar *volume,
                                      uint3 gridSize, uint3 gridSizeShift,
@@ -250,6 +294,20 @@ extern "C" void launch_classifyVoxel(dim3 grid, dim3 threads, uint *voxelVerts,
   getLastCudaError("classifyVoxel failed");
 }
 
+extern "C" void launch_classifyBricks(dim3 grid, dim3 threads,
+                                      uint *voxelVerts, uint *voxelOccupied,
+                                      uchar *volume, uint3 gridSize,
+                                      uint3 gridSizeShift, float3 voxelSize,
+                                      float isoValue, uint *brickList,
+                                      uint numBricks, uint3 brickCount) {
+  // calculate number of vertices need per voxel
+  classifyBricks<<<grid, threads>>>(voxelVerts, voxelOccupied, volume,
+                                    gridSize, gridSizeShift, voxelSize,
+                                    isoValue, brickList, numBricks, brickCount,
+                                    numVertsTex, volumeTex);
+  getLastCudaError("classifyBricks failed");
+}
+
 // compact voxel array
 __global__ void compactVoxels(uint *compactedVoxelArray, uint *voxelOccupied,
                               uint *voxelOccupiedScan, uint numVoxels) {
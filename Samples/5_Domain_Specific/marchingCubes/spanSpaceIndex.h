@@ -0,0 +1,160 @@
+/* Copyright (c) 2022, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Span space index of the bricks of a byte volume.
+ *
+ * The volume is split into bricks of 8x8x8 voxels. Every brick keeps the
+ * smallest and largest sample value of its voxels, including the corners
+ * they share with the next brick. A voxel can only contain the isosurface if
+ * its brick's range contains the isovalue, and its classification can only
+ * change between two isovalues if its brick's range contains a sample value
+ * between them.
+ *
+ * The bricks are bucketed by their smallest value and sorted by their
+ * largest value within a bucket, so the bricks whose range intersects a
+ * value interval are found in O(256 + output) without visiting the others.
+ */
+
+#ifndef _SPAN_SPACE_INDEX_H_
+#define _SPAN_SPACE_INDEX_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "defines.h"
+
+#define BRICK_SIZE_LOG2 3
+
+class SpanSpaceIndex {
+ public:
+  SpanSpaceIndex() : m_numBricks(0) {}
+
+  // gridSize must be a power of two in every dimension, as in the sample
+  void build(const uchar *volume, uint3 gridSize) {
+    m_brickSize = make_uint3(std::min(gridSize.x, 1u << BRICK_SIZE_LOG2),
+                             std::min(gridSize.y, 1u << BRICK_SIZE_LOG2),
+                             std::min(gridSize.z, 1u << BRICK_SIZE_LOG2));
+    m_brickCount =
+        make_uint3(gridSize.x / m_brickSize.x, gridSize.y / m_brickSize.y,
+                   gridSize.z / m_brickSize.z);
+    m_numBricks = m_brickCount.x * m_brickCount.y * m_brickCount.z;
+
+    std::vector<uchar> minValue(m_numBricks, 255), maxValue(m_numBricks, 0);
+
+    // every sample updates the bricks of the voxels that use it as a
+    // corner, the sample at the low face of a brick also belongs to the
+    // brick below it
+    for (uint z = 0; z < gridSize.z; z++) {
+      for (uint y = 0; y < gridSize.y; y++) {
+        const uchar *row = volume + ((size_t)z * gridSize.y + y) * gridSize.x;
+
+        for (uint x = 0; x < gridSize.x; x++) {
+          uchar v = row[x];
+          uint bx = x / m_brickSize.x, by = y / m_brickSize.y;
+          uint bz = z / m_brickSize.z;
+          uint bx0 = (bx > 0 && x % m_brickSize.x == 0) ? bx - 1 : bx;
+          uint by0 = (by > 0 && y % m_brickSize.y == 0) ? by - 1 : by;
+          uint bz0 = (bz > 0 && z % m_brickSize.z == 0) ? bz - 1 : bz;
+
+          for (uint k = bz0; k <= bz; k++) {
+            for (uint j = by0; j <= by; j++) {
+              for (uint i = bx0; i <= bx; i++) {
+                uint b = (k * m_brickCount.y + j) * m_brickCount.x + i;
+                minValue[b] = std::min(minValue[b], v);
+                maxValue[b] = std::max(maxValue[b], v);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // bucket by the smallest value, largest value descending in a bucket
+    m_bucketStart.assign(257, 0);
+
+    for (uint b = 0; b < m_numBricks; b++) m_bucketStart[minValue[b] + 1]++;
+
+    for (int m = 0; m < 256; m++) m_bucketStart[m + 1] += m_bucketStart[m];
+
+    std::vector<uint> next(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    m_sorted.resize(m_numBricks);
+
+    for (uint b = 0; b < m_numBricks; b++) m_sorted[next[minValue[b]]++] = b;
+
+    for (int m = 0; m < 256; m++) {
+      std::sort(m_sorted.begin() + m_bucketStart[m],
+                m_sorted.begin() + m_bucketStart[m + 1],
+                [&](uint a, uint b) { return maxValue[a] > maxValue[b]; });
+    }
+
+    m_sortedMax.resize(m_numBricks);
+
+    for (uint k = 0; k < m_numBricks; k++) {
+      m_sortedMax[k] = maxValue[m_sorted[k]];
+    }
+  }
+
+  // Bricks with a sample value in [lo, hi), that is min < hi and max >= lo,
+  // written to bricks[]; returns their number
+  uint query(uint lo, uint hi, uint *bricks) const {
+    uint n = 0;
+
+    for (uint m = 0; m < std::min(hi, 256u); m++) {
+      for (uint k = m_bucketStart[m];
+           k < m_bucketStart[m + 1] && m_sortedMax[k] >= lo; k++) {
+        bricks[n++] = m_sorted[k];
+      }
+    }
+
+    return n;
+  }
+
+  // Number of byte values v with v / 255 below isoValue, the volume
+  // texture returns normalized values
+  static uint threshold(float isoValue) {
+    uint t = 0;
+
+    while (t < 256 && (float)t / 255.0f < isoValue) t++;
+
+    return t;
+  }
+
+  uint getNumBricks() const { return m_numBricks; }
+  uint3 getBrickSize() const { return m_brickSize; }
+  uint3 getBrickCount() const { return m_brickCount; }
+
+ private:
+  uint3 m_brickSize;
+  uint3 m_brickCount;
+  uint m_numBricks;
+  std::vector<uint> m_bucketStart;
+  std::vector<uint> m_sorted;
+  std::vector<uchar> m_sortedMax;
+};
+
+#endif  // _SPAN_SPACE_INDEX_H_
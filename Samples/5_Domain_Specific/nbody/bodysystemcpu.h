@@ -30,6 +30,20 @@
 
 #include "bodysystem.h"
 
+#include <vector>
+
+// Statistics of the Hermite integrator, accumulated since it was enabled
+struct BodySystemHermiteStats {
+  long long blockSteps;         // block steps, each with its own active set
+  long long forceEvaluations;   // bodies whose force and jerk were computed
+  long long sharedEvaluations;  // the same with one step for all bodies,
+                                // the smallest step of each update
+  int minActive;                // smallest and largest active set
+  int maxActive;
+  double initialEnergy;  // total energy when the integrator started
+  double energy;         // total energy after the last update
+};
+
 // CPU Body System
 template <typename T>
 class BodySystemCPU : public BodySystem<T> {
@@ -53,6 +67,18 @@ class BodySystemCPU : public BodySystem<T> {
 
   virtual unsigned int getNumBodies() const { return m_numBodies; }
 
+  // 4th order Hermite predictor-corrector with power-of-two block time
+  // steps instead of the damped Euler step. eta is the accuracy parameter of
+  // the Aarseth time step criterion, the smallest step is deltaTime /
+  // 2^maxLevel. Damping does not apply.
+  void setHermite(bool enable, T eta = (T)0.02, int maxLevel = 20);
+  const BodySystemHermiteStats &getHermiteStats() const {
+    return m_hermiteStats;
+  }
+
+  // kinetic plus potential energy, with the softening of the forces
+  double computeEnergy() const;
+
  protected:           // methods
   BodySystemCPU() {}  // default constructor
 
@@ -62,6 +88,10 @@ class BodySystemCPU : public BodySystem<T> {
   void _computeNBodyGravitation();
   void _integrateNBodySystem(T deltaTime);
 
+  void _initializeHermite(T deltaTime);
+  void _computeHermiteForces(const int *active, int numActive);
+  void _integrateHermite(T deltaTime);
+
  protected:  // data
   int m_numBodies;
   bool m_bInitialized;
@@ -72,6 +102,19 @@ class BodySystemCPU : public BodySystem<T> {
 
   T m_softeningSquared;
   T m_damping;
+
+  // Hermite integrator: double precision state, with the time of every body
+  // in ticks of deltaTime / 2^maxLevel since the start of the update
+  bool m_hermite;
+  bool m_hermiteValid;
+  double m_hermiteEta;
+  int m_hermiteMaxLevel;
+  T m_hermiteDeltaTime;
+  std::vector<double> m_hPos, m_hVel, m_hAcc, m_hJerk, m_hMass;
+  std::vector<double> m_hPredPos, m_hPredVel, m_hNewAcc, m_hNewJerk;
+  std::vector<long long> m_hTime, m_hStep;
+  std::vector<int> m_hActive;
+  BodySystemHermiteStats m_hermiteStats;
 };
 
 #include "bodysystemcpu_impl.h"
@@ -46,7 +46,12 @@ BodySystemCPU<T>::BodySystemCPU(int numBodies)
       m_bInitialized(false),
       m_force(0),
       m_softeningSquared(.00125f),
-      m_damping(0.995f) {
+      m_damping(0.995f),
+      m_hermite(false),
+      m_hermiteValid(false),
+      m_hermiteEta(0.02),
+      m_hermiteMaxLevel(20),
+      m_hermiteDeltaTime(0) {
   m_pos = 0;
   m_vel = 0;
 
@@ -105,13 +110,19 @@ void BodySystemCPU<T>::loadTipsyFile(const std::string &filename) {
 
   memcpy(m_pos, &positions[0], sizeof(vec4<T>) * nBodies);
   memcpy(m_vel, &velocities[0], sizeof(vec4<T>) * nBodies);
+
+  m_hermiteValid = false;
 }
 
 template <typename T>
 void BodySystemCPU<T>::update(T deltaTime) {
   assert(m_bInitialized);
 
-  _integrateNBodySystem(deltaTime);
+  if (m_hermite) {
+    _integrateHermite(deltaTime);
+  } else {
+    _integrateNBodySystem(deltaTime);
+  }
 
   // std::swap(m_currentRead, m_currentWrite);
 }
@@ -154,6 +165,8 @@ void BodySystemCPU<T>::setArray(BodyArray array, const T *data) {
   }
 
   memcpy(target, data, m_numBodies * 4 * sizeof(T));
+
+  m_hermiteValid = false;
 }
 
 template <typename T>
@@ -278,3 +291,251 @@ void BodySystemCPU<T>::_integrateNBodySystem(T deltaTime) {
     m_vel[index + 2] = vel[2];
   }
 }
+
+template <typename T>
+void BodySystemCPU<T>::setHermite(bool enable, T eta, int maxLevel) {
+  m_hermite = enable;
+  m_hermiteValid = false;
+  m_hermiteEta = eta;
+  m_hermiteMaxLevel = std::min(std::max(maxLevel, 0), 40);
+}
+
+template <typename T>
+double BodySystemCPU<T>::computeEnergy() const {
+  double kinetic = 0, potential = 0;
+
+#ifdef OPENMP
+#pragma omp parallel for reduction(+ : kinetic, potential)
+#endif
+
+  for (int i = 0; i < m_numBodies; i++) {
+    const T *pi = &m_pos[4 * i], *vi = &m_vel[4 * i];
+    double v2 = (double)vi[0] * vi[0] + (double)vi[1] * vi[1] +
+                (double)vi[2] * vi[2];
+    kinetic += 0.5 * pi[3] * v2;
+
+    for (int j = i + 1; j < m_numBodies; j++) {
+      const T *pj = &m_pos[4 * j];
+      double r[3] = {(double)pj[0] - pi[0], (double)pj[1] - pi[1],
+                     (double)pj[2] - pi[2]};
+      double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + m_softeningSquared;
+      potential -= (double)pi[3] * pj[3] / sqrt(r2);
+    }
+  }
+
+  return kinetic + potential;
+}
+
+// Acceleration and jerk of body i from the predicted state of all bodies
+template <typename T>
+void BodySystemCPU<T>::_computeHermiteForces(const int *active,
+                                             int numActive) {
+  const double *pos = &m_hPredPos[0], *vel = &m_hPredVel[0];
+  const double *mass = &m_hMass[0];
+  const double eps2 = m_softeningSquared;
+
+#ifdef OPENMP
+#pragma omp parallel for
+#endif
+
+  for (int k = 0; k < numActive; k++) {
+    int i = active[k];
+    double acc[3] = {0, 0, 0}, jerk[3] = {0, 0, 0};
+
+    for (int j = 0; j < m_numBodies; j++) {
+      if (j == i) continue;
+
+      double r[3] = {pos[3 * j] - pos[3 * i], pos[3 * j + 1] - pos[3 * i + 1],
+                     pos[3 * j + 2] - pos[3 * i + 2]};
+      double v[3] = {vel[3 * j] - vel[3 * i], vel[3 * j + 1] - vel[3 * i + 1],
+                     vel[3 * j + 2] - vel[3 * i + 2]};
+      double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + eps2;
+      double rinv2 = 1.0 / r2;
+      double mrinv3 = mass[j] * rinv2 * sqrt(rinv2);
+      double rv = 3.0 * (r[0] * v[0] + r[1] * v[1] + r[2] * v[2]) * rinv2;
+
+      for (int c = 0; c < 3; c++) {
+        acc[c] += mrinv3 * r[c];
+        jerk[c] += mrinv3 * (v[c] - rv * r[c]);
+      }
+    }
+
+    for (int c = 0; c < 3; c++) {
+      m_hNewAcc[3 * i + c] = acc[c];
+      m_hNewJerk[3 * i + c] = jerk[c];
+    }
+  }
+}
+
+template <typename T>
+void BodySystemCPU<T>::_initializeHermite(T deltaTime) {
+  const int n = m_numBodies;
+  const long long ticks = 1LL << m_hermiteMaxLevel;
+
+  m_hPos.assign(3 * n, 0);
+  m_hVel.assign(3 * n, 0);
+  m_hAcc.assign(3 * n, 0);
+  m_hJerk.assign(3 * n, 0);
+  m_hNewAcc.assign(3 * n, 0);
+  m_hNewJerk.assign(3 * n, 0);
+  m_hMass.assign(n, 0);
+  m_hTime.assign(n, 0);
+  m_hStep.assign(n, ticks);
+  m_hActive.resize(n);
+
+  for (int i = 0; i < n; i++) {
+    for (int c = 0; c < 3; c++) {
+      m_hPos[3 * i + c] = m_pos[4 * i + c];
+      m_hVel[3 * i + c] = m_vel[4 * i + c];
+    }
+
+    m_hMass[i] = m_pos[4 * i + 3];
+    m_hActive[i] = i;
+  }
+
+  m_hPredPos = m_hPos;
+  m_hPredVel = m_hVel;
+  _computeHermiteForces(&m_hActive[0], n);
+  m_hAcc = m_hNewAcc;
+  m_hJerk = m_hNewJerk;
+
+  // Initial steps |a| / |j| * 0.01, the largest power of two fraction of
+  // deltaTime below it
+  for (int i = 0; i < n; i++) {
+    const double *a = &m_hAcc[3 * i], *j = &m_hJerk[3 * i];
+    double a2 = a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+    double j2 = j[0] * j[0] + j[1] * j[1] + j[2] * j[2];
+    double dt = (j2 > 0) ? 0.01 * sqrt(a2 / j2) : (double)deltaTime;
+
+    while (m_hStep[i] > 1 && m_hStep[i] * (double)deltaTime / ticks > dt) {
+      m_hStep[i] /= 2;
+    }
+  }
+
+  memset(&m_hermiteStats, 0, sizeof(m_hermiteStats));
+  m_hermiteStats.minActive = n;
+  m_hermiteStats.initialEnergy = computeEnergy();
+  m_hermiteStats.energy = m_hermiteStats.initialEnergy;
+  m_hermiteStats.forceEvaluations = n;
+
+  m_hermiteDeltaTime = deltaTime;
+  m_hermiteValid = true;
+}
+
+template <typename T>
+void BodySystemCPU<T>::_integrateHermite(T deltaTime) {
+  if (!m_hermiteValid || deltaTime != m_hermiteDeltaTime) {
+    _initializeHermite(deltaTime);
+  }
+
+  const int n = m_numBodies;
+  const long long ticks = 1LL << m_hermiteMaxLevel;
+  const double tick = (double)deltaTime / ticks;
+  long long minStep = ticks;
+
+  // every update starts with all bodies synchronized at tick 0
+  for (int i = 0; i < n; i++) m_hTime[i] = 0;
+
+  for (;;) {
+    // the next block time and the bodies due at it
+    long long now = ticks;
+
+    for (int i = 0; i < n; i++) now = std::min(now, m_hTime[i] + m_hStep[i]);
+
+    int numActive = 0;
+
+    for (int i = 0; i < n; i++) {
+      if (m_hTime[i] + m_hStep[i] == now) m_hActive[numActive++] = i;
+    }
+
+    // predict all bodies to the block time
+#ifdef OPENMP
+#pragma omp parallel for
+#endif
+
+    for (int i = 0; i < n; i++) {
+      double dt = (now - m_hTime[i]) * tick;
+
+      for (int c = 0; c < 3; c++) {
+        int k = 3 * i + c;
+        m_hPredPos[k] =
+            m_hPos[k] +
+            dt * (m_hVel[k] + dt * (0.5 * m_hAcc[k] + dt * m_hJerk[k] / 6.0));
+        m_hPredVel[k] = m_hVel[k] + dt * (m_hAcc[k] + 0.5 * dt * m_hJerk[k]);
+      }
+    }
+
+    _computeHermiteForces(&m_hActive[0], numActive);
+
+    // correct the active bodies and choose their next steps
+    for (int k = 0; k < numActive; k++) {
+      int i = m_hActive[k];
+      double dt = m_hStep[i] * tick;
+      double a1a = 0, j1a = 0, a2a = 0, a3a = 0;
+
+      for (int c = 0; c < 3; c++) {
+        int q = 3 * i + c;
+        double a0 = m_hAcc[q], j0 = m_hJerk[q];
+        double a1 = m_hNewAcc[q], j1 = m_hNewJerk[q];
+        double a2 = (-6.0 * (a0 - a1) - dt * (4.0 * j0 + 2.0 * j1)) / (dt * dt);
+        double a3 = (12.0 * (a0 - a1) + 6.0 * dt * (j0 + j1)) / (dt * dt * dt);
+        double dt3 = dt * dt * dt;
+
+        m_hPos[q] = m_hPredPos[q] + dt3 * dt * (a2 / 24.0 + dt * a3 / 120.0);
+        m_hVel[q] = m_hPredVel[q] + dt3 * (a2 / 6.0 + dt * a3 / 24.0);
+        m_hAcc[q] = a1;
+        m_hJerk[q] = j1;
+
+        // derivatives at the end of the step
+        a2 += dt * a3;
+        a1a += a1 * a1;
+        j1a += j1 * j1;
+        a2a += a2 * a2;
+        a3a += a3 * a3;
+      }
+
+      a1a = sqrt(a1a);
+      j1a = sqrt(j1a);
+      a2a = sqrt(a2a);
+      a3a = sqrt(a3a);
+
+      double denominator = j1a * a3a + a2a * a2a;
+      double dtNew = (denominator > 0)
+                         ? sqrt(m_hermiteEta * (a1a * a2a + j1a * j1a) /
+                                denominator)
+                         : (double)deltaTime;
+
+      // halve as needed, double only at times the doubled step divides
+      long long step = m_hStep[i];
+
+      while (step > 1 && step * tick > dtNew) step /= 2;
+
+      if (step == m_hStep[i] && step < ticks && 2 * step * tick <= dtNew &&
+          now % (2 * step) == 0) {
+        step *= 2;
+      }
+
+      m_hTime[i] = now;
+      m_hStep[i] = step;
+      minStep = std::min(minStep, step);
+    }
+
+    m_hermiteStats.blockSteps++;
+    m_hermiteStats.forceEvaluations += numActive;
+    m_hermiteStats.minActive = std::min(m_hermiteStats.minActive, numActive);
+    m_hermiteStats.maxActive = std::max(m_hermiteStats.maxActive, numActive);
+
+    if (now == ticks) break;
+  }
+
+  m_hermiteStats.sharedEvaluations += (long long)n * (ticks / minStep);
+
+  for (int i = 0; i < n; i++) {
+    for (int c = 0; c < 3; c++) {
+      m_pos[4 * i + c] = (T)m_hPos[3 * i + c];
+      m_vel[4 * i + c] = (T)m_hVel[3 * i + c];
+    }
+  }
+
+  m_hermiteStats.energy = computeEnergy();
+}
@@ -74,6 +74,7 @@ bool useHostMem = false;
 bool useP2P = true;  // this is always optimal to use P2P path when available
 bool fp64 = false;
 bool useCpu = false;
+bool useHermite = false;
 int numDevsRequested = 1;
 bool displayEnabled = true;
 bool bPause = false;
@@ -294,6 +295,7 @@ class NBodyDemo {
              bool useHostMem, bool useP2P, bool useCpu, int devID) {
     if (useCpu) {
       m_nbodyCpu = new BodySystemCPU<T>(numBodies);
+      m_nbodyCpu->setHermite(useHermite);
       m_nbody = m_nbodyCpu;
       m_nbodyCuda = 0;
     } else {
@@ -437,6 +439,19 @@ class NBodyDemo {
     printf("= %.3f billion interactions per second\n", interactionsPerSecond);
     printf("= %.3f %s-precision GFLOP/s at %d flops per interaction\n", gflops,
            (sizeof(T) > 4) ? "double" : "single", flopsPerInteraction);
+
+    if (useCpu && useHermite) {
+      const BodySystemHermiteStats &stats = m_nbodyCpu->getHermiteStats();
+
+      printf("Hermite block steps: %lld, active bodies %d .. %d (mean %.1f)\n",
+             stats.blockSteps, stats.minActive, stats.maxActive,
+             (double)stats.forceEvaluations /
+                 (stats.blockSteps ? stats.blockSteps : 1));
+      printf("= %lld force evaluations, %lld with a shared time step\n",
+             stats.forceEvaluations, stats.sharedEvaluations);
+      printf("= relative energy error %E\n",
+             (stats.energy - stats.initialEnergy) / fabs(stats.initialEnergy));
+    }
   }
 };
 
@@ -923,6 +938,9 @@ void showHelp() {
       "\t-compare          (compares simulation results running once on the "
       "default GPU and once on the CPU)\n");
   printf("\t-cpu              (run n-body simulation on the CPU)\n");
+  printf(
+      "\t-hermite          (with -cpu, 4th order Hermite integrator with "
+      "block time steps)\n");
   printf("\t-tipsy=<file.bin> (load a tipsy model file for simulation)\n\n");
 }
 
@@ -971,6 +989,7 @@ int main(int argc, char **argv) {
   flopsPerInteraction = fp64 ? 30 : 20;
 
   useCpu = (checkCmdLineFlag(argc, (const char **)argv, "cpu") != 0);
+  useHermite = (checkCmdLineFlag(argc, (const char **)argv, "hermite") != 0);
 
   if (checkCmdLineFlag(argc, (const char **)argv, "numdevices")) {
     numDevsRequested =
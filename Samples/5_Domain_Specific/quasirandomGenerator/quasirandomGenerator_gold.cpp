@@ -28,6 +28,8 @@
 #include <stdio.h>
 #include <math.h>
 
+#include <helper_vecmath.h>
+
 #include "quasirandomGenerator_common.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -323,3 +325,34 @@ extern "C" double MoroInvCNDcpu(unsigned int x) {
   // to get the positive side of the bell curve
   return negate ? -z : z;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// MoroInvCNDcpu() of n inputs, computed in chunks with the vector math
+// helpers. As above, the inputs are reflected to the lower half of the
+// domain before the conversion to floating point.
+////////////////////////////////////////////////////////////////////////////////
+extern "C" void MoroInvCNDcpuArray(double *output, const unsigned int *input,
+                                   int n) {
+  const int chunk = 256;
+  const double x1 = 1.0 / static_cast<double>(0xffffffffUL);
+  const double x2 = x1 / 2.0;
+  double p[chunk];
+
+  for (int base = 0; base < n; base += chunk) {
+    int count = (n - base < chunk) ? n - base : chunk;
+
+    for (int i = 0; i < count; i++) {
+      unsigned int x = input[base + i];
+
+      if (x >= 0x80000000UL) x = 0xffffffffUL - x;
+
+      p[i] = x * x1 + x2;
+    }
+
+    sdkVecInvCND(p, p, count);
+
+    for (int i = 0; i < count; i++) {
+      output[base + i] = (input[base + i] >= 0x80000000UL) ? -p[i] : p[i];
+    }
+  }
+}
@@ -48,6 +48,8 @@ extern "C" float getQuasirandomValue(
 
 extern "C" double getQuasirandomValue63(INT64 i, int dim);
 extern "C" double MoroInvCNDcpu(unsigned int p);
+extern "C" void MoroInvCNDcpuArray(double *output, const unsigned int *input,
+                                   int n);
 
 const int N = 1048576;
 
@@ -161,14 +163,31 @@ int main(int argc, char **argv) {
   sumRef = 0;
   unsigned int distance = ((unsigned int)-1) / (QRNG_DIMENSIONS * N + 1);
 
-  for (pos = 0; pos < QRNG_DIMENSIONS * N; pos++) {
-    unsigned int d = (pos + 1) * distance;
-    ref = MoroInvCNDcpu(d);
-    delta = (double)h_OutputGPU[pos] - ref;
-    sumDelta += fabs(delta);
-    sumRef += fabs(ref);
+  // reference values in chunks of refChunk inputs
+  const int refChunk = 4096;
+  unsigned int *h_InputCPU = (unsigned int *)malloc(refChunk * sizeof(unsigned int));
+  double *h_OutputCPU = (double *)malloc(refChunk * sizeof(double));
+
+  for (pos = 0; pos < QRNG_DIMENSIONS * N; pos += refChunk) {
+    int count = QRNG_DIMENSIONS * N - pos;
+
+    if (count > refChunk) count = refChunk;
+
+    for (int i = 0; i < count; i++) h_InputCPU[i] = (pos + i + 1) * distance;
+
+    MoroInvCNDcpuArray(h_OutputCPU, h_InputCPU, count);
+
+    for (int i = 0; i < count; i++) {
+      ref = h_OutputCPU[i];
+      delta = (double)h_OutputGPU[pos + i] - ref;
+      sumDelta += fabs(delta);
+      sumRef += fabs(ref);
+    }
   }
 
+  free(h_InputCPU);
+  free(h_OutputCPU);
+
   printf("L1 norm: %E\n\n", L1norm = sumDelta / sumRef);
   printf("Shutting down...\n");
 